@@ -0,0 +1,710 @@
+#include "bvh.h"
+#include "utils/cpu.h"
+#include "utils/thread.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+
+//Same results as _mm_min_ps and _mm_max_ps, including which side wins when one is NaN
+static float _bvh_Min(float a, float b) { return a < b ? a : b; }
+static float _bvh_Max(float a, float b) { return a > b ? a : b; }
+
+StardustErrorCode _bvh_Build(const StardustMesh* mesh, StardustInstructionSet instructionSet, StardustBVH* bvh)
+{
+	uint32_t triangleCount = mesh->indexCount / 3;
+	bvh->triangleCount = triangleCount;
+	bvh->instructionSet = cpu_SelectInstructionSet(instructionSet);
+
+	BVHBuilder builder;
+	builder.mesh = mesh;
+	builder.boxes = malloc(((size_t)triangleCount + 1) * sizeof(BVHBox));
+	builder.centroids = malloc(((size_t)triangleCount + 1) * 3 * sizeof(float));
+	builder.order = malloc(((size_t)triangleCount + 1) * sizeof(uint32_t));
+
+	if (builder.boxes == 0 || builder.centroids == 0 || builder.order == 0)
+	{
+		free(builder.boxes); free(builder.centroids); free(builder.order);
+		return STARDUST_ERROR_MEMORY_ERROR;
+	}
+
+	//The root box starts empty, the same as _bvh_ResetBox, and grows around every triangle
+	BVHRange root = { 0, triangleCount, 0, 0, 1, { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } } };
+
+	StardustErrorCode ret = STARDUST_ERROR_SUCCESS;
+	for (uint32_t i = 0; i < triangleCount && ret == STARDUST_ERROR_SUCCESS; i++)
+	{
+		BVHBox* box = &builder.boxes[i];
+		_bvh_ResetBox(box);
+
+		for (uint32_t j = 0; j < 3; j++)
+		{
+			uint32_t index = mesh->indices[i * 3 + j];
+			if (index >= mesh->vertexCount)
+			{
+				ret = STARDUST_ERROR_INVALID_ARGUMENT;
+				break;
+			}
+
+			const float* position = &mesh->vertices[index].x;
+			for (int k = 0; k < 3; k++)
+			{
+				box->minimum[k] = _bvh_Min(position[k], box->minimum[k]);
+				box->maximum[k] = _bvh_Max(position[k], box->maximum[k]);
+			}
+		}
+
+		for (int k = 0; k < 3; k++)
+			builder.centroids[i * 3 + k] = (box->minimum[k] + box->maximum[k]) * 0.5f;
+
+		builder.order[i] = i;
+		_bvh_GrowBox(&root.box, box);
+	}
+
+	//Small meshes aren't worth the threads
+	uint32_t threadCount = t_GetThreadCount();
+	uint32_t deferThreshold = 0;
+	if (threadCount > 1 && triangleCount >= BVH_MIN_DEFERRED * 4)
+	{
+		deferThreshold = triangleCount / (threadCount * 4);
+		if (deferThreshold < BVH_MIN_DEFERRED)
+			deferThreshold = BVH_MIN_DEFERRED;
+	}
+
+	BVHSubtree top;
+	memset(&top, 0, sizeof(BVHSubtree));
+
+	if (ret == STARDUST_ERROR_SUCCESS)
+		ret = _bvh_BuildSubtree(&builder, root, deferThreshold, &top);
+
+	if (ret == STARDUST_ERROR_SUCCESS && top.deferredCount > 0)
+	{
+		BVHSubtree* subtrees = malloc(top.deferredCount * sizeof(BVHSubtree));
+		if (subtrees == 0)
+			ret = STARDUST_ERROR_MEMORY_ERROR;
+		else
+		{
+			memset(subtrees, 0, top.deferredCount * sizeof(BVHSubtree));
+
+			BVHDeferredTask task = { &builder, top.deferred, subtrees };
+			ret = t_ParallelFor(top.deferredCount, _bvh_DeferredTask, &task, 0);
+
+			for (uint32_t i = 0; i < top.deferredCount; i++)
+			{
+				if (ret == STARDUST_ERROR_SUCCESS)
+					ret = _bvh_AppendSubtree(&top, &subtrees[i], &top.deferred[i]);
+				_bvh_FreeSubtree(&subtrees[i]);
+			}
+			free(subtrees);
+		}
+	}
+
+	free(builder.boxes); free(builder.centroids); free(builder.order);
+
+	if (ret != STARDUST_ERROR_SUCCESS)
+	{
+		_bvh_FreeSubtree(&top);
+		return ret;
+	}
+
+	free(top.deferred);
+	bvh->nodes = top.nodes;
+	bvh->nodeCount = top.nodeCount;
+	bvh->leaves = top.leaves;
+	bvh->leafCount = top.leafCount;
+	bvh->depth = top.depth;
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+void _bvh_Free(StardustBVH* bvh)
+{
+	free(bvh->nodes);
+	free(bvh->leaves);
+
+	bvh->nodes = 0;
+	bvh->leaves = 0;
+	bvh->nodeCount = 0;
+	bvh->leafCount = 0;
+}
+
+StardustErrorCode _bvh_BuildSubtree(BVHBuilder* builder, BVHRange range, uint32_t deferThreshold, BVHSubtree* subtree)
+{
+	uint32_t stackCapacity = 64;
+	uint32_t stackSize = 0;
+	BVHRange* stack = malloc(stackCapacity * sizeof(BVHRange));
+	if (stack == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
+
+	range.node = _bvh_AddNode(subtree);
+	if (range.node == STARDUST_BVH_EMPTY)
+	{
+		free(stack);
+		return STARDUST_ERROR_MEMORY_ERROR;
+	}
+	stack[stackSize++] = range;
+
+	StardustErrorCode ret = STARDUST_ERROR_SUCCESS;
+	while (stackSize > 0 && ret == STARDUST_ERROR_SUCCESS)
+	{
+		BVHRange current = stack[--stackSize];
+		if (current.depth > subtree->depth)
+			subtree->depth = current.depth;
+
+		//Children start as the whole range. The largest one that doesn't fit in a leaf is split until there are 4
+		uint32_t begins[4] = { current.begin };
+		uint32_t ends[4] = { current.end };
+		BVHBox boxes[4] = { current.box };
+		uint32_t childCount = current.end > current.begin ? 1 : 0;
+
+		while (childCount < 4)
+		{
+			int largest = -1;
+			float largestArea = -1.0f;
+			for (uint32_t i = 0; i < childCount; i++)
+			{
+				float area = _bvh_HalfArea(&boxes[i]);
+				if (ends[i] - begins[i] > BVH_LEAF_SIZE && area > largestArea)
+				{
+					largest = (int)i;
+					largestArea = area;
+				}
+			}
+
+			if (largest < 0)
+				break;
+
+			BVHBox left, right;
+			uint32_t middle = _bvh_SplitRange(builder, begins[largest], ends[largest], &left, &right);
+
+			begins[childCount] = middle;
+			ends[childCount] = ends[largest];
+			boxes[childCount] = right;
+			ends[largest] = middle;
+			boxes[largest] = left;
+			childCount++;
+		}
+
+		//Children that need nodes are pushed in reverse, so the tree is laid out left first
+		for (uint32_t i = childCount; i-- > 0 && ret == STARDUST_ERROR_SUCCESS;)
+		{
+			StardustBVHNode* node = &subtree->nodes[current.node];
+			node->minX[i] = boxes[i].minimum[0]; node->minY[i] = boxes[i].minimum[1]; node->minZ[i] = boxes[i].minimum[2];
+			node->maxX[i] = boxes[i].maximum[0]; node->maxY[i] = boxes[i].maximum[1]; node->maxZ[i] = boxes[i].maximum[2];
+
+			BVHRange child = { begins[i], ends[i], current.node, i, current.depth + 1, boxes[i] };
+
+			uint32_t index;
+			if (ends[i] - begins[i] <= BVH_LEAF_SIZE)
+			{
+				index = _bvh_AddLeaf(builder, begins[i], ends[i], subtree);
+				if (index == STARDUST_BVH_EMPTY)
+					ret = STARDUST_ERROR_MEMORY_ERROR;
+			}
+			else if (ends[i] - begins[i] <= deferThreshold)
+			{
+				//Filled in once the deferred range is built
+				index = STARDUST_BVH_EMPTY;
+
+				if (subtree->deferredCount == subtree->deferredCapacity)
+				{
+					uint32_t capacity = subtree->deferredCapacity == 0 ? 64 : subtree->deferredCapacity * 2;
+					BVHRange* deferred = realloc(subtree->deferred, capacity * sizeof(BVHRange));
+					if (deferred == 0)
+					{
+						ret = STARDUST_ERROR_MEMORY_ERROR;
+						break;
+					}
+
+					subtree->deferred = deferred;
+					subtree->deferredCapacity = capacity;
+				}
+				subtree->deferred[subtree->deferredCount++] = child;
+			}
+			else
+			{
+				index = _bvh_AddNode(subtree);
+				if (index == STARDUST_BVH_EMPTY)
+				{
+					ret = STARDUST_ERROR_MEMORY_ERROR;
+					break;
+				}
+
+				if (stackSize == stackCapacity)
+				{
+					BVHRange* grown = realloc(stack, stackCapacity * 2 * sizeof(BVHRange));
+					if (grown == 0)
+					{
+						ret = STARDUST_ERROR_MEMORY_ERROR;
+						break;
+					}
+
+					stack = grown;
+					stackCapacity *= 2;
+				}
+
+				child.node = index;
+				stack[stackSize++] = child;
+			}
+
+			subtree->nodes[current.node].children[i] = index;
+		}
+	}
+
+	free(stack);
+	return ret;
+}
+
+StardustErrorCode _bvh_DeferredTask(void* context, uint32_t index)
+{
+	BVHDeferredTask* task = context;
+	return _bvh_BuildSubtree(task->builder, task->ranges[index], 0, &task->subtrees[index]);
+}
+
+StardustErrorCode _bvh_AppendSubtree(BVHSubtree* destination, const BVHSubtree* subtree, const BVHRange* range)
+{
+	uint32_t nodeOffset = destination->nodeCount;
+	uint32_t leafOffset = destination->leafCount;
+
+	if (destination->nodeCapacity < nodeOffset + subtree->nodeCount)
+	{
+		StardustBVHNode* nodes = realloc(destination->nodes, ((size_t)nodeOffset + subtree->nodeCount) * sizeof(StardustBVHNode));
+		if (nodes == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
+
+		destination->nodes = nodes;
+		destination->nodeCapacity = nodeOffset + subtree->nodeCount;
+	}
+
+	if (destination->leafCapacity < leafOffset + subtree->leafCount)
+	{
+		StardustBVHLeaf* leaves = realloc(destination->leaves, ((size_t)leafOffset + subtree->leafCount) * sizeof(StardustBVHLeaf));
+		if (leaves == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
+
+		destination->leaves = leaves;
+		destination->leafCapacity = leafOffset + subtree->leafCount;
+	}
+
+	memcpy(destination->nodes + nodeOffset, subtree->nodes, subtree->nodeCount * sizeof(StardustBVHNode));
+	memcpy(destination->leaves + leafOffset, subtree->leaves, subtree->leafCount * sizeof(StardustBVHLeaf));
+
+	//Move the child indices past what is already there
+	for (uint32_t i = nodeOffset; i < nodeOffset + subtree->nodeCount; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			uint32_t child = destination->nodes[i].children[j];
+			if (child == STARDUST_BVH_EMPTY)
+				continue;
+
+			if ((child & STARDUST_BVH_LEAF) == STARDUST_BVH_LEAF)
+				destination->nodes[i].children[j] = STARDUST_BVH_LEAF | ((child & ~STARDUST_BVH_LEAF) + leafOffset);
+			else
+				destination->nodes[i].children[j] = child + nodeOffset;
+		}
+	}
+
+	destination->nodeCount += subtree->nodeCount;
+	destination->leafCount += subtree->leafCount;
+	destination->nodes[range->node].children[range->slot] = nodeOffset;
+
+	if (subtree->depth > destination->depth)
+		destination->depth = subtree->depth;
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+//Bin of a centroid. Used for binning and partitioning alike, so both always agree
+static uint32_t _bvh_GetBin(float centroid, float low, float scale)
+{
+	uint32_t bin = (uint32_t)((centroid - low) * scale);
+	return bin < BVH_BIN_COUNT ? bin : BVH_BIN_COUNT - 1;
+}
+
+uint32_t _bvh_SplitRange(BVHBuilder* builder, uint32_t begin, uint32_t end, BVHBox* left, BVHBox* right)
+{
+	//Bins span the centroids rather than the triangles, so that they all get used
+	BVHBox centroidBox;
+	_bvh_ResetBox(&centroidBox);
+	for (uint32_t i = begin; i < end; i++)
+	{
+		const float* centroid = &builder->centroids[builder->order[i] * 3];
+		for (int k = 0; k < 3; k++)
+		{
+			centroidBox.minimum[k] = _bvh_Min(centroid[k], centroidBox.minimum[k]);
+			centroidBox.maximum[k] = _bvh_Max(centroid[k], centroidBox.maximum[k]);
+		}
+	}
+
+	float scale[3];
+	for (int k = 0; k < 3; k++)
+	{
+		float extent = centroidBox.maximum[k] - centroidBox.minimum[k];
+		scale[k] = extent > 0.0f ? BVH_BIN_COUNT / extent : 0.0f;
+	}
+
+	BVHBox bins[3][BVH_BIN_COUNT];
+	uint32_t counts[3][BVH_BIN_COUNT];
+	memset(counts, 0, sizeof(counts));
+	for (int k = 0; k < 3; k++)
+	{
+		for (int b = 0; b < BVH_BIN_COUNT; b++)
+			_bvh_ResetBox(&bins[k][b]);
+	}
+
+	for (uint32_t i = begin; i < end; i++)
+	{
+		uint32_t triangle = builder->order[i];
+		for (int k = 0; k < 3; k++)
+		{
+			uint32_t bin = _bvh_GetBin(builder->centroids[triangle * 3 + k], centroidBox.minimum[k], scale[k]);
+			_bvh_GrowBox(&bins[k][bin], &builder->boxes[triangle]);
+			counts[k][bin]++;
+		}
+	}
+
+	//Sweep from the right for the cost of every right side, then from the left to find the cheapest split
+	float bestCost = FLT_MAX;
+	int bestAxis = -1;
+	uint32_t bestSplit = 0;
+	for (int k = 0; k < 3; k++)
+	{
+		if (scale[k] == 0.0f)
+			continue;
+
+		float rightCosts[BVH_BIN_COUNT];
+		uint32_t rightCounts[BVH_BIN_COUNT];
+		BVHBox accumulated;
+		_bvh_ResetBox(&accumulated);
+
+		uint32_t count = 0;
+		for (int b = BVH_BIN_COUNT - 1; b > 0; b--)
+		{
+			_bvh_GrowBox(&accumulated, &bins[k][b]);
+			count += counts[k][b];
+			rightCounts[b] = count;
+			rightCosts[b] = count > 0 ? _bvh_HalfArea(&accumulated) * count : 0.0f;
+		}
+
+		_bvh_ResetBox(&accumulated);
+		count = 0;
+		for (int b = 0; b < BVH_BIN_COUNT - 1; b++)
+		{
+			_bvh_GrowBox(&accumulated, &bins[k][b]);
+			count += counts[k][b];
+			if (count == 0 || rightCounts[b + 1] == 0)
+				continue;
+
+			float cost = _bvh_HalfArea(&accumulated) * count + rightCosts[b + 1];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = k;
+				bestSplit = (uint32_t)b + 1;
+			}
+		}
+	}
+
+	uint32_t middle;
+	if (bestAxis < 0)
+	{
+		//Every centroid is in the same place, so no split is better than another
+		middle = begin + (end - begin) / 2;
+	}
+	else
+	{
+		uint32_t i = begin;
+		uint32_t j = end;
+		while (i < j)
+		{
+			uint32_t triangle = builder->order[i];
+			if (_bvh_GetBin(builder->centroids[triangle * 3 + bestAxis], centroidBox.minimum[bestAxis], scale[bestAxis]) < bestSplit)
+				i++;
+			else
+			{
+				builder->order[i] = builder->order[--j];
+				builder->order[j] = triangle;
+			}
+		}
+		middle = i;
+	}
+
+	_bvh_GetRangeBox(builder, begin, middle, left);
+	_bvh_GetRangeBox(builder, middle, end, right);
+
+	return middle;
+}
+
+void _bvh_GetRangeBox(const BVHBuilder* builder, uint32_t begin, uint32_t end, BVHBox* box)
+{
+	_bvh_ResetBox(box);
+	for (uint32_t i = begin; i < end; i++)
+		_bvh_GrowBox(box, &builder->boxes[builder->order[i]]);
+}
+
+uint32_t _bvh_AddLeaf(const BVHBuilder* builder, uint32_t begin, uint32_t end, BVHSubtree* subtree)
+{
+	if (subtree->leafCount == subtree->leafCapacity)
+	{
+		uint32_t capacity = subtree->leafCapacity == 0 ? 64 : subtree->leafCapacity * 2;
+		StardustBVHLeaf* leaves = realloc(subtree->leaves, capacity * sizeof(StardustBVHLeaf));
+		if (leaves == 0) { return STARDUST_BVH_EMPTY; }
+
+		subtree->leaves = leaves;
+		subtree->leafCapacity = capacity;
+	}
+
+	//Unused slots have every vertex at the origin, which no ray can hit
+	StardustBVHLeaf* leaf = &subtree->leaves[subtree->leafCount];
+	memset(leaf, 0, sizeof(StardustBVHLeaf));
+
+	const StardustMesh* mesh = builder->mesh;
+	for (uint32_t i = 0; i < BVH_LEAF_SIZE; i++)
+	{
+		if (begin + i >= end)
+		{
+			leaf->triangles[i] = STARDUST_BVH_EMPTY;
+			continue;
+		}
+
+		uint32_t triangle = builder->order[begin + i];
+		const Vertex* a = &mesh->vertices[mesh->indices[triangle * 3]];
+		const Vertex* b = &mesh->vertices[mesh->indices[triangle * 3 + 1]];
+		const Vertex* c = &mesh->vertices[mesh->indices[triangle * 3 + 2]];
+
+		leaf->ax[i] = a->x; leaf->ay[i] = a->y; leaf->az[i] = a->z;
+		leaf->bx[i] = b->x; leaf->by[i] = b->y; leaf->bz[i] = b->z;
+		leaf->cx[i] = c->x; leaf->cy[i] = c->y; leaf->cz[i] = c->z;
+		leaf->triangles[i] = triangle;
+	}
+
+	return STARDUST_BVH_LEAF | subtree->leafCount++;
+}
+
+uint32_t _bvh_AddNode(BVHSubtree* subtree)
+{
+	if (subtree->nodeCount == subtree->nodeCapacity)
+	{
+		uint32_t capacity = subtree->nodeCapacity == 0 ? 64 : subtree->nodeCapacity * 2;
+		StardustBVHNode* nodes = realloc(subtree->nodes, capacity * sizeof(StardustBVHNode));
+		if (nodes == 0) { return STARDUST_BVH_EMPTY; }
+
+		subtree->nodes = nodes;
+		subtree->nodeCapacity = capacity;
+	}
+
+	//Empty children have inverted boxes, which nothing overlaps
+	StardustBVHNode* node = &subtree->nodes[subtree->nodeCount];
+	for (int i = 0; i < 4; i++)
+	{
+		node->minX[i] = FLT_MAX; node->minY[i] = FLT_MAX; node->minZ[i] = FLT_MAX;
+		node->maxX[i] = -FLT_MAX; node->maxY[i] = -FLT_MAX; node->maxZ[i] = -FLT_MAX;
+		node->children[i] = STARDUST_BVH_EMPTY;
+	}
+
+	return subtree->nodeCount++;
+}
+
+void _bvh_FreeSubtree(BVHSubtree* subtree)
+{
+	free(subtree->nodes);
+	free(subtree->leaves);
+	free(subtree->deferred);
+	memset(subtree, 0, sizeof(BVHSubtree));
+}
+
+void _bvh_ResetBox(BVHBox* box)
+{
+	for (int k = 0; k < 3; k++)
+	{
+		box->minimum[k] = FLT_MAX;
+		box->maximum[k] = -FLT_MAX;
+	}
+}
+
+void _bvh_GrowBox(BVHBox* box, const BVHBox* other)
+{
+	for (int k = 0; k < 3; k++)
+	{
+		box->minimum[k] = _bvh_Min(other->minimum[k], box->minimum[k]);
+		box->maximum[k] = _bvh_Max(other->maximum[k], box->maximum[k]);
+	}
+}
+
+float _bvh_HalfArea(const BVHBox* box)
+{
+	float x = box->maximum[0] - box->minimum[0];
+	float y = box->maximum[1] - box->minimum[1];
+	float z = box->maximum[2] - box->minimum[2];
+	return x * y + y * z + z * x;
+}
+
+
+// ================= Queries ================= //
+
+int _bvh_RaycastScalar(const StardustBVH* bvh, const float* origin, const float* direction, float maxDistance, StardustRayHit* hit)
+{
+	uint32_t local[BVH_STACK_SIZE];
+	uint32_t* stack = _bvh_GetStack(bvh, local);
+	if (stack == 0) { return 0; }
+
+	float inverse[3] = { 1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2] };
+	float best = maxDistance;
+	int found = 0;
+
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		uint32_t child = stack[--stackSize];
+
+		if ((child & STARDUST_BVH_LEAF) == STARDUST_BVH_LEAF)
+		{
+			//Möller-Trumbore. Unused slots have a zero determinant
+			const StardustBVHLeaf* leaf = &bvh->leaves[child & ~STARDUST_BVH_LEAF];
+			for (int i = 0; i < BVH_LEAF_SIZE; i++)
+			{
+				float e1x = leaf->bx[i] - leaf->ax[i], e1y = leaf->by[i] - leaf->ay[i], e1z = leaf->bz[i] - leaf->az[i];
+				float e2x = leaf->cx[i] - leaf->ax[i], e2y = leaf->cy[i] - leaf->ay[i], e2z = leaf->cz[i] - leaf->az[i];
+
+				float px = direction[1] * e2z - direction[2] * e2y;
+				float py = direction[2] * e2x - direction[0] * e2z;
+				float pz = direction[0] * e2y - direction[1] * e2x;
+
+				float determinant = (e1x * px + e1y * py) + e1z * pz;
+				float inverseDeterminant = 1.0f / determinant;
+
+				float sx = origin[0] - leaf->ax[i], sy = origin[1] - leaf->ay[i], sz = origin[2] - leaf->az[i];
+				float u = ((sx * px + sy * py) + sz * pz) * inverseDeterminant;
+
+				float qx = sy * e1z - sz * e1y;
+				float qy = sz * e1x - sx * e1z;
+				float qz = sx * e1y - sy * e1x;
+
+				float v = ((direction[0] * qx + direction[1] * qy) + direction[2] * qz) * inverseDeterminant;
+				float t = ((e2x * qx + e2y * qy) + e2z * qz) * inverseDeterminant;
+
+				if (determinant != 0.0f && u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t >= 0.0f && t < best)
+				{
+					best = t;
+					found = 1;
+
+					hit->distance = t;
+					hit->u = u;
+					hit->v = v;
+					hit->triangle = leaf->triangles[i];
+				}
+			}
+			continue;
+		}
+
+		//Slab test of the 4 children
+		const StardustBVHNode* node = &bvh->nodes[child];
+		float distances[4];
+		uint32_t hitMask = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			float x0 = (node->minX[i] - origin[0]) * inverse[0], x1 = (node->maxX[i] - origin[0]) * inverse[0];
+			float y0 = (node->minY[i] - origin[1]) * inverse[1], y1 = (node->maxY[i] - origin[1]) * inverse[1];
+			float z0 = (node->minZ[i] - origin[2]) * inverse[2], z1 = (node->maxZ[i] - origin[2]) * inverse[2];
+
+			float enter = _bvh_Max(_bvh_Max(_bvh_Min(x0, x1), _bvh_Min(y0, y1)), _bvh_Max(_bvh_Min(z0, z1), 0.0f));
+			float exit = _bvh_Min(_bvh_Min(_bvh_Max(x0, x1), _bvh_Max(y0, y1)), _bvh_Min(_bvh_Max(z0, z1), best));
+
+			distances[i] = enter;
+			if (enter <= exit && node->children[i] != STARDUST_BVH_EMPTY)
+				hitMask |= 1u << i;
+		}
+
+		_bvh_PushNearestLast(node, hitMask, distances, stack, &stackSize);
+	}
+
+	if (stack != local)
+		free(stack);
+
+	return found;
+}
+
+uint32_t _bvh_OverlapScalar(const StardustBVH* bvh, const float* minimum, const float* maximum, uint32_t* triangles, uint32_t capacity)
+{
+	uint32_t local[BVH_STACK_SIZE];
+	uint32_t* stack = _bvh_GetStack(bvh, local);
+	if (stack == 0) { return 0; }
+
+	uint32_t count = 0;
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		uint32_t child = stack[--stackSize];
+
+		if ((child & STARDUST_BVH_LEAF) == STARDUST_BVH_LEAF)
+		{
+			const StardustBVHLeaf* leaf = &bvh->leaves[child & ~STARDUST_BVH_LEAF];
+			for (int i = 0; i < BVH_LEAF_SIZE; i++)
+			{
+				int overlaps = leaf->triangles[i] != STARDUST_BVH_EMPTY &&
+					_bvh_Min(_bvh_Min(leaf->ax[i], leaf->bx[i]), leaf->cx[i]) <= maximum[0] && _bvh_Max(_bvh_Max(leaf->ax[i], leaf->bx[i]), leaf->cx[i]) >= minimum[0] &&
+					_bvh_Min(_bvh_Min(leaf->ay[i], leaf->by[i]), leaf->cy[i]) <= maximum[1] && _bvh_Max(_bvh_Max(leaf->ay[i], leaf->by[i]), leaf->cy[i]) >= minimum[1] &&
+					_bvh_Min(_bvh_Min(leaf->az[i], leaf->bz[i]), leaf->cz[i]) <= maximum[2] && _bvh_Max(_bvh_Max(leaf->az[i], leaf->bz[i]), leaf->cz[i]) >= minimum[2];
+
+				if (overlaps)
+				{
+					if (count < capacity)
+						triangles[count] = leaf->triangles[i];
+					count++;
+				}
+			}
+			continue;
+		}
+
+		//Children in reverse so that the first is visited first
+		const StardustBVHNode* node = &bvh->nodes[child];
+		for (int i = 3; i >= 0; i--)
+		{
+			int overlaps = node->children[i] != STARDUST_BVH_EMPTY &&
+				node->minX[i] <= maximum[0] && node->maxX[i] >= minimum[0] &&
+				node->minY[i] <= maximum[1] && node->maxY[i] >= minimum[1] &&
+				node->minZ[i] <= maximum[2] && node->maxZ[i] >= minimum[2];
+
+			if (overlaps)
+				stack[stackSize++] = node->children[i];
+		}
+	}
+
+	if (stack != local)
+		free(stack);
+
+	return count;
+}
+
+uint32_t* _bvh_GetStack(const StardustBVH* bvh, uint32_t* local)
+{
+	//Each node on the path leaves at most 3 siblings behind, and the deepest pushes 4
+	size_t needed = (size_t)bvh->depth * 3 + 1;
+	if (needed <= BVH_STACK_SIZE)
+		return local;
+
+	return malloc(needed * sizeof(uint32_t));
+}
+
+void _bvh_PushNearestLast(const StardustBVHNode* node, uint32_t hitMask, const float* distances, uint32_t* stack, uint32_t* stackSize)
+{
+	//Insertion sort of at most 4 children, furthest first. Ties keep the lower slot nearer
+	uint32_t order[4];
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		if ((hitMask & (1u << i)) == 0)
+			continue;
+
+		uint32_t j = count++;
+		while (j > 0 && distances[order[j - 1]] <= distances[i])
+		{
+			order[j] = order[j - 1];
+			j--;
+		}
+		order[j] = i;
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+		stack[(*stackSize)++] = node->children[order[i]];
+}
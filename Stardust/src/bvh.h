@@ -0,0 +1,196 @@
+#ifndef _STARDUST_BVH
+#define _STARDUST_BVH
+
+/*
+BVH builder and queries.
+
+Building:
+	Triangle boxes and centroids are computed once. Nodes are then built top down over ranges of a shared triangle order array.
+	A node starts with its whole range as one child and keeps splitting its largest child with a binned SAH split until it has 4
+	children or every child fits in a leaf. Children with more than BVH_LEAF_SIZE triangles become nodes of their own.
+
+	The top of the tree is built on the calling thread. Ranges below a size threshold are deferred instead of descended into.
+	Deferred ranges own disjoint parts of the order array, so they are built in parallel into their own node and leaf arrays,
+	which are then appended in the order they were deferred. The result doesn't depend on the number of threads.
+
+Queries:
+	Traversal keeps an explicit stack sized from the depth of the BVH. Rays visit the nearest children first and shrink their
+	maximum distance with every hit. The scalar and SSE2 kernels do the same operations in the same order, so they agree exactly.
+*/
+
+#include "stardust.h"
+
+#define BVH_LEAF_SIZE 4			//Triangles per leaf. Matches the SSE2 width
+#define BVH_BIN_COUNT 16		//SAH bins per axis
+#define BVH_STACK_SIZE 256		//Traversal stack kept on the stack. Deeper BVHs allocate one
+#define BVH_MIN_DEFERRED 1024	//Smallest range that is deferred to a parallel task
+
+typedef struct
+{
+	float minimum[3];
+	float maximum[3];
+} BVHBox;
+
+//Per triangle data shared by every build task
+typedef struct
+{
+	const StardustMesh* mesh;
+	BVHBox* boxes;			//Box of every triangle
+	float* centroids;		//3 floats per triangle. Centre of its box
+	uint32_t* order;		//Triangle order. Each range of a node is a contiguous part of it
+} BVHBuilder;
+
+//A range that still needs a node
+typedef struct
+{
+	uint32_t begin;
+	uint32_t end;
+	uint32_t node;			//Node to fill. For deferred ranges this is the parent node instead
+	uint32_t slot;			//Child slot of the parent. Only used by deferred ranges
+	uint32_t depth;			//Depth of the node. The root is 1
+	BVHBox box;				//Box around the triangles of the range
+} BVHRange;
+
+//Nodes and leaves built by one task
+typedef struct
+{
+	StardustBVHNode* nodes;
+	uint32_t nodeCount;
+	uint32_t nodeCapacity;
+
+	StardustBVHLeaf* leaves;
+	uint32_t leafCount;
+	uint32_t leafCapacity;
+
+	uint32_t depth;
+
+	BVHRange* deferred;		//Ranges left for parallel tasks. 0 when nothing may be deferred
+	uint32_t deferredCount;
+	uint32_t deferredCapacity;
+} BVHSubtree;
+
+typedef struct
+{
+	BVHBuilder* builder;
+	BVHRange* ranges;
+	BVHSubtree* subtrees;
+} BVHDeferredTask;
+
+// ==================== Functions ==================== //
+
+/// <summary>
+/// Builds a BVH over mesh
+/// </summary>
+/// <param name="mesh">Triangulated mesh</param>
+/// <param name="instructionSet">Highest instruction set the queries may use</param>
+/// <param name="bvh">Zeroed BVH to fill</param>
+/// <returns>Error code</returns>
+StardustErrorCode _bvh_Build(const StardustMesh* mesh, StardustInstructionSet instructionSet, StardustBVH* bvh);
+
+/// <summary>
+/// Frees the arrays of a BVH but not the BVH itself
+/// </summary>
+void _bvh_Free(StardustBVH* bvh);
+
+/// <summary>
+/// Builds the nodes below a range with an explicit stack
+/// </summary>
+/// <param name="builder">Shared triangle data</param>
+/// <param name="range">Range of the root of the subtree</param>
+/// <param name="deferThreshold">Child ranges of at most this many triangles go to subtree->deferred. 0 builds everything</param>
+/// <param name="subtree">Subtree to fill. Its first node is the root</param>
+/// <returns>Error code</returns>
+StardustErrorCode _bvh_BuildSubtree(BVHBuilder* builder, BVHRange range, uint32_t deferThreshold, BVHSubtree* subtree);
+
+/// <summary>
+/// Builds one deferred range. Task for t_ParallelFor
+/// </summary>
+StardustErrorCode _bvh_DeferredTask(void* context, uint32_t index);
+
+/// <summary>
+/// Appends a subtree to the BVH and points the child slot of its parent at it
+/// </summary>
+/// <returns>Error code</returns>
+StardustErrorCode _bvh_AppendSubtree(BVHSubtree* destination, const BVHSubtree* subtree, const BVHRange* range);
+
+/// <summary>
+/// Splits a range in two with binned SAH, falling back to the middle of the range when every centroid is the same
+/// </summary>
+/// <param name="builder">Shared triangle data</param>
+/// <param name="begin">First triangle of the range</param>
+/// <param name="end">One past the last triangle. At least 2 triangles</param>
+/// <param name="left">Filled with the box of the left half</param>
+/// <param name="right">Filled with the box of the right half</param>
+/// <returns>First triangle of the right half</returns>
+uint32_t _bvh_SplitRange(BVHBuilder* builder, uint32_t begin, uint32_t end, BVHBox* left, BVHBox* right);
+
+/// <summary>
+/// Gets the box around a range of triangles
+/// </summary>
+void _bvh_GetRangeBox(const BVHBuilder* builder, uint32_t begin, uint32_t end, BVHBox* box);
+
+/// <summary>
+/// Writes a leaf with the triangles of a range
+/// </summary>
+/// <returns>STARDUST_BVH_LEAF | leaf index, or STARDUST_BVH_EMPTY if the leaf couldn't be allocated</returns>
+uint32_t _bvh_AddLeaf(const BVHBuilder* builder, uint32_t begin, uint32_t end, BVHSubtree* subtree);
+
+/// <summary>
+/// Adds a node with every child slot empty
+/// </summary>
+/// <returns>Index of the node, or STARDUST_BVH_EMPTY if it couldn't be allocated</returns>
+uint32_t _bvh_AddNode(BVHSubtree* subtree);
+
+/// <summary>
+/// Frees the arrays of a subtree
+/// </summary>
+void _bvh_FreeSubtree(BVHSubtree* subtree);
+
+//Box helpers
+void _bvh_ResetBox(BVHBox* box);
+void _bvh_GrowBox(BVHBox* box, const BVHBox* other);
+float _bvh_HalfArea(const BVHBox* box);
+
+// Queries //
+
+/// <summary>
+/// Runs the raycast kernel for the BVH's instruction set. See sd_RaycastBVH
+/// </summary>
+int _bvh_Raycast(const StardustBVH* bvh, const float* origin, const float* direction, float maxDistance, StardustRayHit* hit);
+
+/// <summary>
+/// Runs the overlap kernel for the BVH's instruction set. See sd_OverlapBVH
+/// </summary>
+uint32_t _bvh_Overlap(const StardustBVH* bvh, const float* minimum, const float* maximum, uint32_t* triangles, uint32_t capacity);
+
+/// <summary>
+/// Finds the closest hit of a ray. See sd_RaycastBVH
+/// </summary>
+int _bvh_RaycastScalar(const StardustBVH* bvh, const float* origin, const float* direction, float maxDistance, StardustRayHit* hit);
+int _bvh_RaycastSSE2(const StardustBVH* bvh, const float* origin, const float* direction, float maxDistance, StardustRayHit* hit);
+
+/// <summary>
+/// Lists triangles whose boxes overlap a box. See sd_OverlapBVH
+/// </summary>
+uint32_t _bvh_OverlapScalar(const StardustBVH* bvh, const float* minimum, const float* maximum, uint32_t* triangles, uint32_t capacity);
+uint32_t _bvh_OverlapSSE2(const StardustBVH* bvh, const float* minimum, const float* maximum, uint32_t* triangles, uint32_t capacity);
+
+/// <summary>
+/// Gets a traversal stack of at least BVH_STACK_SIZE entries that fits the BVH. Uses local when it is big enough
+/// </summary>
+/// <param name="bvh">BVH to traverse</param>
+/// <param name="local">Array of BVH_STACK_SIZE entries</param>
+/// <returns>Stack, local or allocated with malloc. 0 if the allocation failed</returns>
+uint32_t* _bvh_GetStack(const StardustBVH* bvh, uint32_t* local);
+
+/// <summary>
+/// Pushes the hit children of a node so that the nearest is popped first
+/// </summary>
+/// <param name="node">Node</param>
+/// <param name="hitMask">Bit i is set when child i is hit</param>
+/// <param name="distances">Entry distance of each child</param>
+/// <param name="stack">Traversal stack</param>
+/// <param name="stackSize">Number of entries on the stack. Updated</param>
+void _bvh_PushNearestLast(const StardustBVHNode* node, uint32_t hitMask, const float* distances, uint32_t* stack, uint32_t* stackSize);
+
+#endif //_STARDUST_BVH
@@ -0,0 +1,223 @@
+#include "bvh.h"
+#include "utils/cpu.h"
+
+#include <stdlib.h>
+
+#ifdef STARDUST_X86
+#include <immintrin.h>
+#endif
+
+/*
+Query kernels.
+The SSE2 kernels test the 4 children of a node or the 4 triangles of a leaf at once. They do the same operations in the same
+order as the scalar kernels, and _mm_min_ps and _mm_max_ps match _bvh_Min and _bvh_Max, so both report the same hits.
+*/
+
+int _bvh_Raycast(const StardustBVH* bvh, const float* origin, const float* direction, float maxDistance, StardustRayHit* hit)
+{
+#ifdef STARDUST_X86
+	if (bvh->instructionSet >= STARDUST_INSTRUCTIONS_SSE2)
+		return _bvh_RaycastSSE2(bvh, origin, direction, maxDistance, hit);
+#endif
+
+	return _bvh_RaycastScalar(bvh, origin, direction, maxDistance, hit);
+}
+
+uint32_t _bvh_Overlap(const StardustBVH* bvh, const float* minimum, const float* maximum, uint32_t* triangles, uint32_t capacity)
+{
+#ifdef STARDUST_X86
+	if (bvh->instructionSet >= STARDUST_INSTRUCTIONS_SSE2)
+		return _bvh_OverlapSSE2(bvh, minimum, maximum, triangles, capacity);
+#endif
+
+	return _bvh_OverlapScalar(bvh, minimum, maximum, triangles, capacity);
+}
+
+#ifdef STARDUST_X86
+
+CPU_TARGET("sse2")
+int _bvh_RaycastSSE2(const StardustBVH* bvh, const float* origin, const float* direction, float maxDistance, StardustRayHit* hit)
+{
+	uint32_t local[BVH_STACK_SIZE];
+	uint32_t* stack = _bvh_GetStack(bvh, local);
+	if (stack == 0) { return 0; }
+
+	const __m128 originX = _mm_set1_ps(origin[0]), originY = _mm_set1_ps(origin[1]), originZ = _mm_set1_ps(origin[2]);
+	const __m128 directionX = _mm_set1_ps(direction[0]), directionY = _mm_set1_ps(direction[1]), directionZ = _mm_set1_ps(direction[2]);
+	const __m128 inverseX = _mm_set1_ps(1.0f / direction[0]), inverseY = _mm_set1_ps(1.0f / direction[1]), inverseZ = _mm_set1_ps(1.0f / direction[2]);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128i empty = _mm_set1_epi32((int)STARDUST_BVH_EMPTY);
+
+	float best = maxDistance;
+	int found = 0;
+
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		uint32_t child = stack[--stackSize];
+
+		if ((child & STARDUST_BVH_LEAF) == STARDUST_BVH_LEAF)
+		{
+			//Möller-Trumbore on 4 triangles. Unused slots have a zero determinant
+			const StardustBVHLeaf* leaf = &bvh->leaves[child & ~STARDUST_BVH_LEAF];
+			__m128 ax = _mm_loadu_ps(leaf->ax), ay = _mm_loadu_ps(leaf->ay), az = _mm_loadu_ps(leaf->az);
+
+			__m128 e1x = _mm_sub_ps(_mm_loadu_ps(leaf->bx), ax), e1y = _mm_sub_ps(_mm_loadu_ps(leaf->by), ay), e1z = _mm_sub_ps(_mm_loadu_ps(leaf->bz), az);
+			__m128 e2x = _mm_sub_ps(_mm_loadu_ps(leaf->cx), ax), e2y = _mm_sub_ps(_mm_loadu_ps(leaf->cy), ay), e2z = _mm_sub_ps(_mm_loadu_ps(leaf->cz), az);
+
+			__m128 px = _mm_sub_ps(_mm_mul_ps(directionY, e2z), _mm_mul_ps(directionZ, e2y));
+			__m128 py = _mm_sub_ps(_mm_mul_ps(directionZ, e2x), _mm_mul_ps(directionX, e2z));
+			__m128 pz = _mm_sub_ps(_mm_mul_ps(directionX, e2y), _mm_mul_ps(directionY, e2x));
+
+			__m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+			__m128 inverseDeterminant = _mm_div_ps(one, determinant);
+
+			__m128 sx = _mm_sub_ps(originX, ax), sy = _mm_sub_ps(originY, ay), sz = _mm_sub_ps(originZ, az);
+			__m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inverseDeterminant);
+
+			__m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+			__m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+			__m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+
+			__m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(directionX, qx), _mm_mul_ps(directionY, qy)), _mm_mul_ps(directionZ, qz)), inverseDeterminant);
+			__m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inverseDeterminant);
+
+			__m128 valid = _mm_and_ps(_mm_cmpneq_ps(determinant, zero), _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmpge_ps(v, zero)));
+			valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmple_ps(_mm_add_ps(u, v), one), _mm_cmpge_ps(t, zero)));
+			valid = _mm_and_ps(valid, _mm_cmplt_ps(t, _mm_set1_ps(best)));
+
+			int mask = _mm_movemask_ps(valid);
+			if (mask != 0)
+			{
+				float distances[4], us[4], vs[4];
+				_mm_storeu_ps(distances, t);
+				_mm_storeu_ps(us, u);
+				_mm_storeu_ps(vs, v);
+
+				//Lowest slot wins ties, like the scalar kernel
+				for (int i = 0; i < BVH_LEAF_SIZE; i++)
+				{
+					if ((mask & (1 << i)) == 0 || distances[i] >= best)
+						continue;
+
+					best = distances[i];
+					found = 1;
+
+					hit->distance = distances[i];
+					hit->u = us[i];
+					hit->v = vs[i];
+					hit->triangle = leaf->triangles[i];
+				}
+			}
+			continue;
+		}
+
+		//Slab test of the 4 children
+		const StardustBVHNode* node = &bvh->nodes[child];
+
+		__m128 x0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node->minX), originX), inverseX), x1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node->maxX), originX), inverseX);
+		__m128 y0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node->minY), originY), inverseY), y1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node->maxY), originY), inverseY);
+		__m128 z0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node->minZ), originZ), inverseZ), z1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node->maxZ), originZ), inverseZ);
+
+		__m128 enter = _mm_max_ps(_mm_max_ps(_mm_min_ps(x0, x1), _mm_min_ps(y0, y1)), _mm_max_ps(_mm_min_ps(z0, z1), zero));
+		__m128 exit = _mm_min_ps(_mm_min_ps(_mm_max_ps(x0, x1), _mm_max_ps(y0, y1)), _mm_min_ps(_mm_max_ps(z0, z1), _mm_set1_ps(best)));
+
+		__m128 unused = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)node->children), empty));
+		uint32_t hitMask = (uint32_t)_mm_movemask_ps(_mm_andnot_ps(unused, _mm_cmple_ps(enter, exit)));
+		if (hitMask == 0)
+			continue;
+
+		float distances[4];
+		_mm_storeu_ps(distances, enter);
+		_bvh_PushNearestLast(node, hitMask, distances, stack, &stackSize);
+	}
+
+	if (stack != local)
+		free(stack);
+
+	return found;
+}
+
+CPU_TARGET("sse2")
+uint32_t _bvh_OverlapSSE2(const StardustBVH* bvh, const float* minimum, const float* maximum, uint32_t* triangles, uint32_t capacity)
+{
+	uint32_t local[BVH_STACK_SIZE];
+	uint32_t* stack = _bvh_GetStack(bvh, local);
+	if (stack == 0) { return 0; }
+
+	const __m128 minimumX = _mm_set1_ps(minimum[0]), minimumY = _mm_set1_ps(minimum[1]), minimumZ = _mm_set1_ps(minimum[2]);
+	const __m128 maximumX = _mm_set1_ps(maximum[0]), maximumY = _mm_set1_ps(maximum[1]), maximumZ = _mm_set1_ps(maximum[2]);
+	const __m128i empty = _mm_set1_epi32((int)STARDUST_BVH_EMPTY);
+
+	uint32_t count = 0;
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		uint32_t child = stack[--stackSize];
+
+		__m128 lowX, lowY, lowZ, highX, highY, highZ;
+		const uint32_t* children;
+		if ((child & STARDUST_BVH_LEAF) == STARDUST_BVH_LEAF)
+		{
+			//Boxes of the 4 triangles
+			const StardustBVHLeaf* leaf = &bvh->leaves[child & ~STARDUST_BVH_LEAF];
+			__m128 ax = _mm_loadu_ps(leaf->ax), bx = _mm_loadu_ps(leaf->bx), cx = _mm_loadu_ps(leaf->cx);
+			__m128 ay = _mm_loadu_ps(leaf->ay), by = _mm_loadu_ps(leaf->by), cy = _mm_loadu_ps(leaf->cy);
+			__m128 az = _mm_loadu_ps(leaf->az), bz = _mm_loadu_ps(leaf->bz), cz = _mm_loadu_ps(leaf->cz);
+
+			lowX = _mm_min_ps(_mm_min_ps(ax, bx), cx); highX = _mm_max_ps(_mm_max_ps(ax, bx), cx);
+			lowY = _mm_min_ps(_mm_min_ps(ay, by), cy); highY = _mm_max_ps(_mm_max_ps(ay, by), cy);
+			lowZ = _mm_min_ps(_mm_min_ps(az, bz), cz); highZ = _mm_max_ps(_mm_max_ps(az, bz), cz);
+			children = leaf->triangles;
+		}
+		else
+		{
+			const StardustBVHNode* node = &bvh->nodes[child];
+			lowX = _mm_loadu_ps(node->minX); highX = _mm_loadu_ps(node->maxX);
+			lowY = _mm_loadu_ps(node->minY); highY = _mm_loadu_ps(node->maxY);
+			lowZ = _mm_loadu_ps(node->minZ); highZ = _mm_loadu_ps(node->maxZ);
+			children = node->children;
+		}
+
+		__m128 overlaps = _mm_and_ps(_mm_cmple_ps(lowX, maximumX), _mm_cmpge_ps(highX, minimumX));
+		overlaps = _mm_and_ps(overlaps, _mm_and_ps(_mm_cmple_ps(lowY, maximumY), _mm_cmpge_ps(highY, minimumY)));
+		overlaps = _mm_and_ps(overlaps, _mm_and_ps(_mm_cmple_ps(lowZ, maximumZ), _mm_cmpge_ps(highZ, minimumZ)));
+
+		__m128 unused = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)children), empty));
+		int mask = _mm_movemask_ps(_mm_andnot_ps(unused, overlaps));
+		if (mask == 0)
+			continue;
+
+		if ((child & STARDUST_BVH_LEAF) == STARDUST_BVH_LEAF)
+		{
+			for (int i = 0; i < BVH_LEAF_SIZE; i++)
+			{
+				if ((mask & (1 << i)) == 0)
+					continue;
+
+				if (count < capacity)
+					triangles[count] = children[i];
+				count++;
+			}
+		}
+		else
+		{
+			//Children in reverse so that the first is visited first
+			for (int i = 3; i >= 0; i--)
+			{
+				if ((mask & (1 << i)) != 0)
+					stack[stackSize++] = children[i];
+			}
+		}
+	}
+
+	if (stack != local)
+		free(stack);
+
+	return count;
+}
+
+#endif //STARDUST_X86
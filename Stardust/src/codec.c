@@ -0,0 +1,604 @@
+#include "codec.h"
+#include "postprocessing.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+StardustErrorCode _codec_EncodeMesh(const StardustMesh* mesh, unsigned char** data, size_t* size)
+{
+	*data = 0;
+	*size = 0;
+
+	StardustMeshDataType dataType = mesh->dataType & CODEC_DATA_TYPES;
+	if (mesh->tangents == 0)
+		dataType &= ~STARDUST_TANGENT_DATA;
+
+	unsigned char channels[CODEC_MAX_CHANNELS];
+	uint32_t channelCount = _codec_GetChannels(dataType, channels);
+
+	size_t bound = CODEC_HEADER_SIZE + _codec_GetIndexBound(mesh->indexCount) + _codec_GetVertexBound(mesh->vertexCount, channelCount);
+	CodecWriter writer = { malloc(bound), 0 };
+	if (writer.data == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
+
+	_codec_WriteU32(&writer, CODEC_MAGIC);
+	_codec_WriteU32(&writer, CODEC_VERSION);
+	_codec_WriteU32(&writer, dataType);
+	_codec_WriteU32(&writer, mesh->vertexCount);
+	_codec_WriteU32(&writer, mesh->indexCount);
+	_codec_WriteU32(&writer, mesh->vertexStride);
+	_codec_WriteU32(&writer, 0); //Index payload size. Filled in once it is known
+
+	//Triangle lists use the FIFO coder. Anything else is a plain delta stream
+	size_t indexStart = writer.size;
+	if (mesh->vertexStride == 3 && mesh->indexCount % 3 == 0)
+		_codec_EncodeTriangles(mesh->indices, mesh->indexCount, &writer);
+	else
+	{
+		uint32_t previous = 0;
+		for (uint32_t i = 0; i < mesh->indexCount; i++)
+		{
+			_codec_WriteVarint(&writer, _codec_Zigzag(mesh->indices[i] - previous));
+			previous = mesh->indices[i];
+		}
+	}
+
+	uint32_t indexSize = (uint32_t)(writer.size - indexStart);
+	for (int i = 0; i < 4; i++)
+		writer.data[CODEC_HEADER_SIZE - 4 + i] = (unsigned char)(indexSize >> (i * 8));
+
+	_codec_EncodeVertices(mesh, dataType, &writer);
+
+	//The bound is the worst case. Most payloads are far smaller
+	unsigned char* shrunk = realloc(writer.data, writer.size);
+	if (shrunk != 0)
+		writer.data = shrunk;
+
+	*data = writer.data;
+	*size = writer.size;
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+StardustErrorCode _codec_DecodeMesh(const unsigned char* data, size_t size, StardustMesh* mesh)
+{
+	CodecReader reader = { data, data + size };
+
+	uint32_t header[7];
+	for (int i = 0; i < 7; i++)
+	{
+		if (_codec_ReadU32(&reader, &header[i]) != STARDUST_ERROR_SUCCESS)
+			return STARDUST_ERROR_FILE_INVALID;
+	}
+
+	if (header[0] != CODEC_MAGIC || header[1] > CODEC_VERSION || header[6] > (size_t)(reader.end - reader.data))
+		return STARDUST_ERROR_FILE_INVALID;
+
+	mesh->dataType = header[2] & CODEC_DATA_TYPES;
+	mesh->vertexCount = header[3];
+	mesh->indexCount = header[4];
+	mesh->vertexStride = header[5];
+
+	//Every block and triangle takes at least a byte, so counts far beyond the payload are corrupt rather than a huge allocation
+	if (mesh->vertexCount / CODEC_BLOCK_VERTICES > size || mesh->indexCount / 3 > size)
+		return STARDUST_ERROR_FILE_INVALID;
+
+	mesh->vertices = malloc(((size_t)mesh->vertexCount + 1) * sizeof(Vertex));
+	mesh->indices = malloc(((size_t)mesh->indexCount + 1) * sizeof(uint32_t));
+	if ((mesh->dataType & STARDUST_TANGENT_DATA) == STARDUST_TANGENT_DATA)
+		mesh->tangents = malloc(((size_t)mesh->vertexCount + 1) * sizeof(Tangent));
+
+	if (mesh->vertices == 0 || mesh->indices == 0 || ((mesh->dataType & STARDUST_TANGENT_DATA) == STARDUST_TANGENT_DATA && mesh->tangents == 0))
+		return STARDUST_ERROR_MEMORY_ERROR;
+
+	memset(mesh->vertices, 0, (size_t)mesh->vertexCount * sizeof(Vertex));
+
+	CodecReader indexReader = { reader.data, reader.data + header[6] };
+	CodecReader vertexReader = { reader.data + header[6], reader.end };
+
+	StardustErrorCode ret = STARDUST_ERROR_SUCCESS;
+	if (mesh->vertexStride == 3 && mesh->indexCount % 3 == 0)
+		ret = _codec_DecodeTriangles(&indexReader, mesh->indexCount, mesh->vertexCount, mesh->indices);
+	else
+	{
+		uint32_t previous = 0;
+		for (uint32_t i = 0; i < mesh->indexCount && ret == STARDUST_ERROR_SUCCESS; i++)
+		{
+			uint32_t delta = 0;
+			ret = _codec_ReadVarint(&indexReader, &delta);
+
+			previous += _codec_Unzigzag(delta);
+			if (ret == STARDUST_ERROR_SUCCESS && previous >= mesh->vertexCount)
+				ret = STARDUST_ERROR_FILE_INVALID;
+
+			mesh->indices[i] = previous;
+		}
+	}
+
+	if (ret != STARDUST_ERROR_SUCCESS)
+		return ret;
+
+	return _codec_DecodeVertices(&vertexReader, mesh);
+}
+
+
+// ================= Indices ================= //
+
+void _codec_EncodeTriangles(const uint32_t* indices, uint32_t indexCount, CodecWriter* writer)
+{
+	IndexCodecState state;
+	memset(&state, 0, sizeof(IndexCodecState));
+
+	//Codes come first, one per triangle, so the decoder knows where the data stream starts
+	uint32_t triangleCount = indexCount / 3;
+	unsigned char* codes = writer->data + writer->size;
+	writer->size += triangleCount;
+
+	for (uint32_t i = 0; i < triangleCount; i++)
+	{
+		const uint32_t* triangle = &indices[i * 3];
+
+		//Most recent edge first. A shared edge appears reversed in the neighbouring triangle, which is how it was pushed
+		uint32_t age = CODEC_EDGE_FIFO_SIZE;
+		uint32_t rotation = 0;
+		for (uint32_t j = 0; j < state.edgeCount && age == CODEC_EDGE_FIFO_SIZE; j++)
+		{
+			const uint32_t* edge = state.edges[(state.edgeHead + CODEC_EDGE_FIFO_SIZE - 1 - j) % CODEC_EDGE_FIFO_SIZE];
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				if (triangle[k] == edge[0] && triangle[(k + 1) % 3] == edge[1])
+				{
+					age = j;
+					rotation = k;
+					break;
+				}
+			}
+		}
+
+		if (age == CODEC_EDGE_FIFO_SIZE)
+		{
+			//The 2 bytes of vertex codes go in front of any explicit vertices
+			unsigned char* vertexCodes = writer->data + writer->size;
+			writer->size += 2;
+
+			uint32_t a = _codec_EncodeVertexIndex(&state, triangle[0], writer);
+			uint32_t b = _codec_EncodeVertexIndex(&state, triangle[1], writer);
+			uint32_t c = _codec_EncodeVertexIndex(&state, triangle[2], writer);
+
+			codes[i] = CODEC_NO_EDGE;
+			vertexCodes[0] = (unsigned char)(a << 4 | b);
+			vertexCodes[1] = (unsigned char)c;
+
+			_codec_PushEdge(&state, triangle[1], triangle[0]);
+			_codec_PushEdge(&state, triangle[2], triangle[1]);
+			_codec_PushEdge(&state, triangle[0], triangle[2]);
+			continue;
+		}
+
+		uint32_t a = triangle[rotation];
+		uint32_t b = triangle[(rotation + 1) % 3];
+		uint32_t c = triangle[(rotation + 2) % 3];
+
+		codes[i] = (unsigned char)(age << 4 | _codec_EncodeVertexIndex(&state, c, writer));
+		_codec_PushEdge(&state, c, b);
+		_codec_PushEdge(&state, a, c);
+	}
+}
+
+StardustErrorCode _codec_DecodeTriangles(CodecReader* reader, uint32_t indexCount, uint32_t vertexCount, uint32_t* indices)
+{
+	IndexCodecState state;
+	memset(&state, 0, sizeof(IndexCodecState));
+
+	uint32_t triangleCount = indexCount / 3;
+	if (triangleCount > (size_t)(reader->end - reader->data))
+		return STARDUST_ERROR_FILE_INVALID;
+
+	const unsigned char* codes = reader->data;
+	reader->data += triangleCount;
+
+	StardustErrorCode ret = STARDUST_ERROR_SUCCESS;
+	for (uint32_t i = 0; i < triangleCount && ret == STARDUST_ERROR_SUCCESS; i++)
+	{
+		uint32_t* triangle = &indices[i * 3];
+
+		if (codes[i] == CODEC_NO_EDGE)
+		{
+			if (reader->end - reader->data < 2)
+				return STARDUST_ERROR_FILE_INVALID;
+
+			uint32_t a = reader->data[0] >> 4;
+			uint32_t b = reader->data[0] & 0x0F;
+			uint32_t c = reader->data[1];
+			reader->data += 2;
+
+			if (c > 0x0F)
+				return STARDUST_ERROR_FILE_INVALID;
+
+			ret = _codec_DecodeVertexIndex(&state, a, reader, vertexCount, &triangle[0]);
+			if (ret == STARDUST_ERROR_SUCCESS)
+				ret = _codec_DecodeVertexIndex(&state, b, reader, vertexCount, &triangle[1]);
+			if (ret == STARDUST_ERROR_SUCCESS)
+				ret = _codec_DecodeVertexIndex(&state, c, reader, vertexCount, &triangle[2]);
+
+			_codec_PushEdge(&state, triangle[1], triangle[0]);
+			_codec_PushEdge(&state, triangle[2], triangle[1]);
+			_codec_PushEdge(&state, triangle[0], triangle[2]);
+			continue;
+		}
+
+		uint32_t age = codes[i] >> 4;
+		if (age >= state.edgeCount)
+			return STARDUST_ERROR_FILE_INVALID;
+
+		const uint32_t* edge = state.edges[(state.edgeHead + CODEC_EDGE_FIFO_SIZE - 1 - age) % CODEC_EDGE_FIFO_SIZE];
+		triangle[0] = edge[0];
+		triangle[1] = edge[1];
+		ret = _codec_DecodeVertexIndex(&state, codes[i] & 0x0F, reader, vertexCount, &triangle[2]);
+
+		_codec_PushEdge(&state, triangle[2], triangle[1]);
+		_codec_PushEdge(&state, triangle[0], triangle[2]);
+	}
+
+	return ret;
+}
+
+uint32_t _codec_EncodeVertexIndex(IndexCodecState* state, uint32_t vertex, CodecWriter* writer)
+{
+	if (vertex == state->next)
+	{
+		state->next++;
+		_codec_PushVertex(state, vertex);
+		return 0;
+	}
+
+	for (uint32_t i = 0; i < state->vertexCount; i++)
+	{
+		if (state->vertices[(state->vertexHead + CODEC_VERTEX_FIFO_SIZE - 1 - i) % CODEC_VERTEX_FIFO_SIZE] == vertex)
+			return i + 1;
+	}
+
+	_codec_WriteVarint(writer, _codec_Zigzag(vertex - state->last));
+	state->last = vertex;
+	_codec_PushVertex(state, vertex);
+
+	return CODEC_EXPLICIT_VERTEX;
+}
+
+StardustErrorCode _codec_DecodeVertexIndex(IndexCodecState* state, uint32_t code, CodecReader* reader, uint32_t vertexCount, uint32_t* vertex)
+{
+	if (code == 0)
+	{
+		if (state->next >= vertexCount)
+			return STARDUST_ERROR_FILE_INVALID;
+
+		*vertex = state->next++;
+		_codec_PushVertex(state, *vertex);
+		return STARDUST_ERROR_SUCCESS;
+	}
+
+	if (code != CODEC_EXPLICIT_VERTEX)
+	{
+		if (code - 1 >= state->vertexCount)
+			return STARDUST_ERROR_FILE_INVALID;
+
+		*vertex = state->vertices[(state->vertexHead + CODEC_VERTEX_FIFO_SIZE - code) % CODEC_VERTEX_FIFO_SIZE];
+		return STARDUST_ERROR_SUCCESS;
+	}
+
+	uint32_t delta = 0;
+	if (_codec_ReadVarint(reader, &delta) != STARDUST_ERROR_SUCCESS)
+		return STARDUST_ERROR_FILE_INVALID;
+
+	*vertex = state->last + _codec_Unzigzag(delta);
+	if (*vertex >= vertexCount)
+		return STARDUST_ERROR_FILE_INVALID;
+
+	state->last = *vertex;
+	_codec_PushVertex(state, *vertex);
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+void _codec_PushEdge(IndexCodecState* state, uint32_t a, uint32_t b)
+{
+	state->edges[state->edgeHead][0] = a;
+	state->edges[state->edgeHead][1] = b;
+	state->edgeHead = (state->edgeHead + 1) % CODEC_EDGE_FIFO_SIZE;
+
+	if (state->edgeCount < CODEC_EDGE_FIFO_SIZE)
+		state->edgeCount++;
+}
+
+void _codec_PushVertex(IndexCodecState* state, uint32_t vertex)
+{
+	state->vertices[state->vertexHead] = vertex;
+	state->vertexHead = (state->vertexHead + 1) % CODEC_VERTEX_FIFO_SIZE;
+
+	if (state->vertexCount < CODEC_VERTEX_FIFO_SIZE)
+		state->vertexCount++;
+}
+
+size_t _codec_GetIndexBound(uint32_t indexCount)
+{
+	//A triangle without a shared edge takes a code, 2 vertex codes and 3 varints of up to 5 bytes. That is 6 bytes per index,
+	//which also covers the 5 byte varints of other strides
+	return (size_t)indexCount * 6;
+}
+
+
+// ================= Vertices ================= //
+
+uint32_t _codec_GetChannels(StardustMeshDataType dataType, unsigned char* channels)
+{
+	//Positions always. Floats 0 to 3 of Vertex
+	uint32_t count = 0;
+	for (unsigned char i = 0; i < 4; i++)
+		channels[count++] = i;
+
+	if ((dataType & STARDUST_COLOR_DATA) == STARDUST_COLOR_DATA)
+	{
+		for (unsigned char i = 4; i < 7; i++)
+			channels[count++] = i;
+	}
+
+	if ((dataType & STARDUST_NORMAL_DATA) == STARDUST_NORMAL_DATA)
+	{
+		for (unsigned char i = 7; i < 10; i++)
+			channels[count++] = i;
+	}
+
+	if ((dataType & STARDUST_TEXTURE_DATA) == STARDUST_TEXTURE_DATA)
+	{
+		for (unsigned char i = 10; i < 13; i++)
+			channels[count++] = i;
+	}
+
+	if ((dataType & STARDUST_TANGENT_DATA) == STARDUST_TANGENT_DATA)
+	{
+		for (unsigned char i = CODEC_TANGENT_CHANNEL; i < CODEC_TANGENT_CHANNEL + 4; i++)
+			channels[count++] = i;
+	}
+
+	return count;
+}
+
+void _codec_EncodeVertices(const StardustMesh* mesh, StardustMeshDataType dataType, CodecWriter* writer)
+{
+	unsigned char channels[CODEC_MAX_CHANNELS];
+	uint32_t channelCount = _codec_GetChannels(dataType, channels);
+
+	uint32_t previous[CODEC_MAX_CHANNELS] = { 0 };
+	unsigned char planes[4][CODEC_BLOCK_VERTICES];
+
+	for (uint32_t start = 0; start < mesh->vertexCount; start += CODEC_BLOCK_VERTICES)
+	{
+		uint32_t count = mesh->vertexCount - start < CODEC_BLOCK_VERTICES ? mesh->vertexCount - start : CODEC_BLOCK_VERTICES;
+
+		for (uint32_t c = 0; c < channelCount; c++)
+		{
+			memset(planes, 0, sizeof(planes));
+
+			for (uint32_t i = 0; i < count; i++)
+			{
+				const float* source = channels[c] < CODEC_TANGENT_CHANNEL ? &((const float*)&mesh->vertices[start + i])[channels[c]] :
+					&((const float*)&mesh->tangents[start + i])[channels[c] - CODEC_TANGENT_CHANNEL];
+
+				uint32_t bits;
+				memcpy(&bits, source, sizeof(uint32_t));
+
+				uint32_t delta = _codec_Zigzag(bits - previous[c]);
+				previous[c] = bits;
+
+				for (int p = 0; p < 4; p++)
+					planes[p][i] = (unsigned char)(delta >> (p * 8));
+			}
+
+			for (int p = 0; p < 4; p++)
+				_codec_EncodePlane(planes[p], count, writer);
+		}
+	}
+}
+
+StardustErrorCode _codec_DecodeVertices(CodecReader* reader, StardustMesh* mesh)
+{
+	unsigned char channels[CODEC_MAX_CHANNELS];
+	uint32_t channelCount = _codec_GetChannels(mesh->dataType, channels);
+
+	ChannelDecoder decoder = _codec_GetChannelDecoder(_post_GetSettings()->instructionSet);
+
+	uint32_t previous[CODEC_MAX_CHANNELS] = { 0 };
+	uint32_t words[CODEC_BLOCK_VERTICES];
+
+	for (uint32_t start = 0; start < mesh->vertexCount; start += CODEC_BLOCK_VERTICES)
+	{
+		uint32_t count = mesh->vertexCount - start < CODEC_BLOCK_VERTICES ? mesh->vertexCount - start : CODEC_BLOCK_VERTICES;
+
+		for (uint32_t c = 0; c < channelCount; c++)
+		{
+			StardustErrorCode ret = decoder(reader, count, &previous[c], words);
+			if (ret != STARDUST_ERROR_SUCCESS)
+				return ret;
+
+			//Scatter into the interleaved vertices
+			if (channels[c] < CODEC_TANGENT_CHANNEL)
+			{
+				for (uint32_t i = 0; i < count; i++)
+					memcpy(&((float*)&mesh->vertices[start + i])[channels[c]], &words[i], sizeof(uint32_t));
+			}
+			else
+			{
+				for (uint32_t i = 0; i < count; i++)
+					memcpy(&((float*)&mesh->tangents[start + i])[channels[c] - CODEC_TANGENT_CHANNEL], &words[i], sizeof(uint32_t));
+			}
+		}
+	}
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+void _codec_EncodePlane(const unsigned char* bytes, uint32_t count, CodecWriter* writer)
+{
+	uint32_t groupCount = (count + CODEC_GROUP_SIZE - 1) / CODEC_GROUP_SIZE;
+
+	//Width codes of 4 groups per byte, in front of the groups
+	unsigned char* header = writer->data + writer->size;
+	writer->size += (groupCount + 3) / 4;
+	memset(header, 0, (groupCount + 3) / 4);
+
+	for (uint32_t g = 0; g < groupCount; g++)
+	{
+		const unsigned char* group = &bytes[g * CODEC_GROUP_SIZE];
+
+		unsigned char largest = 0;
+		for (int i = 0; i < CODEC_GROUP_SIZE; i++)
+		{
+			if (group[i] > largest)
+				largest = group[i];
+		}
+
+		//0, 2, 4 or 8 bits
+		unsigned char width = largest == 0 ? 0 : largest < 4 ? 1 : largest < 16 ? 2 : 3;
+		header[g / 4] |= (unsigned char)(width << ((g % 4) * 2));
+
+		unsigned char* packed = writer->data + writer->size;
+		if (width == 1)
+		{
+			memset(packed, 0, 4);
+			for (int i = 0; i < CODEC_GROUP_SIZE; i++)
+				packed[i % 4] |= (unsigned char)(group[i] << ((i / 4) * 2));
+			writer->size += 4;
+		}
+		else if (width == 2)
+		{
+			memset(packed, 0, 8);
+			for (int i = 0; i < CODEC_GROUP_SIZE; i++)
+				packed[i % 8] |= (unsigned char)(group[i] << ((i / 8) * 4));
+			writer->size += 8;
+		}
+		else if (width == 3)
+		{
+			memcpy(packed, group, CODEC_GROUP_SIZE);
+			writer->size += CODEC_GROUP_SIZE;
+		}
+	}
+}
+
+size_t _codec_GetVertexBound(uint32_t vertexCount, uint32_t channelCount)
+{
+	//Every plane of a block at 8 bits per byte, plus the headers and the padding of the last group
+	size_t blockCount = ((size_t)vertexCount + CODEC_BLOCK_VERTICES - 1) / CODEC_BLOCK_VERTICES;
+	return blockCount * channelCount * 4 * (CODEC_BLOCK_VERTICES + CODEC_BLOCK_VERTICES / CODEC_GROUP_SIZE / 4);
+}
+
+StardustErrorCode _codec_DecodeChannelScalar(CodecReader* reader, uint32_t count, uint32_t* previous, uint32_t* words)
+{
+	unsigned char planes[4][CODEC_BLOCK_VERTICES];
+	uint32_t groupCount = (count + CODEC_GROUP_SIZE - 1) / CODEC_GROUP_SIZE;
+	uint32_t headerSize = (groupCount + 3) / 4;
+
+	for (int p = 0; p < 4; p++)
+	{
+		if (headerSize > (size_t)(reader->end - reader->data))
+			return STARDUST_ERROR_FILE_INVALID;
+
+		const unsigned char* header = reader->data;
+		reader->data += headerSize;
+
+		for (uint32_t g = 0; g < groupCount; g++)
+		{
+			unsigned char* group = &planes[p][g * CODEC_GROUP_SIZE];
+			uint32_t width = (header[g / 4] >> ((g % 4) * 2)) & 3;
+
+			//0, 4, 8 or 16 bytes
+			uint32_t size = width == 0 ? 0 : 2u << width;
+			if (size > (size_t)(reader->end - reader->data))
+				return STARDUST_ERROR_FILE_INVALID;
+
+			const unsigned char* packed = reader->data;
+			for (int i = 0; i < CODEC_GROUP_SIZE; i++)
+			{
+				if (width == 0)
+					group[i] = 0;
+				else if (width == 1)
+					group[i] = (packed[i % 4] >> ((i / 4) * 2)) & 3;
+				else if (width == 2)
+					group[i] = (packed[i % 8] >> ((i / 8) * 4)) & 15;
+				else
+					group[i] = packed[i];
+			}
+
+			reader->data += size;
+		}
+	}
+
+	uint32_t value = *previous;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t delta = planes[0][i] | (uint32_t)planes[1][i] << 8 | (uint32_t)planes[2][i] << 16 | (uint32_t)planes[3][i] << 24;
+		value += _codec_Unzigzag(delta);
+		words[i] = value;
+	}
+	*previous = value;
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+
+// ================= Streams ================= //
+
+void _codec_WriteU32(CodecWriter* writer, uint32_t value)
+{
+	for (int i = 0; i < 4; i++)
+		writer->data[writer->size++] = (unsigned char)(value >> (i * 8));
+}
+
+StardustErrorCode _codec_ReadU32(CodecReader* reader, uint32_t* value)
+{
+	if (reader->end - reader->data < 4)
+		return STARDUST_ERROR_FILE_INVALID;
+
+	*value = 0;
+	for (int i = 0; i < 4; i++)
+		*value |= (uint32_t)reader->data[i] << (i * 8);
+	reader->data += 4;
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+void _codec_WriteVarint(CodecWriter* writer, uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		writer->data[writer->size++] = (unsigned char)(value | 0x80);
+		value >>= 7;
+	}
+	writer->data[writer->size++] = (unsigned char)value;
+}
+
+StardustErrorCode _codec_ReadVarint(CodecReader* reader, uint32_t* value)
+{
+	*value = 0;
+	for (int shift = 0; shift < 35; shift += 7)
+	{
+		if (reader->data == reader->end)
+			return STARDUST_ERROR_FILE_INVALID;
+
+		unsigned char byte = *reader->data++;
+		*value |= (uint32_t)(byte & 0x7F) << shift;
+
+		if ((byte & 0x80) == 0)
+			return STARDUST_ERROR_SUCCESS;
+	}
+
+	return STARDUST_ERROR_FILE_INVALID;
+}
+
+uint32_t _codec_Zigzag(uint32_t value)
+{
+	return (value << 1) ^ (0u - (value >> 31));
+}
+
+uint32_t _codec_Unzigzag(uint32_t value)
+{
+	return (value >> 1) ^ (0u - (value & 1));
+}
@@ -0,0 +1,265 @@
+#ifndef _STARDUST_CODEC
+#define _STARDUST_CODEC
+
+/*
+Mesh codec. Compresses the vertex and index buffers of a mesh into a single payload for caches and network transfer.
+
+Payload:
+	Header of 7 little endian uint32s: magic "SDMC", version, dataType, vertexCount, indexCount, vertexStride, index payload size.
+	The index payload follows the header and the vertex payload takes up the rest.
+
+Indices:
+	Triangle lists are coded one triangle at a time against a FIFO of the edges of recent triangles and a FIFO of recent vertices.
+	Strips and fans almost always share an edge with a recent triangle, so most triangles only need their third vertex.
+	After vertex fetch optimisation that vertex is usually the next unused one, so a typical triangle costs one code byte.
+
+	Code byte of a triangle, written to the code stream which holds one byte per triangle:
+		High nibble 0 to 14 -> Age of the shared edge in the edge FIFO. The triangle starts with that edge
+			Low nibble 0 -> The third vertex is the next unused vertex
+			Low nibble 1 to 14 -> The third vertex is in the vertex FIFO at age (low - 1)
+			Low nibble 15 -> The third vertex follows in the data stream
+		0xF0 -> No edge is shared. 2 bytes in the data stream hold a vertex code (0, 1 to 14 or 15 as above) for each of the 3 vertices
+	Explicit vertices are LEB128 varints of the zigzagged difference to the last explicit vertex.
+	Triangles keep their order and winding, but may start from a different corner.
+	Index buffers of other strides are stored as varints of the zigzagged difference to the previous index.
+
+Vertices:
+	Every attribute in the mesh's data type is split into 32 bit channels, like position x. Channels are coded separately in blocks of
+	CODEC_BLOCK_VERTICES vertices as the difference of the bits to the previous vertex, zigzagged so that small negative differences
+	stay small. The 4 bytes of each difference are then transposed into byte planes, so the mostly zero high bytes sit together.
+	Each plane is cut into groups of 16 bytes, and each group is bit packed at 0, 2, 4 or 8 bits per byte.
+	2 bits per group select the width, packed 4 to a byte in front of the groups of the plane.
+
+	2 bit groups store byte n at bit 2 * (n / 4) of packed byte n % 4, and 4 bit groups store byte n at bit 4 * (n / 8) of packed byte n % 8.
+	This lets the SIMD decoder unpack a group with a handful of shifts and masks.
+*/
+
+#include "stardust.h"
+
+#define CODEC_MAGIC 0x434D4453 //"SDMC" read as a little endian uint32
+#define CODEC_VERSION 1
+#define CODEC_HEADER_SIZE 28
+
+#define CODEC_EDGE_FIFO_SIZE 15 //High nibble 15 marks a triangle without a shared edge
+#define CODEC_VERTEX_FIFO_SIZE 14 //Low nibble 0 is the next vertex and 15 an explicit vertex
+#define CODEC_NO_EDGE 0xF0
+#define CODEC_EXPLICIT_VERTEX 15
+
+#define CODEC_BLOCK_VERTICES 256
+#define CODEC_GROUP_SIZE 16
+#define CODEC_MAX_CHANNELS 17 //13 vertex floats and 4 tangent floats
+#define CODEC_TANGENT_CHANNEL 13 //Channels from here on are tangent components
+
+//Data types that are stored in a payload
+#define CODEC_DATA_TYPES (STARDUST_VERTEX_DATA | STARDUST_INDEX_DATA | STARDUST_TEXTURE_DATA | STARDUST_NORMAL_DATA | STARDUST_COLOR_DATA | STARDUST_SMOOTHSHADING | STARDUST_TANGENT_DATA)
+
+//Write position of a growing byte stream
+typedef struct
+{
+	unsigned char* data;
+	size_t size;
+} CodecWriter;
+
+//Read position of a byte stream
+typedef struct
+{
+	const unsigned char* data;
+	const unsigned char* end;
+} CodecReader;
+
+//FIFOs shared by the index encoder and decoder, so that both see the same history
+typedef struct
+{
+	uint32_t edges[CODEC_EDGE_FIFO_SIZE][2];
+	uint32_t edgeHead;		//Slot the next edge goes in
+	uint32_t edgeCount;
+
+	uint32_t vertices[CODEC_VERTEX_FIFO_SIZE];
+	uint32_t vertexHead;
+	uint32_t vertexCount;
+
+	uint32_t next;			//Next vertex that hasn't been used yet
+	uint32_t last;			//Last explicitly coded vertex
+} IndexCodecState;
+
+/// <summary>
+/// Decodes one channel of a block of vertices. Reads the 4 byte planes and writes the reconstructed bits of every vertex.
+/// </summary>
+/// <param name="reader">Reader at the first plane. Moved past the 4 planes</param>
+/// <param name="count">Number of vertices in the block</param>
+/// <param name="previous">Bits of the channel in the vertex before the block. Updated to the last vertex of the block</param>
+/// <param name="words">Array of CODEC_BLOCK_VERTICES words to fill</param>
+/// <returns>STARDUST_ERROR_SUCCESS, or STARDUST_ERROR_FILE_INVALID if the planes run past the end of the payload</returns>
+typedef StardustErrorCode (*ChannelDecoder)(CodecReader* reader, uint32_t count, uint32_t* previous, uint32_t* words);
+
+// ==================== Functions ==================== //
+
+/// <summary>
+/// Encodes a mesh into a payload allocated with malloc.
+/// </summary>
+/// <param name="mesh">Mesh to encode. Meshlets and levels of detail are not stored</param>
+/// <param name="data">Filled with the payload</param>
+/// <param name="size">Filled with the size of the payload in bytes</param>
+/// <returns>Error code</returns>
+StardustErrorCode _codec_EncodeMesh(const StardustMesh* mesh, unsigned char** data, size_t* size);
+
+/// <summary>
+/// Decodes a payload into mesh.
+/// Every count and index is checked against the payload, so corrupted payloads fail rather than reading out of bounds.
+/// </summary>
+/// <param name="data">Payload</param>
+/// <param name="size">Size of the payload in bytes</param>
+/// <param name="mesh">Zeroed mesh to fill</param>
+/// <returns>Error code. STARDUST_ERROR_FILE_INVALID for payloads that are corrupted or from a newer version</returns>
+StardustErrorCode _codec_DecodeMesh(const unsigned char* data, size_t size, StardustMesh* mesh);
+
+
+
+// Indices //
+
+/// <summary>
+/// Encodes a triangle list with the edge and vertex FIFOs
+/// </summary>
+/// <param name="indices">Triangle list</param>
+/// <param name="indexCount">Number of indices. Must be a multiple of 3</param>
+/// <param name="writer">Writer with room for _codec_GetIndexBound bytes</param>
+void _codec_EncodeTriangles(const uint32_t* indices, uint32_t indexCount, CodecWriter* writer);
+
+/// <summary>
+/// Decodes a triangle list written by _codec_EncodeTriangles
+/// </summary>
+/// <param name="reader">Reader over the index payload</param>
+/// <param name="indexCount">Number of indices</param>
+/// <param name="vertexCount">Number of vertices. Every index is checked against it</param>
+/// <param name="indices">Array of indexCount indices to fill</param>
+/// <returns>Error code</returns>
+StardustErrorCode _codec_DecodeTriangles(CodecReader* reader, uint32_t indexCount, uint32_t vertexCount, uint32_t* indices);
+
+/// <summary>
+/// Codes a vertex of a triangle as the next vertex, a vertex FIFO entry or an explicit vertex, which is written to writer.
+/// New vertices are added to the vertex FIFO.
+/// </summary>
+/// <returns>Vertex code. 0, 1 to 14 or CODEC_EXPLICIT_VERTEX</returns>
+uint32_t _codec_EncodeVertexIndex(IndexCodecState* state, uint32_t vertex, CodecWriter* writer);
+
+/// <summary>
+/// Reverses _codec_EncodeVertexIndex
+/// </summary>
+/// <param name="state">Codec state</param>
+/// <param name="code">Vertex code</param>
+/// <param name="reader">Reader of the data stream, for explicit vertices</param>
+/// <param name="vertexCount">Number of vertices</param>
+/// <param name="vertex">Filled with the vertex</param>
+/// <returns>Error code</returns>
+StardustErrorCode _codec_DecodeVertexIndex(IndexCodecState* state, uint32_t code, CodecReader* reader, uint32_t vertexCount, uint32_t* vertex);
+
+/// <summary>
+/// Adds a directed edge to the edge FIFO
+/// </summary>
+void _codec_PushEdge(IndexCodecState* state, uint32_t a, uint32_t b);
+
+/// <summary>
+/// Adds a vertex to the vertex FIFO
+/// </summary>
+void _codec_PushVertex(IndexCodecState* state, uint32_t vertex);
+
+/// <summary>
+/// Gets the worst case size of an index payload
+/// </summary>
+/// <param name="indexCount">Number of indices</param>
+/// <returns>Size in bytes</returns>
+size_t _codec_GetIndexBound(uint32_t indexCount);
+
+
+
+// Vertices //
+
+/// <summary>
+/// Gets the channels stored for a data type
+/// </summary>
+/// <param name="dataType">Data type of the mesh</param>
+/// <param name="channels">Array of CODEC_MAX_CHANNELS to fill. Below CODEC_TANGENT_CHANNEL a channel is a float of Vertex, otherwise a float of Tangent</param>
+/// <returns>Number of channels</returns>
+uint32_t _codec_GetChannels(StardustMeshDataType dataType, unsigned char* channels);
+
+/// <summary>
+/// Encodes the vertices, and tangents when the mesh has them, in blocks of CODEC_BLOCK_VERTICES
+/// </summary>
+/// <param name="mesh">Mesh to encode</param>
+/// <param name="dataType">Data type that picks the channels</param>
+/// <param name="writer">Writer with room for _codec_GetVertexBound bytes</param>
+void _codec_EncodeVertices(const StardustMesh* mesh, StardustMeshDataType dataType, CodecWriter* writer);
+
+/// <summary>
+/// Decodes vertices written by _codec_EncodeVertices into mesh->vertices and mesh->tangents.
+/// The channel decoder is picked for the instruction set in the post processing settings.
+/// </summary>
+/// <param name="reader">Reader over the vertex payload</param>
+/// <param name="mesh">Mesh with its vertex count, data type and arrays set. Attributes that aren't stored must already be zeroed</param>
+/// <returns>Error code</returns>
+StardustErrorCode _codec_DecodeVertices(CodecReader* reader, StardustMesh* mesh);
+
+/// <summary>
+/// Bit packs a byte plane of a block in groups of CODEC_GROUP_SIZE
+/// </summary>
+/// <param name="bytes">Plane padded with zeros to a multiple of CODEC_GROUP_SIZE</param>
+/// <param name="count">Number of vertices in the block</param>
+/// <param name="writer">Writer</param>
+void _codec_EncodePlane(const unsigned char* bytes, uint32_t count, CodecWriter* writer);
+
+/// <summary>
+/// Gets the worst case size of a vertex payload
+/// </summary>
+/// <param name="vertexCount">Number of vertices</param>
+/// <param name="channelCount">Number of channels</param>
+/// <returns>Size in bytes</returns>
+size_t _codec_GetVertexBound(uint32_t vertexCount, uint32_t channelCount);
+
+/// <summary>
+/// Picks the fastest channel decoder for the CPU, capped by requested
+/// </summary>
+/// <param name="requested">Highest instruction set allowed</param>
+/// <returns>Channel decoder</returns>
+ChannelDecoder _codec_GetChannelDecoder(StardustInstructionSet requested);
+
+//Channel decoders. See ChannelDecoder
+StardustErrorCode _codec_DecodeChannelScalar(CodecReader* reader, uint32_t count, uint32_t* previous, uint32_t* words);
+StardustErrorCode _codec_DecodeChannelSSE2(CodecReader* reader, uint32_t count, uint32_t* previous, uint32_t* words);
+
+
+
+// Streams //
+
+/// <summary>
+/// Writes a little endian uint32
+/// </summary>
+void _codec_WriteU32(CodecWriter* writer, uint32_t value);
+
+/// <summary>
+/// Reads a little endian uint32
+/// </summary>
+/// <returns>STARDUST_ERROR_FILE_INVALID past the end of the stream</returns>
+StardustErrorCode _codec_ReadU32(CodecReader* reader, uint32_t* value);
+
+/// <summary>
+/// Writes a LEB128 varint
+/// </summary>
+void _codec_WriteVarint(CodecWriter* writer, uint32_t value);
+
+/// <summary>
+/// Reads a LEB128 varint of at most 5 bytes
+/// </summary>
+/// <returns>STARDUST_ERROR_FILE_INVALID past the end of the stream or for varints that don't fit 32 bits</returns>
+StardustErrorCode _codec_ReadVarint(CodecReader* reader, uint32_t* value);
+
+/// <summary>
+/// Maps signed differences to unsigned values so that small negative differences stay small. 0, -1, 1, -2 become 0, 1, 2, 3
+/// </summary>
+uint32_t _codec_Zigzag(uint32_t value);
+
+/// <summary>
+/// Reverses _codec_Zigzag
+/// </summary>
+uint32_t _codec_Unzigzag(uint32_t value);
+
+#endif //_STARDUST_CODEC
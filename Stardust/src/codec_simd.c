@@ -0,0 +1,130 @@
+#include "codec.h"
+#include "utils/cpu.h"
+
+#include <string.h>
+
+#ifdef STARDUST_X86
+#include <immintrin.h>
+#endif
+
+/*
+Channel decoders.
+Decoding is one pass per byte plane to unpack the groups, then one pass that interleaves the planes back into words, reverses the
+zigzag and adds up the differences. The SIMD decoders produce exactly the same words as the scalar decoder.
+*/
+
+ChannelDecoder _codec_GetChannelDecoder(StardustInstructionSet requested)
+{
+	StardustInstructionSet set = cpu_SelectInstructionSet(requested);
+
+#ifdef STARDUST_X86
+	//Nothing in the decoder benefits from wider vectors, as groups are only 16 bytes
+	if (set >= STARDUST_INSTRUCTIONS_SSE2)
+		return _codec_DecodeChannelSSE2;
+#endif
+
+	return _codec_DecodeChannelScalar;
+}
+
+#ifdef STARDUST_X86
+
+CPU_TARGET("sse2")
+StardustErrorCode _codec_DecodeChannelSSE2(CodecReader* reader, uint32_t count, uint32_t* previous, uint32_t* words)
+{
+	unsigned char planes[4][CODEC_BLOCK_VERTICES];
+	uint32_t groupCount = (count + CODEC_GROUP_SIZE - 1) / CODEC_GROUP_SIZE;
+	uint32_t headerSize = (groupCount + 3) / 4;
+
+	const __m128i mask2 = _mm_set1_epi8(3);
+	const __m128i mask4 = _mm_set1_epi8(15);
+
+	for (int p = 0; p < 4; p++)
+	{
+		if (headerSize > (size_t)(reader->end - reader->data))
+			return STARDUST_ERROR_FILE_INVALID;
+
+		const unsigned char* header = reader->data;
+		reader->data += headerSize;
+
+		for (uint32_t g = 0; g < groupCount; g++)
+		{
+			uint32_t width = (header[g / 4] >> ((g % 4) * 2)) & 3;
+
+			uint32_t size = width == 0 ? 0 : 2u << width;
+			if (size > (size_t)(reader->end - reader->data))
+				return STARDUST_ERROR_FILE_INVALID;
+
+			__m128i group;
+			if (width == 0)
+				group = _mm_setzero_si128();
+			else if (width == 1)
+			{
+				//Repeat the 4 packed bytes in every lane, then shift each quarter into place. The 16 bit shifts pull in bits
+				//of the neighbouring byte, but only above the 2 that are kept
+				int packed;
+				memcpy(&packed, reader->data, sizeof(int));
+
+				__m128i bytes = _mm_set1_epi32(packed);
+				__m128i low = _mm_unpacklo_epi32(bytes, _mm_srli_epi16(bytes, 2));
+				__m128i high = _mm_unpacklo_epi32(_mm_srli_epi16(bytes, 4), _mm_srli_epi16(bytes, 6));
+				group = _mm_and_si128(_mm_unpacklo_epi64(low, high), mask2);
+			}
+			else if (width == 2)
+			{
+				__m128i bytes = _mm_loadl_epi64((const __m128i*)reader->data);
+				group = _mm_and_si128(_mm_unpacklo_epi64(bytes, _mm_srli_epi16(bytes, 4)), mask4);
+			}
+			else
+				group = _mm_loadu_si128((const __m128i*)reader->data);
+
+			_mm_storeu_si128((__m128i*)&planes[p][g * CODEC_GROUP_SIZE], group);
+			reader->data += size;
+		}
+	}
+
+	__m128i sum = _mm_set1_epi32((int)*previous);
+	const __m128i one = _mm_set1_epi32(1);
+
+	for (uint32_t g = 0; g < groupCount; g++)
+	{
+		__m128i b0 = _mm_loadu_si128((const __m128i*)&planes[0][g * CODEC_GROUP_SIZE]);
+		__m128i b1 = _mm_loadu_si128((const __m128i*)&planes[1][g * CODEC_GROUP_SIZE]);
+		__m128i b2 = _mm_loadu_si128((const __m128i*)&planes[2][g * CODEC_GROUP_SIZE]);
+		__m128i b3 = _mm_loadu_si128((const __m128i*)&planes[3][g * CODEC_GROUP_SIZE]);
+
+		//Interleave the planes back into little endian words
+		__m128i low01 = _mm_unpacklo_epi8(b0, b1);
+		__m128i high01 = _mm_unpackhi_epi8(b0, b1);
+		__m128i low23 = _mm_unpacklo_epi8(b2, b3);
+		__m128i high23 = _mm_unpackhi_epi8(b2, b3);
+
+		__m128i deltas[4] =
+		{
+			_mm_unpacklo_epi16(low01, low23),
+			_mm_unpackhi_epi16(low01, low23),
+			_mm_unpacklo_epi16(high01, high23),
+			_mm_unpackhi_epi16(high01, high23)
+		};
+
+		for (int i = 0; i < 4; i++)
+		{
+			//Unzigzag
+			__m128i delta = _mm_xor_si128(_mm_srli_epi32(deltas[i], 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(deltas[i], one)));
+
+			//Prefix sum of the 4 lanes, on top of the last word before them
+			delta = _mm_add_epi32(delta, _mm_slli_si128(delta, 4));
+			delta = _mm_add_epi32(delta, _mm_slli_si128(delta, 8));
+			sum = _mm_add_epi32(delta, _mm_shuffle_epi32(sum, _MM_SHUFFLE(3, 3, 3, 3)));
+
+			_mm_storeu_si128((__m128i*)&words[g * CODEC_GROUP_SIZE + i * 4], sum);
+		}
+	}
+
+	//Padding past count decodes too, so the last real word carries over rather than the last lane
+	if (count > 0)
+		*previous = words[count - 1];
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+#endif //STARDUST_X86
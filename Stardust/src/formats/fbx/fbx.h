@@ -102,6 +102,11 @@ In progress Features:
 Loading flow
 	1. Call _fbx_loadMesh(path, flags, meshes, meshcount);
 	2. Read in FBX header. If version is >= 7500 call _fbx_createTree_64() else if version >= 7100 _fbx_createTree_32() else ERROR
+		The tree is a flat array of nodes from a single arena. The children of a node are moved next to each other when it is
+		complete, so a node only stores its first child and child count.
+		Only node headers are read. Property lists are skipped and read the first time a property of the node is used, so
+		animation curves, textures and other data the mesh doesn't use are never loaded. The file stays open until the meshes are made
+		With STARDUST_MESH_USE_FIRST_MESH the tree stops as soon as the first 'Geometry' of 'Objects' is complete. Nothing after it is read
 	3. Validate the presence of the 'Objects' tag
 	4. Locate meshes ('Geometry' tag)
 	5. Read in vertices and indices
@@ -112,6 +117,7 @@ Loading flow
 
 #include "stardust.h"
 #include "utils/filestream.h"
+#include "utils/arena.h"
 //#include "filetools.h"
 
 #define MIN_FBX_VER 7100
@@ -186,19 +192,38 @@ typedef struct {
 
 } FBXProperty;
 
-struct FBXNode
+//A node of the tree. Nodes live in FBXTree.nodes and the children of a node are next to each other
+typedef struct
 {
 	uint32_t endOffset;
-	uint32_t propertyCount;
-
 	int8_t nameLen;
-	char* name;
+	const char* name;				//Null terminated
 
-	FBXProperty* properties;
+	uint32_t propertyOffset;		//Position of the property list in the file
+	uint32_t propertyListLength;	//Size of the property list in bytes
+	uint32_t propertyCount;
+	FBXProperty* properties;		//0 until a property is first used. See fbx_GetNodeProperty
 
+	uint32_t firstChild;			//Index into FBXTree.nodes
 	uint32_t childCount;
-	struct FBXNode** children;
-};
+} FBXNode;
+
+//Every node of a file. All of it, including names and property data, is allocated from the arena
+typedef struct
+{
+	Arena arena;
+	FileStream* stream;				//Stream the properties are read from. Must stay open while the tree is used
+
+	FBXNode root;					//Implicit global node. Its children are the top level nodes of the file
+
+	FBXNode* nodes;
+	uint32_t nodeCount;
+	uint32_t nodeCapacity;
+
+	FBXNode* pending;				//Finished nodes whose parent is still being read. Moved into nodes when the parent is done
+	uint32_t pendingCount;
+	uint32_t pendingCapacity;
+} FBXTree;
 
 typedef struct
 {
@@ -223,6 +248,13 @@ typedef struct
 	unsigned int uvIndexCount;
 } FBXRawData;
 
+//Tree reading state shared by every node
+typedef struct
+{
+	int firstGeometryOnly;	//Stop once the first Geometry of Objects has been read. Set for STARDUST_MESH_USE_FIRST_MESH
+	int done;				//Set when reading stopped early. Nodes that are still open keep the children read so far
+} FBXTreeState;
+
 struct FBXVertexHash
 {
 	unsigned int nrmIdx;
@@ -244,14 +276,21 @@ StardustErrorCode _fbx_LoadMesh(const char* path, const StardustMeshFlags flags,
 StardustErrorCode _fbx_GetHeader(FileStream* stream, uint32_t* version);
 
 // Mesh functions
-StardustErrorCode fbx_GetMesh(struct FBXNode* globalNode, StardustMesh** meshes, const StardustMeshFlags flags);
-int fbx_GetNode(struct FBXNode* globalNode, const char* label, int startAt);
+StardustErrorCode fbx_GetMesh(FBXTree* tree, StardustMesh** meshes, size_t* meshCount, const StardustMeshFlags flags);
+
+/// <summary>
+/// Frees the meshes fbx_GetMesh() has built so far along with the mesh array, for when a later mesh fails
+/// </summary>
+/// <param name="meshes">Pointer to the mesh array. Set to null</param>
+/// <param name="meshCount">Set to 0</param>
+/// <param name="builtCount">Number of meshes at the start of the array whose vertices and indices were set</param>
+void _fbx_FreeMeshes(StardustMesh** meshes, size_t* meshCount, int builtCount);
 void fbx_FreeRawData(FBXRawData* data);
 
-StardustErrorCode fbx_GetVertices(struct FBXNode* node, FBXRawData* data);
-StardustErrorCode fbx_GetIndices(struct FBXNode* node, FBXRawData* data);
-StardustErrorCode fbx_GetNormals(struct FBXNode* node, FBXRawData* data);
-StardustErrorCode fbx_GetTextureCoords(struct FBXNode* node, FBXRawData* data);
+StardustErrorCode fbx_GetVertices(FBXTree* tree, FBXNode* node, FBXRawData* data);
+StardustErrorCode fbx_GetIndices(FBXTree* tree, FBXNode* node, FBXRawData* data);
+StardustErrorCode fbx_GetNormals(FBXTree* tree, FBXNode* node, FBXRawData* data);
+StardustErrorCode fbx_GetTextureCoords(FBXTree* tree, FBXNode* node, FBXRawData* data);
 unsigned int* fbx_GenerateDirectIndices(unsigned int count);
 
 StardustErrorCode fbx_CompactArray(float* arr, unsigned int* indices, unsigned int* arrSize, unsigned int elementStride, unsigned int indexSize);
@@ -261,13 +300,66 @@ StardustErrorCode fbx_FormatIndexArray(FBXRawData* data, unsigned int** indexArr
 FBXApplicationType fbx_GetApplicationType(const char* attrib, unsigned int len);
 
 // Node Functions
-StardustErrorCode _fbx_GetGlobalNode(FileStream* stream, struct FBXNode* globalNode);
-struct FBXNode* _fbx_GetNode(FileStream* stream, StardustErrorCode* result);
-StardustErrorCode _fbx_GetProperty(FileStream* stream, FBXProperty* prop);
 
-void _fbx_FreeGlobalNode(struct FBXNode* node);
-void _fbx_FreeNode(struct FBXNode* node);
-void _fbx_FreeProperty(FBXProperty* prop);
+/// <summary>
+/// Finds a child of a node by name
+/// </summary>
+/// <param name="tree">Tree the node belongs to</param>
+/// <param name="node">Node to search</param>
+/// <param name="label">Name of the child</param>
+/// <param name="startAt">First child to check</param>
+/// <returns>Index of the child, or -1 if there is none</returns>
+int fbx_GetNode(const FBXTree* tree, const FBXNode* node, const char* label, int startAt);
+
+/// <summary>
+/// Gets a child of a node. The index must be less than the child count
+/// </summary>
+FBXNode* fbx_GetChild(FBXTree* tree, const FBXNode* node, uint32_t index);
+
+/// <summary>
+/// Gets a property of a node. The properties of a node are read from the file the first time one of them is used
+/// </summary>
+/// <param name="tree">Tree the node belongs to</param>
+/// <param name="node">Node to get the property of</param>
+/// <param name="index">Index of the property</param>
+/// <param name="prop">Pointer to the property</param>
+/// <returns>Error code. STARDUST_ERROR_FILE_INVALID if the node has fewer properties</returns>
+StardustErrorCode fbx_GetNodeProperty(FBXTree* tree, FBXNode* node, uint32_t index, const FBXProperty** prop);
+
+/// <summary>
+/// Reads the node headers of a file into a tree. Property lists are skipped and only their position is kept.
+/// The tree must be freed with _fbx_FreeTree, also when reading fails
+/// </summary>
+/// <param name="stream">Stream positioned after the header. Must stay open while the tree is used</param>
+/// <param name="state">Reading state</param>
+/// <param name="tree">Tree to fill</param>
+/// <returns>Error code</returns>
+StardustErrorCode _fbx_ReadTree(FileStream* stream, FBXTreeState* state, FBXTree* tree);
+
+/// <summary>
+/// Reads a node header and its children. The children are moved into tree->nodes and the node itself is added to tree->pending.
+/// A null record is read without adding anything
+/// </summary>
+StardustErrorCode _fbx_ReadNode(FileStream* stream, FBXTreeState* state, FBXTree* tree);
+
+/// <summary>
+/// Reads every property of a node from the file
+/// </summary>
+StardustErrorCode _fbx_LoadProperties(FBXTree* tree, FBXNode* node);
+
+/// <summary>
+/// Reads one property. Its data is allocated from the arena
+/// </summary>
+/// <param name="listEnd">End of the property list of the node. A property that runs past it is STARDUST_ERROR_FILE_INVALID</param>
+StardustErrorCode _fbx_ReadProperty(FileStream* stream, Arena* arena, long listEnd, FBXProperty* prop);
+
+/// <summary>
+/// Makes room for count more elements in an array of the tree. The capacity doubles, so building the tree is linear
+/// </summary>
+/// <returns>Error code</returns>
+StardustErrorCode _fbx_ReserveArray(Arena* arena, void** array, uint32_t* capacity, uint32_t count, uint32_t extra, size_t elementSize);
+
+void _fbx_FreeTree(FBXTree* tree);
 
 //Dict function
 void _fbx_InitFBXPropertyDict();
@@ -50,25 +50,31 @@ StardustErrorCode _fbx_LoadMesh(const char* path, const StardustMeshFlags flags,
 	// Validate header //
 	ret = _fbx_GetHeader(&stream, &fbxVersion);
 	if (ret != 0)
+	{
+		fs_CloseStream(&stream);
 		return ret;
+	}
 
 	// Create root Node
-	struct FBXNode globalNode; //GLOBAL node appears to contain 1 extra child (in counting)
-	ret = _fbx_GetGlobalNode(&stream, &globalNode);
-
-
-	ret = fbx_GetMesh(&globalNode, meshes, flags);
+	//With STARDUST_MESH_USE_FIRST_MESH the tree stops at the end of the first Geometry, so nothing after it is read
+	FBXTreeState state = { (flags & STARDUST_MESH_USE_FIRST_MESH) == STARDUST_MESH_USE_FIRST_MESH, 0 };
+	//Properties are read as they are used, so the stream stays open until the meshes are made
+	FBXTree tree;
+	ret = _fbx_ReadTree(&stream, &state, &tree);
+	if (ret != 0)
+	{
+		_fbx_FreeTree(&tree);
+		fs_CloseStream(&stream);
+		return ret;
+	}
 
-	//Vertices
-	//Indices
-	//UVs
-	//Normals
+	ret = fbx_GetMesh(&tree, meshes, meshCount, flags);
 
 	//Close
-	_fbx_FreeGlobalNode(&globalNode);
+	_fbx_FreeTree(&tree);
 	fs_CloseStream(&stream);
 
-	return STARDUST_ERROR_SUCCESS;
+	return ret;
 }
 
 StardustErrorCode _fbx_GetHeader(FileStream* stream, uint32_t* version)
@@ -97,91 +103,103 @@ StardustErrorCode _fbx_GetHeader(FileStream* stream, uint32_t* version)
 	return STARDUST_ERROR_SUCCESS;
 }
 
-StardustErrorCode fbx_GetMesh(struct FBXNode* globalNode, StardustMesh** meshes, const StardustMeshFlags flags)
+StardustErrorCode fbx_GetMesh(FBXTree* tree, StardustMesh** meshes, size_t* meshCount, const StardustMeshFlags flags)
 {
 	// Get list of objects
-	//struct FBXNode* objects = fbx_GetNode(globalNode, "Objects", 0);
-	int objectTagIdx = fbx_GetNode(globalNode, "Objects", 0);
+	int objectTagIdx = fbx_GetNode(tree, &tree->root, "Objects", 0);
 	if (objectTagIdx == -1)
 		return STARDUST_ERROR_FILE_INVALID;
-	struct FBXNode* objects = globalNode->children[objectTagIdx];
+	FBXNode* objects = fbx_GetChild(tree, &tree->root, objectTagIdx);
 
 	//Find meshes
-	int meshCount = 0;
+	int geometryCount = 0;
 	for (unsigned int i = 0; i < objects->childCount; i++)
 	{
-		if (strcmp(objects->children[i]->name, "Geometry") == 0)
-			meshCount += 1;
+		if (strcmp(fbx_GetChild(tree, objects, i)->name, "Geometry") == 0)
+			geometryCount += 1;
 	}
 
+	if ((flags & STARDUST_MESH_USE_FIRST_MESH) == STARDUST_MESH_USE_FIRST_MESH && geometryCount > 1)
+		geometryCount = 1;
+
 	//Allocate meshes
-	*meshes = malloc(sizeof(StardustMesh) * meshCount);
+	*meshes = malloc(sizeof(StardustMesh) * (geometryCount > 0 ? geometryCount : 1));
 	if (*meshes == 0)
 		return STARDUST_ERROR_MEMORY_ERROR;
 
+	//Arrays the loader doesn't fill, like tangents and meshlets, start empty
+	memset(*meshes, 0, sizeof(StardustMesh) * geometryCount);
+
 	// Get all models
 	int meshIdx = 0;
-	while (1)
+	int geoIdx = -1;
+	while (meshIdx < geometryCount)
 	{
-		int geoIdx = fbx_GetNode(objects, "Geometry", meshIdx);
+		geoIdx = fbx_GetNode(tree, objects, "Geometry", geoIdx + 1);
 		if (geoIdx == -1)
 			break;
-		struct FBXNode* geometry = objects->children[geoIdx];
+		FBXNode* geometry = fbx_GetChild(tree, objects, geoIdx);
 
 		FBXRawData data = { 0 }; // Initialise FBXRawData struct to 0
 		StardustErrorCode ret;
 
 		// Get all attributes of mesh
-		int vertexIdx = fbx_GetNode(geometry, "Vertices", 0);
-		int indexIdx = fbx_GetNode(geometry, "PolygonVertexIndex", 0);
+		int vertexIdx = fbx_GetNode(tree, geometry, "Vertices", 0);
+		int indexIdx = fbx_GetNode(tree, geometry, "PolygonVertexIndex", 0);
 		
 		// Check that we have both vertexIdx and indexIdx. These are requrired for a mesh
-		if (vertexIdx == -1 || indexIdx == -1) { return STARDUST_ERROR_FILE_INVALID; }
+		if (vertexIdx == -1 || indexIdx == -1) { _fbx_FreeMeshes(meshes, meshCount, meshIdx); return STARDUST_ERROR_FILE_INVALID; }
 
-		int normalIdx = fbx_GetNode(geometry, "LayerElementNormal", 0);
-		int uvIdx = fbx_GetNode(geometry, "LayerElementUV", 0);
+		int normalIdx = fbx_GetNode(tree, geometry, "LayerElementNormal", 0);
+		int uvIdx = fbx_GetNode(tree, geometry, "LayerElementUV", 0);
 
 
 		// Get vertices
-		ret = fbx_GetVertices(geometry->children[vertexIdx], &data);
-		if (ret != 0) { fbx_FreeRawData(&data); free(*meshes); return ret; }
+		ret = fbx_GetVertices(tree, fbx_GetChild(tree, geometry, vertexIdx), &data);
+		if (ret != 0) { fbx_FreeRawData(&data); _fbx_FreeMeshes(meshes, meshCount, meshIdx); return ret; }
 
 		// Get indices
-		ret = fbx_GetIndices(geometry->children[indexIdx], &data);
-		if (ret != 0) { fbx_FreeRawData(&data); free(*meshes); return ret; }
+		ret = fbx_GetIndices(tree, fbx_GetChild(tree, geometry, indexIdx), &data);
+		if (ret != 0) { fbx_FreeRawData(&data); _fbx_FreeMeshes(meshes, meshCount, meshIdx); return ret; }
 
 		if (normalIdx != -1)
 		{
-			ret = fbx_GetNormals(geometry->children[normalIdx], &data);
-			if (ret != 0) { fbx_FreeRawData(&data); free(*meshes); return ret; }
+			ret = fbx_GetNormals(tree, fbx_GetChild(tree, geometry, normalIdx), &data);
+			if (ret != 0) { fbx_FreeRawData(&data); _fbx_FreeMeshes(meshes, meshCount, meshIdx); return ret; }
 
 			if (data.normalApplication == FBX_DIRECT)
 			{
 				data.normalIndexData = fbx_GenerateDirectIndices(data.normalCount);
 				data.normalIndexCount = data.normalCount;
 				data.normalApplication = FBX_INDEX_TO_DIRECT;
+				if (data.normalIndexData == 0) { fbx_FreeRawData(&data); _fbx_FreeMeshes(meshes, meshCount, meshIdx); return STARDUST_ERROR_MEMORY_ERROR; }
 			}
-			if (data.normalIndexCount != data.indexCount) { fbx_FreeRawData(&data); return ret; }
+
+			//Only normals stored per polygon vertex are supported
+			if (data.normalIndexCount != data.indexCount) { fbx_FreeRawData(&data); _fbx_FreeMeshes(meshes, meshCount, meshIdx); return STARDUST_ERROR_FILE_INVALID; }
 
 			ret = fbx_CompactArray(data.normalData, data.normalIndexData, &data.normalCount, 3, data.normalIndexCount);
-			if (ret != 0) { fbx_FreeRawData(&data); free(*meshes); return ret; }
+			if (ret != 0) { fbx_FreeRawData(&data); _fbx_FreeMeshes(meshes, meshCount, meshIdx); return ret; }
 		}
 
 		if (uvIdx != -1)
 		{
-			ret = fbx_GetTextureCoords(geometry->children[uvIdx], &data);
-			if (ret != 0) { fbx_FreeRawData(&data); free(*meshes); return ret; }
+			ret = fbx_GetTextureCoords(tree, fbx_GetChild(tree, geometry, uvIdx), &data);
+			if (ret != 0) { fbx_FreeRawData(&data); _fbx_FreeMeshes(meshes, meshCount, meshIdx); return ret; }
 
 			if (data.uvApplication == FBX_DIRECT)
 			{
 				data.uvIndexData = fbx_GenerateDirectIndices(data.uvCount);
 				data.uvIndexCount = data.uvCount;
 				data.uvApplication = FBX_INDEX_TO_DIRECT;
+				if (data.uvIndexData == 0) { fbx_FreeRawData(&data); _fbx_FreeMeshes(meshes, meshCount, meshIdx); return STARDUST_ERROR_MEMORY_ERROR; }
 			}
-			if (data.uvIndexCount != data.indexCount) { fbx_FreeRawData(&data); return ret; }
+
+			//Only texture coordinates stored per polygon vertex are supported
+			if (data.uvIndexCount != data.indexCount) { fbx_FreeRawData(&data); _fbx_FreeMeshes(meshes, meshCount, meshIdx); return STARDUST_ERROR_FILE_INVALID; }
 
 			ret = fbx_CompactArray(data.uvData, data.uvIndexData, &data.uvCount, 2, data.uvIndexCount);
-			if (ret != 0) { fbx_FreeRawData(&data); free(*meshes); return ret; }
+			if (ret != 0) { fbx_FreeRawData(&data); _fbx_FreeMeshes(meshes, meshCount, meshIdx); return ret; }
 		}
 
 		
@@ -189,10 +207,11 @@ StardustErrorCode fbx_GetMesh(struct FBXNode* globalNode, StardustMesh** meshes,
 		struct FBXVertexHash* hashArr;
 		unsigned int hashArrSize; // This is not the actual size of allocated memory. Just the amount of hashses contained within an array of data.indexCount size
 		ret = fbx_ComputeHashAndIndexArray(&data, &hashArr, data.indexData, &hashArrSize);
+		if (ret != 0) { fbx_FreeRawData(&data); _fbx_FreeMeshes(meshes, meshCount, meshIdx); return ret; }
 
 		// Create vertex array
 		Vertex* vertexArray = malloc(sizeof(Vertex) * hashArrSize);
-		if (vertexArray == 0) { fbx_FreeRawData(&data); free(*meshes); free(hashArr); return ret; }
+		if (vertexArray == 0) { fbx_FreeRawData(&data); _fbx_FreeMeshes(meshes, meshCount, meshIdx); free(hashArr); return STARDUST_ERROR_MEMORY_ERROR; }
 
 		// Create vertices
 		for (unsigned int i = 0; i < hashArrSize; i++)
@@ -232,7 +251,8 @@ StardustErrorCode fbx_GetMesh(struct FBXNode* globalNode, StardustMesh** meshes,
 		currMesh->vertexCount = hashArrSize;
 
 		// Set Indices
-		fbx_FormatIndexArray(&data, &(currMesh->indices));
+		ret = fbx_FormatIndexArray(&data, &(currMesh->indices));
+		if (ret != 0) { fbx_FreeRawData(&data); free(vertexArray); _fbx_FreeMeshes(meshes, meshCount, meshIdx); return ret; }
 		currMesh->indexCount = data.indexCount;
 
 		// Temporary
@@ -252,18 +272,21 @@ StardustErrorCode fbx_GetMesh(struct FBXNode* globalNode, StardustMesh** meshes,
 		meshIdx++;
 	}
 
+	*meshCount = meshIdx;
 	return STARDUST_ERROR_SUCCESS;
 }
 
-int fbx_GetNode(struct FBXNode* globalNode, const char* label, int startAt)
+void _fbx_FreeMeshes(StardustMesh** meshes, size_t* meshCount, int builtCount)
 {
-	for (unsigned int i = startAt; i < globalNode->childCount; i++)
+	for (int i = 0; i < builtCount; i++)
 	{
-		if (strcmp(globalNode->children[i]->name, label) == 0)
-			return i;
+		free((*meshes)[i].vertices);
+		free((*meshes)[i].indices);
 	}
 
-	return -1;
+	free(*meshes);
+	*meshes = 0;
+	*meshCount = 0; //Helps with fallthrough on the client side
 }
 
 void fbx_FreeRawData(FBXRawData* data)
@@ -287,22 +310,27 @@ void fbx_FreeRawData(FBXRawData* data)
 	}
 }
 
-StardustErrorCode fbx_GetVertices(struct FBXNode* node, FBXRawData* data)
+StardustErrorCode fbx_GetVertices(FBXTree* tree, FBXNode* node, FBXRawData* data)
 {
 	StardustErrorCode ret;
 	char* vertexBytes;
 	unsigned int vertexByteCount;
 
-	if (node->properties[0].enc)
+	const FBXProperty* vertexProp;
+	ret = fbx_GetNodeProperty(tree, node, 0, &vertexProp);
+	if (ret != 0)
+		return ret;
+
+	if (vertexProp->enc)
 	{
-		ret = zlib_Inflate(&vertexBytes, &vertexByteCount, node->properties[0].rawArr);
+		ret = zlib_Inflate(&vertexBytes, &vertexByteCount, vertexProp->rawArr);
 		if (ret != 0)
 			return ret;
 	}
 	else
 	{
-		vertexBytes = node->properties[0].rawArr;
-		vertexByteCount = node->properties[0].length;
+		vertexBytes = vertexProp->rawArr;
+		vertexByteCount = vertexProp->length * _fbx_Sizes[vertexProp->type]; // The length of an array is its element count
 	}
 
 	unsigned int elementCount = vertexByteCount / 8; // Assuming double for now. Advance this later?
@@ -310,7 +338,7 @@ StardustErrorCode fbx_GetVertices(struct FBXNode* node, FBXRawData* data)
 	
 	//Allocate vertex array
 	data->vertexData = malloc(sizeof(float) * elementCount);
-	if (data->vertexData == 0) { if (node->properties[0].enc) { free(vertexBytes); } return STARDUST_ERROR_MEMORY_ERROR; }
+	if (data->vertexData == 0) { if (vertexProp->enc) { free(vertexBytes); } return STARDUST_ERROR_MEMORY_ERROR; }
 
 	int idx = 0;
 	for (unsigned int i = 0; i < elementCount; i++)
@@ -324,27 +352,32 @@ StardustErrorCode fbx_GetVertices(struct FBXNode* node, FBXRawData* data)
 	data->vertexCount = elementCount / 3;
 	data->dataType |= FBX_VERTICES;
 
-	if (node->properties[0].enc) { free(vertexBytes); }
+	if (vertexProp->enc) { free(vertexBytes); }
 	return STARDUST_ERROR_SUCCESS;
 }
 
-StardustErrorCode fbx_GetIndices(struct FBXNode* node, FBXRawData* data)
+StardustErrorCode fbx_GetIndices(FBXTree* tree, FBXNode* node, FBXRawData* data)
 {
 	StardustErrorCode ret;
 	char* indexBytes;
 	unsigned int indexByteCount;
 
+	const FBXProperty* indexProp;
+	ret = fbx_GetNodeProperty(tree, node, 0, &indexProp);
+	if (ret != 0)
+		return ret;
+
 	// Decompress memory
-	if (node->properties[0].enc)
+	if (indexProp->enc)
 	{
-		ret = zlib_Inflate(&indexBytes, &indexByteCount, node->properties[0].rawArr);
+		ret = zlib_Inflate(&indexBytes, &indexByteCount, indexProp->rawArr);
 		if (ret != 0)
 			return ret;
 	}
 	else
 	{
-		indexBytes = node->properties[0].rawArr;
-		indexByteCount = node->properties[0].length;
+		indexBytes = indexProp->rawArr;
+		indexByteCount = indexProp->length * _fbx_Sizes[indexProp->type];
 	}
 
 	data->indexCount = indexByteCount / 4;
@@ -352,7 +385,7 @@ StardustErrorCode fbx_GetIndices(struct FBXNode* node, FBXRawData* data)
 
 	// Allocate array
 	data->indexData = malloc(sizeof(int) * data->indexCount);
-	if (*data->indexData == 0) { if (node->properties[0].enc) { free(indexBytes); } return STARDUST_ERROR_MEMORY_ERROR; }
+	if (*data->indexData == 0) { if (indexProp->enc) { free(indexBytes); } return STARDUST_ERROR_MEMORY_ERROR; }
 
 	// Unpack memory
 	int idx = 0;
@@ -365,39 +398,49 @@ StardustErrorCode fbx_GetIndices(struct FBXNode* node, FBXRawData* data)
 
 	data->dataType |= FBX_INDICES;
 
-	if (node->properties[0].enc) { free(indexBytes); }
+	if (indexProp->enc) { free(indexBytes); }
 	return STARDUST_ERROR_SUCCESS;
 }
 
-StardustErrorCode fbx_GetNormals(struct FBXNode* node, FBXRawData* data)
+StardustErrorCode fbx_GetNormals(FBXTree* tree, FBXNode* node, FBXRawData* data)
 {
 	StardustErrorCode ret;
 
 	// Get nodes
-	int normIdx = fbx_GetNode(node, "Normals", 0);
-	int refIdx = fbx_GetNode(node, "ReferenceInformationType", 0);
+	int normIdx = fbx_GetNode(tree, node, "Normals", 0);
+	int refIdx = fbx_GetNode(tree, node, "ReferenceInformationType", 0);
 
 	if (normIdx == -1 || refIdx == -1)
 		return STARDUST_ERROR_FILE_INVALID;
 
+	const FBXProperty* normProp;
+	ret = fbx_GetNodeProperty(tree, fbx_GetChild(tree, node, normIdx), 0, &normProp);
+	if (ret != 0)
+		return ret;
+
+	const FBXProperty* refProp;
+	ret = fbx_GetNodeProperty(tree, fbx_GetChild(tree, node, refIdx), 0, &refProp);
+	if (ret != 0)
+		return ret;
+
 	// Get application type. Defer assignment of type until all data has been successfully loaded 
-	FBXApplicationType type = fbx_GetApplicationType(node->children[refIdx]->properties[0].strArr, node->children[refIdx]->properties[0].length);
+	FBXApplicationType type = fbx_GetApplicationType(refProp->strArr, refProp->length);
 
 	{ // Get normals
 		char* normalBytes;
 		unsigned int normalByteCount;
 
 		// Decompress memory
-		if (node->children[normIdx]->properties[0].enc)
+		if (normProp->enc)
 		{
-			ret = zlib_Inflate(&normalBytes, &normalByteCount, node->children[normIdx]->properties[0].rawArr);
+			ret = zlib_Inflate(&normalBytes, &normalByteCount, normProp->rawArr);
 			if (ret != 0)
 				return ret;
 		}
 		else
 		{
-			normalBytes = node->properties[0].rawArr;
-			normalByteCount = node->properties[0].length;
+			normalBytes = normProp->rawArr;
+			normalByteCount = normProp->length * _fbx_Sizes[normProp->type];
 		}
 
 
@@ -405,7 +448,7 @@ StardustErrorCode fbx_GetNormals(struct FBXNode* node, FBXRawData* data)
 
 		// Allocate array
 		data->normalData = malloc(sizeof(float) * normalElementCount);
-		if (data->normalData == 0) { if (node->children[normIdx]->properties[0].enc) { free(normalBytes); } return STARDUST_ERROR_MEMORY_ERROR; }
+		if (data->normalData == 0) { if (normProp->enc) { free(normalBytes); } return STARDUST_ERROR_MEMORY_ERROR; }
 
 		// Unpack memory
 		int idx = 0;
@@ -419,7 +462,7 @@ StardustErrorCode fbx_GetNormals(struct FBXNode* node, FBXRawData* data)
 
 		data->normalCount = normalElementCount / 3;
 
-		if (node->children[normIdx]->properties[0].enc) { free(normalBytes); }
+		if (normProp->enc) { free(normalBytes); }
 	}
 
 	data->dataType |= FBX_NORMALS;
@@ -431,29 +474,33 @@ StardustErrorCode fbx_GetNormals(struct FBXNode* node, FBXRawData* data)
 	}
 
 	{ // Get Index data
-		int normIdxIdx = fbx_GetNode(node, "NormalsIndex", 0);
+		int normIdxIdx = fbx_GetNode(tree, node, "NormalsIndex", 0);
 		if (normIdxIdx == -1) { return STARDUST_ERROR_FILE_INVALID; }
 
+		const FBXProperty* normIndexProp;
+		ret = fbx_GetNodeProperty(tree, fbx_GetChild(tree, node, normIdxIdx), 0, &normIndexProp);
+		if (ret != 0) { return ret; }
+
 		char* indexBytes;
 		unsigned int indexByteCount;
 
-		if (node->children[normIdxIdx]->properties[0].enc)
+		if (normIndexProp->enc)
 		{
-			ret = zlib_Inflate(&indexBytes, &indexByteCount, node->children[normIdxIdx]->properties[0].rawArr);
+			ret = zlib_Inflate(&indexBytes, &indexByteCount, normIndexProp->rawArr);
 			if (ret != 0)
 				return ret;
 		}
 		else
 		{
-			indexBytes = node->properties[0].rawArr;
-			indexByteCount = node->properties[0].length;
+			indexBytes = normIndexProp->rawArr;
+			indexByteCount = normIndexProp->length * _fbx_Sizes[normIndexProp->type];
 		}
 
 		data->normalIndexCount = indexByteCount / 4;
 
 		// Allocate memory
 		data->normalIndexData = malloc(sizeof(unsigned int) * data->normalIndexCount);
-		if (data->normalIndexData == 0) { if (node->children[normIdxIdx]->properties[0].enc) { free(indexBytes); }return STARDUST_ERROR_MEMORY_ERROR; }
+		if (data->normalIndexData == 0) { if (normIndexProp->enc) { free(indexBytes); }return STARDUST_ERROR_MEMORY_ERROR; }
 
 		// Unpack memory
 		int idx = 0;
@@ -466,48 +513,58 @@ StardustErrorCode fbx_GetNormals(struct FBXNode* node, FBXRawData* data)
 
 		data->normalApplication = type;
 
-		if (node->children[normIdx]->properties[0].enc) { free(indexBytes); }
+		if (normIndexProp->enc) { free(indexBytes); }
 	}
 
 	return STARDUST_ERROR_SUCCESS;
 }
 
-StardustErrorCode fbx_GetTextureCoords(struct FBXNode* node, FBXRawData* data)
+StardustErrorCode fbx_GetTextureCoords(FBXTree* tree, FBXNode* node, FBXRawData* data)
 {
 	StardustErrorCode ret;
 
 	// Get nodes
-	int normIdx = fbx_GetNode(node, "UV", 0);
-	int refIdx = fbx_GetNode(node, "ReferenceInformationType", 0);
+	int normIdx = fbx_GetNode(tree, node, "UV", 0);
+	int refIdx = fbx_GetNode(tree, node, "ReferenceInformationType", 0);
 
 	if (normIdx == -1 || refIdx == -1)
 		return STARDUST_ERROR_FILE_INVALID;
 
+	const FBXProperty* uvProp;
+	ret = fbx_GetNodeProperty(tree, fbx_GetChild(tree, node, normIdx), 0, &uvProp);
+	if (ret != 0)
+		return ret;
+
+	const FBXProperty* refProp;
+	ret = fbx_GetNodeProperty(tree, fbx_GetChild(tree, node, refIdx), 0, &refProp);
+	if (ret != 0)
+		return ret;
+
 	// Get application type
-	FBXApplicationType type = fbx_GetApplicationType(node->children[refIdx]->properties[0].strArr, node->children[refIdx]->properties[0].length);
+	FBXApplicationType type = fbx_GetApplicationType(refProp->strArr, refProp->length);
 
 	{ // Get normals
 		char* uvBytes;
 		unsigned int ubByteCount;
 
 		// Decompress memory
-		if (node->children[normIdx]->properties[0].enc)
+		if (uvProp->enc)
 		{
-			ret = zlib_Inflate(&uvBytes, &ubByteCount, node->children[normIdx]->properties[0].rawArr);
+			ret = zlib_Inflate(&uvBytes, &ubByteCount, uvProp->rawArr);
 			if (ret != 0)
 				return ret;
 		}
 		else
 		{
-			uvBytes = node->children[normIdx]->properties[0].rawArr;
-			ubByteCount = node->children[normIdx]->properties[0].length;
+			uvBytes = uvProp->rawArr;
+			ubByteCount = uvProp->length * _fbx_Sizes[uvProp->type];
 		}
 
 		unsigned int uvElementCount = ubByteCount / 8; // Assuming double
 
 		// Allocate array
 		data->uvData = malloc(sizeof(float) * uvElementCount);
-		if (data->uvData == 0) { if (node->children[normIdx]->properties[0].enc) { free(uvBytes); } return STARDUST_ERROR_MEMORY_ERROR; }
+		if (data->uvData == 0) { if (uvProp->enc) { free(uvBytes); } return STARDUST_ERROR_MEMORY_ERROR; }
 
 		// Unpack memory
 		int idx = 0;
@@ -521,7 +578,7 @@ StardustErrorCode fbx_GetTextureCoords(struct FBXNode* node, FBXRawData* data)
 
 		data->uvCount = uvElementCount / 2;
 
-		if (node->children[normIdx]->properties[0].enc) { free(uvBytes); }
+		if (uvProp->enc) { free(uvBytes); }
 	}
 
 	data->dataType |= FBX_UVS;
@@ -533,28 +590,32 @@ StardustErrorCode fbx_GetTextureCoords(struct FBXNode* node, FBXRawData* data)
 	}
 
 	{ // Get Index data
-		int uvIdxIdx = fbx_GetNode(node, "UVIndex", 0);
+		int uvIdxIdx = fbx_GetNode(tree, node, "UVIndex", 0);
 		if (uvIdxIdx == -1) { return STARDUST_ERROR_MEMORY_ERROR; }
 
+		const FBXProperty* uvIndexProp;
+		ret = fbx_GetNodeProperty(tree, fbx_GetChild(tree, node, uvIdxIdx), 0, &uvIndexProp);
+		if (ret != 0) { return ret; }
+
 		char* indexBytes;
 		unsigned int indexByteCount;
 
-		if (node->children[uvIdxIdx]->properties[0].enc)
+		if (uvIndexProp->enc)
 		{
-			ret = zlib_Inflate(&indexBytes, &indexByteCount, node->children[uvIdxIdx]->properties[0].rawArr);
+			ret = zlib_Inflate(&indexBytes, &indexByteCount, uvIndexProp->rawArr);
 			if (ret != 0) { return STARDUST_ERROR_FILE_INVALID; }
 		}
 		else
 		{
-			indexBytes = node->children[uvIdxIdx]->properties[0].rawArr;
-			indexByteCount = node->children[uvIdxIdx]->properties[0].length;
+			indexBytes = uvIndexProp->rawArr;
+			indexByteCount = uvIndexProp->length * _fbx_Sizes[uvIndexProp->type];
 		}
 
 		data->uvIndexCount = indexByteCount / 4;
 
 		// Allocate memory
 		data->uvIndexData = malloc(sizeof(unsigned int) * data->uvIndexCount);
-		if (data->uvIndexData == 0) { if (node->children[uvIdxIdx]->properties[0].enc) { free(indexBytes); } return STARDUST_ERROR_MEMORY_ERROR; }
+		if (data->uvIndexData == 0) { if (uvIndexProp->enc) { free(indexBytes); } return STARDUST_ERROR_MEMORY_ERROR; }
 
 		// Unpack memory
 		int idx = 0;
@@ -566,7 +627,7 @@ StardustErrorCode fbx_GetTextureCoords(struct FBXNode* node, FBXRawData* data)
 		}
 
 		data->uvApplication = type;
-		if (node->children[uvIdxIdx]->properties[0].enc) { free(indexBytes); }
+		if (uvIndexProp->enc) { free(indexBytes); }
 	}
 
 	return STARDUST_ERROR_SUCCESS;
@@ -766,164 +827,187 @@ FBXApplicationType fbx_GetApplicationType(const char* attrib, unsigned int len)
 
 }
 
-StardustErrorCode _fbx_GetGlobalNode(FileStream* stream, struct FBXNode* globalNode)
+int fbx_GetNode(const FBXTree* tree, const FBXNode* node, const char* label, int startAt)
 {
-	//Fill global node
-	globalNode->endOffset = 0;
-	globalNode->propertyCount = 0;
-	globalNode->properties = 0;
-	globalNode->nameLen = 0;
-	globalNode->name = 0;
+	for (unsigned int i = startAt; i < node->childCount; i++)
+	{
+		if (strcmp(tree->nodes[node->firstChild + i].name, label) == 0)
+			return i;
+	}
 
-	globalNode->childCount = 0;
-	globalNode->children = 0;
+	return -1;
+}
 
-	StardustErrorCode result = 0;
+FBXNode* fbx_GetChild(FBXTree* tree, const FBXNode* node, uint32_t index)
+{
+	return &tree->nodes[node->firstChild + index];
+}
 
-	while (stream->characterIndex < stream->eof - 162) //162 is the size of the footer. The contents of this is currently unknown. Appears to just be binary garbage
-	{
-		//Increase storage
-		struct FBXNode** children = malloc(sizeof(struct FBXNode*) * (globalNode->childCount + 1)); //Allocate new buffer
-		if (children == 0) //Verify allocation
-		{
-			//_fbx_FreeNode(globalNode);
-			for (uint32_t i = 0; i < globalNode->childCount; i++)
-				_fbx_FreeNode(globalNode->children[i]);
-			free(globalNode->children);
+StardustErrorCode fbx_GetNodeProperty(FBXTree* tree, FBXNode* node, uint32_t index, const FBXProperty** prop)
+{
+	if (index >= node->propertyCount)
+		return STARDUST_ERROR_FILE_INVALID;
 
-			return STARDUST_ERROR_MEMORY_ERROR;
-		}
+	if (node->properties == 0)
+	{
+		StardustErrorCode ret = _fbx_LoadProperties(tree, node);
+		if (ret != STARDUST_ERROR_SUCCESS)
+			return ret;
+	}
 
-		//Copy in nodes
-		memcpy(children, globalNode->children, globalNode->childCount * sizeof(struct FBXNode*));
+	*prop = &node->properties[index];
+	return STARDUST_ERROR_SUCCESS;
+}
 
-		//Free old memory
-		if (globalNode->children != 0)
-			free(globalNode->children);
+StardustErrorCode _fbx_ReadTree(FileStream* stream, FBXTreeState* state, FBXTree* tree)
+{
+	memset(tree, 0, sizeof(FBXTree));
+	ar_InitArena(&tree->arena, 0);
+	tree->stream = stream;
 
-		//Set new memory
-		globalNode->children = children;
-		globalNode->childCount += 1;
+	StardustErrorCode result = STARDUST_ERROR_SUCCESS;
 
-		//Create new node
-		struct FBXNode* childNode = _fbx_GetNode(stream, &result);
-		if (result != 0)
-		{
-			for (uint32_t i = 0; i < globalNode->childCount - 1; i++)
-				_fbx_FreeNode(globalNode->children[i]);
-			free(globalNode->children);
+	while (stream->characterIndex < stream->eof - 162 && !state->done) //162 is the size of the footer. The contents of this is currently unknown. Appears to just be binary garbage
+	{
+		uint32_t pendingCount = tree->pendingCount;
+		result = _fbx_ReadNode(stream, state, tree);
+		if (result != STARDUST_ERROR_SUCCESS)
 			return result;
-		}
 
-		globalNode->children[globalNode->childCount - 1] = childNode;
+		//Only the footer follows the null record
+		if (tree->pendingCount == pendingCount)
+			break;
 	}
 
-	return result;
+	//The top level nodes are the children of the global node
+	result = _fbx_ReserveArray(&tree->arena, (void**)&tree->nodes, &tree->nodeCapacity, tree->nodeCount, tree->pendingCount, sizeof(FBXNode));
+	if (result != STARDUST_ERROR_SUCCESS)
+		return result;
+
+	if (tree->pendingCount != 0)
+		memcpy(&tree->nodes[tree->nodeCount], tree->pending, sizeof(FBXNode) * tree->pendingCount);
+
+	tree->root.firstChild = tree->nodeCount;
+	tree->root.childCount = tree->pendingCount;
+	tree->nodeCount += tree->pendingCount;
+	tree->pendingCount = 0;
+
+	return STARDUST_ERROR_SUCCESS;
 }
 
-struct FBXNode* _fbx_GetNode(FileStream* stream, StardustErrorCode* result)
+StardustErrorCode _fbx_ReadNode(FileStream* stream, FBXTreeState* state, FBXTree* tree)
 {
+	StardustErrorCode result;
+
 	// Read node header
-	uint32_t endOffset = fs_ReadUint32(stream);	//Distance from beginning of file to end of this node
-	uint32_t propCount = fs_ReadUint32(stream);	//Number of properties
-	uint32_t propLen = fs_ReadUint32(stream);	//Property size in bytes
-	int8_t nameLen = fs_ReadInt8(stream);		//Length of the name in bytes
+	FBXNode node = { 0 };
+	node.endOffset = fs_ReadUint32(stream);			//Distance from beginning of file to end of this node
+	node.propertyCount = fs_ReadUint32(stream);		//Number of properties
+	node.propertyListLength = fs_ReadUint32(stream);	//Property size in bytes
+	node.nameLen = fs_ReadInt8(stream);				//Length of the name in bytes
+
+	//The null record that ends a list of nodes
+	if (node.endOffset == 0)
+		return STARDUST_ERROR_SUCCESS;
 
-	char* nodeName = malloc(nameLen + 1);
-	if (nodeName == 0)
-	{
-		*result = STARDUST_ERROR_MEMORY_ERROR;
-		return 0;
-	}
-	*result = fs_ReadBytes(stream, nodeName, nameLen);
-	if (*result != 0)
-	{
-		free(nodeName);
-		*result = STARDUST_ERROR_IO_ERROR;
-		return 0;
-	}
+	//A node can't end past the file. This is where a truncated file is caught
+	if (stream->characterIndex > stream->eof || node.endOffset > (uint32_t)stream->eof || node.nameLen < 0)
+		return STARDUST_ERROR_FILE_INVALID;
 
-	nodeName[nameLen] = 0;
+	char* nodeName = ar_Allocate(&tree->arena, (size_t)node.nameLen + 1);
+	if (nodeName == 0)
+		return STARDUST_ERROR_MEMORY_ERROR;
 
-	// Create node
-	struct FBXNode* node = malloc(sizeof(struct FBXNode));
-	if (node == 0)
-	{
-		free(nodeName);
-		*result = STARDUST_ERROR_MEMORY_ERROR;
-		return 0;
-	}
+	if (fs_ReadBytes(stream, nodeName, node.nameLen) != STARDUST_ERROR_SUCCESS)
+		return STARDUST_ERROR_IO_ERROR;
 
+	nodeName[node.nameLen] = 0;
+	node.name = nodeName;
 
-	// Fill node
-	node->endOffset = endOffset;
-	node->propertyCount = propCount;
-	node->nameLen = nameLen;
-	node->name = nodeName;
+	//Skip the properties. They are read when they are used
+	node.propertyOffset = (uint32_t)stream->characterIndex;
+	if ((uint64_t)node.propertyOffset + node.propertyListLength > node.endOffset)
+		return STARDUST_ERROR_FILE_INVALID;
+	fs_Seek(stream, (long)node.propertyOffset + (long)node.propertyListLength);
 
-	node->childCount = 0;
-	node->children = 0;
+	//Get children. Each one is added to the pending array when it's complete
+	uint32_t firstPending = tree->pendingCount;
+	while ((int32_t)stream->characterIndex < (int32_t)node.endOffset - 13 && !state->done) //Convert to int32_t to handle unexpected null terminators
+	{
+		result = _fbx_ReadNode(stream, state, tree);
+		if (result != STARDUST_ERROR_SUCCESS)
+			return result;
 
-	node->properties = malloc(sizeof(FBXProperty) * node->propertyCount);
+		//The first mesh is complete. Every node still open is cut short here. A null record adds no child, so there's nothing to check
+		if (state->firstGeometryOnly && tree->pendingCount > firstPending && strcmp(node.name, "Objects") == 0 && strcmp(tree->pending[tree->pendingCount - 1].name, "Geometry") == 0)
+			state->done = 1;
+	}
 
-	//Read properties
-	for (uint32_t i = 0; i < node->propertyCount; i++)
+	//Move the children into the node array in one block
+	node.childCount = tree->pendingCount - firstPending;
+	if (node.childCount != 0)
 	{
-		_fbx_GetProperty(stream, node->properties + i);
-	}
+		result = _fbx_ReserveArray(&tree->arena, (void**)&tree->nodes, &tree->nodeCapacity, tree->nodeCount, node.childCount, sizeof(FBXNode));
+		if (result != STARDUST_ERROR_SUCCESS)
+			return result;
 
+		memcpy(&tree->nodes[tree->nodeCount], &tree->pending[firstPending], sizeof(FBXNode) * node.childCount);
+		node.firstChild = tree->nodeCount;
+		tree->nodeCount += node.childCount;
+		tree->pendingCount = firstPending;
+	}
 
-	//Get children
-	while ((int32_t)stream->characterIndex < (int32_t)node->endOffset - 13) //Convert to int32_t to handle unexpected null terminators
+	if (node.childCount != 0 && !state->done)
 	{
-		//Increase storage
-		struct FBXNode** children = malloc(sizeof(struct FBXNode*) * (node->childCount + 1)); //Allocate new buffer
-		if (children == 0) //Verify allocation
-		{
-			_fbx_FreeNode(node);
-			*result = STARDUST_ERROR_MEMORY_ERROR;
-			return 0;
-		}
+		f_Seek(stream->file, 13, FileOrigin_Current);
+		stream->characterIndex += 13;
+	}
 
-		//Copy in nodes
-		memcpy(children, node->children, node->childCount * sizeof(struct FBXNode*));
-	
-		//Free old memory
-		if (node->children != 0)
-			free(node->children);
+	result = _fbx_ReserveArray(&tree->arena, (void**)&tree->pending, &tree->pendingCapacity, tree->pendingCount, 1, sizeof(FBXNode));
+	if (result != STARDUST_ERROR_SUCCESS)
+		return result;
 
-		//Set new memory
-		node->children = children;
-		node->childCount += 1;
+	tree->pending[tree->pendingCount++] = node;
 
-		//Create new node
-		struct FBXNode* childNode = _fbx_GetNode(stream, result);
-		if (*result != 0)
-		{
-			_fbx_FreeNode(node); //This will error. Implement more generalised solution
-			return 0;
-		}
+	return STARDUST_ERROR_SUCCESS;
+}
 
-		node->children[node->childCount - 1] = childNode;
-	}
+StardustErrorCode _fbx_LoadProperties(FBXTree* tree, FBXNode* node)
+{
+	FBXProperty* properties = ar_Allocate(&tree->arena, sizeof(FBXProperty) * node->propertyCount);
+	if (properties == 0)
+		return STARDUST_ERROR_MEMORY_ERROR;
 
-	if (node->childCount != 0)
+	fs_Seek(tree->stream, (long)node->propertyOffset);
+	for (uint32_t i = 0; i < node->propertyCount; i++)
 	{
-		f_Seek(stream->file, 13, FileOrigin_Current);
-		stream->characterIndex += 13;
+		StardustErrorCode ret = _fbx_ReadProperty(tree->stream, &tree->arena, (long)node->propertyOffset + (long)node->propertyListLength, &properties[i]);
+		if (ret != STARDUST_ERROR_SUCCESS)
+			return ret;
 	}
 
-	return node;
+	//The properties have to fill the list exactly, otherwise the header was wrong
+	if (tree->stream->characterIndex != (long)node->propertyOffset + (long)node->propertyListLength)
+		return STARDUST_ERROR_FILE_INVALID;
+
+	node->properties = properties;
+	return STARDUST_ERROR_SUCCESS;
 }
 
-StardustErrorCode _fbx_GetProperty(FileStream* stream, FBXProperty* prop)
+StardustErrorCode _fbx_ReadProperty(FileStream* stream, Arena* arena, long listEnd, FBXProperty* prop)
 {
 	//Get type
 	char type;
-	fs_ReadBytes(stream, &type, 1);
+	StardustErrorCode ret = fs_ReadBytes(stream, &type, 1);
+	if (ret != STARDUST_ERROR_SUCCESS)
+		return ret;
+	if (type < 0)
+		return STARDUST_ERROR_FILE_INVALID;
 
 	prop->type = FBXPropertyDict[(int8_t)type]; //Use ASCII value of type for dict index
 	prop->length = 1;
+	prop->enc = 0;
+	prop->raw = 0;
 
 	//Validate type
 	if (prop->type < 0 || prop->type > 12)
@@ -942,60 +1026,47 @@ StardustErrorCode _fbx_GetProperty(FileStream* stream, FBXProperty* prop)
 		else
 			prop->enc = 0;
 	}
-	
-	if (prop->enc == 1)
-	{
-		prop->rawArr = malloc(prop->compLen);
-		if (prop->rawArr == 0)
-			return STARDUST_ERROR_MEMORY_ERROR;
 
-		StardustErrorCode ret = fs_ReadBytes(stream, prop->rawArr, prop->compLen);
-		return ret;
-	}
+	//Compressed arrays are stored as they are and inflated when they are used
+	size_t byteCount = prop->enc == 1 ? prop->compLen : (size_t)prop->length * _fbx_Sizes[prop->type];
 
-	prop->raw = malloc(prop->length * _fbx_Sizes[prop->type]);
+	//A length that runs past the property list is corrupt. Nothing after the list belongs to this property
+	if (stream->characterIndex > listEnd || byteCount > (size_t)(listEnd - stream->characterIndex))
+		return STARDUST_ERROR_FILE_INVALID;
+
+	prop->raw = ar_Allocate(arena, byteCount);
 	if (prop->raw == 0)
 		return STARDUST_ERROR_MEMORY_ERROR;
 
-	StardustErrorCode ret = fs_ReadBytes(stream, prop->raw, prop->length * _fbx_Sizes[prop->type]);
-	return ret;
+	return fs_ReadBytes(stream, prop->raw, (long)byteCount);
 }
 
-void _fbx_FreeGlobalNode(struct FBXNode* node)
+StardustErrorCode _fbx_ReserveArray(Arena* arena, void** array, uint32_t* capacity, uint32_t count, uint32_t extra, size_t elementSize)
 {
-	if (node->children != 0)
-	{
-		for (uint32_t i = 0; i < node->childCount; i++)
-			_fbx_FreeNode(node->children[i]);
-		free(node->children);
-	}
-}
+	if (count + extra <= *capacity)
+		return STARDUST_ERROR_SUCCESS;
 
-void _fbx_FreeNode(struct FBXNode* node)
-{
-	if (node->name != 0)
-		free(node->name);
+	uint32_t newCapacity = *capacity > 0 ? *capacity * 2 : 64;
+	while (newCapacity < count + extra)
+		newCapacity *= 2;
 
-	if (node->propertyCount != 0)
-	{
-		for (uint32_t i = 0; i < node->propertyCount; i++)
-			_fbx_FreeProperty(&node->properties[i]);
-		free(node->properties);
-	}
+	void* grown = ar_Grow(arena, *array, elementSize * *capacity, elementSize * newCapacity);
+	if (grown == 0)
+		return STARDUST_ERROR_MEMORY_ERROR;
 
-	if (node->children != 0)
-	{
-		for (uint32_t i = 0; i < node->childCount; i++)
-			_fbx_FreeNode(node->children[i]);
-		free(node->children);
-	}
+	*array = grown;
+	*capacity = newCapacity;
 
-	free(node);
+	return STARDUST_ERROR_SUCCESS;
 }
 
-void _fbx_FreeProperty(FBXProperty* prop)
+void _fbx_FreeTree(FBXTree* tree)
 {
-	free(prop->raw);
+	//Every node, name and property is in the arena
+	ar_FreeArena(&tree->arena);
+
+	tree->nodes = 0;
+	tree->pending = 0;
 }
 
 void _fbx_InitFBXPropertyDict()
@@ -174,8 +174,8 @@ OBJObject* _obj_GetObjects(FILE* file, StardustErrorCode* result, size_t* object
 			memset(object->tags, 0, sizeof(OBJTags));
 			
 			//Swap pointers
-			//Free previous objects
-			_obj_FreeObjects(objects, currentObjectCount - 1);
+			//Free previous array. The objects themselves were moved into the new one
+			free(objects);
 
 			objects = newObjects;
 		}
@@ -673,7 +673,7 @@ void _obj_FreeObjects(OBJObject* objs, size_t count)
 {
 	for (size_t i = 0; i < count; i++)
 	{
-		_obj_FreeObject(objs);
+		_obj_FreeObject(&objs[i]);
 	}
 	free(objs);
 }
@@ -1,4 +1,7 @@
 #include "postprocessing.h"
+#include "utils/thread.h"
+#include "utils/sort.h"
+#include "utils/bounds.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -6,246 +9,3119 @@
 
 #include <stdio.h>
 
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static StardustPostProcessSettings _post_Settings =
+{
+	1e-5f,			//weldPositionTolerance
+	0.01745329f,	//weldNormalAngle. 1 degree
+	1e-5f,			//weldUVTolerance
+
+	3.14159265f,	//normalCreaseAngle. 180 degrees smooths every edge
+	STARDUST_NORMAL_WEIGHT_AREA, //normalWeighting
+
+	STARDUST_INSTRUCTIONS_BEST, //instructionSet
+	1,				//deterministic
+
+	32,				//vertexCacheSize
+	1.05f,			//overdrawThreshold
+
+	64,				//meshletMaxVertices
+	124,			//meshletMaxTriangles
+
+	3,				//lodCount
+	0.5f,			//lodReduction
+	0.01f			//lodTargetError
+};
+
+StardustPostProcessSettings* _post_GetSettings()
+{
+	return &_post_Settings;
+}
+
+void _post_FreeDerivedData(StardustMesh* mesh)
+{
+	free(mesh->tangents);
+	mesh->tangents = 0;
+	mesh->dataType &= ~STARDUST_TANGENT_DATA;
+
+	_post_FreeMeshlets(mesh);
+	_post_FreeLODs(mesh);
+
+	mesh->postProcessStages &= ~POST_DERIVED_STAGES;
+	mesh->acmr = 0.0f;
+}
+
 StardustErrorCode _post_PerformPostProcessing(StardustMesh* mesh, StardustMeshFlags flags)
 {
 	StardustErrorCode ret;
 
-	//Switch on flags
+	PostProcessPlan plan;
+	_post_PlanPostProcessing(mesh, flags, &_post_Settings, &plan);
+
+	//A mesh that was processed before may have data built from the vertices these stages replace
+	if ((plan.stages & POST_REBUILD_STAGES) != 0)
+		_post_FreeDerivedData(mesh);
+
+	//Welding during normal generation uses the weld settings. Otherwise normal generation only merges exact duplicates
+	const StardustPostProcessSettings* fusedWeld = (plan.stages & STARDUST_STAGE_FUSED_WELD) == STARDUST_STAGE_FUSED_WELD ? &_post_Settings : 0;
+
+	//Triangulation of meshes. Flat normal generation triangulates as it goes
+	if ((plan.stages & STARDUST_STAGE_TRIANGULATE) == STARDUST_STAGE_TRIANGULATE && (plan.stages & STARDUST_STAGE_FUSED_TRIANGULATE) != STARDUST_STAGE_FUSED_TRIANGULATE)
+	{
+		ret = _post_TriangulateMeshEC(mesh);
+		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+	}
+
+	//Degenerate triangles. Removed before normal generation, which would give them zero length normals
+	int degenerates = (plan.stages & STARDUST_STAGE_REMOVE_DEGENERATES) == STARDUST_STAGE_REMOVE_DEGENERATES;
+	if (degenerates)
+	{
+		ret = _post_RemoveDegenerates(mesh);
+		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+	}
+
+	//Normal Generation / Normal Hardening
+	if ((plan.stages & STARDUST_STAGE_GENERATE_NORMALS) == STARDUST_STAGE_GENERATE_NORMALS)
+	{
+		ret = _post_GenerateNormals(mesh, plan.creaseAngle, _post_Settings.normalWeighting, fusedWeld);
+		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+	}
+
+	//Normal Smoothing of existing normals
+	else if ((plan.stages & STARDUST_STAGE_SMOOTH_NORMALS) == STARDUST_STAGE_SMOOTH_NORMALS)
+	{
+		ret = _post_SmoothNormals(mesh);
+		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+	}
+
+	//Vertex Welding. Done after normal generation so that the normal tolerance applies to the final normals
+	if ((plan.stages & STARDUST_STAGE_WELD_VERTICES) == STARDUST_STAGE_WELD_VERTICES && fusedWeld == 0)
+	{
+		ret = _post_WeldVertices(mesh, &_post_Settings);
+		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+	}
+
+	//Welding can pull the corners of small triangles together
+	if (degenerates && (plan.stages & STARDUST_STAGE_WELD_VERTICES) == STARDUST_STAGE_WELD_VERTICES)
+	{
+		ret = _post_RemoveDegenerates(mesh);
+		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+	}
+
+	//Tangent Generation. Done last as it splits vertices that welding would merge again
+	if ((plan.stages & STARDUST_STAGE_GENERATE_TANGENTS) == STARDUST_STAGE_GENERATE_TANGENTS)
+	{
+		ret = _post_GenerateTangents(mesh);
+		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+	}
+
+	//Levels of detail. Simplified from the final vertices so that every level can share them
+	if ((plan.stages & STARDUST_STAGE_GENERATE_LODS) == STARDUST_STAGE_GENERATE_LODS)
+	{
+		ret = _post_GenerateLODs(mesh, _post_Settings.lodCount, _post_Settings.lodReduction, _post_Settings.lodTargetError);
+		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+
+		//Meshes that couldn't be simplified at all, like ones with hard normals on every edge, don't report the stage
+		if (mesh->lodCount == 0)
+			plan.stages &= ~STARDUST_STAGE_GENERATE_LODS;
+	}
+
+	//Spatial Sorting. Gives the vertex cache optimisation and meshlets a coherent order to start from
+	if ((plan.stages & STARDUST_STAGE_SORT_TRIANGLES) == STARDUST_STAGE_SORT_TRIANGLES)
+	{
+		ret = _post_SortTrianglesSpatial(mesh);
+		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+	}
+
+	if ((plan.stages & STARDUST_STAGE_SORT_VERTICES) == STARDUST_STAGE_SORT_VERTICES)
+	{
+		ret = _post_SortVerticesSpatial(mesh);
+		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+	}
+
+	//Vertex Cache Optimization. Only reorders triangles, so it runs once every stage that changes the indices is done
+	if ((plan.stages & STARDUST_STAGE_OPTIMIZE_VERTEX_CACHE) == STARDUST_STAGE_OPTIMIZE_VERTEX_CACHE)
+	{
+		ret = _post_OptimizeVertexCache(mesh, _post_Settings.vertexCacheSize);
+		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+	}
+
+	//Overdraw Optimization. Splits the cache optimised order into clusters
+	if ((plan.stages & STARDUST_STAGE_OPTIMIZE_OVERDRAW) == STARDUST_STAGE_OPTIMIZE_OVERDRAW)
+	{
+		ret = _post_OptimizeOverdraw(mesh, _post_Settings.vertexCacheSize, _post_Settings.overdrawThreshold);
+		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+	}
+
+	//The levels of detail get the same triangle order optimisations as the full mesh
+	if (mesh->lodCount > 0)
+	{
+		ret = _post_OptimizeLODs(mesh, plan.stages);
+		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+	}
+
+	//Vertex Fetch Optimization. Follows the final index order
+	if ((plan.stages & STARDUST_STAGE_OPTIMIZE_VERTEX_FETCH) == STARDUST_STAGE_OPTIMIZE_VERTEX_FETCH)
+	{
+		ret = _post_OptimizeVertexFetch(mesh);
+		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+	}
+
+	//Meshlets. Built from the final indices
+	if ((plan.stages & STARDUST_STAGE_BUILD_MESHLETS) == STARDUST_STAGE_BUILD_MESHLETS)
+	{
+		ret = _post_BuildMeshlets(mesh, _post_Settings.meshletMaxVertices, _post_Settings.meshletMaxTriangles);
+		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+	}
+
+	//Kept on top of stages that already ran while loading, like triangulation for STARDUST_MESH_MERGE_MESHES
+	mesh->postProcessStages |= plan.stages;
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+void _post_PlanPostProcessing(const StardustMesh* mesh, StardustMeshFlags flags, const StardustPostProcessSettings* settings, PostProcessPlan* plan)
+{
+	plan->stages = 0;
+	plan->creaseAngle = 0.0f;
+
+	//Normals
+	if ((flags & STARDUST_MESH_GENERATE_NORMALS) == STARDUST_MESH_GENERATE_NORMALS)
+	{
+		//Hard normals unless smoothing is also requested, in which case only edges sharper than the crease angle are hardened
+		plan->stages |= STARDUST_STAGE_GENERATE_NORMALS;
+		if ((flags & STARDUST_MESH_SMOOTH_NORMALS) == STARDUST_MESH_SMOOTH_NORMALS)
+			plan->creaseAngle = settings->normalCreaseAngle;
+	}
+	else if ((flags & STARDUST_MESH_SMOOTH_NORMALS) == STARDUST_MESH_SMOOTH_NORMALS && (mesh->dataType & STARDUST_SMOOTHSHADING) != STARDUST_SMOOTHSHADING)
+	{
+		//Smooth the existing normals, or generate smooth normals if there are none
+		if ((mesh->dataType & STARDUST_NORMAL_DATA) != STARDUST_NORMAL_DATA)
+		{
+			plan->stages |= STARDUST_STAGE_GENERATE_NORMALS;
+			plan->creaseAngle = settings->normalCreaseAngle;
+		}
+		else
+			plan->stages |= STARDUST_STAGE_SMOOTH_NORMALS;
+	}
+
+	if ((plan->stages & STARDUST_STAGE_GENERATE_NORMALS) == STARDUST_STAGE_GENERATE_NORMALS && plan->creaseAngle > 0.0f)
+		plan->stages |= STARDUST_STAGE_SMOOTH_NORMALS;
+
+	//Tangents need texture coordinates and normals, either loaded or generated
+	int generate = (plan->stages & STARDUST_STAGE_GENERATE_NORMALS) == STARDUST_STAGE_GENERATE_NORMALS;
+	if ((flags & STARDUST_MESH_GENERATE_TANGENTS) == STARDUST_MESH_GENERATE_TANGENTS && (mesh->dataType & STARDUST_TEXTURE_DATA) == STARDUST_TEXTURE_DATA &&
+		((mesh->dataType & STARDUST_NORMAL_DATA) == STARDUST_NORMAL_DATA || generate))
+		plan->stages |= STARDUST_STAGE_GENERATE_TANGENTS;
+
+	if ((flags & STARDUST_MESH_OPTIMIZE_VERTEX_CACHE) == STARDUST_MESH_OPTIMIZE_VERTEX_CACHE)
+		plan->stages |= STARDUST_STAGE_OPTIMIZE_VERTEX_CACHE;
+
+	//The overdraw clusters are cut from a cache optimised order
+	if ((flags & STARDUST_MESH_OPTIMIZE_OVERDRAW) == STARDUST_MESH_OPTIMIZE_OVERDRAW)
+		plan->stages |= STARDUST_STAGE_OPTIMIZE_VERTEX_CACHE | STARDUST_STAGE_OPTIMIZE_OVERDRAW;
+
+	if ((flags & STARDUST_MESH_OPTIMIZE_VERTEX_FETCH) == STARDUST_MESH_OPTIMIZE_VERTEX_FETCH)
+		plan->stages |= STARDUST_STAGE_OPTIMIZE_VERTEX_FETCH;
+
+	if ((flags & STARDUST_MESH_BUILD_MESHLETS) == STARDUST_MESH_BUILD_MESHLETS)
+		plan->stages |= STARDUST_STAGE_BUILD_MESHLETS;
+
+	if ((flags & STARDUST_MESH_GENERATE_LODS) == STARDUST_MESH_GENERATE_LODS && settings->lodCount > 0)
+		plan->stages |= STARDUST_STAGE_GENERATE_LODS;
+
+	if ((flags & STARDUST_MESH_REMOVE_DEGENERATES) == STARDUST_MESH_REMOVE_DEGENERATES)
+		plan->stages |= STARDUST_STAGE_REMOVE_DEGENERATES;
+
+	if ((flags & STARDUST_MESH_SORT_TRIANGLES) == STARDUST_MESH_SORT_TRIANGLES)
+		plan->stages |= STARDUST_STAGE_SORT_TRIANGLES;
+
+	if ((flags & STARDUST_MESH_SORT_VERTICES) == STARDUST_MESH_SORT_VERTICES)
+		plan->stages |= STARDUST_STAGE_SORT_VERTICES;
+
+	//Triangulation. Normal and tangent generation, the vertex cache optimisation, meshlets, simplification, degenerate removal and triangle sorting need triangles
+	int tangents = (plan->stages & STARDUST_STAGE_GENERATE_TANGENTS) == STARDUST_STAGE_GENERATE_TANGENTS;
+	int cache = (plan->stages & STARDUST_STAGE_OPTIMIZE_VERTEX_CACHE) == STARDUST_STAGE_OPTIMIZE_VERTEX_CACHE;
+	int meshlets = (plan->stages & STARDUST_STAGE_BUILD_MESHLETS) == STARDUST_STAGE_BUILD_MESHLETS;
+	int lods = (plan->stages & STARDUST_STAGE_GENERATE_LODS) == STARDUST_STAGE_GENERATE_LODS;
+	int degenerates = (plan->stages & STARDUST_STAGE_REMOVE_DEGENERATES) == STARDUST_STAGE_REMOVE_DEGENERATES;
+	int sortTriangles = (plan->stages & STARDUST_STAGE_SORT_TRIANGLES) == STARDUST_STAGE_SORT_TRIANGLES;
+	if (mesh->vertexStride != 3 && ((flags & STARDUST_MESH_TRIANGULATE) == STARDUST_MESH_TRIANGULATE || generate || tangents || cache || meshlets || lods || degenerates || sortTriangles))
+	{
+		plan->stages |= STARDUST_STAGE_TRIANGULATE;
+
+		//Flat normals are generated polygon by polygon as they are triangulated. Smooth normals need every face first,
+		//and degenerate removal needs every triangle before normals are generated
+		if (generate && plan->creaseAngle <= 0.0f && !degenerates)
+			plan->stages |= STARDUST_STAGE_FUSED_TRIANGULATE;
+	}
+
+	//Welding. Normal generation already builds a new vertex array, so welding happens as the vertices are added to it
+	if ((flags & STARDUST_MESH_WELD_VERTICES) == STARDUST_MESH_WELD_VERTICES)
+	{
+		plan->stages |= STARDUST_STAGE_WELD_VERTICES;
+		if (generate)
+			plan->stages |= STARDUST_STAGE_FUSED_WELD;
+	}
+}
+
+// ================= Degenerate Triangles ================= //
+
+StardustErrorCode _post_RemoveDegenerates(StardustMesh* mesh)
+{
+	//Marks used vertices, then becomes the remap table
+	uint32_t* remap = malloc(((size_t)mesh->vertexCount + 1) * sizeof(uint32_t));
+	if (remap == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
+	memset(remap, 0xFF, (size_t)mesh->vertexCount * sizeof(uint32_t)); //Every vertex starts unused
+
+	//Kept triangles are moved down over the removed ones
+	uint32_t indexCount = 0;
+	for (uint32_t i = 0; i + 2 < mesh->indexCount; i += 3)
+	{
+		uint32_t a = mesh->indices[i];
+		uint32_t b = mesh->indices[i + 1];
+		uint32_t c = mesh->indices[i + 2];
+
+		if (a == b || b == c || c == a || _post_IsTriangleDegenerate(&mesh->vertices[a], &mesh->vertices[b], &mesh->vertices[c]))
+			continue;
+
+		mesh->indices[indexCount] = a;
+		mesh->indices[indexCount + 1] = b;
+		mesh->indices[indexCount + 2] = c;
+		indexCount += 3;
+
+		remap[a] = 0;
+		remap[b] = 0;
+		remap[c] = 0;
+	}
+	mesh->indexCount = indexCount;
+
+	//Used vertices keep their order, so each one moves down to its new index or stays where it is
+	uint32_t vertexCount = 0;
+	for (uint32_t i = 0; i < mesh->vertexCount; i++)
+	{
+		if (remap[i] == POST_HASH_EMPTY)
+			continue;
+
+		remap[i] = vertexCount;
+		mesh->vertices[vertexCount] = mesh->vertices[i];
+		if (mesh->tangents != 0)
+			mesh->tangents[vertexCount] = mesh->tangents[i];
+		vertexCount++;
+	}
+	mesh->vertexCount = vertexCount;
+
+	for (uint32_t i = 0; i < mesh->indexCount; i++)
+		mesh->indices[i] = remap[mesh->indices[i]];
+
+	free(remap);
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+int _post_IsTriangleDegenerate(const Vertex* a, const Vertex* b, const Vertex* c)
+{
+	float e1X = b->x - a->x;
+	float e1Y = b->y - a->y;
+	float e1Z = b->z - a->z;
+
+	float e2X = c->x - a->x;
+	float e2Y = c->y - a->y;
+	float e2Z = c->z - a->z;
+
+	float nX = e1Y * e2Z - e1Z * e2Y;
+	float nY = e1Z * e2X - e1X * e2Z;
+	float nZ = e1X * e2Y - e1Y * e2X;
+
+	//|e1 x e2|^2 = |e1|^2 |e2|^2 sin^2. Products are done in double so that tiny and huge triangles don't underflow or overflow
+	double cross = (double)nX * nX + (double)nY * nY + (double)nZ * nZ;
+	double lengths = ((double)e1X * e1X + (double)e1Y * e1Y + (double)e1Z * e1Z) * ((double)e2X * e2X + (double)e2Y * e2Y + (double)e2Z * e2Z);
+
+	return cross <= lengths * POST_DEGENERATE_SINE2;
+}
+
+// ================= Weld Vertices ================= //
+
+StardustErrorCode _post_WeldVertices(StardustMesh* mesh, const StardustPostProcessSettings* settings)
+{
+	VertexEmitter emitter;
+	StardustErrorCode ret = _post_InitVertexEmitter(&emitter, mesh->vertexCount, mesh->dataType, settings);
+	if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+
+	uint32_t* remap = malloc(mesh->vertexCount * sizeof(uint32_t));
+	if (remap == 0) { _post_FreeVertexEmitter(&emitter); return STARDUST_ERROR_MEMORY_ERROR; }
+
+	for (uint32_t i = 0; i < mesh->vertexCount; i++)
+		remap[i] = _post_EmitVertex(&emitter, &mesh->vertices[i]);
+
+	//Remap indices
+	for (uint32_t i = 0; i < mesh->indexCount; i++)
+		mesh->indices[i] = remap[mesh->indices[i]];
+
+	free(remap);
+
+	_post_FinishVertexEmitter(&emitter, mesh);
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+int _post_CanWeldVertices(const Vertex* a, const Vertex* b, StardustMeshDataType dataType, float positionTolerance2, float normalCosine, float uvTolerance)
+{
+	//Position
+	float dX = a->x - b->x;
+	float dY = a->y - b->y;
+	float dZ = a->z - b->z;
+
+	if (dX * dX + dY * dY + dZ * dZ > positionTolerance2 || a->w != b->w)
+		return 0;
+
+	//Color
+	if ((dataType & STARDUST_COLOR_DATA) == STARDUST_COLOR_DATA)
+	{
+		if (a->r != b->r || a->g != b->g || a->b != b->b)
+			return 0;
+	}
+
+	//Normal. Compare against the product of the lengths so that unnormalised normals still work
+	if ((dataType & STARDUST_NORMAL_DATA) == STARDUST_NORMAL_DATA)
+	{
+		float dot = a->normX * b->normX + a->normY * b->normY + a->normZ * b->normZ;
+		float lengthA = a->normX * a->normX + a->normY * a->normY + a->normZ * a->normZ;
+		float lengthB = b->normX * b->normX + b->normY * b->normY + b->normZ * b->normZ;
+
+		if (dot < normalCosine * sqrtf(lengthA * lengthB))
+			return 0;
+	}
+
+	//Texture coordinates
+	if ((dataType & STARDUST_TEXTURE_DATA) == STARDUST_TEXTURE_DATA)
+	{
+		if (fabsf(a->texU - b->texU) > uvTolerance || fabsf(a->texV - b->texV) > uvTolerance || fabsf(a->texW - b->texW) > uvTolerance)
+			return 0;
+	}
+
+	return 1;
+}
+
+int32_t _post_GetGridCell(float value, float inverseCellSize)
+{
+	double cell = floor((double)value * inverseCellSize);
+
+	//Clamp to a range that leaves room for the neighbour offsets
+	if (cell > 1073741824.0)
+		return 1073741824;
+	if (cell < -1073741824.0)
+		return -1073741824;
+
+	return (int32_t)cell;
+}
+
+// ================= Vertex Emitter ================= //
+
+StardustErrorCode _post_InitVertexEmitter(VertexEmitter* emitter, uint32_t maxVertexCount, StardustMeshDataType dataType, const StardustPostProcessSettings* weld)
+{
+	memset(emitter, 0, sizeof(VertexEmitter));
+	emitter->dataType = dataType;
+
+	//Without a position tolerance welding is the same as exact deduplication
+	if (weld != 0 && weld->weldPositionTolerance > 0.0f)
+		emitter->weld = weld;
+
+	size_t vertexSize = (maxVertexCount > 0 ? maxVertexCount : 1) * sizeof(Vertex);
+
+	emitter->tableSize = _post_GetHashTableSize(maxVertexCount);
+	emitter->table = malloc(emitter->tableSize * sizeof(uint32_t));
+	emitter->unique = malloc(vertexSize);
+	if (emitter->table == 0 || emitter->unique == 0) { _post_FreeVertexEmitter(emitter); return STARDUST_ERROR_MEMORY_ERROR; }
+
+	memset(emitter->table, 0xFF, emitter->tableSize * sizeof(uint32_t)); //Set every slot to POST_HASH_EMPTY
+
+	if (emitter->weld == 0)
+	{
+		emitter->vertices = emitter->unique; //Unique vertices are the output
+		return STARDUST_ERROR_SUCCESS;
+	}
+
+	emitter->inverseCellSize = 1.0f / weld->weldPositionTolerance;
+	emitter->positionTolerance2 = weld->weldPositionTolerance * weld->weldPositionTolerance;
+	emitter->normalCosine = cosf(weld->weldNormalAngle);
+
+	//Grid cells are hashed into buckets. Each bucket is a linked list of welded vertices through cellNext
+	emitter->bucketCount = _post_GetHashTableSize(maxVertexCount);
+	emitter->buckets = malloc(emitter->bucketCount * sizeof(uint32_t));
+	emitter->cellNext = malloc((maxVertexCount > 0 ? maxVertexCount : 1) * sizeof(uint32_t));
+	emitter->uniqueOutput = malloc((maxVertexCount > 0 ? maxVertexCount : 1) * sizeof(uint32_t));
+	emitter->vertices = malloc(vertexSize);
+	if (emitter->buckets == 0 || emitter->cellNext == 0 || emitter->uniqueOutput == 0 || emitter->vertices == 0)
+	{
+		_post_FreeVertexEmitter(emitter);
+		return STARDUST_ERROR_MEMORY_ERROR;
+	}
+
+	memset(emitter->buckets, 0xFF, emitter->bucketCount * sizeof(uint32_t)); //Set every bucket to POST_HASH_EMPTY
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+uint32_t _post_EmitVertex(VertexEmitter* emitter, const Vertex* vertex)
+{
+	//Exact duplicates share a vertex. Linear probe until we find the vertex or an empty slot
+	uint32_t slot = _post_HashVertex(vertex, emitter->dataType) & (emitter->tableSize - 1);
+	while (emitter->table[slot] != POST_HASH_EMPTY)
+	{
+		if (_post_CompareVertexData(vertex, &emitter->unique[emitter->table[slot]], emitter->dataType))
+			return emitter->weld == 0 ? emitter->table[slot] : emitter->uniqueOutput[emitter->table[slot]];
+
+		slot = (slot + 1) & (emitter->tableSize - 1);
+	}
+
+	uint32_t unique = emitter->uniqueCount++;
+	emitter->unique[unique] = *vertex;
+	emitter->table[slot] = unique;
+
+	if (emitter->weld == 0)
+	{
+		emitter->vertexCount++;
+		return unique;
+	}
+
+	// Weld //
+	int32_t cell[3];
+	cell[0] = _post_GetGridCell(vertex->x, emitter->inverseCellSize);
+	cell[1] = _post_GetGridCell(vertex->y, emitter->inverseCellSize);
+	cell[2] = _post_GetGridCell(vertex->z, emitter->inverseCellSize);
+
+	//Search the neighbouring cells. A vertex within the tolerance can be at most one cell away
+	for (int32_t n = 0; n < 27; n++)
+	{
+		int32_t neighbour[3] = { cell[0] + n % 3 - 1, cell[1] + (n / 3) % 3 - 1, cell[2] + n / 9 - 1 };
+		uint32_t bucket = _post_HashWords(neighbour, 3, 0) & (emitter->bucketCount - 1);
+
+		for (uint32_t j = emitter->buckets[bucket]; j != POST_HASH_EMPTY; j = emitter->cellNext[j])
+		{
+			if (_post_CanWeldVertices(vertex, &emitter->vertices[j], emitter->dataType, emitter->positionTolerance2, emitter->normalCosine, emitter->weld->weldUVTolerance))
+			{
+				emitter->uniqueOutput[unique] = j;
+				return j;
+			}
+		}
+	}
+
+	//First vertex of a new cluster. Add it to its own cell
+	uint32_t bucket = _post_HashWords(cell, 3, 0) & (emitter->bucketCount - 1);
+	uint32_t output = emitter->vertexCount++;
+
+	emitter->vertices[output] = *vertex;
+	emitter->cellNext[output] = emitter->buckets[bucket];
+	emitter->buckets[bucket] = output;
+
+	emitter->uniqueOutput[unique] = output;
+	return output;
+}
+
+void _post_FinishVertexEmitter(VertexEmitter* emitter, StardustMesh* mesh)
+{
+	Vertex* vertexArray = emitter->vertices;
+	if (emitter->vertices != emitter->unique)
+		free(emitter->unique);
+	emitter->unique = 0;
+	emitter->vertices = 0;
+
+	//Shrink vertex array to the emitted vertex count
+	if (emitter->vertexCount != 0)
+	{
+		Vertex* shrunkArray = realloc(vertexArray, emitter->vertexCount * sizeof(Vertex));
+		if (shrunkArray != 0)
+			vertexArray = shrunkArray;
+	}
+
+	free(mesh->vertices);
+	mesh->vertices = vertexArray;
+	mesh->vertexCount = emitter->vertexCount;
+
+	_post_FreeVertexEmitter(emitter);
+}
+
+void _post_FreeVertexEmitter(VertexEmitter* emitter)
+{
+	if (emitter->vertices != emitter->unique)
+		free(emitter->vertices);
+	free(emitter->unique);
+	free(emitter->table);
+	free(emitter->uniqueOutput);
+	free(emitter->buckets);
+	free(emitter->cellNext);
+
+	memset(emitter, 0, sizeof(VertexEmitter));
+}
+
+// ================= Smooth Normals ================= //
+
+StardustErrorCode _post_SmoothNormals(StardustMesh* mesh)
+{
+	uint32_t* vertexPositions = malloc(((size_t)mesh->vertexCount + 1) * sizeof(uint32_t));
+	if (vertexPositions == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
+
+	//Vertices at the same position share a normal, so it doesn't matter which faces use them
+	uint32_t positionCount = 0;
+	StardustErrorCode ret = _post_GroupPositions(mesh, vertexPositions, &positionCount);
+	float* sums = 0;
+	if (ret == STARDUST_ERROR_SUCCESS)
+	{
+		sums = malloc(((size_t)positionCount + 1) * 3 * sizeof(float));
+		if (sums == 0)
+			ret = STARDUST_ERROR_MEMORY_ERROR;
+	}
+
+	if (ret != STARDUST_ERROR_SUCCESS)
+	{
+		free(vertexPositions);
+		return ret;
+	}
+
+	// Average normals
+	memset(sums, 0, (size_t)positionCount * 3 * sizeof(float));
+	for (uint32_t i = 0; i < mesh->vertexCount; i++)
+	{
+		float* sum = &sums[vertexPositions[i] * 3];
+		sum[0] += mesh->vertices[i].normX;
+		sum[1] += mesh->vertices[i].normY;
+		sum[2] += mesh->vertices[i].normZ;
+	}
+
+	for (uint32_t i = 0; i < positionCount; i++)
+	{
+		float* sum = &sums[i * 3];
+		float mag = sqrtf(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+
+		//Normals that cancel out are left as they are
+		if (mag > 0.0f)
+		{
+			sum[0] /= mag;
+			sum[1] /= mag;
+			sum[2] /= mag;
+		}
+	}
+
+	for (uint32_t i = 0; i < mesh->vertexCount; i++)
+	{
+		const float* sum = &sums[vertexPositions[i] * 3];
+		if (sum[0] == 0.0f && sum[1] == 0.0f && sum[2] == 0.0f)
+			continue;
+
+		mesh->vertices[i].normX = sum[0];
+		mesh->vertices[i].normY = sum[1];
+		mesh->vertices[i].normZ = sum[2];
+	}
+
+	mesh->dataType |= STARDUST_SMOOTHSHADING;
+
+	free(vertexPositions);
+	free(sums);
+
+	return _post_RecomputeIndexArray(mesh);
+}
+
+
+
+
+
+// ================= Generate Normals ================= //
+
+StardustErrorCode _post_GenerateNormals(StardustMesh* mesh, float creaseAngle, StardustNormalWeighting weighting, const StardustPostProcessSettings* weld)
+{
+	StardustErrorCode ret;
+
+	//Flat normals only need the triangles of one polygon at a time, so they are generated while triangulating
+	if (mesh->vertexStride != 3 && creaseAngle <= 0.0f)
+		return _post_GenerateFlatNormals(mesh, weld);
+
+	//Check that mesh is triangulated
+	if (mesh->vertexStride != 3)
+	{
+		ret = _post_TriangulateMeshEC(mesh); //If not, triangulate
+		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+	}
+
+	uint32_t triangleCount = mesh->indexCount / 3;
+
+	// Face normals and corner weights //
+	float* faceNormals = malloc((size_t)triangleCount * 3 * sizeof(float));
+	if (faceNormals == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
+	float* cornerWeights = malloc((size_t)mesh->indexCount * sizeof(float));
+	if (cornerWeights == 0) { free(faceNormals); return STARDUST_ERROR_MEMORY_ERROR; }
+
+	_post_CalculateFaceNormals(mesh, weighting, faceNormals, cornerWeights);
+
+	// Corner adjacency //
+	//Group every corner by the position of its vertex so that smoothing crosses uv and color seams
+	StardustAdjacency adjacency;
+	memset(&adjacency, 0, sizeof(StardustAdjacency));
+	if (creaseAngle > 0.0f)
+	{
+		ret = _post_BuildAdjacency(mesh, 0, &adjacency);
+		if (ret != STARDUST_ERROR_SUCCESS) { free(faceNormals); free(cornerWeights); return ret; }
+	}
+
+	// Emit vertices //
+	//Worst case is a vertex per corner. The indices are emitted into a new array as the old vertices are still being read
+	VertexEmitter emitter;
+	ret = _post_InitVertexEmitter(&emitter, mesh->indexCount, mesh->dataType | STARDUST_NORMAL_DATA, weld);
+	uint32_t* indexArray = malloc((size_t)mesh->indexCount * sizeof(uint32_t));
+	if (ret != STARDUST_ERROR_SUCCESS || indexArray == 0)
+	{
+		_post_FreeVertexEmitter(&emitter); free(indexArray);
+		free(faceNormals); free(cornerWeights);
+		_post_FreeAdjacency(&adjacency);
+		return STARDUST_ERROR_MEMORY_ERROR;
+	}
+
+	float creaseCosine = cosf(creaseAngle);
+
+	for (uint32_t i = 0; i < mesh->indexCount; i++)
+	{
+		float* faceNormal = &faceNormals[(i / 3) * 3];
+		float normX = faceNormal[0], normY = faceNormal[1], normZ = faceNormal[2];
+
+		if (creaseAngle > 0.0f)
+		{
+			//Accumulate the weighted normals of every face around this position that is within the crease angle
+			uint32_t position = adjacency.vertexPositions[mesh->indices[i]];
+			normX = 0; normY = 0; normZ = 0;
+
+			for (uint32_t j = adjacency.cornerStart[position]; j < adjacency.cornerStart[position + 1]; j++)
+			{
+				uint32_t corner = adjacency.corners[j];
+				float* otherNormal = &faceNormals[(corner / 3) * 3];
+
+				float dot = faceNormal[0] * otherNormal[0] + faceNormal[1] * otherNormal[1] + faceNormal[2] * otherNormal[2];
+				if (corner != i && dot < creaseCosine)
+					continue;
+
+				normX += otherNormal[0] * cornerWeights[corner];
+				normY += otherNormal[1] * cornerWeights[corner];
+				normZ += otherNormal[2] * cornerWeights[corner];
+			}
+
+			float mag = sqrtf(normX * normX + normY * normY + normZ * normZ);
+			if (mag > 0.0f)
+			{
+				normX /= mag;
+				normY /= mag;
+				normZ /= mag;
+			}
+			else //Every face cancelled out. Use the face normal
+			{
+				normX = faceNormal[0];
+				normY = faceNormal[1];
+				normZ = faceNormal[2];
+			}
+		}
+
+		//Create vertex
+		Vertex vertex = mesh->vertices[mesh->indices[i]];
+		vertex.normX = normX;
+		vertex.normY = normY;
+		vertex.normZ = normZ;
+
+		//Corners that end up with the same vertex share it. This replaces expanding the mesh and welding it afterwards
+		indexArray[i] = _post_EmitVertex(&emitter, &vertex);
+	}
+
+	free(faceNormals);
+	free(cornerWeights);
+	_post_FreeAdjacency(&adjacency);
+
+	//Set new data
+	_post_FinishVertexEmitter(&emitter, mesh);
+
+	free(mesh->indices);
+	mesh->indices = indexArray;
+
+	mesh->dataType |= STARDUST_NORMAL_DATA;
+	if (creaseAngle > 0.0f)
+		mesh->dataType |= STARDUST_SMOOTHSHADING;
+	else
+		mesh->dataType &= ~STARDUST_SMOOTHSHADING;
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+StardustErrorCode _post_GenerateFlatNormals(StardustMesh* mesh, const StardustPostProcessSettings* weld)
+{
+	uint32_t polygonCount = mesh->indexCount / mesh->vertexStride;
+	uint32_t polygonIndexCount = 3 * (mesh->vertexStride - 2); //Indices of a triangulated polygon
+	size_t newIndexCount = (size_t)polygonIndexCount * polygonCount;
+
+	VertexEmitter emitter;
+	StardustErrorCode ret = _post_InitVertexEmitter(&emitter, (uint32_t)newIndexCount, mesh->dataType | STARDUST_NORMAL_DATA, weld);
+	if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+
+	//Scratch memory shared by every polygon
+	uint32_t* indexArray = malloc(newIndexCount * sizeof(uint32_t));
+	uint32_t* triangles = malloc(polygonIndexCount * sizeof(uint32_t));
+	float* faceNormals = malloc(polygonIndexCount * sizeof(float));
+	float* cornerWeights = malloc(polygonIndexCount * sizeof(float));
+	float* positions = malloc(sizeof(float) * 3 * _post_GetConvexScratchSize(mesh->vertexStride));
+	PolygonScratch scratch = { 0 };
+
+	ret = STARDUST_ERROR_MEMORY_ERROR;
+	if (indexArray != 0 && triangles != 0 && faceNormals != 0 && cornerWeights != 0 && positions != 0)
+		ret = STARDUST_ERROR_SUCCESS;
+
+	FaceNormalKernel kernel = _post_GetFaceNormalKernel(_post_Settings.instructionSet, mesh->vertexCount);
+
+	uint32_t written = 0;
+	for (uint32_t i = 0; i < polygonCount && ret == STARDUST_ERROR_SUCCESS; i++)
+	{
+		Polygon polygon;
+		polygon.indices = mesh->indices + (size_t)i * mesh->vertexStride;
+		polygon.vertexCount = mesh->vertexStride;
+
+		//Triangulate then calculate the normals of just this polygon's triangles
+		uint32_t count = 0;
+		ret = _post_TriangulatePolygon(mesh, &polygon, positions, &scratch, triangles, &count);
+		if (ret != STARDUST_ERROR_SUCCESS)
+			break;
+
+		kernel(mesh->vertices, triangles, count / 3, _post_Settings.deterministic, faceNormals, cornerWeights);
+
+		for (uint32_t j = 0; j < count; j++)
+		{
+			Vertex vertex = mesh->vertices[triangles[j]];
+			vertex.normX = faceNormals[(j / 3) * 3];
+			vertex.normY = faceNormals[(j / 3) * 3 + 1];
+			vertex.normZ = faceNormals[(j / 3) * 3 + 2];
+
+			indexArray[written++] = _post_EmitVertex(&emitter, &vertex);
+		}
+	}
+
+	_post_FreePolygonScratch(&scratch);
+	free(triangles);
+	free(faceNormals);
+	free(cornerWeights);
+	free(positions);
+
+	if (ret != STARDUST_ERROR_SUCCESS)
+	{
+		_post_FreeVertexEmitter(&emitter);
+		free(indexArray);
+		return ret;
+	}
+
+	//Set new data
+	_post_FinishVertexEmitter(&emitter, mesh);
+
+	free(mesh->indices);
+	mesh->indices = indexArray;
+	mesh->indexCount = written;
+	mesh->vertexStride = 3;
+
+	mesh->dataType |= STARDUST_NORMAL_DATA;
+	mesh->dataType &= ~STARDUST_SMOOTHSHADING;
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+void _post_CalculateFaceNormals(StardustMesh* mesh, StardustNormalWeighting weighting, float* faceNormals, float* cornerWeights)
+{
+	//Normals and area weights in bulk
+	FaceNormalKernel kernel = _post_GetFaceNormalKernel(_post_Settings.instructionSet, mesh->vertexCount);
+	kernel(mesh->vertices, mesh->indices, mesh->indexCount / 3, _post_Settings.deterministic, faceNormals, cornerWeights);
+
+	if (weighting != STARDUST_NORMAL_WEIGHT_ANGLE)
+		return;
+
+	for (uint32_t i = 0; i < mesh->indexCount; i += 3)
+	{
+		Vertex* a = &mesh->vertices[mesh->indices[i]];
+		Vertex* b = &mesh->vertices[mesh->indices[i + 1]];
+		Vertex* c = &mesh->vertices[mesh->indices[i + 2]];
+
+		cornerWeights[i] = _post_GetCornerAngle(a, b, c);
+		cornerWeights[i + 1] = _post_GetCornerAngle(b, c, a);
+		cornerWeights[i + 2] = _post_GetCornerAngle(c, a, b);
+	}
+}
+
+float _post_GetCornerAngle(Vertex* corner, Vertex* next, Vertex* prev)
+{
+	float edgeAx = next->x - corner->x;
+	float edgeAy = next->y - corner->y;
+	float edgeAz = next->z - corner->z;
+
+	float edgeBx = prev->x - corner->x;
+	float edgeBy = prev->y - corner->y;
+	float edgeBz = prev->z - corner->z;
+
+	float lengths = sqrtf((edgeAx*edgeAx + edgeAy*edgeAy + edgeAz*edgeAz) * (edgeBx*edgeBx + edgeBy*edgeBy + edgeBz*edgeBz));
+	if (lengths == 0.0f)
+		return 0.0f;
+
+	float cosine = (edgeAx*edgeBx + edgeAy*edgeBy + edgeAz*edgeBz) / lengths;
+	if (cosine > 1.0f) cosine = 1.0f;
+	if (cosine < -1.0f) cosine = -1.0f;
+
+	return acosf(cosine);
+}
+
+
+// ================= Adjacency ================= //
+
+StardustErrorCode _post_GroupPositions(const StardustMesh* mesh, uint32_t* vertexGroups, uint32_t* groupCount)
+{
+	uint32_t tableSize = _post_GetHashTableSize(mesh->vertexCount);
+	uint32_t* table = malloc(tableSize * sizeof(uint32_t));
+	if (table == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
+	memset(table, 0xFF, tableSize * sizeof(uint32_t)); //Set every slot to POST_HASH_EMPTY
+
+	//A data type of 0 only keys the position
+	*groupCount = 0;
+	for (uint32_t i = 0; i < mesh->vertexCount; i++)
+	{
+		uint32_t slot = _post_HashVertex(&mesh->vertices[i], 0) & (tableSize - 1);
+		while (table[slot] != POST_HASH_EMPTY)
+		{
+			if (_post_CompareVertexData(&mesh->vertices[i], &mesh->vertices[table[slot]], 0))
+				break;
+
+			slot = (slot + 1) & (tableSize - 1);
+		}
+
+		if (table[slot] == POST_HASH_EMPTY)
+		{
+			table[slot] = i;
+			vertexGroups[i] = (*groupCount)++;
+		}
+		else
+			vertexGroups[i] = vertexGroups[table[slot]];
+	}
+
+	free(table);
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+StardustErrorCode _post_BuildAdjacency(const StardustMesh* mesh, int halfEdges, StardustAdjacency* adjacency)
+{
+	memset(adjacency, 0, sizeof(StardustAdjacency));
+	adjacency->vertexStride = mesh->vertexStride;
+	adjacency->faceCount = mesh->vertexStride > 0 ? mesh->indexCount / mesh->vertexStride : 0;
+	adjacency->halfEdgeCount = mesh->indexCount;
+
+	adjacency->vertexPositions = malloc(((size_t)mesh->vertexCount + 1) * sizeof(uint32_t));
+	if (adjacency->vertexPositions == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
+
+	StardustErrorCode ret = _post_GroupPositions(mesh, adjacency->vertexPositions, &adjacency->positionCount);
+	if (ret != STARDUST_ERROR_SUCCESS)
+	{
+		_post_FreeAdjacency(adjacency);
+		return ret;
+	}
+
+	//Count corners per position and prefix sum into offsets
+	uint32_t positionCount = adjacency->positionCount;
+	uint32_t* cornerStart = malloc(((size_t)positionCount + 1) * sizeof(uint32_t));
+	uint32_t* corners = malloc(((size_t)mesh->indexCount + 1) * sizeof(uint32_t));
+	adjacency->cornerStart = cornerStart;
+	adjacency->corners = corners;
+	if (cornerStart == 0 || corners == 0)
+	{
+		_post_FreeAdjacency(adjacency);
+		return STARDUST_ERROR_MEMORY_ERROR;
+	}
+	memset(cornerStart, 0, ((size_t)positionCount + 1) * sizeof(uint32_t));
+
+	const uint32_t* vertexPositions = adjacency->vertexPositions;
+	for (uint32_t i = 0; i < mesh->indexCount; i++)
+		cornerStart[vertexPositions[mesh->indices[i]] + 1]++;
+
+	for (uint32_t i = 0; i < positionCount; i++)
+		cornerStart[i + 1] += cornerStart[i];
+
+	//Fill corners. cornerStart is used as a write cursor and shifted back afterwards
+	for (uint32_t i = 0; i < mesh->indexCount; i++)
+		corners[cornerStart[vertexPositions[mesh->indices[i]]]++] = i;
+
+	for (uint32_t i = positionCount; i > 0; i--)
+		cornerStart[i] = cornerStart[i - 1];
+	cornerStart[0] = 0;
+
+	if (halfEdges)
+	{
+		ret = _post_PairHalfEdges(mesh, adjacency);
+		if (ret != STARDUST_ERROR_SUCCESS)
+			_post_FreeAdjacency(adjacency);
+	}
+
+	return ret;
+}
+
+StardustErrorCode _post_PairHalfEdges(const StardustMesh* mesh, StardustAdjacency* adjacency)
+{
+	uint32_t tableSize = _post_GetHashTableSize(mesh->indexCount);
+	uint64_t* edges = malloc((size_t)tableSize * sizeof(uint64_t));
+	uint32_t* edgeHalves = malloc((size_t)tableSize * sizeof(uint32_t)); //Half-edge of every directed edge, or STARDUST_ADJACENCY_NONE once it is used twice
+	adjacency->twins = malloc(((size_t)mesh->indexCount + 1) * sizeof(uint32_t));
+	if (edges == 0 || edgeHalves == 0 || adjacency->twins == 0)
+	{
+		free(edges);
+		free(edgeHalves);
+		return STARDUST_ERROR_MEMORY_ERROR;
+	}
+	memset(edges, 0xFF, (size_t)tableSize * sizeof(uint64_t)); //Set every slot to POST_EDGE_EMPTY
+
+	const uint32_t* vertexPositions = adjacency->vertexPositions;
+	uint32_t stride = mesh->vertexStride;
+	for (uint32_t i = 0; i < mesh->indexCount; i++)
+	{
+		uint32_t a = vertexPositions[mesh->indices[i]];
+		uint32_t b = vertexPositions[mesh->indices[i - i % stride + (i % stride + 1) % stride]];
+
+		uint64_t key = ((uint64_t)a << 32) | b;
+		uint32_t slot = _post_FindEdge(edges, tableSize, key);
+		if (edges[slot] == POST_EDGE_EMPTY)
+		{
+			edges[slot] = key;
+			edgeHalves[slot] = i;
+		}
+		else
+			edgeHalves[slot] = STARDUST_ADJACENCY_NONE;
+	}
+
+	//Both directions have to be used once. Edges that collapse onto one position have no twin
+	for (uint32_t i = 0; i < mesh->indexCount; i++)
+	{
+		uint32_t a = vertexPositions[mesh->indices[i]];
+		uint32_t b = vertexPositions[mesh->indices[i - i % stride + (i % stride + 1) % stride]];
+
+		adjacency->twins[i] = STARDUST_ADJACENCY_NONE;
+		if (a == b || edgeHalves[_post_FindEdge(edges, tableSize, ((uint64_t)a << 32) | b)] == STARDUST_ADJACENCY_NONE)
+			continue;
+
+		uint64_t reverse = ((uint64_t)b << 32) | a;
+		uint32_t slot = _post_FindEdge(edges, tableSize, reverse);
+		if (edges[slot] == reverse)
+			adjacency->twins[i] = edgeHalves[slot];
+	}
+
+	free(edges);
+	free(edgeHalves);
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+void _post_FreeAdjacency(StardustAdjacency* adjacency)
+{
+	free(adjacency->twins);
+	free(adjacency->vertexPositions);
+	free(adjacency->cornerStart);
+	free(adjacency->corners);
+
+	memset(adjacency, 0, sizeof(StardustAdjacency));
+}
+
+
+// ================= Tangents ================= //
+
+StardustErrorCode _post_GenerateTangents(StardustMesh* mesh)
+{
+	uint32_t triangleCount = mesh->indexCount / 3;
+
+	TangentContext context;
+	context.mesh = mesh;
+	context.cornerTangents = malloc((size_t)mesh->indexCount * 3 * sizeof(float));
+	context.orientations = malloc((size_t)triangleCount + 1);
+	context.cornerStart = malloc(((size_t)mesh->vertexCount + 1) * sizeof(uint32_t));
+	context.vertexCorners = malloc(((size_t)mesh->indexCount + 1) * sizeof(uint32_t));
+	context.tangents = malloc(((size_t)mesh->vertexCount + 1) * sizeof(Tangent));
+	context.mirrored = malloc(((size_t)mesh->vertexCount + 1) * sizeof(Tangent));
+	context.vertexOrientations = malloc((size_t)mesh->vertexCount + 1);
+
+	StardustErrorCode ret = STARDUST_ERROR_MEMORY_ERROR;
+	if (context.cornerTangents != 0 && context.orientations != 0 && context.cornerStart != 0 && context.vertexCorners != 0 &&
+		context.tangents != 0 && context.mirrored != 0 && context.vertexOrientations != 0)
+		ret = STARDUST_ERROR_SUCCESS;
+
+	if (ret == STARDUST_ERROR_SUCCESS)
+	{
+		//Per corner tangents. Every triangle is independent
+		ret = t_ParallelFor((triangleCount + POST_TANGENT_TASK_SIZE - 1) / POST_TANGENT_TASK_SIZE, _post_TangentTriangleTask, &context, 0);
+	}
+
+	if (ret == STARDUST_ERROR_SUCCESS)
+	{
+		//Corners around each vertex. Filled in corner order so that the sums don't depend on the thread count
+		memset(context.cornerStart, 0, ((size_t)mesh->vertexCount + 1) * sizeof(uint32_t));
+		for (uint32_t i = 0; i < mesh->indexCount; i++)
+			context.cornerStart[mesh->indices[i] + 1]++;
+
+		for (uint32_t i = 0; i < mesh->vertexCount; i++)
+			context.cornerStart[i + 1] += context.cornerStart[i];
+
+		for (uint32_t i = 0; i < mesh->indexCount; i++)
+			context.vertexCorners[context.cornerStart[mesh->indices[i]]++] = i;
+
+		for (uint32_t i = mesh->vertexCount; i > 0; i--)
+			context.cornerStart[i] = context.cornerStart[i - 1];
+		context.cornerStart[0] = 0;
+
+		ret = t_ParallelFor((mesh->vertexCount + POST_TANGENT_TASK_SIZE - 1) / POST_TANGENT_TASK_SIZE, _post_TangentVertexTask, &context, 0);
+	}
+
+	//Vertices used by both mirrored and preserving triangles get a copy for the mirrored ones
+	uint32_t splitCount = 0;
+	if (ret == STARDUST_ERROR_SUCCESS)
+	{
+		for (uint32_t i = 0; i < mesh->vertexCount; i++)
+		{
+			if (context.vertexOrientations[i] == (POST_TANGENT_PRESERVING | POST_TANGENT_MIRRORED))
+				splitCount++;
+		}
+
+		if (splitCount > 0)
+		{
+			Vertex* vertices = realloc(mesh->vertices, ((size_t)mesh->vertexCount + splitCount) * sizeof(Vertex));
+			Tangent* tangents = realloc(context.tangents, ((size_t)mesh->vertexCount + splitCount) * sizeof(Tangent));
+			if (vertices != 0)
+				mesh->vertices = vertices;
+			if (tangents != 0)
+				context.tangents = tangents;
+
+			if (vertices == 0 || tangents == 0)
+				ret = STARDUST_ERROR_MEMORY_ERROR;
+		}
+	}
+
+	if (ret == STARDUST_ERROR_SUCCESS && splitCount > 0)
+	{
+		uint32_t next = mesh->vertexCount;
+		for (uint32_t i = 0; i < mesh->vertexCount; i++)
+		{
+			if (context.vertexOrientations[i] != (POST_TANGENT_PRESERVING | POST_TANGENT_MIRRORED))
+				continue;
+
+			mesh->vertices[next] = mesh->vertices[i];
+			context.tangents[next] = context.mirrored[i];
+
+			for (uint32_t j = context.cornerStart[i]; j < context.cornerStart[i + 1]; j++)
+			{
+				uint32_t corner = context.vertexCorners[j];
+				if (context.orientations[corner / 3] == POST_TANGENT_MIRRORED)
+					mesh->indices[corner] = next;
+			}
+
+			next++;
+		}
+
+		mesh->vertexCount = next;
+	}
+
+	free(context.cornerTangents);
+	free(context.orientations);
+	free(context.cornerStart);
+	free(context.vertexCorners);
+	free(context.mirrored);
+	free(context.vertexOrientations);
+
+	if (ret != STARDUST_ERROR_SUCCESS)
+	{
+		free(context.tangents);
+		return ret;
+	}
+
+	free(mesh->tangents);
+	mesh->tangents = context.tangents;
+	mesh->dataType |= STARDUST_TANGENT_DATA;
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+StardustErrorCode _post_TangentTriangleTask(void* context, uint32_t index)
+{
+	TangentContext* tangentContext = context;
+	const StardustMesh* mesh = tangentContext->mesh;
+
+	uint32_t start = index * POST_TANGENT_TASK_SIZE;
+	uint32_t end = mesh->indexCount / 3;
+	if (end - start > POST_TANGENT_TASK_SIZE)
+		end = start + POST_TANGENT_TASK_SIZE;
+
+	for (uint32_t i = start; i < end; i++)
+	{
+		const uint32_t* indices = &mesh->indices[i * 3];
+		const Vertex* a = &mesh->vertices[indices[0]];
+		const Vertex* b = &mesh->vertices[indices[1]];
+		const Vertex* c = &mesh->vertices[indices[2]];
+
+		//Direction of increasing U. Scaled by the signed UV area, which is divided out by normalising with the sign of the area
+		float edgeA[3] = { b->x - a->x, b->y - a->y, b->z - a->z };
+		float edgeB[3] = { c->x - a->x, c->y - a->y, c->z - a->z };
+		float uvA[2] = { b->texU - a->texU, b->texV - a->texV };
+		float uvB[2] = { c->texU - a->texU, c->texV - a->texV };
+
+		float area = uvA[0] * uvB[1] - uvA[1] * uvB[0];
+		float direction[3];
+		for (int j = 0; j < 3; j++)
+			direction[j] = uvB[1] * edgeA[j] - uvA[1] * edgeB[j];
+
+		float length = sqrtf(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+
+		unsigned char orientation = area > 0.0f ? POST_TANGENT_PRESERVING : POST_TANGENT_MIRRORED;
+		if (area == 0.0f || length == 0.0f || isfinite(length) == 0)
+			orientation = POST_TANGENT_DEGENERATE;
+
+		tangentContext->orientations[i] = orientation;
+
+		float scale = orientation == POST_TANGENT_DEGENERATE ? 0.0f : (area > 0.0f ? 1.0f : -1.0f) / length;
+		for (int j = 0; j < 3; j++)
+			direction[j] *= scale;
+
+		//Project onto each corner's normal plane and weight by the corner angle measured in that plane
+		for (uint32_t j = 0; j < 3; j++)
+		{
+			const Vertex* corner = &mesh->vertices[indices[j]];
+			const Vertex* next = &mesh->vertices[indices[(j + 1) % 3]];
+			const Vertex* prev = &mesh->vertices[indices[(j + 2) % 3]];
+			float* cornerTangent = &tangentContext->cornerTangents[((size_t)i * 3 + j) * 3];
+
+			float normal[3] = { corner->normX, corner->normY, corner->normZ };
+			float normalLength = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			if (orientation == POST_TANGENT_DEGENERATE || normalLength == 0.0f)
+			{
+				cornerTangent[0] = cornerTangent[1] = cornerTangent[2] = 0.0f;
+				continue;
+			}
+
+			for (int k = 0; k < 3; k++)
+				normal[k] /= normalLength;
+
+			float edges[2][3] = {
+				{ next->x - corner->x, next->y - corner->y, next->z - corner->z },
+				{ prev->x - corner->x, prev->y - corner->y, prev->z - corner->z } };
+
+			float projected[3][3];
+			float lengths[3];
+			for (int k = 0; k < 3; k++)
+			{
+				const float* vector = k == 0 ? direction : edges[k - 1];
+				float d = normal[0] * vector[0] + normal[1] * vector[1] + normal[2] * vector[2];
+				for (int l = 0; l < 3; l++)
+					projected[k][l] = vector[l] - normal[l] * d;
+
+				lengths[k] = sqrtf(projected[k][0] * projected[k][0] + projected[k][1] * projected[k][1] + projected[k][2] * projected[k][2]);
+			}
+
+			float angle = 0.0f;
+			if (lengths[1] > 0.0f && lengths[2] > 0.0f)
+			{
+				float cosine = (projected[1][0] * projected[2][0] + projected[1][1] * projected[2][1] + projected[1][2] * projected[2][2]) / (lengths[1] * lengths[2]);
+				if (cosine > 1.0f) cosine = 1.0f;
+				if (cosine < -1.0f) cosine = -1.0f;
+				angle = acosf(cosine);
+			}
+
+			float weight = lengths[0] > 0.0f ? angle / lengths[0] : 0.0f;
+			for (int k = 0; k < 3; k++)
+				cornerTangent[k] = projected[0][k] * weight;
+		}
+	}
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+StardustErrorCode _post_TangentVertexTask(void* context, uint32_t index)
+{
+	TangentContext* tangentContext = context;
+	const StardustMesh* mesh = tangentContext->mesh;
+
+	uint32_t start = index * POST_TANGENT_TASK_SIZE;
+	uint32_t end = mesh->vertexCount;
+	if (end - start > POST_TANGENT_TASK_SIZE)
+		end = start + POST_TANGENT_TASK_SIZE;
+
+	for (uint32_t i = start; i < end; i++)
+	{
+		float preserving[3] = { 0.0f, 0.0f, 0.0f };
+		float mirrored[3] = { 0.0f, 0.0f, 0.0f };
+		unsigned char orientations = 0;
+
+		for (uint32_t j = tangentContext->cornerStart[i]; j < tangentContext->cornerStart[i + 1]; j++)
+		{
+			uint32_t corner = tangentContext->vertexCorners[j];
+			unsigned char orientation = tangentContext->orientations[corner / 3];
+			if (orientation == POST_TANGENT_DEGENERATE)
+				continue;
+
+			float* sum = orientation == POST_TANGENT_PRESERVING ? preserving : mirrored;
+			for (int k = 0; k < 3; k++)
+				sum[k] += tangentContext->cornerTangents[(size_t)corner * 3 + k];
+
+			orientations |= orientation;
+		}
+
+		tangentContext->vertexOrientations[i] = orientations;
+
+		//The vertex keeps the preserving tangent. Its mirrored copy, if it needs one, gets the other
+		if (orientations == POST_TANGENT_MIRRORED)
+			_post_FinishTangent(mirrored, &mesh->vertices[i], -1.0f, &tangentContext->tangents[i]);
+		else
+			_post_FinishTangent(preserving, &mesh->vertices[i], 1.0f, &tangentContext->tangents[i]);
+
+		if (orientations == (POST_TANGENT_PRESERVING | POST_TANGENT_MIRRORED))
+			_post_FinishTangent(mirrored, &mesh->vertices[i], -1.0f, &tangentContext->mirrored[i]);
+	}
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+void _post_FinishTangent(const float* sum, const Vertex* vertex, float handedness, Tangent* tangent)
+{
+	tangent->w = handedness;
+
+	float length = sqrtf(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+	if (length > 0.0f)
+	{
+		tangent->x = sum[0] / length;
+		tangent->y = sum[1] / length;
+		tangent->z = sum[2] / length;
+		return;
+	}
+
+	//Nothing to go on. Cross the normal with the axis it is least aligned with
+	float normal[3] = { vertex->normX, vertex->normY, vertex->normZ };
+	float axis[3] = { 0.0f, 0.0f, 0.0f };
+	if (fabsf(normal[0]) <= fabsf(normal[1]) && fabsf(normal[0]) <= fabsf(normal[2]))
+		axis[0] = 1.0f;
+	else if (fabsf(normal[1]) <= fabsf(normal[2]))
+		axis[1] = 1.0f;
+	else
+		axis[2] = 1.0f;
+
+	float cross[3] = {
+		normal[1] * axis[2] - normal[2] * axis[1],
+		normal[2] * axis[0] - normal[0] * axis[2],
+		normal[0] * axis[1] - normal[1] * axis[0] };
+
+	length = sqrtf(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+	if (length == 0.0f) //No normal either
+	{
+		tangent->x = 1.0f;
+		tangent->y = 0.0f;
+		tangent->z = 0.0f;
+		return;
+	}
+
+	tangent->x = cross[0] / length;
+	tangent->y = cross[1] / length;
+	tangent->z = cross[2] / length;
+}
+
+
+// ================= Vertex Cache ================= //
+
+StardustErrorCode _post_OptimizeVertexCache(StardustMesh* mesh, uint32_t cacheSize)
+{
+	if (cacheSize < POST_VERTEX_CACHE_MIN_SIZE)
+		cacheSize = POST_VERTEX_CACHE_MIN_SIZE;
+
+	uint32_t triangleCount = mesh->indexCount / 3;
+	if (triangleCount == 0)
+		return STARDUST_ERROR_SUCCESS;
+
+	//Triangles around each vertex. The first liveTriangles[v] entries of a vertex are the ones not yet emitted
+	uint32_t* triangleStart = malloc(((size_t)mesh->vertexCount + 1) * sizeof(uint32_t));
+	uint32_t* vertexTriangles = malloc((size_t)triangleCount * 3 * sizeof(uint32_t));
+	uint32_t* liveTriangles = malloc(((size_t)mesh->vertexCount + 1) * sizeof(uint32_t));
+	int32_t* cachePositions = malloc(((size_t)mesh->vertexCount + 1) * sizeof(int32_t));
+	float* vertexScores = malloc(((size_t)mesh->vertexCount + 1) * sizeof(float));
+	unsigned char* emitted = malloc(triangleCount);
+	uint32_t* newIndices = malloc((size_t)triangleCount * 3 * sizeof(uint32_t));
+
+	//Room for the 3 vertices of a triangle on top of a full cache
+	uint32_t* cache = malloc(((size_t)cacheSize + 3) * sizeof(uint32_t));
+	uint32_t* nextCache = malloc(((size_t)cacheSize + 3) * sizeof(uint32_t));
+
+	if (triangleStart == 0 || vertexTriangles == 0 || liveTriangles == 0 || cachePositions == 0 || vertexScores == 0 ||
+		emitted == 0 || newIndices == 0 || cache == 0 || nextCache == 0)
+	{
+		free(triangleStart); free(vertexTriangles); free(liveTriangles); free(cachePositions); free(vertexScores);
+		free(emitted); free(newIndices); free(cache); free(nextCache);
+		return STARDUST_ERROR_MEMORY_ERROR;
+	}
+
+	_post_BuildVertexTriangles(mesh, triangleStart, vertexTriangles, liveTriangles);
+
+	for (uint32_t i = 0; i < mesh->vertexCount; i++)
+	{
+		cachePositions[i] = -1;
+		vertexScores[i] = _post_GetVertexCacheScore(-1, liveTriangles[i], cacheSize);
+	}
+
+	memset(emitted, 0, triangleCount);
+
+	uint32_t cacheCount = 0;
+	uint32_t nextUnemitted = 0; //Every triangle before this has been emitted
+	uint32_t best = 0;
+	int hasBest = 0;
+
+	for (uint32_t i = 0; i < triangleCount; i++)
+	{
+		//Nothing left around the cache. Restart from the first unused triangle
+		if (hasBest == 0)
+		{
+			while (emitted[nextUnemitted] != 0)
+				nextUnemitted++;
+			best = nextUnemitted;
+		}
+
+		const uint32_t* triangle = &mesh->indices[best * 3];
+		newIndices[i * 3] = triangle[0];
+		newIndices[i * 3 + 1] = triangle[1];
+		newIndices[i * 3 + 2] = triangle[2];
+		emitted[best] = 1;
+
+		_post_RemoveLiveTriangle(mesh, best, triangleStart, vertexTriangles, liveTriangles);
+
+		//Move the triangle's vertices to the front of the cache
+		uint32_t nextCount = 0;
+		for (uint32_t j = 0; j < 3; j++)
+		{
+			int duplicate = 0;
+			for (uint32_t k = 0; k < nextCount; k++)
+				duplicate |= nextCache[k] == triangle[j];
+
+			if (duplicate == 0)
+				nextCache[nextCount++] = triangle[j];
+		}
+
+		for (uint32_t j = 0; j < cacheCount; j++)
+		{
+			uint32_t vertex = cache[j];
+			if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+				nextCache[nextCount++] = vertex;
+		}
+
+		uint32_t* swap = cache;
+		cache = nextCache;
+		nextCache = swap;
+		cacheCount = nextCount;
+
+		//Rescore the vertices that moved. Vertices past the end of the cache drop out of it
+		for (uint32_t j = 0; j < cacheCount; j++)
+		{
+			uint32_t vertex = cache[j];
+			cachePositions[vertex] = j < cacheSize ? (int32_t)j : -1;
+			vertexScores[vertex] = _post_GetVertexCacheScore(cachePositions[vertex], liveTriangles[vertex], cacheSize);
+		}
+
+		if (cacheCount > cacheSize)
+			cacheCount = cacheSize;
+
+		//Only triangles around the cache changed score, so the best one is among them
+		hasBest = 0;
+		float bestScore = 0.0f;
+		for (uint32_t j = 0; j < cacheCount; j++)
+		{
+			uint32_t vertex = cache[j];
+			const uint32_t* triangles = &vertexTriangles[triangleStart[vertex]];
+			for (uint32_t k = 0; k < liveTriangles[vertex]; k++)
+			{
+				const uint32_t* corners = &mesh->indices[triangles[k] * 3];
+				float score = vertexScores[corners[0]] + vertexScores[corners[1]] + vertexScores[corners[2]];
+
+				if (hasBest == 0 || score > bestScore)
+				{
+					best = triangles[k];
+					bestScore = score;
+					hasBest = 1;
+				}
+			}
+		}
+	}
+
+	memcpy(mesh->indices, newIndices, (size_t)triangleCount * 3 * sizeof(uint32_t));
+	mesh->acmr = _post_CalculateACMR(mesh->indices, mesh->indexCount, mesh->vertexCount, cacheSize);
+
+	free(triangleStart); free(vertexTriangles); free(liveTriangles); free(cachePositions); free(vertexScores);
+	free(emitted); free(newIndices); free(cache); free(nextCache);
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+void _post_BuildVertexTriangles(const StardustMesh* mesh, uint32_t* triangleStart, uint32_t* vertexTriangles, uint32_t* liveTriangles)
+{
+	uint32_t triangleCount = mesh->indexCount / 3;
+
+	memset(liveTriangles, 0, (size_t)mesh->vertexCount * sizeof(uint32_t));
+	for (uint32_t i = 0; i < triangleCount * 3; i++)
+		liveTriangles[mesh->indices[i]]++;
+
+	triangleStart[0] = 0;
+	for (uint32_t i = 0; i < mesh->vertexCount; i++)
+		triangleStart[i + 1] = triangleStart[i] + liveTriangles[i];
+
+	//liveTriangles is the fill cursor here and ends up back at the count
+	memset(liveTriangles, 0, (size_t)mesh->vertexCount * sizeof(uint32_t));
+	for (uint32_t i = 0; i < triangleCount * 3; i++)
+	{
+		uint32_t vertex = mesh->indices[i];
+		vertexTriangles[triangleStart[vertex] + liveTriangles[vertex]++] = i / 3;
+	}
+}
+
+void _post_RemoveLiveTriangle(const StardustMesh* mesh, uint32_t triangle, const uint32_t* triangleStart, uint32_t* vertexTriangles, uint32_t* liveTriangles)
+{
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		uint32_t vertex = mesh->indices[triangle * 3 + i];
+		uint32_t* triangles = &vertexTriangles[triangleStart[vertex]];
+		for (uint32_t j = 0; j < liveTriangles[vertex]; j++)
+		{
+			if (triangles[j] == triangle)
+			{
+				triangles[j] = triangles[--liveTriangles[vertex]];
+				break;
+			}
+		}
+	}
+}
+
+float _post_GetVertexCacheScore(int32_t cachePosition, uint32_t liveTriangles, uint32_t cacheSize)
+{
+	//Nothing left to draw with this vertex
+	if (liveTriangles == 0)
+		return -1.0f;
+
+	float score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		//The last triangle's vertices score the same, so that the order within a triangle doesn't matter
+		if (cachePosition < 3)
+			score = 0.75f;
+		else
+			score = powf(1.0f - (float)(cachePosition - 3) / (float)(cacheSize - 3), 1.5f);
+	}
+
+	//Favour vertices with few triangles left, so that they are finished and leave the cache
+	return score + 2.0f / sqrtf((float)liveTriangles);
+}
+
+float _post_CalculateACMR(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+{
+	uint32_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+		return 0.0f;
+
+	//A vertex is cached while fewer than cacheSize misses happened since it was loaded
+	uint32_t* loadedAt = malloc(((size_t)vertexCount + 1) * sizeof(uint32_t));
+	if (loadedAt == 0)
+		return 0.0f;
+
+	uint32_t misses = 0;
+	memset(loadedAt, 0, (size_t)vertexCount * sizeof(uint32_t));
+
+	for (uint32_t i = 0; i < triangleCount; i++)
+		_post_SimulateVertexCache(&indices[i * 3], loadedAt, &misses, cacheSize);
+
+	free(loadedAt);
+
+	return (float)misses / (float)triangleCount;
+}
+
+uint32_t _post_SimulateVertexCache(const uint32_t* triangle, uint32_t* loadedAt, uint32_t* misses, uint32_t cacheSize)
+{
+	uint32_t triangleMisses = 0;
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		uint32_t vertex = triangle[i];
+		if (loadedAt[vertex] == 0 || *misses - loadedAt[vertex] >= cacheSize)
+		{
+			(*misses)++;
+			loadedAt[vertex] = *misses; //Offset by one so that 0 means never loaded
+			triangleMisses++;
+		}
+	}
+
+	return triangleMisses;
+}
+
+
+// ================= Overdraw ================= //
+
+StardustErrorCode _post_OptimizeOverdraw(StardustMesh* mesh, uint32_t cacheSize, float threshold)
+{
+	if (cacheSize < POST_VERTEX_CACHE_MIN_SIZE)
+		cacheSize = POST_VERTEX_CACHE_MIN_SIZE;
+
+	uint32_t triangleCount = mesh->indexCount / 3;
+	if (triangleCount == 0)
+		return STARDUST_ERROR_SUCCESS;
+
+	uint32_t* loadedAt = malloc(((size_t)mesh->vertexCount + 1) * sizeof(uint32_t));
+	uint32_t* hardBoundaries = malloc(((size_t)triangleCount + 1) * sizeof(uint32_t));
+	TriangleCluster* clusters = malloc((size_t)triangleCount * sizeof(TriangleCluster));
+	uint32_t* newIndices = malloc((size_t)triangleCount * 3 * sizeof(uint32_t));
+	if (loadedAt == 0 || hardBoundaries == 0 || clusters == 0 || newIndices == 0)
+	{
+		free(loadedAt); free(hardBoundaries); free(clusters); free(newIndices);
+		return STARDUST_ERROR_MEMORY_ERROR;
+	}
+
+	//Hard boundaries. A triangle that misses on all 3 vertices starts a new patch of the mesh
+	uint32_t misses = 0;
+	uint32_t hardCount = 0;
+	memset(loadedAt, 0, (size_t)mesh->vertexCount * sizeof(uint32_t));
+	for (uint32_t i = 0; i < triangleCount; i++)
+	{
+		if (_post_SimulateVertexCache(&mesh->indices[i * 3], loadedAt, &misses, cacheSize) == 3 || i == 0)
+			hardBoundaries[hardCount++] = i;
+	}
+	hardBoundaries[hardCount] = triangleCount;
+
+	//Soft boundaries. Each patch is split wherever the ACMR since the last split, with a cold cache, is within threshold of the patch's ACMR
+	uint32_t clusterCount = 0;
+	for (uint32_t i = 0; i < hardCount; i++)
+	{
+		uint32_t start = hardBoundaries[i];
+		uint32_t end = hardBoundaries[i + 1];
+
+		misses += cacheSize; //Empties the cache
+		uint32_t patchMisses = 0;
+		for (uint32_t j = start; j < end; j++)
+			patchMisses += _post_SimulateVertexCache(&mesh->indices[j * 3], loadedAt, &misses, cacheSize);
+
+		float patchThreshold = threshold * (float)patchMisses / (float)(end - start);
+
+		uint32_t firstCluster = clusterCount;
+		uint32_t clusterStart = start;
+		uint32_t clusterMisses = 0;
+		misses += cacheSize;
+		for (uint32_t j = start; j < end; j++)
+		{
+			clusterMisses += _post_SimulateVertexCache(&mesh->indices[j * 3], loadedAt, &misses, cacheSize);
+			if ((float)clusterMisses / (float)(j + 1 - clusterStart) > patchThreshold)
+				continue;
+
+			clusters[clusterCount].start = clusterStart;
+			clusters[clusterCount].count = j + 1 - clusterStart;
+			clusterCount++;
+
+			clusterStart = j + 1;
+			clusterMisses = 0;
+			misses += cacheSize;
+		}
+
+		//The triangles left after the last split rarely reach the threshold. They go in with the previous cluster of the patch
+		if (clusterStart < end)
+		{
+			if (clusterCount > firstCluster)
+				clusters[clusterCount - 1].count += end - clusterStart;
+			else
+			{
+				clusters[clusterCount].start = clusterStart;
+				clusters[clusterCount].count = end - clusterStart;
+				clusterCount++;
+			}
+		}
+	}
+
+	//Area weighted centre of the mesh
+	float meshCentre[3] = { 0.0f, 0.0f, 0.0f };
+	float meshArea = 0.0f;
+	for (uint32_t i = 0; i < triangleCount; i++)
+	{
+		float centre[3];
+		float normal[3];
+		float area = _post_GetTriangleCentreNormal(mesh, i, centre, normal);
+
+		for (int j = 0; j < 3; j++)
+			meshCentre[j] += centre[j] * area;
+		meshArea += area;
+	}
+
+	for (int j = 0; j < 3; j++)
+		meshCentre[j] = meshArea > 0.0f ? meshCentre[j] / meshArea : 0.0f;
+
+	//Occlusion potential. Clusters far out from the centre and facing away from it are likely to hide the rest of the mesh
+	for (uint32_t i = 0; i < clusterCount; i++)
+	{
+		float clusterCentre[3] = { 0.0f, 0.0f, 0.0f };
+		float clusterNormal[3] = { 0.0f, 0.0f, 0.0f };
+		float clusterArea = 0.0f;
+
+		for (uint32_t j = clusters[i].start; j < clusters[i].start + clusters[i].count; j++)
+		{
+			float centre[3];
+			float normal[3];
+			float area = _post_GetTriangleCentreNormal(mesh, j, centre, normal);
+
+			for (int k = 0; k < 3; k++)
+			{
+				clusterCentre[k] += centre[k] * area;
+				clusterNormal[k] += normal[k] * area;
+			}
+			clusterArea += area;
+		}
+
+		clusters[i].occlusion = 0.0f;
+
+		float normalLength = sqrtf(clusterNormal[0] * clusterNormal[0] + clusterNormal[1] * clusterNormal[1] + clusterNormal[2] * clusterNormal[2]);
+		if (clusterArea > 0.0f && normalLength > 0.0f)
+		{
+			for (int k = 0; k < 3; k++)
+				clusters[i].occlusion += (clusterCentre[k] / clusterArea - meshCentre[k]) * clusterNormal[k] / normalLength;
+		}
+	}
+
+	//Draw the best occluders first. Ties keep their cache order
+	qsort(clusters, clusterCount, sizeof(TriangleCluster), _post_CompareClusters);
+
+	uint32_t written = 0;
+	for (uint32_t i = 0; i < clusterCount; i++)
+	{
+		memcpy(&newIndices[written], &mesh->indices[(size_t)clusters[i].start * 3], (size_t)clusters[i].count * 3 * sizeof(uint32_t));
+		written += clusters[i].count * 3;
+	}
+
+	memcpy(mesh->indices, newIndices, (size_t)triangleCount * 3 * sizeof(uint32_t));
+	mesh->acmr = _post_CalculateACMR(mesh->indices, mesh->indexCount, mesh->vertexCount, cacheSize);
+
+	free(loadedAt); free(hardBoundaries); free(clusters); free(newIndices);
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+float _post_GetTriangleCentreNormal(const StardustMesh* mesh, uint32_t triangle, float* centre, float* normal)
+{
+	const Vertex* a = &mesh->vertices[mesh->indices[triangle * 3]];
+	const Vertex* b = &mesh->vertices[mesh->indices[triangle * 3 + 1]];
+	const Vertex* c = &mesh->vertices[mesh->indices[triangle * 3 + 2]];
+
+	centre[0] = (a->x + b->x + c->x) / 3.0f;
+	centre[1] = (a->y + b->y + c->y) / 3.0f;
+	centre[2] = (a->z + b->z + c->z) / 3.0f;
+
+	float edgeA[3] = { b->x - a->x, b->y - a->y, b->z - a->z };
+	float edgeB[3] = { c->x - a->x, c->y - a->y, c->z - a->z };
+
+	normal[0] = edgeA[1] * edgeB[2] - edgeA[2] * edgeB[1];
+	normal[1] = edgeA[2] * edgeB[0] - edgeA[0] * edgeB[2];
+	normal[2] = edgeA[0] * edgeB[1] - edgeA[1] * edgeB[0];
+
+	float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+	if (length == 0.0f)
+		return 0.0f;
+
+	for (int i = 0; i < 3; i++)
+		normal[i] /= length;
+
+	return length * 0.5f;
+}
+
+int _post_CompareClusters(const void* a, const void* b)
+{
+	const TriangleCluster* clusterA = a;
+	const TriangleCluster* clusterB = b;
+
+	if (clusterA->occlusion != clusterB->occlusion)
+		return clusterA->occlusion > clusterB->occlusion ? -1 : 1;
+
+	return clusterA->start < clusterB->start ? -1 : (clusterA->start > clusterB->start);
+}
+
+
+// ================= Vertex Fetch ================= //
+
+StardustErrorCode _post_OptimizeVertexFetch(StardustMesh* mesh)
+{
+	uint32_t* remap = malloc(((size_t)mesh->vertexCount + 1) * sizeof(uint32_t));
+	if (remap == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
+	memset(remap, 0xFF, (size_t)mesh->vertexCount * sizeof(uint32_t)); //Every vertex starts unassigned
+
+	uint32_t next = 0;
+	for (uint32_t i = 0; i < mesh->indexCount; i++)
+	{
+		if (remap[mesh->indices[i]] == POST_HASH_EMPTY)
+			remap[mesh->indices[i]] = next++;
+	}
+
+	//Unused vertices go last
+	for (uint32_t i = 0; i < mesh->vertexCount; i++)
+	{
+		if (remap[i] == POST_HASH_EMPTY)
+			remap[i] = next++;
+	}
+
+	StardustErrorCode ret = _post_RemapVertices(mesh, remap);
+	free(remap);
+
+	return ret;
+}
+
+StardustErrorCode _post_RemapVertices(StardustMesh* mesh, const uint32_t* remap)
+{
+	Vertex* vertices = malloc(((size_t)mesh->vertexCount + 1) * sizeof(Vertex));
+	Tangent* tangents = 0;
+	if (mesh->tangents != 0)
+		tangents = malloc(((size_t)mesh->vertexCount + 1) * sizeof(Tangent));
+
+	if (vertices == 0 || (mesh->tangents != 0 && tangents == 0))
+	{
+		free(vertices);
+		free(tangents);
+		return STARDUST_ERROR_MEMORY_ERROR;
+	}
+
+	for (uint32_t i = 0; i < mesh->vertexCount; i++)
+		vertices[remap[i]] = mesh->vertices[i];
+
+	if (tangents != 0)
+	{
+		for (uint32_t i = 0; i < mesh->vertexCount; i++)
+			tangents[remap[i]] = mesh->tangents[i];
+	}
+
+	for (uint32_t i = 0; i < mesh->indexCount; i++)
+		mesh->indices[i] = remap[mesh->indices[i]];
+
+	for (uint32_t i = 0; i < mesh->lodCount; i++)
+	{
+		for (uint32_t j = 0; j < mesh->lods[i].indexCount; j++)
+			mesh->lods[i].indices[j] = remap[mesh->lods[i].indices[j]];
+	}
+
+	if (mesh->meshlets != 0)
+	{
+		uint32_t meshletVertexCount = 0;
+		for (uint32_t i = 0; i < mesh->meshletCount; i++)
+		{
+			uint32_t end = mesh->meshlets[i].vertexOffset + mesh->meshlets[i].vertexCount;
+			if (end > meshletVertexCount)
+				meshletVertexCount = end;
+		}
+
+		for (uint32_t i = 0; i < meshletVertexCount; i++)
+			mesh->meshletVertices[i] = remap[mesh->meshletVertices[i]];
+	}
+
+	free(mesh->vertices);
+	mesh->vertices = vertices;
+
+	free(mesh->tangents);
+	mesh->tangents = tangents;
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+
+// ================= Spatial Sorting ================= //
+
+StardustErrorCode _post_SortTrianglesSpatial(StardustMesh* mesh)
+{
+	uint32_t triangleCount = mesh->indexCount / 3;
+	if (triangleCount < 2)
+		return STARDUST_ERROR_SUCCESS;
+
+	MortonContext context;
+	_post_InitMortonContext(mesh, &context);
+
+	context.codes = malloc((size_t)triangleCount * sizeof(uint32_t));
+	context.order = malloc((size_t)triangleCount * sizeof(uint32_t));
+	uint32_t* indices = malloc((size_t)mesh->indexCount * sizeof(uint32_t));
+	if (context.codes == 0 || context.order == 0 || indices == 0)
+	{
+		free(context.codes);
+		free(context.order);
+		free(indices);
+		return STARDUST_ERROR_MEMORY_ERROR;
+	}
+
+	uint32_t taskCount = (triangleCount + POST_MORTON_TASK_SIZE - 1) / POST_MORTON_TASK_SIZE;
+	StardustErrorCode ret = t_ParallelFor(taskCount, _post_TriangleMortonTask, &context, 0);
+	if (ret == STARDUST_ERROR_SUCCESS)
+		ret = rs_RadixSort(context.codes, context.order, triangleCount, POST_MORTON_AXIS_BITS * 3);
+
+	if (ret == STARDUST_ERROR_SUCCESS)
+	{
+		for (uint32_t i = 0; i < triangleCount; i++)
+		{
+			const uint32_t* triangle = &mesh->indices[context.order[i] * 3];
+			indices[i * 3] = triangle[0];
+			indices[i * 3 + 1] = triangle[1];
+			indices[i * 3 + 2] = triangle[2];
+		}
+
+		memcpy(mesh->indices, indices, (size_t)triangleCount * 3 * sizeof(uint32_t));
+	}
+
+	free(context.codes);
+	free(context.order);
+	free(indices);
+
+	return ret;
+}
+
+StardustErrorCode _post_SortVerticesSpatial(StardustMesh* mesh)
+{
+	if (mesh->vertexCount < 2)
+		return STARDUST_ERROR_SUCCESS;
+
+	MortonContext context;
+	_post_InitMortonContext(mesh, &context);
+
+	context.codes = malloc((size_t)mesh->vertexCount * sizeof(uint32_t));
+	context.order = malloc((size_t)mesh->vertexCount * sizeof(uint32_t));
+	if (context.codes == 0 || context.order == 0)
+	{
+		free(context.codes);
+		free(context.order);
+		return STARDUST_ERROR_MEMORY_ERROR;
+	}
+
+	uint32_t taskCount = (mesh->vertexCount + POST_MORTON_TASK_SIZE - 1) / POST_MORTON_TASK_SIZE;
+	StardustErrorCode ret = t_ParallelFor(taskCount, _post_VertexMortonTask, &context, 0);
+	if (ret == STARDUST_ERROR_SUCCESS)
+		ret = rs_RadixSort(context.codes, context.order, mesh->vertexCount, POST_MORTON_AXIS_BITS * 3);
+
+	//The codes aren't needed any more, so their array becomes the remap table
+	if (ret == STARDUST_ERROR_SUCCESS)
+	{
+		uint32_t* remap = context.codes;
+		for (uint32_t i = 0; i < mesh->vertexCount; i++)
+			remap[context.order[i]] = i;
+
+		ret = _post_RemapVertices(mesh, remap);
+	}
+
+	free(context.codes);
+	free(context.order);
+
+	return ret;
+}
+
+void _post_InitMortonContext(const StardustMesh* mesh, MortonContext* context)
+{
+	float maximum[3];
+	uint32_t minimumVertex[3], maximumVertex[3];
+	bd_FindExtremesScalar(mesh->vertices, mesh->vertexCount, context->minimum, maximum, minimumVertex, maximumVertex);
+
+	const float cells = (float)((1u << POST_MORTON_AXIS_BITS) - 1);
+	for (int i = 0; i < 3; i++)
+	{
+		float extent = maximum[i] - context->minimum[i];
+		context->scale[i] = extent > 0.0f ? cells / extent : 0.0f;
+	}
+
+	context->mesh = mesh;
+	context->codes = 0;
+	context->order = 0;
+}
+
+StardustErrorCode _post_TriangleMortonTask(void* context, uint32_t index)
+{
+	MortonContext* mortonContext = context;
+	const StardustMesh* mesh = mortonContext->mesh;
+
+	uint32_t start = index * POST_MORTON_TASK_SIZE;
+	uint32_t end = mesh->indexCount / 3;
+	if (end - start > POST_MORTON_TASK_SIZE)
+		end = start + POST_MORTON_TASK_SIZE;
+
+	for (uint32_t i = start; i < end; i++)
+	{
+		const uint32_t* indices = &mesh->indices[i * 3];
+		const Vertex* a = &mesh->vertices[indices[0]];
+		const Vertex* b = &mesh->vertices[indices[1]];
+		const Vertex* c = &mesh->vertices[indices[2]];
+
+		const float third = 1.0f / 3.0f;
+		mortonContext->codes[i] = _post_GetMortonCode(mortonContext, (a->x + b->x + c->x) * third, (a->y + b->y + c->y) * third, (a->z + b->z + c->z) * third);
+		mortonContext->order[i] = i;
+	}
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+StardustErrorCode _post_VertexMortonTask(void* context, uint32_t index)
+{
+	MortonContext* mortonContext = context;
+	const StardustMesh* mesh = mortonContext->mesh;
+
+	uint32_t start = index * POST_MORTON_TASK_SIZE;
+	uint32_t end = mesh->vertexCount;
+	if (end - start > POST_MORTON_TASK_SIZE)
+		end = start + POST_MORTON_TASK_SIZE;
+
+	for (uint32_t i = start; i < end; i++)
+	{
+		const Vertex* v = &mesh->vertices[i];
+		mortonContext->codes[i] = _post_GetMortonCode(mortonContext, v->x, v->y, v->z);
+		mortonContext->order[i] = i;
+	}
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+uint32_t _post_GetMortonCode(const MortonContext* context, float x, float y, float z)
+{
+	const float position[3] = { x, y, z };
+	const float cells = (float)((1u << POST_MORTON_AXIS_BITS) - 1);
+
+	uint32_t code = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		float cell = (position[i] - context->minimum[i]) * context->scale[i];
+
+		//Written so that NaN lands in cell 0
+		if (!(cell > 0.0f))
+			cell = 0.0f;
+		else if (cell > cells)
+			cell = cells;
+
+		code |= _post_SpreadBits((uint32_t)cell) << i;
+	}
+
+	return code;
+}
+
+uint32_t _post_SpreadBits(uint32_t value)
+{
+	value &= 0x3FF;
+	value = (value | (value << 16)) & 0x030000FF;
+	value = (value | (value << 8)) & 0x0300F00F;
+	value = (value | (value << 4)) & 0x030C30C3;
+	value = (value | (value << 2)) & 0x09249249;
+	return value;
+}
+
+
+// ================= Meshlets ================= //
+
+StardustErrorCode _post_BuildMeshlets(StardustMesh* mesh, uint32_t maxVertices, uint32_t maxTriangles)
+{
+	if (maxVertices < 3) maxVertices = 3;
+	if (maxVertices > POST_MESHLET_MAX_VERTICES) maxVertices = POST_MESHLET_MAX_VERTICES;
+	if (maxTriangles < 1) maxTriangles = 1;
+	if (maxTriangles > POST_MESHLET_MAX_TRIANGLES) maxTriangles = POST_MESHLET_MAX_TRIANGLES;
+
+	_post_FreeMeshlets(mesh);
+
+	uint32_t triangleCount = mesh->indexCount / 3;
+
+	uint32_t* triangleStart = malloc(((size_t)mesh->vertexCount + 1) * sizeof(uint32_t));
+	uint32_t* vertexTriangles = malloc(((size_t)triangleCount * 3 + 1) * sizeof(uint32_t));
+	uint32_t* liveTriangles = malloc(((size_t)mesh->vertexCount + 1) * sizeof(uint32_t));
+	uint32_t* localIndices = malloc(((size_t)mesh->vertexCount + 1) * sizeof(uint32_t)); //Index of each vertex in the current meshlet
+	unsigned char* emitted = malloc((size_t)triangleCount + 1);
+	float* centres = malloc(((size_t)triangleCount * 3 + 1) * sizeof(float));
+
+	//Every triangle could end up in its own meshlet. Shrunk to fit at the end
+	StardustMeshlet* meshlets = malloc(((size_t)triangleCount + 1) * sizeof(StardustMeshlet));
+	uint32_t* meshletVertices = malloc(((size_t)triangleCount * 3 + 1) * sizeof(uint32_t));
+	uint8_t* meshletTriangles = malloc((size_t)triangleCount * 3 + 1);
+
+	if (triangleStart == 0 || vertexTriangles == 0 || liveTriangles == 0 || localIndices == 0 || emitted == 0 || centres == 0 ||
+		meshlets == 0 || meshletVertices == 0 || meshletTriangles == 0)
+	{
+		free(triangleStart); free(vertexTriangles); free(liveTriangles); free(localIndices); free(emitted); free(centres);
+		free(meshlets); free(meshletVertices); free(meshletTriangles);
+		return STARDUST_ERROR_MEMORY_ERROR;
+	}
+
+	_post_BuildVertexTriangles(mesh, triangleStart, vertexTriangles, liveTriangles);
+	memset(localIndices, 0xFF, (size_t)mesh->vertexCount * sizeof(uint32_t)); //POST_HASH_EMPTY marks vertices outside the meshlet
+	memset(emitted, 0, triangleCount);
+
+	for (uint32_t i = 0; i < triangleCount; i++)
+	{
+		const Vertex* a = &mesh->vertices[mesh->indices[(size_t)i * 3]];
+		const Vertex* b = &mesh->vertices[mesh->indices[(size_t)i * 3 + 1]];
+		const Vertex* c = &mesh->vertices[mesh->indices[(size_t)i * 3 + 2]];
+
+		centres[(size_t)i * 3] = (a->x + b->x + c->x) / 3.0f;
+		centres[(size_t)i * 3 + 1] = (a->y + b->y + c->y) / 3.0f;
+		centres[(size_t)i * 3 + 2] = (a->z + b->z + c->z) / 3.0f;
+	}
+
+	uint32_t meshletCount = 0;
+	uint32_t vertexTotal = 0;
+	uint32_t triangleTotal = 0;
+	uint32_t nextUnemitted = 0;
+
+	StardustMeshlet* meshlet = &meshlets[0];
+	memset(meshlet, 0, sizeof(StardustMeshlet));
+	float centre[3] = { 0.0f, 0.0f, 0.0f }; //Sum of the triangle centres of the meshlet
+
+	for (uint32_t emittedCount = 0; emittedCount < triangleCount;)
+	{
+		//Search around the meshlet, or around the previous meshlet to seed a new one
+		const StardustMeshlet* around = meshlet->triangleCount > 0 ? meshlet : (meshletCount > 0 ? &meshlets[meshletCount - 1] : 0);
+		float target[3] = { 0.0f, 0.0f, 0.0f };
+		if (meshlet->triangleCount > 0)
+		{
+			for (int i = 0; i < 3; i++)
+				target[i] = centre[i] / (float)meshlet->triangleCount;
+		}
+		else if (around != 0)
+		{
+			target[0] = around->centerX;
+			target[1] = around->centerY;
+			target[2] = around->centerZ;
+		}
+
+		uint32_t best = POST_HASH_EMPTY;
+		uint32_t bestNew = 4;
+		float bestDistance = 0.0f;
+		for (uint32_t i = 0; around != 0 && i < around->vertexCount; i++)
+		{
+			uint32_t vertex = meshletVertices[around->vertexOffset + i];
+			const uint32_t* triangles = &vertexTriangles[triangleStart[vertex]];
+
+			for (uint32_t j = 0; j < liveTriangles[vertex]; j++)
+			{
+				const uint32_t* corners = &mesh->indices[(size_t)triangles[j] * 3];
+				uint32_t newVertices = (localIndices[corners[0]] == POST_HASH_EMPTY) + (localIndices[corners[1]] == POST_HASH_EMPTY && corners[1] != corners[0]) +
+					(localIndices[corners[2]] == POST_HASH_EMPTY && corners[2] != corners[0] && corners[2] != corners[1]);
+
+				float distance = 0.0f;
+				for (int k = 0; k < 3; k++)
+				{
+					float delta = centres[(size_t)triangles[j] * 3 + k] - target[k];
+					distance += delta * delta;
+				}
+
+				if (newVertices < bestNew || (newVertices == bestNew && (distance < bestDistance || (distance == bestDistance && triangles[j] < best))))
+				{
+					best = triangles[j];
+					bestNew = newVertices;
+					bestDistance = distance;
+				}
+			}
+		}
+
+		if (best == POST_HASH_EMPTY)
+		{
+			//Nothing connected is left. Continue from the first unused triangle
+			while (emitted[nextUnemitted] != 0)
+				nextUnemitted++;
+
+			best = nextUnemitted;
+			const uint32_t* corners = &mesh->indices[(size_t)best * 3];
+			bestNew = (localIndices[corners[0]] == POST_HASH_EMPTY) + (localIndices[corners[1]] == POST_HASH_EMPTY && corners[1] != corners[0]) +
+				(localIndices[corners[2]] == POST_HASH_EMPTY && corners[2] != corners[0] && corners[2] != corners[1]);
+		}
+
+		//Full. Close the meshlet and seed the next one with a fresh search
+		if (meshlet->vertexCount + bestNew > maxVertices || meshlet->triangleCount + 1 > maxTriangles)
+		{
+			_post_CalculateMeshletBounds(mesh, meshlet, meshletVertices, meshletTriangles);
+			for (uint32_t i = 0; i < meshlet->vertexCount; i++)
+				localIndices[meshletVertices[meshlet->vertexOffset + i]] = POST_HASH_EMPTY;
+
+			meshletCount++;
+			meshlet = &meshlets[meshletCount];
+			memset(meshlet, 0, sizeof(StardustMeshlet));
+			meshlet->vertexOffset = vertexTotal;
+			meshlet->triangleOffset = triangleTotal;
+			centre[0] = centre[1] = centre[2] = 0.0f;
+			continue;
+		}
+
+		//Add the triangle
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			uint32_t vertex = mesh->indices[(size_t)best * 3 + i];
+			if (localIndices[vertex] == POST_HASH_EMPTY)
+			{
+				localIndices[vertex] = meshlet->vertexCount++;
+				meshletVertices[vertexTotal++] = vertex;
+			}
+
+			meshletTriangles[triangleTotal++] = (uint8_t)localIndices[vertex];
+		}
+
+		for (int i = 0; i < 3; i++)
+			centre[i] += centres[(size_t)best * 3 + i];
+
+		meshlet->triangleCount++;
+		emitted[best] = 1;
+		emittedCount++;
+		_post_RemoveLiveTriangle(mesh, best, triangleStart, vertexTriangles, liveTriangles);
+	}
+
+	if (meshlet->triangleCount > 0)
+	{
+		_post_CalculateMeshletBounds(mesh, meshlet, meshletVertices, meshletTriangles);
+		meshletCount++;
+	}
+
+	free(triangleStart); free(vertexTriangles); free(liveTriangles); free(localIndices); free(emitted); free(centres);
+
+	//Give back the unused space. Failing to shrink keeps the larger arrays
+	StardustMeshlet* shrunkMeshlets = realloc(meshlets, ((size_t)meshletCount + 1) * sizeof(StardustMeshlet));
+	uint32_t* shrunkVertices = realloc(meshletVertices, ((size_t)vertexTotal + 1) * sizeof(uint32_t));
+	uint8_t* shrunkTriangles = realloc(meshletTriangles, (size_t)triangleTotal + 1);
+
+	mesh->meshlets = shrunkMeshlets != 0 ? shrunkMeshlets : meshlets;
+	mesh->meshletVertices = shrunkVertices != 0 ? shrunkVertices : meshletVertices;
+	mesh->meshletTriangles = shrunkTriangles != 0 ? shrunkTriangles : meshletTriangles;
+	mesh->meshletCount = meshletCount;
+	mesh->dataType |= STARDUST_MESHLET_DATA;
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+void _post_CalculateMeshletBounds(const StardustMesh* mesh, StardustMeshlet* meshlet, const uint32_t* meshletVertices, const uint8_t* meshletTriangles)
+{
+	const uint32_t* vertices = &meshletVertices[meshlet->vertexOffset];
+	const uint8_t* triangles = &meshletTriangles[meshlet->triangleOffset];
+
+	//Sphere around the centre of the bounding box
+	float minimum[3] = { mesh->vertices[vertices[0]].x, mesh->vertices[vertices[0]].y, mesh->vertices[vertices[0]].z };
+	float maximum[3] = { minimum[0], minimum[1], minimum[2] };
+	for (uint32_t i = 1; i < meshlet->vertexCount; i++)
+	{
+		const Vertex* vertex = &mesh->vertices[vertices[i]];
+		float position[3] = { vertex->x, vertex->y, vertex->z };
+		for (int j = 0; j < 3; j++)
+		{
+			if (position[j] < minimum[j]) minimum[j] = position[j];
+			if (position[j] > maximum[j]) maximum[j] = position[j];
+		}
+	}
+
+	float centre[3];
+	for (int i = 0; i < 3; i++)
+		centre[i] = (minimum[i] + maximum[i]) * 0.5f;
+
+	float radius2 = 0.0f;
+	for (uint32_t i = 0; i < meshlet->vertexCount; i++)
+	{
+		const Vertex* vertex = &mesh->vertices[vertices[i]];
+		float dx = vertex->x - centre[0];
+		float dy = vertex->y - centre[1];
+		float dz = vertex->z - centre[2];
+
+		float distance2 = dx * dx + dy * dy + dz * dz;
+		if (distance2 > radius2)
+			radius2 = distance2;
+	}
+
+	meshlet->centerX = centre[0];
+	meshlet->centerY = centre[1];
+	meshlet->centerZ = centre[2];
+	meshlet->radius = sqrtf(radius2);
+
+	//Cone around the average normal. Starts out unable to cull
+	meshlet->coneApexX = centre[0];
+	meshlet->coneApexY = centre[1];
+	meshlet->coneApexZ = centre[2];
+	meshlet->coneAxisX = 0.0f;
+	meshlet->coneAxisY = 0.0f;
+	meshlet->coneAxisZ = 0.0f;
+	meshlet->coneCutoff = 1.0f;
+
+	float axis[3] = { 0.0f, 0.0f, 0.0f };
+	for (uint32_t i = 0; i < meshlet->triangleCount; i++)
+	{
+		float normal[3];
+		if (_post_GetMeshletTriangleNormal(mesh, vertices, &triangles[i * 3], normal) != 0)
+		{
+			for (int j = 0; j < 3; j++)
+				axis[j] += normal[j];
+		}
+	}
+
+	float axisLength = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	if (axisLength == 0.0f)
+		return;
+
+	for (int i = 0; i < 3; i++)
+		axis[i] /= axisLength;
+
+	//Widest normal. Past about 84 degrees the cone would hardly ever cull and the apex moves far away
+	float minimumDot = 1.0f;
+	for (uint32_t i = 0; i < meshlet->triangleCount; i++)
+	{
+		float normal[3];
+		if (_post_GetMeshletTriangleNormal(mesh, vertices, &triangles[i * 3], normal) == 0)
+			continue;
+
+		float d = axis[0] * normal[0] + axis[1] * normal[1] + axis[2] * normal[2];
+		if (d < minimumDot)
+			minimumDot = d;
+	}
+
+	if (minimumDot <= 0.1f)
+		return;
+
+	//The apex is pushed back along the axis until it is behind the plane of every triangle
+	float maximumT = 0.0f;
+	for (uint32_t i = 0; i < meshlet->triangleCount; i++)
+	{
+		float normal[3];
+		if (_post_GetMeshletTriangleNormal(mesh, vertices, &triangles[i * 3], normal) == 0)
+			continue;
+
+		const Vertex* corner = &mesh->vertices[vertices[triangles[i * 3]]];
+		float dc = (centre[0] - corner->x) * normal[0] + (centre[1] - corner->y) * normal[1] + (centre[2] - corner->z) * normal[2];
+		float dn = axis[0] * normal[0] + axis[1] * normal[1] + axis[2] * normal[2];
+
+		float t = dc / dn;
+		if (t > maximumT)
+			maximumT = t;
+	}
+
+	meshlet->coneApexX = centre[0] - axis[0] * maximumT;
+	meshlet->coneApexY = centre[1] - axis[1] * maximumT;
+	meshlet->coneApexZ = centre[2] - axis[2] * maximumT;
+	meshlet->coneAxisX = axis[0];
+	meshlet->coneAxisY = axis[1];
+	meshlet->coneAxisZ = axis[2];
+
+	//The cone of view directions that see only back faces is the normal cone widened by 90 degrees and flipped. cos(a + 90) = -sin(a)
+	meshlet->coneCutoff = sqrtf(1.0f - minimumDot * minimumDot);
+}
+
+int _post_GetMeshletTriangleNormal(const StardustMesh* mesh, const uint32_t* vertices, const uint8_t* triangle, float* normal)
+{
+	const Vertex* a = &mesh->vertices[vertices[triangle[0]]];
+	const Vertex* b = &mesh->vertices[vertices[triangle[1]]];
+	const Vertex* c = &mesh->vertices[vertices[triangle[2]]];
+
+	float edgeA[3] = { b->x - a->x, b->y - a->y, b->z - a->z };
+	float edgeB[3] = { c->x - a->x, c->y - a->y, c->z - a->z };
+
+	normal[0] = edgeA[1] * edgeB[2] - edgeA[2] * edgeB[1];
+	normal[1] = edgeA[2] * edgeB[0] - edgeA[0] * edgeB[2];
+	normal[2] = edgeA[0] * edgeB[1] - edgeA[1] * edgeB[0];
+
+	float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+	if (length == 0.0f)
+		return 0;
+
+	for (int i = 0; i < 3; i++)
+		normal[i] /= length;
+
+	return 1;
+}
+
+void _post_FreeMeshlets(StardustMesh* mesh)
+{
+	free(mesh->meshlets);
+	free(mesh->meshletVertices);
+	free(mesh->meshletTriangles);
+
+	mesh->meshlets = 0;
+	mesh->meshletVertices = 0;
+	mesh->meshletTriangles = 0;
+	mesh->meshletCount = 0;
+	mesh->dataType &= ~STARDUST_MESHLET_DATA;
+}
+
+
+// ================= Simplification ================= //
+
+StardustErrorCode _post_SimplifyIndices(const StardustMesh* mesh, const uint32_t* indices, uint32_t indexCount, uint32_t targetIndexCount, float targetError, uint32_t* destination, uint32_t* resultCount, float* resultError)
+{
+	*resultCount = indexCount - indexCount % 3;
+	*resultError = 0.0f;
+	if (*resultCount == 0)
+		return STARDUST_ERROR_SUCCESS;
+
+	memcpy(destination, indices, (size_t)*resultCount * sizeof(uint32_t));
+	if (*resultCount <= targetIndexCount)
+		return STARDUST_ERROR_SUCCESS;
+
+	SimplifyState state;
+	StardustErrorCode ret = _post_InitSimplify(&state, mesh, destination, *resultCount);
+	if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+
+	//Errors are squared distances in the unit cube the mesh was scaled into
+	float maximumCost = targetError * targetError;
+	float reachedCost = 0.0f;
+
+	while (state.liveTriangles * 3 > targetIndexCount && state.heapCount > 0)
+	{
+		EdgeCollapse collapse = _post_PopCollapse(&state);
+
+		//One of the ends changed since this was queued. The change queued a fresh cost
+		if (state.versions[collapse.from] != collapse.fromVersion || state.versions[collapse.to] != collapse.toVersion)
+			continue;
+
+		//The heap is ordered by cost so nothing cheaper is left
+		if (collapse.cost > maximumCost)
+			break;
+
+		if (_post_CanCollapse(&state, collapse.from, collapse.to) == 0)
+			continue;
+
+		ret = _post_Collapse(&state, collapse.from, collapse.to);
+		if (ret != STARDUST_ERROR_SUCCESS)
+			break;
+
+		if (collapse.cost > reachedCost)
+			reachedCost = collapse.cost;
+	}
+
+	//Move the remaining triangles to the front
+	uint32_t written = 0;
+	for (uint32_t i = 0; i < state.indexCount / 3 && ret == STARDUST_ERROR_SUCCESS; i++)
+	{
+		if (state.removed[i] != 0)
+			continue;
+
+		destination[written++] = destination[i * 3];
+		destination[written++] = destination[i * 3 + 1];
+		destination[written++] = destination[i * 3 + 2];
+	}
+
+	_post_FreeSimplify(&state);
+
+	if (ret != STARDUST_ERROR_SUCCESS)
+		return ret;
+
+	*resultCount = written;
+	*resultError = sqrtf(reachedCost);
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+StardustErrorCode _post_InitSimplify(SimplifyState* state, const StardustMesh* mesh, uint32_t* indices, uint32_t indexCount)
+{
+	memset(state, 0, sizeof(SimplifyState));
+	state->vertices = mesh->vertices;
+	state->indices = indices;
+	state->indexCount = indexCount;
+	state->liveTriangles = indexCount / 3;
+
+	uint32_t triangleCount = indexCount / 3;
+	uint32_t tableSize = _post_GetHashTableSize(indexCount);
+
+	state->vertexGroups = malloc(((size_t)mesh->vertexCount + 1) * sizeof(uint32_t));
+	state->removed = malloc((size_t)triangleCount + 1);
+	state->cornerNext = malloc(((size_t)indexCount + 1) * sizeof(uint32_t));
+	state->heapCapacity = indexCount * 2;
+	state->heap = malloc(((size_t)state->heapCapacity + 1) * sizeof(EdgeCollapse));
+
+	uint64_t* positionEdges = malloc((size_t)tableSize * sizeof(uint64_t));
+	uint64_t* vertexEdges = malloc((size_t)tableSize * sizeof(uint64_t));
+	uint32_t* edgeCounts = 0;
+
+	StardustErrorCode ret = STARDUST_ERROR_MEMORY_ERROR;
+	if (state->vertexGroups != 0 && state->removed != 0 && state->cornerNext != 0 && state->heap != 0 && positionEdges != 0 && vertexEdges != 0)
+		ret = _post_GroupPositions(mesh, state->vertexGroups, &state->groupCount);
+
+	uint32_t groupCount = state->groupCount;
+	if (ret == STARDUST_ERROR_SUCCESS)
+	{
+		state->wedgeStart = malloc(((size_t)groupCount + 1) * sizeof(uint32_t));
+		state->wedges = malloc(((size_t)mesh->vertexCount + 1) * sizeof(uint32_t));
+		state->positions = malloc(((size_t)groupCount * 3 + 1) * sizeof(float));
+		state->kinds = malloc((size_t)groupCount + 1);
+		state->quadrics = malloc(((size_t)groupCount + 1) * sizeof(Quadric));
+		state->versions = malloc(((size_t)groupCount + 1) * sizeof(uint32_t));
+		state->cornerHead = malloc(((size_t)groupCount + 1) * sizeof(uint32_t));
+		state->cornerTail = malloc(((size_t)groupCount + 1) * sizeof(uint32_t));
+		state->marks = malloc(((size_t)groupCount + 1) * sizeof(uint32_t));
+		edgeCounts = malloc(((size_t)groupCount * 3 + 1) * sizeof(uint32_t));
+
+		if (state->wedgeStart == 0 || state->wedges == 0 || state->positions == 0 || state->kinds == 0 || state->quadrics == 0 ||
+			state->versions == 0 || state->cornerHead == 0 || state->cornerTail == 0 || state->marks == 0 || edgeCounts == 0)
+			ret = STARDUST_ERROR_MEMORY_ERROR;
+	}
+
+	if (ret != STARDUST_ERROR_SUCCESS)
+	{
+		free(positionEdges);
+		free(vertexEdges);
+		free(edgeCounts);
+		_post_FreeSimplify(state);
+		return ret;
+	}
+
+	memset(state->removed, 0, triangleCount);
+	memset(state->versions, 0, (size_t)groupCount * sizeof(uint32_t));
+	memset(state->marks, 0, (size_t)groupCount * sizeof(uint32_t));
+	memset(state->quadrics, 0, (size_t)groupCount * sizeof(Quadric));
+
+	//Vertices sharing each position
+	memset(state->wedgeStart, 0, ((size_t)groupCount + 1) * sizeof(uint32_t));
+	for (uint32_t i = 0; i < mesh->vertexCount; i++)
+		state->wedgeStart[state->vertexGroups[i] + 1]++;
+
+	for (uint32_t i = 0; i < groupCount; i++)
+		state->wedgeStart[i + 1] += state->wedgeStart[i];
+
+	for (uint32_t i = 0; i < mesh->vertexCount; i++)
+		state->wedges[state->wedgeStart[state->vertexGroups[i]]++] = i;
+
+	for (uint32_t i = groupCount; i > 0; i--)
+		state->wedgeStart[i] = state->wedgeStart[i - 1];
+	state->wedgeStart[0] = 0;
+
+	//Scale positions into the unit cube so that errors don't depend on the size of the mesh
+	float minimum[3] = { 0.0f, 0.0f, 0.0f };
+	float extent = 0.0f;
+	if (mesh->vertexCount > 0)
+	{
+		float maximum[3] = { mesh->vertices[0].x, mesh->vertices[0].y, mesh->vertices[0].z };
+		minimum[0] = maximum[0]; minimum[1] = maximum[1]; minimum[2] = maximum[2];
+
+		for (uint32_t i = 1; i < mesh->vertexCount; i++)
+		{
+			float position[3] = { mesh->vertices[i].x, mesh->vertices[i].y, mesh->vertices[i].z };
+			for (int j = 0; j < 3; j++)
+			{
+				if (position[j] < minimum[j]) minimum[j] = position[j];
+				if (position[j] > maximum[j]) maximum[j] = position[j];
+			}
+		}
+
+		for (int j = 0; j < 3; j++)
+		{
+			if (maximum[j] - minimum[j] > extent)
+				extent = maximum[j] - minimum[j];
+		}
+	}
+
+	float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+	for (uint32_t i = 0; i < groupCount; i++)
+	{
+		const Vertex* vertex = &mesh->vertices[state->wedges[state->wedgeStart[i]]];
+		state->positions[i * 3] = (vertex->x - minimum[0]) * scale;
+		state->positions[i * 3 + 1] = (vertex->y - minimum[1]) * scale;
+		state->positions[i * 3 + 2] = (vertex->z - minimum[2]) * scale;
+	}
+
+	//Corner lists
+	memset(state->cornerHead, 0xFF, (size_t)groupCount * sizeof(uint32_t)); //POST_HASH_EMPTY
+	for (uint32_t i = 0; i < indexCount; i++)
+	{
+		uint32_t group = state->vertexGroups[indices[i]];
+		state->cornerNext[i] = POST_HASH_EMPTY;
+
+		if (state->cornerHead[group] == POST_HASH_EMPTY)
+			state->cornerHead[group] = i;
+		else
+			state->cornerNext[state->cornerTail[group]] = i;
+		state->cornerTail[group] = i;
+	}
+
+	//Directed edges by position and by vertex. An edge without its reverse is open
+	memset(positionEdges, 0xFF, (size_t)tableSize * sizeof(uint64_t));
+	memset(vertexEdges, 0xFF, (size_t)tableSize * sizeof(uint64_t));
+	for (uint32_t i = 0; i < indexCount; i++)
+	{
+		uint32_t a = indices[i];
+		uint32_t b = indices[i - i % 3 + (i + 1) % 3];
+		if (state->vertexGroups[a] == state->vertexGroups[b])
+			continue;
+
+		uint64_t positionKey = ((uint64_t)state->vertexGroups[a] << 32) | state->vertexGroups[b];
+		uint64_t vertexKey = ((uint64_t)a << 32) | b;
+		positionEdges[_post_FindEdge(positionEdges, tableSize, positionKey)] = positionKey;
+		vertexEdges[_post_FindEdge(vertexEdges, tableSize, vertexKey)] = vertexKey;
+	}
+
+	//Open edges around every position. Open vertex edges that are closed by position are attribute seams
+	uint32_t* borderOut = edgeCounts;
+	uint32_t* borderIn = edgeCounts + groupCount;
+	uint32_t* seamEdges = edgeCounts + (size_t)groupCount * 2;
+	memset(edgeCounts, 0, (size_t)groupCount * 3 * sizeof(uint32_t));
+
+	for (uint32_t i = 0; i < indexCount; i++)
+	{
+		uint32_t a = indices[i];
+		uint32_t b = indices[i - i % 3 + (i + 1) % 3];
+		uint32_t groupA = state->vertexGroups[a];
+		uint32_t groupB = state->vertexGroups[b];
+		if (groupA == groupB)
+			continue;
+
+		uint64_t positionReverse = ((uint64_t)groupB << 32) | groupA;
+		uint64_t vertexReverse = ((uint64_t)b << 32) | a;
+
+		int border = positionEdges[_post_FindEdge(positionEdges, tableSize, positionReverse)] != positionReverse;
+		int seam = border == 0 && vertexEdges[_post_FindEdge(vertexEdges, tableSize, vertexReverse)] != vertexReverse;
+
+		if (border != 0)
+		{
+			borderOut[groupA]++;
+			borderIn[groupB]++;
+		}
+		else if (seam != 0)
+		{
+			seamEdges[groupA]++;
+			seamEdges[groupB]++;
+		}
+
+		//Border and seam edges keep their place through a plane perpendicular to the triangle
+		if (border != 0 || seam != 0)
+		{
+			uint32_t c = indices[i - i % 3 + (i + 2) % 3];
+			_post_AddEdgeQuadric(state, groupA, groupB, state->vertexGroups[c]);
+		}
+	}
+
+	for (uint32_t i = 0; i < groupCount; i++)
+	{
+		uint32_t wedgeCount = state->wedgeStart[i + 1] - state->wedgeStart[i];
+
+		state->kinds[i] = POST_VERTEX_LOCKED;
+		if (wedgeCount == 1 && borderOut[i] == 0 && borderIn[i] == 0 && seamEdges[i] == 0)
+			state->kinds[i] = POST_VERTEX_MANIFOLD;
+		else if (wedgeCount == 1 && borderOut[i] == 1 && borderIn[i] == 1 && seamEdges[i] == 0)
+			state->kinds[i] = POST_VERTEX_BORDER;
+		else if (wedgeCount == 2 && borderOut[i] == 0 && borderIn[i] == 0 && seamEdges[i] == 4) //2 seam edges, each seen from both sides
+			state->kinds[i] = POST_VERTEX_SEAM;
+	}
+
+	free(positionEdges);
+	free(vertexEdges);
+	free(edgeCounts);
+
+	//Plane of every triangle weighted by its area
+	for (uint32_t i = 0; i < triangleCount; i++)
+	{
+		uint32_t groups[3] = { state->vertexGroups[indices[i * 3]], state->vertexGroups[indices[i * 3 + 1]], state->vertexGroups[indices[i * 3 + 2]] };
+
+		float normal[3];
+		float area = _post_GetGroupTriangleNormal(state, groups, normal);
+		if (area == 0.0f)
+			continue;
+
+		const float* p = &state->positions[groups[0] * 3];
+		Quadric quadric;
+		_post_QuadricFromPlane(&quadric, normal, -(normal[0] * p[0] + normal[1] * p[1] + normal[2] * p[2]), area);
+
+		for (int j = 0; j < 3; j++)
+			_post_AddQuadric(&state->quadrics[groups[j]], &quadric);
+	}
+
+	//Every edge both ways. Interior edges are queued twice, and the second copy is skipped once either end changes
+	for (uint32_t i = 0; i < indexCount && ret == STARDUST_ERROR_SUCCESS; i++)
+	{
+		uint32_t a = state->vertexGroups[indices[i]];
+		uint32_t b = state->vertexGroups[indices[i - i % 3 + (i + 1) % 3]];
+		if (a == b)
+			continue;
+
+		ret = _post_PushCollapse(state, a, b);
+		if (ret == STARDUST_ERROR_SUCCESS)
+			ret = _post_PushCollapse(state, b, a);
+	}
+
+	if (ret != STARDUST_ERROR_SUCCESS)
+		_post_FreeSimplify(state);
+
+	return ret;
+}
+
+void _post_FreeSimplify(SimplifyState* state)
+{
+	free(state->removed);
+	free(state->vertexGroups);
+	free(state->wedgeStart);
+	free(state->wedges);
+	free(state->positions);
+	free(state->kinds);
+	free(state->quadrics);
+	free(state->versions);
+	free(state->cornerHead);
+	free(state->cornerTail);
+	free(state->cornerNext);
+	free(state->marks);
+	free(state->heap);
+
+	memset(state, 0, sizeof(SimplifyState));
+}
+
+int _post_CanCollapse(SimplifyState* state, uint32_t from, uint32_t to)
+{
+	unsigned char fromKind = state->kinds[from];
+	unsigned char toKind = state->kinds[to];
+
+	if (fromKind == POST_VERTEX_LOCKED)
+		return 0;
+	if (fromKind == POST_VERTEX_BORDER && toKind != POST_VERTEX_BORDER && toKind != POST_VERTEX_LOCKED)
+		return 0;
+	if (fromKind == POST_VERTEX_SEAM && toKind != POST_VERTEX_SEAM && toKind != POST_VERTEX_LOCKED)
+		return 0;
+
+	//Triangles on the edge. Borders have 1. Seams have 2 with different attributes on either side
+	uint32_t shared = 0;
+	uint32_t sharedWedges[2] = { 0, 0 };
+
+	for (uint32_t corner = state->cornerHead[from]; corner != POST_HASH_EMPTY; corner = state->cornerNext[corner])
+	{
+		uint32_t triangle = corner / 3;
+		if (state->removed[triangle] != 0)
+			continue;
+
+		uint32_t groups[3];
+		int hasTo = 0;
+		for (int i = 0; i < 3; i++)
+		{
+			groups[i] = state->vertexGroups[state->indices[triangle * 3 + i]];
+			hasTo |= groups[i] == to;
+		}
+
+		if (hasTo != 0)
+		{
+			if (shared < 2)
+				sharedWedges[shared] = state->indices[corner];
+			shared++;
+			continue;
+		}
+
+		//Moving from onto to must not flip the triangle
+		float before[3];
+		if (_post_GetGroupTriangleNormal(state, groups, before) == 0.0f)
+			continue;
+
+		for (int i = 0; i < 3; i++)
+		{
+			if (groups[i] == from)
+				groups[i] = to;
+		}
+
+		float after[3];
+		if (_post_GetGroupTriangleNormal(state, groups, after) == 0.0f)
+			return 0;
+
+		if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0f)
+			return 0;
+	}
+
+	if (shared == 0)
+		return 0;
+	if (fromKind == POST_VERTEX_BORDER && shared != 1)
+		return 0;
+	if (fromKind == POST_VERTEX_SEAM && (shared != 2 || sharedWedges[0] == sharedWedges[1]))
+		return 0;
+
+	//Link condition. Positions next to both ends may only be the ones opposite the edge, otherwise the collapse folds the surface onto itself
+	state->markStamp += 2;
+	for (uint32_t corner = state->cornerHead[to]; corner != POST_HASH_EMPTY; corner = state->cornerNext[corner])
+	{
+		if (state->removed[corner / 3] != 0)
+			continue;
+
+		for (int i = 0; i < 3; i++)
+			state->marks[state->vertexGroups[state->indices[corner - corner % 3 + i]]] = state->markStamp;
+	}
+
+	uint32_t common = 0;
+	state->marks[from] = 0;
+	state->marks[to] = 0;
+	for (uint32_t corner = state->cornerHead[from]; corner != POST_HASH_EMPTY; corner = state->cornerNext[corner])
+	{
+		if (state->removed[corner / 3] != 0)
+			continue;
+
+		for (int i = 0; i < 3; i++)
+		{
+			uint32_t group = state->vertexGroups[state->indices[corner - corner % 3 + i]];
+			if (state->marks[group] == state->markStamp)
+			{
+				state->marks[group] = state->markStamp + 1;
+				common++;
+			}
+		}
+	}
+
+	return common <= shared;
+}
+
+StardustErrorCode _post_Collapse(SimplifyState* state, uint32_t from, uint32_t to)
+{
+	//Each vertex at from moves to the vertex at to that it shares a triangle with. At most 2 for seams
+	uint32_t wedgeCount = state->wedgeStart[from + 1] - state->wedgeStart[from];
+	uint32_t targets[2];
+
+	for (uint32_t i = 0; i < wedgeCount && i < 2; i++)
+	{
+		uint32_t wedge = state->wedges[state->wedgeStart[from] + i];
+		targets[i] = state->wedges[state->wedgeStart[to]];
+
+		for (uint32_t corner = state->cornerHead[from]; corner != POST_HASH_EMPTY; corner = state->cornerNext[corner])
+		{
+			uint32_t triangle = corner / 3;
+			if (state->removed[triangle] != 0 || state->indices[corner] != wedge)
+				continue;
+
+			int found = 0;
+			for (int j = 0; j < 3; j++)
+			{
+				uint32_t vertex = state->indices[triangle * 3 + j];
+				if (state->vertexGroups[vertex] == to)
+				{
+					targets[i] = vertex;
+					found = 1;
+				}
+			}
+
+			if (found != 0)
+				break;
+		}
+	}
+
+	//Move the corners. Triangles that had both ends of the edge collapse to nothing
+	for (uint32_t corner = state->cornerHead[from]; corner != POST_HASH_EMPTY; corner = state->cornerNext[corner])
+	{
+		uint32_t triangle = corner / 3;
+		if (state->removed[triangle] != 0)
+			continue;
+
+		int hasTo = 0;
+		for (int i = 0; i < 3; i++)
+			hasTo |= state->vertexGroups[state->indices[triangle * 3 + i]] == to;
+
+		if (hasTo != 0)
+		{
+			state->removed[triangle] = 1;
+			state->liveTriangles--;
+			continue;
+		}
+
+		uint32_t wedge = state->indices[corner];
+		state->indices[corner] = wedgeCount > 1 && wedge == state->wedges[state->wedgeStart[from] + 1] ? targets[1] : targets[0];
+	}
+
+	//Hand the corners over
+	if (state->cornerHead[from] != POST_HASH_EMPTY)
+	{
+		if (state->cornerHead[to] == POST_HASH_EMPTY)
+			state->cornerHead[to] = state->cornerHead[from];
+		else
+			state->cornerNext[state->cornerTail[to]] = state->cornerHead[from];
+
+		state->cornerTail[to] = state->cornerTail[from];
+		state->cornerHead[from] = POST_HASH_EMPTY;
+	}
+
+	_post_AddQuadric(&state->quadrics[to], &state->quadrics[from]);
+	state->kinds[from] = POST_VERTEX_LOCKED;
+	state->versions[from]++;
+	state->versions[to]++;
+
+	//Every edge around to has a new cost
+	for (uint32_t corner = state->cornerHead[to]; corner != POST_HASH_EMPTY; corner = state->cornerNext[corner])
+	{
+		uint32_t triangle = corner / 3;
+		if (state->removed[triangle] != 0)
+			continue;
+
+		for (int i = 0; i < 3; i++)
+		{
+			uint32_t group = state->vertexGroups[state->indices[triangle * 3 + i]];
+			if (group == to)
+				continue;
+
+			StardustErrorCode ret = _post_PushCollapse(state, group, to);
+			if (ret == STARDUST_ERROR_SUCCESS)
+				ret = _post_PushCollapse(state, to, group);
+			if (ret != STARDUST_ERROR_SUCCESS)
+				return ret;
+		}
+	}
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+StardustErrorCode _post_PushCollapse(SimplifyState* state, uint32_t from, uint32_t to)
+{
+	if (state->kinds[from] == POST_VERTEX_LOCKED)
+		return STARDUST_ERROR_SUCCESS;
 
-	//Triangulation of meshes
-	if ((flags & STARDUST_MESH_TRIANGULATE) == STARDUST_MESH_TRIANGULATE)
+	if (state->heapCount == state->heapCapacity)
 	{
-		ret = _post_TriangulateMeshEC(mesh);
-		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
-	}
+		EdgeCollapse* heap = realloc(state->heap, ((size_t)state->heapCapacity * 2 + 1) * sizeof(EdgeCollapse));
+		if (heap == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
 
-	//Normal Generation / Normal Hardening
-	if ((flags & STARDUST_MESH_GENERATE_NORMALS) == STARDUST_MESH_GENERATE_NORMALS)
-	{
-		ret = _post_GenerateNormals(mesh);
-		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+		state->heap = heap;
+		state->heapCapacity *= 2;
 	}
 
-	//Normal Smoothing
-	if ((flags & STARDUST_MESH_SMOOTH_NORMALS) == STARDUST_MESH_SMOOTH_NORMALS && (mesh->dataType & STARDUST_SMOOTHSHADING) != STARDUST_SMOOTHSHADING)
+	//Cost of moving from onto to with the planes of both
+	Quadric quadric = state->quadrics[from];
+	_post_AddQuadric(&quadric, &state->quadrics[to]);
+
+	EdgeCollapse collapse;
+	collapse.cost = _post_QuadricError(&quadric, &state->positions[to * 3]);
+	collapse.from = from;
+	collapse.to = to;
+	collapse.fromVersion = state->versions[from];
+	collapse.toVersion = state->versions[to];
+
+	//Sift up
+	uint32_t index = state->heapCount++;
+	while (index > 0)
 	{
-		if ((mesh->dataType & STARDUST_NORMAL_DATA) != STARDUST_NORMAL_DATA) //Generate normal data if need be
-		{
-			ret = _post_GenerateNormals(mesh);
-			if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
-		}
+		uint32_t parent = (index - 1) / 2;
+		if (state->heap[parent].cost <= collapse.cost)
+			break;
 
-		ret = _post_SmoothNormals(mesh); //Smooth normals if flag is present and mesh does not contain smooth normals
-		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+		state->heap[index] = state->heap[parent];
+		index = parent;
 	}
+	state->heap[index] = collapse;
 
 	return STARDUST_ERROR_SUCCESS;
 }
 
-// ================= Smooth Normals ================= //
-
-StardustErrorCode _post_SmoothNormals(StardustMesh* mesh)
+EdgeCollapse _post_PopCollapse(SimplifyState* state)
 {
-	// Create index list of simillar position vertices //
-	uint32_t bucketCount = 0;
-	
-	//Set buckets for worst case scenario
-	NormalPosition** normalBuckets = malloc(mesh->vertexCount * sizeof(NormalPosition*)); //Assume that every vertex is different
-	if (normalBuckets == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
-	uint32_t* bucketSizes = malloc(mesh->vertexCount * sizeof(uint32_t));
-	if (bucketSizes == 0) { free(normalBuckets); return STARDUST_ERROR_MEMORY_ERROR; }
+	EdgeCollapse top = state->heap[0];
+	EdgeCollapse last = state->heap[--state->heapCount];
 
-	memset(normalBuckets, 0, mesh->vertexCount * sizeof(Vertex*));
-	memset(bucketSizes, 0, mesh->vertexCount * sizeof(uint32_t));
+	//Sift down
+	uint32_t index = 0;
+	while (1)
+	{
+		uint32_t child = index * 2 + 1;
+		if (child >= state->heapCount)
+			break;
+		if (child + 1 < state->heapCount && state->heap[child + 1].cost < state->heap[child].cost)
+			child++;
+		if (last.cost <= state->heap[child].cost)
+			break;
+
+		state->heap[index] = state->heap[child];
+		index = child;
+	}
 
+	if (state->heapCount > 0)
+		state->heap[index] = last;
 
-	for (uint32_t i = 0; i < mesh->vertexCount; i++)
-	{
-		//Iterate through buckets
-		uint32_t j = 0;
-		for (; j < bucketCount; j++)
-		{
-			if (_post_ComarePositions((normalBuckets[j]), &(mesh->vertices[i])))
-				break;
-		}
-		
-		//Allocate new bucket
-		NormalPosition* newBucket = malloc(((size_t)bucketSizes[j] + 1) * sizeof(NormalPosition));
-		if (newBucket == 0)
-		{
-			for (uint32_t k = 0; k < bucketCount; k++)
-				free(normalBuckets[k]);
-			free(normalBuckets);
-			free(bucketSizes);
-			return STARDUST_ERROR_MEMORY_ERROR;
-		}
+	return top;
+}
 
-		//Copy in old data
-		memcpy(newBucket, normalBuckets[j], (size_t)bucketSizes[j] * sizeof(NormalPosition));
+float _post_GetGroupTriangleNormal(const SimplifyState* state, const uint32_t* groups, float* normal)
+{
+	const float* a = &state->positions[groups[0] * 3];
+	const float* b = &state->positions[groups[1] * 3];
+	const float* c = &state->positions[groups[2] * 3];
 
-		//Add new vertex to bucket
-		newBucket[bucketSizes[j]].x = mesh->vertices[i].x;
-		newBucket[bucketSizes[j]].y = mesh->vertices[i].y;
-		newBucket[bucketSizes[j]].z = mesh->vertices[i].z;
-		newBucket[bucketSizes[j]].w = mesh->vertices[i].w;
-		newBucket[bucketSizes[j]].index = i;
+	float edgeA[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+	float edgeB[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
 
-		//Free old bucket
-		if (normalBuckets[j] != 0)
-			free(normalBuckets[j]);
-		else
-			bucketCount++; //Only increment when adding a new bucket. Which would not replace an old one
+	normal[0] = edgeA[1] * edgeB[2] - edgeA[2] * edgeB[1];
+	normal[1] = edgeA[2] * edgeB[0] - edgeA[0] * edgeB[2];
+	normal[2] = edgeA[0] * edgeB[1] - edgeA[1] * edgeB[0];
 
-		//Set new pointer
-		normalBuckets[j] = newBucket;
+	float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+	if (length == 0.0f)
+		return 0.0f;
 
-		bucketSizes[j]++;
-	}
+	for (int i = 0; i < 3; i++)
+		normal[i] /= length;
 
-	// Average normals
-	for (uint32_t i = 0; i < bucketCount; i++)
-	{
-		//Acumulate values
-		float totalX = 0, totalY = 0, totalZ = 0;
-		for (uint32_t j = 0; j < bucketSizes[i]; j++)
-		{
-			totalX += mesh->vertices[normalBuckets[i][j].index].normX;
-			totalY += mesh->vertices[normalBuckets[i][j].index].normY;
-			totalZ += mesh->vertices[normalBuckets[i][j].index].normZ;
-		}
+	return length * 0.5f;
+}
 
-		//Calculate magnitude
-		float mag = sqrtf(totalX * totalX + totalY * totalY + totalZ * totalZ);
+void _post_AddEdgeQuadric(SimplifyState* state, uint32_t a, uint32_t b, uint32_t c)
+{
+	uint32_t groups[3] = { a, b, c };
+	float normal[3];
+	if (_post_GetGroupTriangleNormal(state, groups, normal) == 0.0f)
+		return;
 
-		//Divide by total
-		totalX /= mag;
-		totalY /= mag;
-		totalZ /= mag;
+	const float* p = &state->positions[a * 3];
+	const float* q = &state->positions[b * 3];
+	float edge[3] = { q[0] - p[0], q[1] - p[1], q[2] - p[2] };
 
-		//Set normals of all vertices
-		for (uint32_t j = 0; j < bucketSizes[i]; j++)
-		{
-			mesh->vertices[normalBuckets[i][j].index].normX = totalX;
-			mesh->vertices[normalBuckets[i][j].index].normY = totalY;
-			mesh->vertices[normalBuckets[i][j].index].normZ = totalZ;
-		}
-	}
+	//Plane through the edge, perpendicular to the triangle
+	float plane[3] = {
+		edge[1] * normal[2] - edge[2] * normal[1],
+		edge[2] * normal[0] - edge[0] * normal[2],
+		edge[0] * normal[1] - edge[1] * normal[0] };
 
+	float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+	if (length == 0.0f)
+		return;
 
-	mesh->dataType |= STARDUST_SMOOTHSHADING;
+	for (int i = 0; i < 3; i++)
+		plane[i] /= length;
 
-	free(bucketSizes);
-	for (uint32_t i = 0; i < bucketCount; i++)
-		free(normalBuckets[i]);
-	free(normalBuckets);
+	//The edge length is also the length of the plane's normal before normalising, as the triangle normal is a unit vector
+	Quadric quadric;
+	_post_QuadricFromPlane(&quadric, plane, -(plane[0] * p[0] + plane[1] * p[1] + plane[2] * p[2]), length * length * POST_SIMPLIFY_EDGE_WEIGHT);
 
-	_post_RecomputeIndexArray(mesh);
+	_post_AddQuadric(&state->quadrics[a], &quadric);
+	_post_AddQuadric(&state->quadrics[b], &quadric);
+}
 
-	return STARDUST_ERROR_SUCCESS;
+void _post_QuadricFromPlane(Quadric* quadric, const float* normal, float distance, float weight)
+{
+	quadric->a00 = normal[0] * normal[0] * weight;
+	quadric->a01 = normal[0] * normal[1] * weight;
+	quadric->a02 = normal[0] * normal[2] * weight;
+	quadric->a11 = normal[1] * normal[1] * weight;
+	quadric->a12 = normal[1] * normal[2] * weight;
+	quadric->a22 = normal[2] * normal[2] * weight;
+	quadric->b0 = normal[0] * distance * weight;
+	quadric->b1 = normal[1] * distance * weight;
+	quadric->b2 = normal[2] * distance * weight;
+	quadric->c = distance * distance * weight;
+	quadric->weight = weight;
 }
 
+void _post_AddQuadric(Quadric* quadric, const Quadric* other)
+{
+	quadric->a00 += other->a00;
+	quadric->a01 += other->a01;
+	quadric->a02 += other->a02;
+	quadric->a11 += other->a11;
+	quadric->a12 += other->a12;
+	quadric->a22 += other->a22;
+	quadric->b0 += other->b0;
+	quadric->b1 += other->b1;
+	quadric->b2 += other->b2;
+	quadric->c += other->c;
+	quadric->weight += other->weight;
+}
 
+float _post_QuadricError(const Quadric* quadric, const float* position)
+{
+	float x = position[0];
+	float y = position[1];
+	float z = position[2];
 
+	float rx = quadric->a00 * x + quadric->a01 * y + quadric->a02 * z;
+	float ry = quadric->a01 * x + quadric->a11 * y + quadric->a12 * z;
+	float rz = quadric->a02 * x + quadric->a12 * y + quadric->a22 * z;
 
+	float error = rx * x + ry * y + rz * z + 2.0f * (quadric->b0 * x + quadric->b1 * y + quadric->b2 * z) + quadric->c;
 
-// ================= Generate Normals ================= //
+	//Weighted mean of the squared distances to the planes
+	return quadric->weight > 0.0f ? fabsf(error) / quadric->weight : 0.0f;
+}
 
-StardustErrorCode _post_GenerateNormals(StardustMesh* mesh)
+uint32_t _post_FindEdge(const uint64_t* table, uint32_t tableSize, uint64_t key)
 {
-	//Check that mesh is triangulated
-	if (mesh->vertexStride != 3)
-	{
-		StardustErrorCode ret = _post_TriangulateMeshEC(mesh); //If not, triangulate
-		if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
-	}
+	uint32_t slot = _post_HashWords(&key, 2, 0) & (tableSize - 1);
+	while (table[slot] != key && table[slot] != POST_EDGE_EMPTY)
+		slot = (slot + 1) & (tableSize - 1);
 
-	//Loop by face.
-	uint32_t vertexCount = 0;
-	uint32_t indexCount = 0;
+	return slot;
+}
 
-	Vertex* vertexArray = malloc(mesh->indexCount * mesh->vertexStride * sizeof(Vertex));
-	if (vertexArray == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
-	uint32_t* indexArray = malloc(mesh->indexCount * mesh->vertexStride * sizeof(uint32_t));
-	if (indexArray == 0) { free(vertexArray);  return STARDUST_ERROR_MEMORY_ERROR; }
 
-	
-	for (uint32_t i = 0; i < mesh->indexCount; i += mesh->vertexStride)
-	{
-		// a == 1
-		// b == 2
-		// c == 3
-		// norm(cross(b - a, c - a))
+// ================= Levels Of Detail ================= //
 
-		uint32_t a = mesh->indices[i];
-		uint32_t b = mesh->indices[i + 1];
-		uint32_t c = mesh->indices[i + 2];
+StardustErrorCode _post_GenerateLODs(StardustMesh* mesh, uint32_t lodCount, float reduction, float targetError)
+{
+	_post_FreeLODs(mesh);
+	if (lodCount == 0)
+		return STARDUST_ERROR_SUCCESS;
 
-		//Edge AB
-		float edgeAx = mesh->vertices[b].x - mesh->vertices[a].x;
-		float edgeAy = mesh->vertices[b].y - mesh->vertices[a].y;
-		float edgeAz = mesh->vertices[b].z - mesh->vertices[a].z;
+	StardustLOD* lods = malloc((size_t)lodCount * sizeof(StardustLOD));
+	if (lods == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
 
-		//Edge AC
-		float edgeBx = mesh->vertices[c].x - mesh->vertices[a].x;
-		float edgeBy = mesh->vertices[c].y - mesh->vertices[a].y;
-		float edgeBz = mesh->vertices[c].z - mesh->vertices[a].z;
+	//Each level is simplified from the one before, which is much faster than starting from the full mesh every time
+	const uint32_t* source = mesh->indices;
+	uint32_t sourceCount = mesh->indexCount;
+	float error = 0.0f;
+	uint32_t levels = 0;
+
+	StardustErrorCode ret = STARDUST_ERROR_SUCCESS;
+	while (levels < lodCount)
+	{
+		uint32_t target = (uint32_t)((float)sourceCount * reduction);
+		target -= target % 3;
 
-		//Cross product
-		float normX = edgeAy*edgeBz - edgeAz*edgeBy;
-		float normY = edgeAz*edgeBx - edgeAx*edgeBz;
-		float normZ = edgeAx*edgeBy - edgeAy*edgeBx;
+		uint32_t* indices = malloc(((size_t)sourceCount + 1) * sizeof(uint32_t));
+		if (indices == 0) { ret = STARDUST_ERROR_MEMORY_ERROR; break; }
 
-		//Mag
-		float mag = sqrtf(normX*normX + normY*normY + normZ*normZ);
-		normX /= mag;
-		normY /= mag;
-		normZ /= mag;
+		uint32_t count = 0;
+		float levelError = 0.0f;
+		ret = _post_SimplifyIndices(mesh, source, sourceCount, target, targetError, indices, &count, &levelError);
 
-		//Create vertices
-		for (uint32_t j = i; j < i + 3; j++)
+		//Stop once the error limit keeps a level from getting any simpler
+		if (ret != STARDUST_ERROR_SUCCESS || count == sourceCount)
 		{
-			uint32_t idx = mesh->indices[j];
+			free(indices);
+			break;
+		}
 
-			vertexArray[j].x = mesh->vertices[idx].x;
-			vertexArray[j].y = mesh->vertices[idx].y;
-			vertexArray[j].z = mesh->vertices[idx].z;
-			vertexArray[j].w = mesh->vertices[idx].w;
+		uint32_t* shrunk = realloc(indices, ((size_t)count + 1) * sizeof(uint32_t));
+		if (shrunk != 0)
+			indices = shrunk;
 
-			vertexArray[j].texU = mesh->vertices[idx].texU;
-			vertexArray[j].texV = mesh->vertices[idx].texV;
-			vertexArray[j].texW = mesh->vertices[idx].texW;
+		//Errors add up along the chain
+		error += levelError;
 
-			vertexArray[j].normX = normX;
-			vertexArray[j].normY = normY;
-			vertexArray[j].normZ = normZ;
+		lods[levels].indices = indices;
+		lods[levels].indexCount = count;
+		lods[levels].error = error;
 
-			indexArray[j] = j;
-		}
+		source = indices;
+		sourceCount = count;
+		levels++;
+	}
 
-		vertexCount += mesh->vertexStride;
-		indexCount += mesh->vertexStride;
+	if (ret != STARDUST_ERROR_SUCCESS)
+	{
+		for (uint32_t i = 0; i < levels; i++)
+			free(lods[i].indices);
+		free(lods);
+		return ret;
 	}
 
-	//Free old data
-	free(mesh->vertices);
-	free(mesh->indices);
+	if (levels == 0)
+	{
+		free(lods);
+		return STARDUST_ERROR_SUCCESS;
+	}
 
-	//Set new data
-	mesh->vertices = vertexArray;
-	mesh->indices = indexArray;
+	mesh->lods = lods;
+	mesh->lodCount = levels;
+	mesh->dataType |= STARDUST_LOD_DATA;
 
-	mesh->vertexCount = vertexCount;
-	mesh->indexCount = indexCount;
+	return STARDUST_ERROR_SUCCESS;
+}
 
-	mesh->dataType &= ~STARDUST_SMOOTHSHADING;
+StardustErrorCode _post_OptimizeLODs(StardustMesh* mesh, StardustPostProcessStages stages)
+{
+	for (uint32_t i = 0; i < mesh->lodCount; i++)
+	{
+		//The passes only touch the indices, so each level is optimised through a copy of the mesh that uses its indices
+		StardustMesh level = *mesh;
+		level.indices = mesh->lods[i].indices;
+		level.indexCount = mesh->lods[i].indexCount;
+
+		StardustErrorCode ret = STARDUST_ERROR_SUCCESS;
+		if ((stages & STARDUST_STAGE_OPTIMIZE_VERTEX_CACHE) == STARDUST_STAGE_OPTIMIZE_VERTEX_CACHE)
+			ret = _post_OptimizeVertexCache(&level, _post_Settings.vertexCacheSize);
 
-	//Shrink vertices
-	_post_RecomputeIndexArray(mesh);
+		if (ret == STARDUST_ERROR_SUCCESS && (stages & STARDUST_STAGE_OPTIMIZE_OVERDRAW) == STARDUST_STAGE_OPTIMIZE_OVERDRAW)
+			ret = _post_OptimizeOverdraw(&level, _post_Settings.vertexCacheSize, _post_Settings.overdrawThreshold);
 
+		if (ret != STARDUST_ERROR_SUCCESS)
+			return ret;
+	}
 
 	return STARDUST_ERROR_SUCCESS;
 }
 
+void _post_FreeLODs(StardustMesh* mesh)
+{
+	for (uint32_t i = 0; i < mesh->lodCount; i++)
+		free(mesh->lods[i].indices);
+	free(mesh->lods);
+
+	mesh->lods = 0;
+	mesh->lodCount = 0;
+	mesh->dataType &= ~STARDUST_LOD_DATA;
+}
+
 
 // ================= Triangulation ================= //
 
@@ -258,326 +3134,594 @@ StardustErrorCode _post_TriangulateMeshEC(StardustMesh* mesh)
 	//Precalculate polygon count
 	uint32_t polygonCount = mesh->indexCount / mesh->vertexStride; //IndexCount / number of indices per polygon
 
-	//Allocate polygon array
-	Polygon* polygons = malloc(sizeof(Polygon) * polygonCount);
-	if (polygons == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
-
-	//Fill polygons
-	for (uint32_t i = 0; i < polygonCount; i++)
-	{
-		uint32_t index = i * mesh->vertexStride;
-		polygons[i].indices = malloc(sizeof(uint32_t) * mesh->vertexStride); //WHAT?
-		if (polygons[i].indices == 0)
-		{
-			for (uint32_t j = 0; j < i; i++)
-				free(polygons[j].indices);
-			free(polygons);
-			return STARDUST_ERROR_MEMORY_ERROR;
-		}
-
-		for (uint32_t j = 0; j < mesh->vertexStride; j++)
-			polygons[i].indices[j] = mesh->indices[mesh->indices[index + j]]; //WHAT?
-		polygons[i].vertexCount = mesh->vertexStride;
-
-		_post_CalculatePolygonNormal(mesh, &polygons[i]);
-	}
-
+	//Allocate new index array. Every polygon becomes vertexStride - 2 triangles
+	uint32_t* newIndices = malloc(sizeof(uint32_t) * 3 * (size_t)(mesh->vertexStride - 2) * polygonCount);
+	if (newIndices == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
 
-	//Allocate new index array
-	uint32_t* newIndices = malloc(sizeof(uint32_t) * 3 * (mesh->indexCount - 2));
-	if (newIndices == 0)
-	{
-		for (uint32_t i = 0; i < polygonCount; i++)
-		{
-			if (polygons[i].indices != 0)
-				free(polygons[i].indices);
-		}
-		free(polygons);
+	//Scratch memory shared by every polygon. Allocated once so that no polygon allocates
+	float* positions = malloc(sizeof(float) * 3 * _post_GetConvexScratchSize(mesh->vertexStride));
+	if (positions == 0) { free(newIndices); return STARDUST_ERROR_MEMORY_ERROR; }
 
-		return STARDUST_ERROR_MEMORY_ERROR;
-	}
+	PolygonScratch scratch = { 0 };
 
 	//Iterate over polygons and triangulate them
-	StardustErrorCode res; //Return code
-	uint32_t count = 0; //Number of polygons triangulated from fuctiion
 	uint32_t newIndexCount = 0; //Position in newIndices
 	for (uint32_t i = 0; i < polygonCount; i++)
 	{
-		res = _post_TriangulatePolygonEC(mesh, &polygons[i], newIndices + newIndexCount, &count);
+		Polygon polygon;
+		polygon.indices = mesh->indices + (size_t)i * mesh->vertexStride;
+		polygon.vertexCount = mesh->vertexStride;
+
+		uint32_t count = 0;
+		StardustErrorCode res = _post_TriangulatePolygon(mesh, &polygon, positions, &scratch, newIndices + newIndexCount, &count);
 		if (res != STARDUST_ERROR_SUCCESS) //Validate success
 		{
-			for (uint32_t i = 0; i < polygonCount; i++)
-			{
-				if (polygons[i].indices != 0)
-					free(polygons[i].indices);
-			}
-			free(polygons);
 			free(newIndices);
+			free(positions);
+			_post_FreePolygonScratch(&scratch);
 			return res;
 		}
 
 		newIndexCount += count;
 	}
 
+	free(positions);
+	_post_FreePolygonScratch(&scratch);
+
 	//Set mesh to new indices
 	free(mesh->indices);
 	mesh->indices = newIndices;
 	mesh->vertexStride = 3;
 	mesh->indexCount = newIndexCount;
 
-	for (uint32_t i = 0; i < polygonCount; i++)
+	return STARDUST_ERROR_SUCCESS;
+}
+
+StardustErrorCode _post_TriangulatePolygon(StardustMesh* mesh, Polygon* poly, float* positions, PolygonScratch* scratch, uint32_t* indexArray, uint32_t* indexCount)
+{
+	_post_CalculatePolygonNormal(mesh, poly);
+
+	//Convex polygons are fanned straight into the index buffer
+	if (_post_IsPolygonConvex(mesh, poly, positions))
 	{
-		if (polygons[i].indices != 0)
-			free(polygons[i].indices);
+		uint32_t written = 0;
+		for (uint32_t j = 1; j + 1 < poly->vertexCount; j++)
+		{
+			indexArray[written] = poly->indices[0];
+			indexArray[written + 1] = poly->indices[j];
+			indexArray[written + 2] = poly->indices[j + 1];
+			written += 3;
+		}
+
+		*indexCount = written;
+		return STARDUST_ERROR_SUCCESS;
 	}
-	free(polygons);
 
-	return STARDUST_ERROR_SUCCESS;
+	//Concave polygons go through ear clipping
+	return _post_TriangulatePolygonEC(mesh, poly, scratch, indexArray, indexCount);
 }
 
-StardustErrorCode _post_TriangulatePolygonEC(StardustMesh* mesh, Polygon* poly, uint32_t* indexArray, uint32_t* polygonCount)
+int _post_IsPolygonConvex(StardustMesh* mesh, Polygon* poly, float* positions)
 {
-	//Preallocate arrays
-	uint32_t* convexIndices = malloc(sizeof(uint32_t) * mesh->vertexStride); //Allocate for maximum scenarios
-	if (convexIndices == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
-	uint32_t* concaveIndices = malloc(sizeof(uint32_t) * mesh->vertexStride); 
-	if (concaveIndices == 0) { free(convexIndices); return STARDUST_ERROR_MEMORY_ERROR; }
+	uint32_t n = poly->vertexCount;
+	uint32_t blockSize = _post_GetConvexScratchSize(n);
 
+	//Gather positions into x, y and z blocks. Element k holds polygon vertex k - 1 so that the
+	//previous, current and next vertices of corner i are elements i, i + 1 and i + 2 of each block
+	float* px = positions;
+	float* py = positions + blockSize;
+	float* pz = positions + blockSize * 2;
+
+	for (uint32_t k = 0; k < blockSize; k++)
+	{
+		Vertex* v = &mesh->vertices[poly->indices[(k + n - 1) % n]];
+		px[k] = v->x;
+		py[k] = v->y;
+		pz[k] = v->z;
+	}
 
-	//Get convex indices
-	uint32_t convexCount = _post_FillConvexConcaveVertices(mesh, poly, convexIndices, concaveIndices);
-	uint32_t concaveCount = mesh->vertexStride - convexCount;
+	//A polygon is convex when the turn at every corner is on the same side as the polygon normal
+#if defined(_M_X64) || defined(__SSE2__)
+	__m128 normX = _mm_set1_ps(poly->normal.x);
+	__m128 normY = _mm_set1_ps(poly->normal.y);
+	__m128 normZ = _mm_set1_ps(poly->normal.z);
+	__m128 zero = _mm_setzero_ps();
 
-	//Preallocate ears
-	uint32_t* earIndices = malloc(sizeof(uint32_t) * mesh->vertexStride);
-	if (earIndices == 0) 
-	{ 
-		free(convexIndices); free(concaveIndices);
-		return STARDUST_ERROR_MEMORY_ERROR;
+	for (uint32_t i = 0; i < n; i += 4)
+	{
+		//Edges into and out of each of the 4 corners
+		__m128 inX = _mm_sub_ps(_mm_loadu_ps(px + i + 1), _mm_loadu_ps(px + i));
+		__m128 inY = _mm_sub_ps(_mm_loadu_ps(py + i + 1), _mm_loadu_ps(py + i));
+		__m128 inZ = _mm_sub_ps(_mm_loadu_ps(pz + i + 1), _mm_loadu_ps(pz + i));
+
+		__m128 outX = _mm_sub_ps(_mm_loadu_ps(px + i + 2), _mm_loadu_ps(px + i + 1));
+		__m128 outY = _mm_sub_ps(_mm_loadu_ps(py + i + 2), _mm_loadu_ps(py + i + 1));
+		__m128 outZ = _mm_sub_ps(_mm_loadu_ps(pz + i + 2), _mm_loadu_ps(pz + i + 1));
+
+		//dot(cross(in, out), normal)
+		__m128 crossX = _mm_sub_ps(_mm_mul_ps(inY, outZ), _mm_mul_ps(inZ, outY));
+		__m128 crossY = _mm_sub_ps(_mm_mul_ps(inZ, outX), _mm_mul_ps(inX, outZ));
+		__m128 crossZ = _mm_sub_ps(_mm_mul_ps(inX, outY), _mm_mul_ps(inY, outX));
+		__m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(crossX, normX), _mm_mul_ps(crossY, normY)), _mm_mul_ps(crossZ, normZ));
+
+		//Lanes past the last corner are ignored
+		int laneMask = n - i >= 4 ? 0xF : (1 << (n - i)) - 1;
+		if ((_mm_movemask_ps(_mm_cmplt_ps(dot, zero)) & laneMask) != 0)
+			return 0;
+	}
+#else
+	for (uint32_t i = 0; i < n; i++)
+	{
+		float inX = px[i + 1] - px[i], inY = py[i + 1] - py[i], inZ = pz[i + 1] - pz[i];
+		float outX = px[i + 2] - px[i + 1], outY = py[i + 2] - py[i + 1], outZ = pz[i + 2] - pz[i + 1];
+
+		float dot = (inY * outZ - inZ * outY) * poly->normal.x + (inZ * outX - inX * outZ) * poly->normal.y + (inX * outY - inY * outX) * poly->normal.z;
+		if (dot < 0.0f)
+			return 0;
 	}
+#endif
 
-	//Get ears
-	uint32_t earCount = _post_FillEars(mesh, poly, convexIndices, convexCount, concaveIndices, concaveCount, earIndices);
+	return 1;
+}
 
-	//Loop over ears
-	uint32_t indexCount = 0;
-	while (earCount > 0)
+uint32_t _post_GetConvexScratchSize(uint32_t vertexCount)
+{
+	//Two wrapped vertices plus padding so that the last block of 4 corners can be read
+	return ((vertexCount + 3) & ~3u) + 2;
+}
+
+StardustErrorCode _post_TriangulatePolygonEC(StardustMesh* mesh, Polygon* poly, PolygonScratch* scratch, uint32_t* indexArray, uint32_t* indexCount)
+{
+	uint32_t n = poly->vertexCount;
+
+	StardustErrorCode ret = _post_ReservePolygonScratch(scratch, n);
+	if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
+
+	//Project onto the plane of the dominant normal axis so that the polygon winds CCW in 2D
+	_post_ProjectPolygon(mesh, poly, scratch->x, scratch->y);
+
+	//Build linked list and find reflex vertices
+	uint32_t reflexCount = 0;
+	for (uint32_t i = 0; i < n; i++)
 	{
-		//	Get indices
-		uint32_t earIdx = earIndices[earCount - 1];
-		uint32_t prevIdx = (earIdx + poly->vertexCount - 1) % poly->vertexCount;
-		uint32_t nextIdx = (earIdx + 1) % poly->vertexCount;
+		scratch->prev[i] = (i + n - 1) % n;
+		scratch->next[i] = (i + 1) % n;
+	}
 
-		//	Add to indexArray
-		indexArray[indexCount] = poly->indices[prevIdx];
-		indexArray[indexCount + 1] = poly->indices[earIdx];
-		indexArray[indexCount + 2] = poly->indices[nextIdx];
-		indexCount += 3;
+	for (uint32_t i = 0; i < n; i++)
+	{
+		scratch->reflex[i] = !_post_IsCornerConvex2D(scratch, scratch->prev[i], i, scratch->next[i]);
+		reflexCount += scratch->reflex[i];
+	}
+
+	_post_BuildReflexGrid(scratch, n, reflexCount);
+
+	//Every vertex starts as an ear candidate. After a clip only the two neighbours are queued again, as they are the only
+	//vertices whose corners changed. This keeps the search local instead of walking around the whole polygon per clip
+	uint32_t queueHead = 0;
+	uint32_t queueCount = n;
+	for (uint32_t i = 0; i < n; i++)
+	{
+		scratch->queue[i] = i;
+		scratch->queued[i] = 1;
+	}
+
+	//Clip ears
+	uint32_t written = 0;
+	uint32_t remaining = n;
+	uint32_t live = 0; //Any vertex that is still part of the polygon
+	int clipped = 0; //Whether anything has been clipped since the queue was last filled
+
+	while (remaining > 3)
+	{
+		uint32_t ear;
+		if (queueCount == 0)
+		{
+			//	Clipping a reflex vertex can unblock ears anywhere, so requeue every remaining vertex
+			if (clipped)
+			{
+				uint32_t v = live;
+				do
+				{
+					scratch->queue[(queueHead + queueCount) % n] = v;
+					scratch->queued[v] = 1;
+					queueCount++;
+					v = scratch->next[v];
+				} while (v != live);
+
+				clipped = 0;
+				continue;
+			}
+
+			//	No ears left means the polygon is degenerate or self intersecting. Clip anyway so that we always terminate
+			ear = live;
+		}
+		else
+		{
+			ear = scratch->queue[queueHead];
+			queueHead = (queueHead + 1) % n;
+			queueCount--;
+			scratch->queued[ear] = 0;
+
+			if (scratch->next[ear] == POST_HASH_EMPTY || !_post_IsEar(scratch, scratch->prev[ear], ear, scratch->next[ear]))
+				continue;
+		}
 
-		//Remove from polygon
-		_post_RemoveFromPolygon(poly, earIdx);
+		uint32_t prev = scratch->prev[ear];
+		uint32_t next = scratch->next[ear];
 
-		//	Recalculate convex indices
-		convexCount = _post_FillConvexConcaveVertices(mesh, poly, convexIndices, concaveIndices);
-		concaveCount = mesh->vertexStride - concaveCount;
+		//	Add to indexArray
+		indexArray[written] = poly->indices[prev];
+		indexArray[written + 1] = poly->indices[ear];
+		indexArray[written + 2] = poly->indices[next];
+		written += 3;
+
+		//	Unlink from polygon
+		scratch->next[prev] = next;
+		scratch->prev[next] = prev;
+		scratch->next[ear] = POST_HASH_EMPTY; //Marks the vertex as clipped for when it is still queued
+		scratch->reflex[ear] = 0;
+		remaining--;
+
+		//	Only the neighbours can change. A reflex vertex can become convex but never the other way around
+		if (scratch->reflex[prev] && _post_IsCornerConvex2D(scratch, scratch->prev[prev], prev, next))
+			scratch->reflex[prev] = 0;
+		if (scratch->reflex[next] && _post_IsCornerConvex2D(scratch, prev, next, scratch->next[next]))
+			scratch->reflex[next] = 0;
+
+		//	Queue the neighbours
+		if (!scratch->queued[prev])
+		{
+			scratch->queue[(queueHead + queueCount) % n] = prev;
+			scratch->queued[prev] = 1;
+			queueCount++;
+		}
+		if (!scratch->queued[next])
+		{
+			scratch->queue[(queueHead + queueCount) % n] = next;
+			scratch->queued[next] = 1;
+			queueCount++;
+		}
 
-		//	Recalculate ears
-		earCount = _post_FillEars(mesh, poly, convexIndices, convexCount, concaveIndices, concaveCount, earIndices);
+		live = prev;
+		clipped = 1;
 	}
 
-	free(convexIndices);
-	free(concaveIndices);
-	free(earIndices);
+	//Last triangle
+	indexArray[written] = poly->indices[scratch->prev[live]];
+	indexArray[written + 1] = poly->indices[live];
+	indexArray[written + 2] = poly->indices[scratch->next[live]];
+	written += 3;
 
-	*polygonCount = indexCount;
+	*indexCount = written;
 
 	return STARDUST_ERROR_SUCCESS;
 }
 
-uint32_t _post_FillConvexConcaveVertices(StardustMesh* mesh, Polygon* poly, uint32_t* convexIndices, uint32_t* concaveIndices)
+void _post_ProjectPolygon(StardustMesh* mesh, Polygon* poly, float* x, float* y)
 {
-	//Counters
-	uint32_t vexIdx = 0; //Convex idx
-	uint32_t aveIdx = 0; //Concave idx
+	float absX = fabsf(poly->normal.x);
+	float absY = fabsf(poly->normal.y);
+	float absZ = fabsf(poly->normal.z);
 
-	//Iterate over indices
 	for (uint32_t i = 0; i < poly->vertexCount; i++)
 	{
-		//Get previous and next vertices for triangle
-		uint32_t prevIdx = (i + poly->vertexCount - 1) % poly->vertexCount; //I'm pretty sure C doesn't auto abs the result of a modulo op like python does.
-		uint32_t nextIdx = (i + 1) % poly->vertexCount;
+		Vertex* v = &mesh->vertices[poly->indices[i]];
 
-		//Check if vertex is convex. Indiex into vertex array by using mesh->indices
-		if (_post_IsVertexConvex(&mesh->vertices[poly->indices[i]], &mesh->vertices[poly->indices[prevIdx]], &mesh->vertices[poly->indices[nextIdx]], &poly->normal) == 1)
+		//Drop the dominant axis. The remaining axes are kept in cyclic order so that a positive normal gives a CCW polygon
+		if (absZ >= absX && absZ >= absY)
+		{
+			x[i] = v->x;
+			y[i] = poly->normal.z >= 0.0f ? v->y : -v->y;
+		}
+		else if (absX >= absY)
 		{
-			convexIndices[vexIdx] = i; //Add vertex as convexVertex
-			vexIdx++; //Increment Counter
+			x[i] = v->y;
+			y[i] = poly->normal.x >= 0.0f ? v->z : -v->z;
 		}
 		else
 		{
-			concaveIndices[aveIdx] = i; //Add vertex as concaveVertex
-			aveIdx++; //Increment Counter
+			x[i] = v->z;
+			y[i] = poly->normal.y >= 0.0f ? v->x : -v->x;
 		}
 	}
+}
+
+int _post_IsCornerConvex2D(PolygonScratch* scratch, uint32_t prev, uint32_t curr, uint32_t next)
+{
+	float cross = (scratch->x[curr] - scratch->x[prev]) * (scratch->y[next] - scratch->y[curr]) -
+		(scratch->y[curr] - scratch->y[prev]) * (scratch->x[next] - scratch->x[curr]);
 
-	return vexIdx; //Only return a vexIdx because aveIdx can be calculated using mesh->vertexCount - vexIdx
+	return cross > 0.0f;
 }
 
-uint32_t _post_FillEars(StardustMesh* mesh, Polygon* poly, uint32_t* convexIndices, uint32_t convexCount, uint32_t* concaveIndices, uint32_t concaveCount, uint32_t* earArray)
+int _post_IsEar(PolygonScratch* scratch, uint32_t prev, uint32_t curr, uint32_t next)
 {
-	uint32_t earIdx = 0;
+	if (scratch->reflex[curr] || !_post_IsCornerConvex2D(scratch, prev, curr, next))
+		return 0;
 
-	for (uint32_t i = 0; i < convexCount; i++)
-	{
-		//Get adjacent indices
-		uint32_t currIdx = poly->indices[convexCount];
-		uint32_t prevIdx = (currIdx + mesh->vertexStride - 1) % mesh->vertexStride;
-		uint32_t nextIdx = (currIdx + 1) % mesh->vertexStride;
+	float ax = scratch->x[prev], ay = scratch->y[prev];
+	float bx = scratch->x[curr], by = scratch->y[curr];
+	float cx = scratch->x[next], cy = scratch->y[next];
 
-		int isEar = 1;
-		for (uint32_t j = 0; j < concaveCount; j++)
-		{
-			if (j == prevIdx || j == nextIdx)
-				continue;
+	//Triangle bounds in grid cells
+	float minX = ax < bx ? (ax < cx ? ax : cx) : (bx < cx ? bx : cx);
+	float maxX = ax > bx ? (ax > cx ? ax : cx) : (bx > cx ? bx : cx);
+	float minY = ay < by ? (ay < cy ? ay : cy) : (by < cy ? by : cy);
+	float maxY = ay > by ? (ay > cy ? ay : cy) : (by > cy ? by : cy);
 
-			if (_post_TriangleContainsPoint(&mesh->vertices[prevIdx], &mesh->vertices[currIdx], &mesh->vertices[nextIdx], &mesh->vertices[j]))
-				isEar = 0;
-		}
+	float inverseCellSize = scratch->gridInverseCellSize;
+	uint32_t cellMinX = _post_GetReflexCell(minX, scratch->gridMinX, inverseCellSize, scratch->gridWidth);
+	uint32_t cellMaxX = _post_GetReflexCell(maxX, scratch->gridMinX, inverseCellSize, scratch->gridWidth);
+	uint32_t cellMinY = _post_GetReflexCell(minY, scratch->gridMinY, inverseCellSize, scratch->gridHeight);
+	uint32_t cellMaxY = _post_GetReflexCell(maxY, scratch->gridMinY, inverseCellSize, scratch->gridHeight);
 
-		if (isEar)
+	//Only reflex vertices can be inside an ear
+	for (uint32_t gy = cellMinY; gy <= cellMaxY; gy++)
+	{
+		for (uint32_t gx = cellMinX; gx <= cellMaxX; gx++)
 		{
-			earArray[earIdx] = i;
-			earIdx++;
+			uint32_t cell = gy * scratch->gridWidth + gx;
+			for (uint32_t j = scratch->cellStart[cell]; j < scratch->cellStart[cell + 1]; j++)
+			{
+				uint32_t v = scratch->cellVertices[j];
+				if (!scratch->reflex[v] || v == prev || v == next)
+					continue;
+
+				float px = scratch->x[v], py = scratch->y[v];
+
+				//Vertices sharing a position with the ear edges are allowed. These appear where a polygon touches itself
+				if ((px == ax && py == ay) || (px == cx && py == cy))
+					continue;
+
+				if (_post_TriangleContainsPoint(ax, ay, bx, by, cx, cy, px, py))
+					return 0;
+			}
 		}
 	}
 
-	return earIdx;
+	return 1;
 }
 
-// ================= Utils ================= //
-
-
-StardustErrorCode _post_RecomputeIndexArray(StardustMesh* mesh)
+void _post_BuildReflexGrid(PolygonScratch* scratch, uint32_t vertexCount, uint32_t reflexCount)
 {
-	uint32_t vertexCount = 0;
+	//Bounds of the polygon
+	float minX = scratch->x[0], maxX = scratch->x[0];
+	float minY = scratch->y[0], maxY = scratch->y[0];
+	for (uint32_t i = 1; i < vertexCount; i++)
+	{
+		if (scratch->x[i] < minX) minX = scratch->x[i];
+		if (scratch->x[i] > maxX) maxX = scratch->x[i];
+		if (scratch->y[i] < minY) minY = scratch->y[i];
+		if (scratch->y[i] > maxY) maxY = scratch->y[i];
+	}
 
-	Vertex* vertexArray = malloc(mesh->vertexCount * sizeof(Vertex)); //Assign max size arrays. reduce later
-	if (vertexArray == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
-	uint32_t* indexArray = malloc(mesh->indexCount * sizeof(uint32_t));
-	if (indexArray == 0) { free(vertexArray);  return STARDUST_ERROR_MEMORY_ERROR; }
+	//Square cells with roughly one reflex vertex per cell. The cell count never exceeds reflexCount
+	float width = maxX - minX;
+	float height = maxY - minY;
+	float cellSize = 0.0f;
+	if (reflexCount > 0)
+		cellSize = (width > 0.0f && height > 0.0f) ? sqrtf(width * height / (float)reflexCount) : (width + height) / (float)reflexCount;
 
-	for (uint32_t i = 0; i < mesh->indexCount; i++)
+	uint32_t gridWidth = 1;
+	uint32_t gridHeight = 1;
+	if (cellSize > 0.0f)
 	{
-		//Get vertex pointer
-		Vertex* meshVertex = &mesh->vertices[mesh->indices[i]];
+		float cellsX = width / cellSize;
+		float cellsY = height / cellSize;
+		gridWidth = cellsX >= 1.0f ? (cellsX < (float)reflexCount ? (uint32_t)cellsX : reflexCount) : 1;
+		gridHeight = cellsY >= 1.0f ? (cellsY < (float)reflexCount ? (uint32_t)cellsY : reflexCount) : 1;
+
+		//Rounding a thin axis up to one cell can push the other past the limit. Either axis can be the thin one
+		if (gridWidth > reflexCount / gridHeight)
+			gridWidth = reflexCount / gridHeight;
+		if (gridWidth == 0)
+			gridWidth = 1;
+		if (gridHeight > reflexCount / gridWidth)
+			gridHeight = reflexCount / gridWidth;
+		if (gridHeight == 0)
+			gridHeight = 1;
+	}
 
-		//Check if vertex exists within vertexArray
-		int found = 0;
-		for (uint32_t j = 0; j < vertexCount; j++)
-		{
-			if (sd_CompareVertex(meshVertex, &(vertexArray[j])))
-			{
-				//Add indice to indexArray
-				indexArray[i] = j;
+	scratch->gridWidth = gridWidth;
+	scratch->gridHeight = gridHeight;
+	scratch->gridMinX = minX;
+	scratch->gridMinY = minY;
+	scratch->gridInverseCellSize = cellSize > 0.0f ? 1.0f / cellSize : 0.0f;
 
-				found = 1;
-				break;
-			}
-		}
+	//Counting sort reflex vertices into cells
+	uint32_t cellCount = gridWidth * gridHeight;
+	memset(scratch->cellStart, 0, sizeof(uint32_t) * (cellCount + 1));
 
-		if (!found)
-		{
-			//Add vertex to array
-			vertexArray[vertexCount] = *meshVertex; //Copy instruction
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		if (scratch->reflex[i])
+			scratch->cellStart[_post_GetReflexCell(scratch->y[i], minY, scratch->gridInverseCellSize, gridHeight) * gridWidth + _post_GetReflexCell(scratch->x[i], minX, scratch->gridInverseCellSize, gridWidth) + 1]++;
+	}
 
-			//Add index to array
-			indexArray[i] = vertexCount;
+	for (uint32_t i = 0; i < cellCount; i++)
+		scratch->cellStart[i + 1] += scratch->cellStart[i];
 
-			//Increment arrays
-			vertexCount++;
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		if (scratch->reflex[i])
+		{
+			uint32_t cell = _post_GetReflexCell(scratch->y[i], minY, scratch->gridInverseCellSize, gridHeight) * gridWidth + _post_GetReflexCell(scratch->x[i], minX, scratch->gridInverseCellSize, gridWidth);
+			scratch->cellVertices[scratch->cellStart[cell]++] = i;
 		}
 	}
 
-	free(mesh->vertices);
-	free(mesh->indices);
+	//Shift offsets back after using them as write cursors
+	for (uint32_t i = cellCount; i > 0; i--)
+		scratch->cellStart[i] = scratch->cellStart[i - 1];
+	scratch->cellStart[0] = 0;
+}
 
-	mesh->vertices = vertexArray;
-	mesh->indices = indexArray;
+uint32_t _post_GetReflexCell(float value, float gridMin, float inverseCellSize, uint32_t cellCount)
+{
+	float cell = (value - gridMin) * inverseCellSize;
+	if (cell <= 0.0f)
+		return 0;
+	if (cell >= (float)(cellCount - 1))
+		return cellCount - 1;
 
-	mesh->vertexCount = vertexCount;
+	return (uint32_t)cell;
+}
+
+StardustErrorCode _post_ReservePolygonScratch(PolygonScratch* scratch, uint32_t vertexCount)
+{
+	if (vertexCount <= scratch->capacity)
+		return STARDUST_ERROR_SUCCESS;
+
+	//Allocate every buffer in one block
+	size_t size = sizeof(float) * 2 * vertexCount + //x, y
+		sizeof(uint32_t) * 2 * vertexCount + //prev, next
+		sizeof(uint32_t) * ((size_t)vertexCount + 1) + //cellStart. The grid never has more cells than vertices
+		sizeof(uint32_t) * vertexCount + //cellVertices
+		sizeof(uint32_t) * vertexCount + //queue
+		(size_t)vertexCount * 2; //reflex, queued
+
+	unsigned char* block = malloc(size);
+	if (block == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
 
-	return STARDUST_ERROR_MEMORY_ERROR;
+	free(scratch->x);
+
+	scratch->x = (float*)block;
+	scratch->y = scratch->x + vertexCount;
+	scratch->prev = (uint32_t*)(scratch->y + vertexCount);
+	scratch->next = scratch->prev + vertexCount;
+	scratch->cellStart = scratch->next + vertexCount;
+	scratch->cellVertices = scratch->cellStart + vertexCount + 1;
+	scratch->queue = scratch->cellVertices + vertexCount;
+	scratch->reflex = (unsigned char*)(scratch->queue + vertexCount);
+	scratch->queued = scratch->reflex + vertexCount;
+
+	scratch->capacity = vertexCount;
+
+	return STARDUST_ERROR_SUCCESS;
 }
 
-int _post_ComarePositions(NormalPosition* norm, Vertex* vertex)
+void _post_FreePolygonScratch(PolygonScratch* scratch)
 {
-	return norm->x == vertex->x &&
-		norm->y == vertex->y &&
-		norm->z == vertex->z &&
-		norm->w == vertex->w;
+	free(scratch->x); //Every buffer is part of the same block
+	memset(scratch, 0, sizeof(PolygonScratch));
 }
 
-int _post_IsVertexConvex(Vertex* vertex, Vertex* vPrev, Vertex* vNext, Vertex* normal)
+// ================= Utils ================= //
+
+
+StardustErrorCode _post_RecomputeIndexArray(StardustMesh* mesh)
 {
-	//Get edges
-	float E1x = vPrev->x - vertex->x;
-	float E1y = vPrev->y - vertex->y;
-	float E1z = vPrev->z - vertex->z;
-	
-	float E2x = vNext->x - vertex->x;
-	float E2y = vNext->y - vertex->y;
-	float E2z = vNext->z - vertex->z;
+	VertexEmitter emitter;
+	StardustErrorCode ret = _post_InitVertexEmitter(&emitter, mesh->vertexCount, mesh->dataType, 0);
+	if (ret != STARDUST_ERROR_SUCCESS) { return ret; }
 
-	//Cross product
-	float crossX = (E1y * E2z) - (E1z * E2y);
-	float crossY = (E1z * E2x) - (E1x * E2z);
-	float crossZ = (E1x * E2y) - (E1y * E2x);
+	//Vertices are read from the old array so the indices can be replaced in place
+	for (uint32_t i = 0; i < mesh->indexCount; i++)
+		mesh->indices[i] = _post_EmitVertex(&emitter, &mesh->vertices[mesh->indices[i]]);
 
-	//Length squared
-	float l2 = crossX*crossX + crossY*crossY + crossZ*crossZ;
+	_post_FinishVertexEmitter(&emitter, mesh);
 
-	if (l2 == 0) //Early exit
-		return 0;
+	return STARDUST_ERROR_SUCCESS;
+}
 
-	//Get signs
-	int xSign = signbit(crossX);
-	int ySign = signbit(crossY);
-	int zSign = signbit(crossZ);
+uint32_t _post_HashVertex(const Vertex* vertex, StardustMeshDataType dataType)
+{
+	uint32_t key[13];
+	uint32_t keyLength = _post_GetVertexKey(vertex, dataType, key);
+
+	return _post_HashWords(key, keyLength, 0);
+}
 
-	int xSignNormal = signbit(normal->x);
-	int ySignNormal = signbit(normal->y);
-	int zSignNormal = signbit(normal->z);
+int _post_CompareVertexData(const Vertex* a, const Vertex* b, StardustMeshDataType dataType)
+{
+	uint32_t keyA[13];
+	uint32_t keyB[13];
 
-	if (xSign != xSignNormal || ySign != ySignNormal || zSign != zSignNormal) //Return -1 if concave
-		return 1;
-	return -1; //Return 1 if convex
+	uint32_t keyLength = _post_GetVertexKey(a, dataType, keyA);
+	_post_GetVertexKey(b, dataType, keyB);
 
+	return memcmp(keyA, keyB, keyLength * sizeof(uint32_t)) == 0;
 }
 
-//Came from some stack overflow post. Can't remember which one. 
-int _post_TriangleContainsPoint(Vertex* a, Vertex* b, Vertex* c, Vertex* p)
+uint32_t _post_GetVertexKey(const Vertex* vertex, StardustMeshDataType dataType, uint32_t* key)
 {
-	float A = 0.5f * (b->y * c->x + a->y * (-b->x + c->x) + a->x * (b->y - c->y) + b->x * c->y);
-	float sign = A > 0.0f ? 1.0f : -1.0f;
-	float s = (a->y * c->x - a->x * c->y + (c->y - a->y) * p->x + (a->x - c->x) * p->y) * sign;
-	float t = (a->x * b->y - a->y * b->x + (a->y - b->y) * p->x + (b->x - a->x) * p->y) * sign;
+	//Each attribute is contiguous in the Vertex struct so they can be copied as blocks of bits
+	uint32_t length = 0;
+
+	memcpy(key, &vertex->x, 4 * sizeof(float)); //Position is always present
+	length += 4;
+
+	if ((dataType & STARDUST_COLOR_DATA) == STARDUST_COLOR_DATA)
+	{
+		memcpy(key + length, &vertex->r, 3 * sizeof(float));
+		length += 3;
+	}
+
+	if ((dataType & STARDUST_NORMAL_DATA) == STARDUST_NORMAL_DATA)
+	{
+		memcpy(key + length, &vertex->normX, 3 * sizeof(float));
+		length += 3;
+	}
+
+	if ((dataType & STARDUST_TEXTURE_DATA) == STARDUST_TEXTURE_DATA)
+	{
+		memcpy(key + length, &vertex->texU, 3 * sizeof(float));
+		length += 3;
+	}
+
+	//-0.0 and 0.0 compare equal as floats so they need to share a key
+	for (uint32_t i = 0; i < length; i++)
+	{
+		if (key[i] == 0x80000000)
+			key[i] = 0;
+	}
 
-	if (s > 0 && t > 0 && (s + t) < 2 * A * sign)
-		return 1;
-	return 0;
+	return length;
 }
 
-void _post_RemoveFromPolygon(Polygon* poly, uint32_t idx)
+//Murmur3 style mixing on each word
+uint32_t _post_HashWords(const void* words, uint32_t count, uint32_t hash)
 {
-	if (idx == poly->vertexCount - 1)
+	const unsigned char* bytes = words;
+
+	for (uint32_t i = 0; i < count; i++)
 	{
-		poly->vertexCount -= 1;
-		return;
+		uint32_t k;
+		memcpy(&k, bytes + i * sizeof(uint32_t), sizeof(uint32_t));
+
+		k *= 0xCC9E2D51;
+		k = (k << 15) | (k >> 17);
+		k *= 0x1B873593;
+
+		hash ^= k;
+		hash = (hash << 13) | (hash >> 19);
+		hash = hash * 5 + 0xE6546B64;
 	}
 
-	memcpy(poly + idx, poly + idx + 1, (poly->vertexCount - 1) - idx);
+	//Finalise so that the low bits, which are used for the slot, are well mixed
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6B;
+	hash ^= hash >> 13;
+
+	return hash;
+}
+
+uint32_t _post_GetHashTableSize(uint32_t count)
+{
+	uint32_t size = 16;
+	while (size < count * 2ull)
+		size <<= 1;
+
+	return size;
+}
 
-	poly->vertexCount -= 1;
+//Inclusive of the triangle edges so that points lying on an ear's edge block it
+int _post_TriangleContainsPoint(float ax, float ay, float bx, float by, float cx, float cy, float px, float py)
+{
+	return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+		(ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+		(bx - px) * (cy - py) >= (cx - px) * (by - py);
 }
 
 void _post_CalculatePolygonNormal(StardustMesh* mesh, Polygon* poly)
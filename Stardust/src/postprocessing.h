@@ -7,15 +7,35 @@ Documentation
 
 #include "stardust.h"
 
-typedef struct
-{
-	float x;
-	float y;
-	float z;
-	float w;
+#define POST_HASH_EMPTY 0xFFFFFFFF //Marks an unused slot in a post processing hash table
+#define POST_TANGENT_TASK_SIZE 4096 //Triangles or vertices per tangent generation task
+#define POST_MESHLET_MAX_VERTICES 256 //Micro indices are 8 bit
+#define POST_MESHLET_MAX_TRIANGLES 512
+#define POST_VERTEX_CACHE_MIN_SIZE 4 //Smallest cache modelled by the vertex cache optimisation. The 3 most recent vertices are scored separately
+#define POST_EDGE_EMPTY 0xFFFFFFFFFFFFFFFFull //Marks an unused slot in a directed edge hash table
+#define POST_SIMPLIFY_EDGE_WEIGHT 10.0f //Weight of the planes that hold borders and seams in place, relative to the face planes
+#define POST_DEGENERATE_SINE2 1e-12f //Squared sine of the corner angle below which a triangle is treated as having no area
+#define POST_MORTON_TASK_SIZE 4096 //Triangles or vertices per Morton code task
+#define POST_MORTON_AXIS_BITS 10 //Bits of each axis in a Morton code. 3 axes fit in 30 bits
+
+//Stages that build new vertices or triangles. Tangents, meshlets and levels of detail made by an earlier run are dropped before them
+#define POST_REBUILD_STAGES (STARDUST_STAGE_TRIANGULATE | STARDUST_STAGE_GENERATE_NORMALS | STARDUST_STAGE_SMOOTH_NORMALS | STARDUST_STAGE_WELD_VERTICES | \
+	STARDUST_STAGE_REMOVE_DEGENERATES | STARDUST_STAGE_GENERATE_TANGENTS)
 
-	uint32_t index;
-} NormalPosition;
+//Stages whose results only hold for the vertices and triangles they ran on
+#define POST_DERIVED_STAGES (STARDUST_STAGE_GENERATE_TANGENTS | STARDUST_STAGE_OPTIMIZE_VERTEX_CACHE | STARDUST_STAGE_OPTIMIZE_OVERDRAW | \
+	STARDUST_STAGE_OPTIMIZE_VERTEX_FETCH | STARDUST_STAGE_BUILD_MESHLETS | STARDUST_STAGE_GENERATE_LODS | STARDUST_STAGE_SORT_TRIANGLES | STARDUST_STAGE_SORT_VERTICES)
+
+//Texture space orientation of a triangle
+#define POST_TANGENT_PRESERVING 1 //UVs wind the same way as the positions
+#define POST_TANGENT_MIRRORED 2 //UVs are mirrored
+#define POST_TANGENT_DEGENERATE 0 //UVs have no area. Takes the tangent of whichever triangles share its vertices
+
+//How a position may move during simplification
+#define POST_VERTEX_MANIFOLD 0 //Surrounded by triangles with one set of attributes. Can collapse onto any neighbour
+#define POST_VERTEX_BORDER 1 //On an open edge. Can only collapse along the border
+#define POST_VERTEX_SEAM 2 //Has 2 vertices on either side of an attribute seam. Can only collapse along the seam
+#define POST_VERTEX_LOCKED 3 //Corners, seam ends and non manifold positions. Never moves
 
 typedef struct 
 {
@@ -24,6 +44,149 @@ typedef struct
 	Vertex normal;
 } Polygon;
 
+//Scratch memory for ear clipping. Reused between polygons so that clipping doesn't allocate per polygon
+typedef struct
+{
+	uint32_t capacity;
+
+	float* x; //Projected 2D positions
+	float* y;
+	uint32_t* prev; //Linked list of the remaining vertices
+	uint32_t* next;
+	unsigned char* reflex; //1 while a vertex is reflex. Cleared when it becomes convex or is clipped
+	uint32_t* queue; //Circular queue of ear candidates
+	unsigned char* queued; //1 while a vertex is in the queue
+
+	//Uniform grid of the reflex vertices. Vertices of cell c are cellVertices[cellStart[c]] to cellVertices[cellStart[c + 1] - 1]
+	uint32_t* cellStart;
+	uint32_t* cellVertices;
+	uint32_t gridWidth;
+	uint32_t gridHeight;
+	float gridMinX;
+	float gridMinY;
+	float gridInverseCellSize;
+} PolygonScratch;
+
+//The stages post processing will run for a mesh
+typedef struct
+{
+	StardustPostProcessStages stages;	//STARDUST_STAGE_* bits
+	float creaseAngle;					//Crease angle used by STARDUST_STAGE_GENERATE_NORMALS
+} PostProcessPlan;
+
+//Collects the vertices of a mesh that is being rebuilt.
+//Exact duplicates share a vertex and, when welding, vertices within the weld tolerances of each other share a vertex
+typedef struct
+{
+	StardustMeshDataType dataType;
+
+	//Exact deduplication
+	Vertex* unique;
+	uint32_t uniqueCount;
+	uint32_t* table; //Open addressing hash table of indices into unique
+	uint32_t tableSize;
+
+	//Welding. Only used when weld is not 0
+	const StardustPostProcessSettings* weld;
+	uint32_t* uniqueOutput; //Output vertex of every unique vertex
+	float inverseCellSize;
+	float positionTolerance2;
+	float normalCosine;
+	uint32_t* buckets; //Grid cells hashed into buckets. Each bucket is a linked list of output vertices through cellNext
+	uint32_t bucketCount;
+	uint32_t* cellNext;
+
+	//Output. Same array as unique when not welding
+	Vertex* vertices;
+	uint32_t vertexCount;
+} VertexEmitter;
+
+//Shared state of the tangent generation tasks
+typedef struct
+{
+	const StardustMesh* mesh;
+
+	float* cornerTangents;			//Angle weighted tangent of every corner. 3 floats per corner
+	unsigned char* orientations;	//POST_TANGENT_* of every triangle
+
+	//Corners of vertex v are vertexCorners[cornerStart[v]] to vertexCorners[cornerStart[v + 1] - 1]
+	uint32_t* cornerStart;
+	uint32_t* vertexCorners;
+
+	Tangent* tangents;				//Tangent of every vertex
+	Tangent* mirrored;				//Tangent of the mirrored copy of a vertex. Only set for vertices that need splitting
+	unsigned char* vertexOrientations; //POST_TANGENT_PRESERVING and POST_TANGENT_MIRRORED bits of the triangles around every vertex
+} TangentContext;
+
+//Shared state of the Morton code tasks
+typedef struct
+{
+	const StardustMesh* mesh;
+	float minimum[3];		//Smallest corner of the mesh's box
+	float scale[3];			//Maps the box onto 0 to 2^POST_MORTON_AXIS_BITS - 1. 0 on axes where the box is flat
+
+	uint32_t* codes;		//Morton code of every triangle or vertex
+	uint32_t* order;		//Filled with 0 to count - 1. Sorted along with the codes
+} MortonContext;
+//A run of triangles kept together by the overdraw optimisation
+typedef struct
+{
+	uint32_t start;		//First triangle
+	uint32_t count;		//Number of triangles
+	float occlusion;	//How likely the cluster is to hide the rest of the mesh
+} TriangleCluster;
+
+//Symmetric 4x4 matrix summing the squared distances to a set of weighted planes
+typedef struct
+{
+	float a00, a01, a02, a11, a12, a22;
+	float b0, b1, b2;
+	float c;
+	float weight;		//Summed plane weights. The error is divided by this so that it is a distance squared
+} Quadric;
+
+//A queued collapse of the position from onto the position to
+typedef struct
+{
+	float cost;
+	uint32_t from;
+	uint32_t to;
+	uint32_t fromVersion;	//Versions of the positions when the cost was calculated. The collapse is stale if either changed
+	uint32_t toVersion;
+} EdgeCollapse;
+
+//Working state of the edge collapse simplification. Collapses work on positions, called groups, which may have several vertices (wedges)
+typedef struct
+{
+	const Vertex* vertices;
+	uint32_t* indices;			//Triangles being simplified. Corners are rewritten as positions collapse
+	uint32_t indexCount;
+	unsigned char* removed;		//1 once a triangle has collapsed
+	uint32_t liveTriangles;
+
+	uint32_t* vertexGroups;		//Position group of every vertex
+	uint32_t groupCount;
+	uint32_t* wedgeStart;		//Vertices of group g are wedges[wedgeStart[g]] to wedges[wedgeStart[g + 1] - 1]
+	uint32_t* wedges;
+
+	float* positions;			//Position of every group scaled into the unit cube. 3 floats per group
+	unsigned char* kinds;		//POST_VERTEX_* of every group
+	Quadric* quadrics;
+	uint32_t* versions;			//Bumped whenever a group takes part in a collapse
+
+	//Corners of every group as linked lists, so that the corners of a collapsed group can be handed over in O(1)
+	uint32_t* cornerHead;
+	uint32_t* cornerTail;
+	uint32_t* cornerNext;
+
+	uint32_t* marks;			//Scratch marks of groups for the link condition. A group is marked when it equals markStamp
+	uint32_t markStamp;
+
+	EdgeCollapse* heap;			//Binary min heap of collapses by cost
+	uint32_t heapCount;
+	uint32_t heapCapacity;
+} SimplifyState;
+
 // ==================== Functions ==================== //
 
 /// <summary>
@@ -35,12 +198,141 @@ StardustErrorCode _post_PerformPostProcessing(StardustMesh* mesh, StardustMeshFl
 
 
 
+/// <summary>
+/// Plans the post processing stages for a mesh from the flags and the data already in the mesh.
+/// Stages that would do nothing are left out, and stages that can share a pass are marked as fused.
+/// Generating normals builds a new vertex array, so welding is fused into it. Flat normals also fuse triangulation
+/// as they only need one polygon at a time.
+/// </summary>
+/// <param name="mesh">Mesh that will be processed</param>
+/// <param name="flags">The post processing flags</param>
+/// <param name="settings">Post processing settings</param>
+/// <param name="plan">Plan to fill</param>
+void _post_PlanPostProcessing(const StardustMesh* mesh, StardustMeshFlags flags, const StardustPostProcessSettings* settings, PostProcessPlan* plan);
+
+
+
+/// <summary>
+/// Frees the tangents, meshlets and levels of detail of a mesh and clears the POST_DERIVED_STAGES bits.
+/// Used when post processing runs again on a mesh and is about to replace its vertices or triangles.
+/// </summary>
+/// <param name="mesh">Mesh to clear</param>
+void _post_FreeDerivedData(StardustMesh* mesh);
+
+
+
+/// <summary>
+/// Gets the post processing settings shared by every load.
+/// sd_GetPostProcessSettings and sd_SetPostProcessSettings copy to and from this.
+/// </summary>
+/// <returns>Pointer to the settings</returns>
+StardustPostProcessSettings* _post_GetSettings();
+
+
+
+// Degenerate Triangles //
+
+/// <summary>
+/// Removes triangles that repeat an index or whose edges are parallel, then removes the vertices no remaining triangle uses.
+/// A triangle is degenerate when the squared sine of the angle between two of its edges is below POST_DEGENERATE_SINE2,
+/// which doesn't depend on its size. Runs in one pass over the triangles and one over the vertices. The kept triangles
+/// and vertices stay in order, so the vertices are compacted in place through a remap table.
+/// </summary>
+/// <param name="mesh">Triangulated mesh</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_RemoveDegenerates(StardustMesh* mesh);
+
+/// <summary>
+/// Checks whether a triangle has no area
+/// </summary>
+/// <returns>1 if the triangle is degenerate. Otherwise 0</returns>
+int _post_IsTriangleDegenerate(const Vertex* a, const Vertex* b, const Vertex* c);
+
+
+
+// Vertex Welding //
+
+/// <summary>
+/// Merges vertices whose attributes are within the given tolerances of each other.
+/// Positions are bucketed into a uniform grid with a cell size of the position tolerance. Each vertex only
+/// checks the 27 cells around it, so this runs in near linear time.
+/// The first vertex found in a cluster is kept and all other vertices in the cluster are remapped to it.
+/// Exact duplicates are always merged, so a position tolerance of zero only removes duplicates.
+/// Unreferenced vertices are kept.
+/// </summary>
+/// <param name="mesh">Mesh to weld</param>
+/// <param name="settings">Settings containing the weld tolerances</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_WeldVertices(StardustMesh* mesh, const StardustPostProcessSettings* settings);
+
+/// <summary>
+/// Checks whether two vertices are within the weld tolerances.
+/// Only attributes present in dataType are compared. W and color must match exactly.
+/// </summary>
+/// <param name="a">Vertex A</param>
+/// <param name="b">Vertex B</param>
+/// <param name="dataType">The data type of the mesh the vertices belong to</param>
+/// <param name="positionTolerance2">Squared position tolerance</param>
+/// <param name="normalCosine">Cosine of the normal angle tolerance</param>
+/// <param name="uvTolerance">Texture coordinate tolerance</param>
+/// <returns>1 if the vertices can be welded. Otherwise 0</returns>
+int _post_CanWeldVertices(const Vertex* a, const Vertex* b, StardustMeshDataType dataType, float positionTolerance2, float normalCosine, float uvTolerance);
+
+/// <summary>
+/// Gets the grid cell coordinate of a position component.
+/// The result is clamped so that very large positions can't overflow.
+/// </summary>
+/// <param name="value">Position component</param>
+/// <param name="inverseCellSize">1 / cell size</param>
+/// <returns>Cell coordinate</returns>
+int32_t _post_GetGridCell(float value, float inverseCellSize);
+
+
+
+// Vertex Emitter //
+
+/// <summary>
+/// Prepares an emitter for up to maxVertexCount vertices
+/// </summary>
+/// <param name="emitter">Emitter to initialise</param>
+/// <param name="maxVertexCount">Maximum number of vertices that will be emitted</param>
+/// <param name="dataType">Data type of the emitted vertices. Only these attributes are compared</param>
+/// <param name="weld">Settings with the weld tolerances. 0, or a position tolerance of 0, only merges exact duplicates</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_InitVertexEmitter(VertexEmitter* emitter, uint32_t maxVertexCount, StardustMeshDataType dataType, const StardustPostProcessSettings* weld);
+
+/// <summary>
+/// Adds a vertex to the emitter.
+/// Exact duplicates are found through a hash table. New vertices are then welded the same way as _post_WeldVertices.
+/// </summary>
+/// <param name="emitter">Emitter</param>
+/// <param name="vertex">Vertex to add</param>
+/// <returns>Index of the output vertex</returns>
+uint32_t _post_EmitVertex(VertexEmitter* emitter, const Vertex* vertex);
+
+/// <summary>
+/// Replaces the vertices of a mesh with the emitted vertices and frees the emitter.
+/// The indices of the mesh are not changed
+/// </summary>
+/// <param name="emitter">Emitter</param>
+/// <param name="mesh">Mesh to set the vertices of</param>
+void _post_FinishVertexEmitter(VertexEmitter* emitter, StardustMesh* mesh);
+
+/// <summary>
+/// Frees an emitter without using its vertices
+/// </summary>
+/// <param name="emitter">Emitter</param>
+void _post_FreeVertexEmitter(VertexEmitter* emitter);
+
+
+
 // Normal Smoothing //
 
 /// <summary>
 /// Smooths the normals of mesh.
 /// This may reduce the amount of verticies in the mesh.
 /// This is done by getting all verticies of the same position and averaging their normals.
+/// Vertices are grouped by position with the hash table of the adjacency builder, so it runs in linear time.
 /// </summary>
 /// <param name="mesh">Mesh to be smoothed</param>
 StardustErrorCode _post_SmoothNormals(StardustMesh* mesh);
@@ -50,22 +342,528 @@ StardustErrorCode _post_SmoothNormals(StardustMesh* mesh);
 // Normal Hardening / Generate normals //
 
 /// <summary>
-/// Regenerates the normals for a mesh as face normals.
-/// This can be used to "harden normals" as well
+/// Generates the normals for a mesh in a single pass.
+/// Face normals are calculated once and each corner accumulates the weighted normals of the faces around its position
+/// that are within creaseAngle of its own face. Vertices are only split where that produces a different normal.
+/// A crease angle of 0 gives hard face normals. This can be used to "harden normals" as well
+/// A crease angle of PI smooths every edge.
 /// This may increase the amount of verticies in the mesh
-/// This is done by calculating the face normal of each mesh and creating verticies using it.
 /// This function will recalculate the indices of the mesh
 /// </summary>
-/// <param name="mesh"></param>
+/// <param name="mesh">Mesh to generate normals for. Triangulated if it isn't already</param>
+/// <param name="creaseAngle">Angle in radians between two faces above which the edge between them is kept hard</param>
+/// <param name="weighting">How each face contributes to a vertex normal</param>
+/// <param name="weld">Settings to weld the new vertices with. 0 only merges exact duplicates</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_GenerateNormals(StardustMesh* mesh, float creaseAngle, StardustNormalWeighting weighting, const StardustPostProcessSettings* weld);
+
+/// <summary>
+/// Generates hard normals for a mesh that is not triangulated.
+/// Each polygon is triangulated and given normals on its own, so no triangulated index buffer or face normal array is built.
+/// </summary>
+/// <param name="mesh">Mesh with a vertex stride above 3</param>
+/// <param name="weld">Settings to weld the new vertices with. 0 only merges exact duplicates</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_GenerateFlatNormals(StardustMesh* mesh, const StardustPostProcessSettings* weld);
+
+/// <summary>
+/// Calculates the unit face normal of every triangle and the weight of each corner.
+/// Degenerate triangles get a zero normal.
+/// The normals are calculated by the kernel from _post_GetFaceNormalKernel for the instruction set in the settings.
+/// </summary>
+/// <param name="mesh">Triangulated mesh</param>
+/// <param name="weighting">Weighting used to fill cornerWeights</param>
+/// <param name="faceNormals">Array of size (mesh->indexCount / 3) * 3 to fill with face normals</param>
+/// <param name="cornerWeights">Array of size mesh->indexCount to fill with corner weights</param>
+void _post_CalculateFaceNormals(StardustMesh* mesh, StardustNormalWeighting weighting, float* faceNormals, float* cornerWeights);
+
+/// <summary>
+/// Calculates the normal and the magnitude of the cross product (twice the area) of triangleCount triangles.
+/// Face normals are written 3 floats per triangle and the magnitude to each of the 3 corner weights of a triangle.
+/// Degenerate triangles keep their unnormalised cross product.
+/// </summary>
+/// <param name="vertices">Vertex array</param>
+/// <param name="indices">Index array of 3 indices per triangle</param>
+/// <param name="triangleCount">Number of triangles</param>
+/// <param name="deterministic">When 0 the SIMD kernels may approximate the normalisation</param>
+/// <param name="faceNormals">Array of triangleCount * 3 floats to fill</param>
+/// <param name="cornerWeights">Array of triangleCount * 3 floats to fill</param>
+typedef void (*FaceNormalKernel)(const Vertex* vertices, const uint32_t* indices, uint32_t triangleCount, int deterministic, float* faceNormals, float* cornerWeights);
+
+/// <summary>
+/// Picks the fastest face normal kernel for the CPU, capped by requested
+/// </summary>
+/// <param name="requested">Highest instruction set allowed</param>
+/// <param name="vertexCount">Number of vertices in the mesh. Meshes too large for 32 bit gather offsets stay on SSE2</param>
+/// <returns>Kernel function</returns>
+FaceNormalKernel _post_GetFaceNormalKernel(StardustInstructionSet requested, uint32_t vertexCount);
+
+//Face normal kernels. 1, 4, 8 and 16 triangles at a time. See FaceNormalKernel
+void _post_FaceNormalsScalar(const Vertex* vertices, const uint32_t* indices, uint32_t triangleCount, int deterministic, float* faceNormals, float* cornerWeights);
+void _post_FaceNormalsSSE2(const Vertex* vertices, const uint32_t* indices, uint32_t triangleCount, int deterministic, float* faceNormals, float* cornerWeights);
+void _post_FaceNormalsAVX2(const Vertex* vertices, const uint32_t* indices, uint32_t triangleCount, int deterministic, float* faceNormals, float* cornerWeights);
+void _post_FaceNormalsAVX512(const Vertex* vertices, const uint32_t* indices, uint32_t triangleCount, int deterministic, float* faceNormals, float* cornerWeights);
+
+/// <summary>
+/// Calculates the angle of a triangle corner
+/// </summary>
+/// <param name="corner">Vertex at the corner</param>
+/// <param name="next">Next vertex in the triangle</param>
+/// <param name="prev">Previous vertex in the triangle</param>
+/// <returns>Angle in radians</returns>
+float _post_GetCornerAngle(Vertex* corner, Vertex* next, Vertex* prev);
+
+
+
+// Adjacency //
+
+/// <summary>
+/// Groups the vertices of a mesh by position. Groups are numbered in order of their first vertex
+/// </summary>
+/// <param name="mesh">Mesh to group</param>
+/// <param name="vertexGroups">Array of mesh->vertexCount to fill with the group of every vertex</param>
+/// <param name="groupCount">Filled with the number of groups</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_GroupPositions(const StardustMesh* mesh, uint32_t* vertexGroups, uint32_t* groupCount);
+
+/// <summary>
+/// Groups the vertices of a mesh by position and builds the list of corners (index positions) around each position.
+/// With halfEdges set the half-edges are also paired. Smooth normal generation only needs the corners and skips that.
+/// The arrays are freed with _post_FreeAdjacency.
+/// </summary>
+/// <param name="mesh">Mesh to build from. The face size is taken from vertexStride</param>
+/// <param name="halfEdges">1 to fill adjacency->twins. Otherwise it is left at 0</param>
+/// <param name="adjacency">Adjacency to fill</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_BuildAdjacency(const StardustMesh* mesh, int halfEdges, StardustAdjacency* adjacency);
+
+/// <summary>
+/// Pairs every half-edge with the half-edge running the other way between the same positions.
+/// Directed edges go into a hash table keyed on their positions, then every half-edge looks up its reverse.
+/// </summary>
+/// <param name="mesh">Mesh the adjacency belongs to</param>
+/// <param name="adjacency">Adjacency with its positions grouped. adjacency->twins is allocated and filled</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_PairHalfEdges(const StardustMesh* mesh, StardustAdjacency* adjacency);
+
+/// <summary>
+/// Frees the arrays of an adjacency and zeroes it. Safe on partially built adjacencies
+/// </summary>
+void _post_FreeAdjacency(StardustAdjacency* adjacency);
+
+
+
+// Tangent Generation //
+
+/// <summary>
+/// Generates a MikkTSpace tangent for every vertex into mesh->tangents.
+/// Triangles are processed in parallel and each corner projects its triangle's tangent onto the vertex normal, weighted by the corner angle.
+/// The corners around each vertex are then summed in parallel, keeping mirrored and preserving triangles apart.
+/// Vertices used by both are split so that the mirrored triangles get their own copy with a handedness of -1.
+/// </summary>
+/// <param name="mesh">Triangulated mesh with normal and texture data</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_GenerateTangents(StardustMesh* mesh);
+
+/// <summary>
+/// t_ParallelFor task filling the corner tangents and orientations of POST_TANGENT_TASK_SIZE triangles
+/// </summary>
+/// <param name="context">TangentContext</param>
+/// <param name="index">Task index</param>
+/// <returns>STARDUST_ERROR_SUCCESS</returns>
+StardustErrorCode _post_TangentTriangleTask(void* context, uint32_t index);
+
+/// <summary>
+/// t_ParallelFor task summing the corner tangents around POST_TANGENT_TASK_SIZE vertices
+/// </summary>
+/// <param name="context">TangentContext</param>
+/// <param name="index">Task index</param>
+/// <returns>STARDUST_ERROR_SUCCESS</returns>
+StardustErrorCode _post_TangentVertexTask(void* context, uint32_t index);
+
+/// <summary>
+/// Normalises a summed tangent and stores it with a handedness.
+/// Tangents with no length are replaced by any unit vector perpendicular to the normal
+/// </summary>
+/// <param name="sum">Summed tangent</param>
+/// <param name="vertex">Vertex the tangent belongs to</param>
+/// <param name="handedness">1 or -1</param>
+/// <param name="tangent">Tangent to fill</param>
+void _post_FinishTangent(const float* sum, const Vertex* vertex, float handedness, Tangent* tangent);
+
+
+
+// Vertex Cache Optimization //
+
+/// <summary>
+/// Reorders the triangles of a mesh for the post transform vertex cache with Tom Forsyth's algorithm.
+/// Vertices are scored by their position in a simulated LRU cache and by how few triangles still use them.
+/// The highest scoring triangle around the cache is emitted next, so only the triangles of vertices that were in the cache are rescored.
+/// When none are left the next unused triangle in the original order is taken. This runs in linear time with the triangle count.
+/// mesh->acmr is set to the resulting ACMR.
+/// </summary>
+/// <param name="mesh">Triangulated mesh</param>
+/// <param name="cacheSize">Number of vertices in the simulated cache</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_OptimizeVertexCache(StardustMesh* mesh, uint32_t cacheSize);
+
+/// <summary>
+/// Lists the triangles around every vertex of a triangulated mesh.
+/// The triangles of vertex v are vertexTriangles[triangleStart[v]] onwards. Only the first liveTriangles[v] of them are still in use,
+/// so passes that consume triangles can remove them with _post_RemoveLiveTriangle.
+/// </summary>
+/// <param name="mesh">Triangulated mesh</param>
+/// <param name="triangleStart">Array of mesh->vertexCount + 1 offsets to fill</param>
+/// <param name="vertexTriangles">Array of mesh->indexCount triangle indices to fill</param>
+/// <param name="liveTriangles">Array of mesh->vertexCount counts to fill</param>
+void _post_BuildVertexTriangles(const StardustMesh* mesh, uint32_t* triangleStart, uint32_t* vertexTriangles, uint32_t* liveTriangles);
+
+/// <summary>
+/// Removes a triangle from the live triangles of its vertices
+/// </summary>
+/// <param name="mesh">Mesh the lists were built from</param>
+/// <param name="triangle">Triangle index</param>
+/// <param name="triangleStart">From _post_BuildVertexTriangles</param>
+/// <param name="vertexTriangles">From _post_BuildVertexTriangles</param>
+/// <param name="liveTriangles">From _post_BuildVertexTriangles</param>
+void _post_RemoveLiveTriangle(const StardustMesh* mesh, uint32_t triangle, const uint32_t* triangleStart, uint32_t* vertexTriangles, uint32_t* liveTriangles);
+
+/// <summary>
+/// Scores a vertex for _post_OptimizeVertexCache
+/// </summary>
+/// <param name="cachePosition">Position of the vertex in the cache, -1 if not cached</param>
+/// <param name="liveTriangles">Number of triangles that use the vertex and haven't been emitted</param>
+/// <param name="cacheSize">Number of vertices in the cache</param>
+/// <returns>Score. Vertices without live triangles score -1</returns>
+float _post_GetVertexCacheScore(int32_t cachePosition, uint32_t liveTriangles, uint32_t cacheSize);
+
+/// <summary>
+/// Calculates the average cache miss ratio of a triangle list with a FIFO cache
+/// </summary>
+/// <param name="indices">Index array of 3 indices per triangle</param>
+/// <param name="indexCount">Number of indices</param>
+/// <param name="vertexCount">Number of vertices the indices refer to</param>
+/// <param name="cacheSize">Number of vertices in the cache</param>
+/// <returns>Cache misses per triangle. 0 without triangles, or if the memory for the simulation can't be allocated</returns>
+float _post_CalculateACMR(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize);
+
+
+
+/// <summary>
+/// Runs one triangle through a FIFO cache simulation.
+/// A vertex is cached while fewer than cacheSize misses happened since it was loaded, so adding cacheSize to misses empties the cache
+/// </summary>
+/// <param name="triangle">3 indices</param>
+/// <param name="loadedAt">Miss count at which each vertex was loaded. Zeroed before the first triangle</param>
+/// <param name="misses">Running miss count</param>
+/// <param name="cacheSize">Number of vertices in the cache</param>
+/// <returns>Number of vertices of the triangle that missed</returns>
+uint32_t _post_SimulateVertexCache(const uint32_t* triangle, uint32_t* loadedAt, uint32_t* misses, uint32_t cacheSize);
+
+
+
+// Overdraw Optimization //
+
+/// <summary>
+/// Reorders the clusters of a cache optimised mesh so that the ones most likely to occlude the rest of the mesh are drawn first.
+/// This is the Tipsify overdraw pass of Sander et al. The index buffer is cut into patches wherever a triangle misses on all of its vertices,
+/// and each patch is cut further wherever its ACMR with a cold cache is within threshold of the ACMR of the whole patch.
+/// Clusters are sorted by how far their centre is in front of the mesh centre along their normal.
+/// mesh->acmr is set to the resulting ACMR.
+/// </summary>
+/// <param name="mesh">Triangulated mesh, usually after _post_OptimizeVertexCache</param>
+/// <param name="cacheSize">Number of vertices in the simulated FIFO cache</param>
+/// <param name="threshold">How much worse the ACMR of a cluster may be than its patch. Higher gives smaller clusters</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_OptimizeOverdraw(StardustMesh* mesh, uint32_t cacheSize, float threshold);
+
+/// <summary>
+/// Gets the centre, unit normal and area of a triangle
+/// </summary>
+/// <param name="mesh">Triangulated mesh</param>
+/// <param name="triangle">Triangle index</param>
+/// <param name="centre">3 floats to fill with the centre</param>
+/// <param name="normal">3 floats to fill with the normal. Left unnormalised for degenerate triangles</param>
+/// <returns>Area of the triangle</returns>
+float _post_GetTriangleCentreNormal(const StardustMesh* mesh, uint32_t triangle, float* centre, float* normal);
+
+/// <summary>
+/// qsort comparison putting the clusters with the highest occlusion potential first
+/// </summary>
+/// <returns>Less than 0 if a goes first, more than 0 if b goes first</returns>
+int _post_CompareClusters(const void* a, const void* b);
+
+
+
+// Vertex Fetch Optimization //
+
+/// <summary>
+/// Renumbers the vertices of a mesh in the order the index buffer first uses them.
+/// Vertices that no index uses keep their relative order after the used ones.
+/// </summary>
+/// <param name="mesh">Mesh to renumber</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_OptimizeVertexFetch(StardustMesh* mesh);
+
+/// <summary>
+/// Moves every vertex of a mesh to a new index. Every per vertex stream, currently the vertices and tangents, is permuted and the indices,
+/// including the meshlet vertices and levels of detail, are updated.
+/// </summary>
+/// <param name="mesh">Mesh to remap</param>
+/// <param name="remap">New index of every vertex. Must be a permutation of 0 to mesh->vertexCount - 1</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_RemapVertices(StardustMesh* mesh, const uint32_t* remap);
+
+
+
+// Spatial Sorting //
+
+/// <summary>
+/// Reorders the triangles of a mesh by the Morton code of their centroids inside the box around the vertices.
+/// Codes are worked out in parallel and sorted with the parallel radix sort, which is stable, so triangles with the same code keep their order.
+/// </summary>
+/// <param name="mesh">Triangulated mesh</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_SortTrianglesSpatial(StardustMesh* mesh);
+
+/// <summary>
+/// Renumbers the vertices of a mesh by the Morton code of their positions inside the box around the vertices.
+/// The vertices are moved with _post_RemapVertices, so every index buffer follows them.
+/// </summary>
+/// <param name="mesh">Mesh to renumber</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_SortVerticesSpatial(StardustMesh* mesh);
+
+/// <summary>
+/// Finds the box around the vertices of a mesh and the scale that maps it onto the Morton code grid
+/// </summary>
+/// <param name="mesh">Mesh with at least one vertex</param>
+/// <param name="context">Filled with the minimum and scale</param>
+void _post_InitMortonContext(const StardustMesh* mesh, MortonContext* context);
+
+/// <summary>
+/// t_ParallelFor task calculating the Morton codes of the centroids of POST_MORTON_TASK_SIZE triangles
+/// </summary>
+/// <param name="context">MortonContext</param>
+/// <param name="index">Task index</param>
+/// <returns>STARDUST_ERROR_SUCCESS</returns>
+StardustErrorCode _post_TriangleMortonTask(void* context, uint32_t index);
+
+/// <summary>
+/// t_ParallelFor task calculating the Morton codes of POST_MORTON_TASK_SIZE vertices
+/// </summary>
+/// <param name="context">MortonContext</param>
+/// <param name="index">Task index</param>
+/// <returns>STARDUST_ERROR_SUCCESS</returns>
+StardustErrorCode _post_VertexMortonTask(void* context, uint32_t index);
+
+/// <summary>
+/// Calculates the Morton code of a point. Points outside the box and NaNs are clamped onto it
+/// </summary>
+/// <param name="context">Box and scale of the grid</param>
+/// <param name="x">X position</param>
+/// <param name="y">Y position</param>
+/// <param name="z">Z position</param>
+/// <returns>Code with the bits of x, y and z interleaved. x holds the lowest bit</returns>
+uint32_t _post_GetMortonCode(const MortonContext* context, float x, float y, float z);
+
+/// <summary>
+/// Spreads the low 10 bits of a value out so that there are 2 zero bits between each of them
+/// </summary>
+/// <returns>Spread bits</returns>
+uint32_t _post_SpreadBits(uint32_t value);
+
+
+
+// Meshlets //
+
+/// <summary>
+/// Splits a triangulated mesh into meshlets and fills the meshlet arrays of the mesh.
+/// A meshlet grows from a seed by adding the triangle around its vertices that adds the fewest new vertices, with ties going to the triangle
+/// closest to the meshlet's centre. A new meshlet is seeded next to the last one, or from the first unused triangle when nothing is next to it.
+/// </summary>
+/// <param name="mesh">Triangulated mesh</param>
+/// <param name="maxVertices">Maximum vertices per meshlet. Clamped to 3 to POST_MESHLET_MAX_VERTICES</param>
+/// <param name="maxTriangles">Maximum triangles per meshlet. Clamped to 1 to POST_MESHLET_MAX_TRIANGLES</param>
 /// <returns>Error code</returns>
-StardustErrorCode _post_GenerateNormals(StardustMesh* mesh);
+StardustErrorCode _post_BuildMeshlets(StardustMesh* mesh, uint32_t maxVertices, uint32_t maxTriangles);
+
+/// <summary>
+/// Calculates the bounding sphere and normal cone of a meshlet.
+/// The sphere is centred on the bounds of the vertices. The cone axis is the average triangle normal, and the cone is only
+/// usable when every triangle normal is within about 84 degrees of it.
+/// </summary>
+/// <param name="mesh">Mesh the meshlet was built from</param>
+/// <param name="meshlet">Meshlet with its offsets and counts set</param>
+/// <param name="meshletVertices">Meshlet vertex array</param>
+/// <param name="meshletTriangles">Meshlet micro index array</param>
+void _post_CalculateMeshletBounds(const StardustMesh* mesh, StardustMeshlet* meshlet, const uint32_t* meshletVertices, const uint8_t* meshletTriangles);
+
+/// <summary>
+/// Gets the unit normal of a meshlet triangle
+/// </summary>
+/// <param name="mesh">Mesh the meshlet was built from</param>
+/// <param name="vertices">Vertices of the meshlet</param>
+/// <param name="triangle">3 micro indices</param>
+/// <param name="normal">3 floats to fill</param>
+/// <returns>1 on success. 0 for degenerate triangles</returns>
+int _post_GetMeshletTriangleNormal(const StardustMesh* mesh, const uint32_t* vertices, const uint8_t* triangle, float* normal);
+
+/// <summary>
+/// Frees the meshlet arrays of a mesh and zeroes them
+/// </summary>
+/// <param name="mesh">Mesh</param>
+void _post_FreeMeshlets(StardustMesh* mesh);
+
+
+
+// Simplification //
+
+/// <summary>
+/// Simplifies a triangle list by collapsing edges in order of their quadric error, following Garland and Heckbert.
+/// Each position collapses onto one of its neighbours, so the result only uses vertices that indices already uses.
+/// Positions on borders and attribute seams only move along them, and collapses that would flip a triangle are skipped.
+/// </summary>
+/// <param name="mesh">Mesh with the vertices the indices refer to</param>
+/// <param name="indices">Triangle list to simplify</param>
+/// <param name="indexCount">Number of indices</param>
+/// <param name="targetIndexCount">Stops once at most this many indices are left</param>
+/// <param name="targetError">Stops before a collapse with a larger error. Relative to the largest extent of the mesh</param>
+/// <param name="destination">Array of indexCount indices to fill. Can't be indices</param>
+/// <param name="resultCount">Filled with the number of indices written</param>
+/// <param name="resultError">Filled with the largest error of any collapse</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_SimplifyIndices(const StardustMesh* mesh, const uint32_t* indices, uint32_t indexCount, uint32_t targetIndexCount, float targetError, uint32_t* destination, uint32_t* resultCount, float* resultError);
+
+/// <summary>
+/// Builds the simplification state for a triangle list. Positions are classified through hash tables of their directed edges.
+/// An edge without a reverse at the position level is a border, and one that only has a reverse at the position level is a seam.
+/// Every edge is queued in both directions.
+/// </summary>
+/// <param name="state">State to fill. Freed with _post_FreeSimplify</param>
+/// <param name="mesh">Mesh with the vertices</param>
+/// <param name="indices">Triangle list. Rewritten in place as edges collapse</param>
+/// <param name="indexCount">Number of indices</param>
+/// <returns>Error code. The state is freed on failure</returns>
+StardustErrorCode _post_InitSimplify(SimplifyState* state, const StardustMesh* mesh, uint32_t* indices, uint32_t indexCount);
+
+/// <summary>
+/// Frees the memory of a simplification state and zeroes it
+/// </summary>
+/// <param name="state">State</param>
+void _post_FreeSimplify(SimplifyState* state);
+
+/// <summary>
+/// Checks the kinds of both ends, the triangles on the edge, the link condition and that no triangle around from would flip
+/// </summary>
+/// <param name="state">State</param>
+/// <param name="from">Group that would move</param>
+/// <param name="to">Group it would move onto</param>
+/// <returns>1 if the collapse is allowed. Otherwise 0</returns>
+int _post_CanCollapse(SimplifyState* state, uint32_t from, uint32_t to);
+
+/// <summary>
+/// Collapses the group from onto to. Triangles on the edge are removed and every other corner of from takes the vertex of to
+/// it shared a triangle with, so attributes follow the seam. The edges around to are queued again.
+/// </summary>
+/// <param name="state">State</param>
+/// <param name="from">Group to remove</param>
+/// <param name="to">Group to keep</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_Collapse(SimplifyState* state, uint32_t from, uint32_t to);
+
+/// <summary>
+/// Queues the collapse of from onto to at the error of the combined quadrics at the position of to
+/// </summary>
+/// <returns>Error code</returns>
+StardustErrorCode _post_PushCollapse(SimplifyState* state, uint32_t from, uint32_t to);
+
+/// <summary>
+/// Removes the cheapest collapse from the heap. The heap must not be empty
+/// </summary>
+/// <returns>The cheapest collapse</returns>
+EdgeCollapse _post_PopCollapse(SimplifyState* state);
+
+/// <summary>
+/// Gets the unit normal of a triangle of scaled group positions
+/// </summary>
+/// <param name="state">State</param>
+/// <param name="groups">3 groups</param>
+/// <param name="normal">3 floats to fill</param>
+/// <returns>Area of the triangle. 0 for degenerate triangles, in which case normal is not normalised</returns>
+float _post_GetGroupTriangleNormal(const SimplifyState* state, const uint32_t* groups, float* normal);
+
+/// <summary>
+/// Adds a plane through the edge (a, b), perpendicular to the triangle (a, b, c), to the quadrics of a and b.
+/// Weighted by the squared edge length and POST_SIMPLIFY_EDGE_WEIGHT
+/// </summary>
+void _post_AddEdgeQuadric(SimplifyState* state, uint32_t a, uint32_t b, uint32_t c);
+
+/// <summary>
+/// Makes the quadric of a weighted plane. normal must be a unit vector
+/// </summary>
+/// <param name="quadric">Quadric to fill</param>
+/// <param name="normal">Plane normal</param>
+/// <param name="distance">Plane distance, so that dot(normal, p) + distance is 0 on the plane</param>
+/// <param name="weight">Plane weight</param>
+void _post_QuadricFromPlane(Quadric* quadric, const float* normal, float distance, float weight);
+
+/// <summary>
+/// Adds other to quadric
+/// </summary>
+void _post_AddQuadric(Quadric* quadric, const Quadric* other);
+
+/// <summary>
+/// Evaluates a quadric at a position
+/// </summary>
+/// <returns>Weighted mean squared distance of the position to the planes of the quadric</returns>
+float _post_QuadricError(const Quadric* quadric, const float* position);
+
+/// <summary>
+/// Finds the slot of a directed edge in an open addressing table, or the empty slot it would go in
+/// </summary>
+/// <param name="table">Table of POST_EDGE_EMPTY or (first << 32 | second) keys</param>
+/// <param name="tableSize">Power of two size of the table</param>
+/// <param name="key">Edge key</param>
+/// <returns>Slot index</returns>
+uint32_t _post_FindEdge(const uint64_t* table, uint32_t tableSize, uint64_t key);
+
+
+
+// Levels Of Detail //
+
+/// <summary>
+/// Fills mesh->lods with up to lodCount simplified index buffers. Each level is simplified from the one before towards
+/// reduction times its index count. Stops early when a level can't be simplified within targetError.
+/// </summary>
+/// <param name="mesh">Triangulated mesh</param>
+/// <param name="lodCount">Maximum number of levels</param>
+/// <param name="reduction">Fraction of the indices of the previous level to aim for</param>
+/// <param name="targetError">Largest error each level may add</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_GenerateLODs(StardustMesh* mesh, uint32_t lodCount, float reduction, float targetError);
+
+/// <summary>
+/// Runs the vertex cache and overdraw optimisations in stages on every level of detail
+/// </summary>
+/// <param name="mesh">Mesh with levels of detail</param>
+/// <param name="stages">Planned STARDUST_STAGE_* bits</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_OptimizeLODs(StardustMesh* mesh, StardustPostProcessStages stages);
+
+/// <summary>
+/// Frees the levels of detail of a mesh and zeroes them
+/// </summary>
+/// <param name="mesh">Mesh</param>
+void _post_FreeLODs(StardustMesh* mesh);
 
 
 
 // Mesh Triangulation //
 
 /// <summary>
-/// Triangulates a mesh using the ear clipping method.
+/// Triangulates a mesh.
+/// Convex polygons are fan triangulated straight into the new index buffer. Only concave polygons use the ear clipping method.
 /// This will only effect the indices of the mesh and will not generate any extra vertices.
 /// Can be called on a mesh that is already triangulated as it will early exit.
 /// </summary>
@@ -73,43 +871,102 @@ StardustErrorCode _post_GenerateNormals(StardustMesh* mesh);
 StardustErrorCode _post_TriangulateMeshEC(StardustMesh* mesh);
 
 /// <summary>
-/// Triangulates a polygon and places the triangulated indices into indexArray
-/// Assumes a CCW winding order
+/// Triangulates a single polygon. Convex polygons are fanned and concave polygons are ear clipped.
+/// Calculates poly->normal.
 /// </summary>
-/// <param name="mesh">Mesh containing the vertices that the poly is indexed from<\param>
-/// <param name="poly"></param>
-/// <param name="indexArray"></param>
-/// <param name="returnCode">Return code from the function</param>
-/// <returns></returns>
-StardustErrorCode _post_TriangulatePolygonEC(StardustMesh* mesh, Polygon* poly, uint32_t* indexArray, uint32_t* polygonCount);
+/// <param name="mesh">Mesh containing the vertices that the poly is indexed from</param>
+/// <param name="poly">Polygon to triangulate</param>
+/// <param name="positions">Scratch array for _post_IsPolygonConvex</param>
+/// <param name="scratch">Scratch memory for _post_TriangulatePolygonEC</param>
+/// <param name="indexArray">Array of at least 3 * (poly->vertexCount - 2) indices to fill</param>
+/// <param name="indexCount">Filled with the number of indices written</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_TriangulatePolygon(StardustMesh* mesh, Polygon* poly, float* positions, PolygonScratch* scratch, uint32_t* indexArray, uint32_t* indexCount);
+
+/// <summary>
+/// Checks whether a polygon is convex by testing the sign of the turn at every corner against the polygon normal.
+/// Corners are tested 4 at a time with SSE2 where it is available.
+/// poly->normal must already be calculated with _post_CalculatePolygonNormal.
+/// </summary>
+/// <param name="mesh">Mesh containing the vertices that the poly is indexed from</param>
+/// <param name="poly">Polygon to test</param>
+/// <param name="positions">Scratch array of at least 3 * _post_GetConvexScratchSize(poly->vertexCount) floats</param>
+/// <returns>1 if the polygon is convex, otherwise 0</returns>
+int _post_IsPolygonConvex(StardustMesh* mesh, Polygon* poly, float* positions);
+
+/// <summary>
+/// Gets the number of floats per component needed by the scratch array of _post_IsPolygonConvex
+/// </summary>
+/// <param name="vertexCount">Number of vertices in the polygon</param>
+/// <returns>Floats per component</returns>
+uint32_t _post_GetConvexScratchSize(uint32_t vertexCount);
+
+/// <summary>
+/// Triangulates a polygon with ear clipping and places the triangulated indices into indexArray.
+/// The polygon is projected to 2D along its normal and the remaining vertices are kept in a linked list, so clipping an ear is O(1).
+/// Only reflex vertices can block an ear, so they are bucketed into a uniform grid and an ear only tests the cells under its bounds.
+/// Only the neighbours of a clipped ear are reclassified and queued as new ear candidates. poly is not modified.
+/// poly->normal must already be calculated with _post_CalculatePolygonNormal.
+/// </summary>
+/// <param name="mesh">Mesh containing the vertices that the poly is indexed from</param>
+/// <param name="poly">Polygon to triangulate</param>
+/// <param name="scratch">Scratch memory. Grown as needed and freed with _post_FreePolygonScratch</param>
+/// <param name="indexArray">Array of at least 3 * (poly->vertexCount - 2) indices to fill</param>
+/// <param name="indexCount">Filled with the number of indices written</param>
+/// <returns>Error code</returns>
+StardustErrorCode _post_TriangulatePolygonEC(StardustMesh* mesh, Polygon* poly, PolygonScratch* scratch, uint32_t* indexArray, uint32_t* indexCount);
+
+/// <summary>
+/// Projects a polygon onto the plane of the dominant axis of its normal.
+/// The polygon winds CCW in the projected plane.
+/// </summary>
+/// <param name="mesh">Mesh containing the vertices that the poly is indexed from</param>
+/// <param name="poly">Polygon to project</param>
+/// <param name="x">Array of poly->vertexCount floats to fill with projected x</param>
+/// <param name="y">Array of poly->vertexCount floats to fill with projected y</param>
+void _post_ProjectPolygon(StardustMesh* mesh, Polygon* poly, float* x, float* y);
+
+/// <summary>
+/// Checks whether the corner at curr turns CCW in the projected polygon
+/// </summary>
+/// <returns>1 if the corner is convex. Otherwise 0</returns>
+int _post_IsCornerConvex2D(PolygonScratch* scratch, uint32_t prev, uint32_t curr, uint32_t next);
+
+/// <summary>
+/// Checks whether curr is an ear. It must be convex and no remaining reflex vertex may lie within (prev, curr, next).
+/// </summary>
+/// <returns>1 if curr is an ear. Otherwise 0</returns>
+int _post_IsEar(PolygonScratch* scratch, uint32_t prev, uint32_t curr, uint32_t next);
 
 /// <summary>
-/// Calculates which vertices of a mesh polygon are convex or reflexive.
-/// Uses the provided mesh to find the vertices.
-/// This is kind of unsafe as the memory for the array is allocated outside of the function and many C programmers are screaming at me for that.
-/// However, for this usecase where I'm going to reuse this function and would like to minimise allocations. This works fine.
-/// Just don't call this function without an array of size mesh->vertexCount or larger.
+/// Buckets the reflex vertices of the projected polygon into a grid of square cells with about one vertex per cell.
+/// Clipped vertices are not removed from the grid. They are skipped through scratch->reflex instead.
 /// </summary>
-/// <param name="mesh">Mesh with vertices to check</param>
-/// <param name="poly">Polygon to find vertices from</param>
-/// <param name="convexIndices">Array of indices to fill for convex vertices</param>
-/// <param name="concaveVertices">Array of indices to fill for concave vertices</param>
-/// <returns>Number of convex vertices found</returns>
-uint32_t _post_FillConvexConcaveVertices(StardustMesh* mesh, Polygon* poly, uint32_t* convexIndices, uint32_t* concaveVertices);
+/// <param name="scratch">Scratch with the projected positions and reflex flags filled</param>
+/// <param name="vertexCount">Number of vertices in the polygon</param>
+/// <param name="reflexCount">Number of reflex vertices</param>
+void _post_BuildReflexGrid(PolygonScratch* scratch, uint32_t vertexCount, uint32_t reflexCount);
 
 /// <summary>
-/// Checks if a given convex vertex is an ear.
-/// It checks that no concave vertex is present within the triangle formed by the two adjacent vertices around the convex index.
-/// See above function for memory managment justification. Same here, ensure that the given array is of size mesh->vertexCount
+/// Gets the clamped grid cell coordinate of a projected position component
 /// </summary>
-/// <param name="mesh">Mesh with vertices to check</param>
-/// <param name="convexIndices">Array filled with convex indices</param>
-/// <param name="convexCount">Size of convex array</param>
-/// <param name="concaveIndices">Array filled with concave indices</param>
-/// <param name="concaveCount">Size of concave array</param>
-/// <param name="earArray">Array to fill with ear indices</param>
-/// <returns>The number of ears in the earArray</returns>
-uint32_t _post_FillEars(StardustMesh* mesh, Polygon* poly, uint32_t* convexIndices, uint32_t convexCount, uint32_t* concaveIndices, uint32_t concaveCount, uint32_t* earArray);
+/// <param name="value">Position component</param>
+/// <param name="gridMin">Minimum of the grid along the same axis</param>
+/// <param name="inverseCellSize">1 / cell size</param>
+/// <param name="cellCount">Number of cells along the axis</param>
+/// <returns>Cell coordinate</returns>
+uint32_t _post_GetReflexCell(float value, float gridMin, float inverseCellSize, uint32_t cellCount);
+
+/// <summary>
+/// Makes sure scratch can hold a polygon of vertexCount vertices
+/// </summary>
+/// <returns>Error code</returns>
+StardustErrorCode _post_ReservePolygonScratch(PolygonScratch* scratch, uint32_t vertexCount);
+
+/// <summary>
+/// Frees the memory of a polygon scratch and zeroes it
+/// </summary>
+void _post_FreePolygonScratch(PolygonScratch* scratch);
 
 
 // Util Funcs //
@@ -117,53 +974,66 @@ uint32_t _post_FillEars(StardustMesh* mesh, Polygon* poly, uint32_t* convexIndic
 /// <summary>
 /// Removes duplicate verticies from a mesh
 /// This will update the mesh verticies and the mesh indices along with their respective counts
-/// This is slower than the hash method that can be used by a loader
+/// Vertices are deduplicated through a VertexEmitter, which hashes the bit patterns of the attributes in mesh->dataType.
+/// This runs in linear time with the index count.
 /// </summary>
 /// <param name="mesh">Mesh to be reduced</param>
 /// <return>Returns the error code</return>
 StardustErrorCode _post_RecomputeIndexArray(StardustMesh* mesh);
 
 /// <summary>
-/// Compares the position of a NormalPosition object to a Vertex object.
+/// Hashes the bit patterns of the attributes of a vertex that are present in dataType.
+/// Position is always hashed. Color, normal and texture data are only hashed when their flags are set.
 /// </summary>
-/// <param name="norm">Pointer to a normal position object</param>
-/// <param name="vertex">Pointer to a Vertex object</param>
+/// <param name="vertex">Vertex to hash</param>
+/// <param name="dataType">The data type of the mesh the vertex belongs to</param>
+/// <returns>32 bit hash of the vertex</returns>
+uint32_t _post_HashVertex(const Vertex* vertex, StardustMeshDataType dataType);
+
+/// <summary>
+/// Compares the bit patterns of the attributes of two vertices that are present in dataType.
+/// Attributes that are not in dataType are ignored. Negative and positive zero are treated as equal.
+/// </summary>
+/// <param name="a">Vertex A</param>
+/// <param name="b">Vertex B</param>
+/// <param name="dataType">The data type of the mesh the vertices belong to</param>
 /// <returns>1 for a match. Otherwise 0</returns>
-int _post_ComarePositions(NormalPosition* norm, Vertex* vertex);
+int _post_CompareVertexData(const Vertex* a, const Vertex* b, StardustMeshDataType dataType);
 
 /// <summary>
-/// Indicates wheteher a vertex is convex.
-/// Takes a triangle of the adjacent vertices to "vertex", (Vprev, Vnext) and the normal of the polygon
-/// Proceeds to check that the vertex winding faces the normal direction.
-/// Assumes a CCW winding order
-/// Credit for Idea goes to https://github.com/NMO13/earclipper/blob/master/EarClipperLib/Misc.cs#L13
+/// Fills key with the bit patterns of the attributes of a vertex that are present in dataType.
+/// Negative zero is stored as positive zero so that the key matches float equality.
 /// </summary>
-/// <param name="vertex">Vertex to evalutate</param>
-/// <param name="Vprev">Previous vertex in the polygon</param>
-/// <param name="Vnext">Next vertex in the polygon</param>
-/// <param name="normal">Polygon normal</param>
-/// <returns>1 for convex, -1 for concave, 0 is an error</returns>
-int _post_IsVertexConvex(Vertex* vertex, Vertex* Vprev, Vertex* Vnext, Vertex* normal);
+/// <param name="vertex">Vertex to get the key of</param>
+/// <param name="dataType">The data type of the mesh the vertex belongs to</param>
+/// <param name="key">Array of at least 13 words to fill</param>
+/// <returns>Number of words written to key</returns>
+uint32_t _post_GetVertexKey(const Vertex* vertex, StardustMeshDataType dataType, uint32_t* key);
 
 /// <summary>
-/// An algorithm for checking whether triangle (A,B,C) contains vertex P
-/// Assumes a CCW winding order
+/// Hashes an array of 32 bit words. The words are read with memcpy so that float arrays can be hashed by their bit patterns.
 /// </summary>
-/// <param name="a">Point A of the triangle</param>
-/// <param name="b">Point B of the traingle</param>
-/// <param name="c">Point C of the triangle</param>
-/// <param name="p">Point to test</param>
-/// <returns>1 if the ABC contains P, otherwise returns 0</returns>
-int _post_TriangleContainsPoint(Vertex* a, Vertex* b, Vertex* c, Vertex* p);
+/// <param name="words">Pointer to the first word</param>
+/// <param name="count">Number of words to hash</param>
+/// <param name="hash">Seed, or the hash of previous data to continue from</param>
+/// <returns>The updated hash</returns>
+uint32_t _post_HashWords(const void* words, uint32_t count, uint32_t hash);
+
+/// <summary>
+/// Gets the size of a power of two hash table that can hold count elements at a load factor of at most one half.
+/// </summary>
+/// <param name="count">Maximum number of elements that will be inserted</param>
+/// <returns>Table size</returns>
+uint32_t _post_GetHashTableSize(uint32_t count);
+
 
 /// <summary>
-/// Removes a indices at the given index from the polygon object.
-/// Does not reallocate any memory. Simply overwrites the value with the values above it using memcpy.
-/// Will decrease poly->vertexCount attribute
+/// An algorithm for checking whether the 2D triangle (A,B,C) contains point P.
+/// Points on the edges count as contained.
+/// Assumes a CCW winding order
 /// </summary>
-/// <param name="poly">Polygon to remove an index from</param>
-/// <param name="idx">Index to remove</param>
-void _post_RemoveFromPolygon(Polygon* poly, uint32_t idx);
+/// <returns>1 if the ABC contains P, otherwise returns 0</returns>
+int _post_TriangleContainsPoint(float ax, float ay, float bx, float by, float cx, float cy, float px, float py);
 
 /// <summary>
 /// Calculates the normal of a projected polygon.
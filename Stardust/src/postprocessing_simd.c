@@ -0,0 +1,335 @@
+#include "postprocessing.h"
+#include "utils/cpu.h"
+
+#include <math.h>
+#include <float.h>
+
+#ifdef STARDUST_X86
+#include <immintrin.h>
+#endif
+
+/*
+Face normal kernels.
+Every kernel does the same operations in the same order as the scalar kernel: edges, cross product, the squared length summed
+as (x*x + y*y) + z*z, sqrt and a divide. These are all correctly rounded so deterministic results are bit identical.
+The fast path swaps sqrt and divide for a reciprocal square root estimate and one Newton-Raphson step.
+*/
+
+FaceNormalKernel _post_GetFaceNormalKernel(StardustInstructionSet requested, uint32_t vertexCount)
+{
+	StardustInstructionSet set = cpu_SelectInstructionSet(requested);
+
+	//The gathers index floats with 32 bit signed offsets
+	if (set > STARDUST_INSTRUCTIONS_SSE2 && vertexCount > INT32_MAX / (sizeof(Vertex) / sizeof(float)))
+		set = STARDUST_INSTRUCTIONS_SSE2;
+
+#ifdef STARDUST_X86
+	switch (set)
+	{
+	case STARDUST_INSTRUCTIONS_AVX512: return _post_FaceNormalsAVX512;
+	case STARDUST_INSTRUCTIONS_AVX2: return _post_FaceNormalsAVX2;
+	case STARDUST_INSTRUCTIONS_SSE2: return _post_FaceNormalsSSE2;
+	}
+#endif
+
+	return _post_FaceNormalsScalar;
+}
+
+void _post_FaceNormalsScalar(const Vertex* vertices, const uint32_t* indices, uint32_t triangleCount, int deterministic, float* faceNormals, float* cornerWeights)
+{
+	(void)deterministic; //Always exact. Only the SIMD kernels have an approximate path
+
+	for (uint32_t i = 0; i < triangleCount * 3; i += 3)
+	{
+		// a == 1
+		// b == 2
+		// c == 3
+		// norm(cross(b - a, c - a))
+
+		const Vertex* a = &vertices[indices[i]];
+		const Vertex* b = &vertices[indices[i + 1]];
+		const Vertex* c = &vertices[indices[i + 2]];
+
+		//Edge AB
+		float edgeAx = b->x - a->x;
+		float edgeAy = b->y - a->y;
+		float edgeAz = b->z - a->z;
+
+		//Edge AC
+		float edgeBx = c->x - a->x;
+		float edgeBy = c->y - a->y;
+		float edgeBz = c->z - a->z;
+
+		//Cross product
+		float normX = edgeAy*edgeBz - edgeAz*edgeBy;
+		float normY = edgeAz*edgeBx - edgeAx*edgeBz;
+		float normZ = edgeAx*edgeBy - edgeAy*edgeBx;
+
+		//Mag. This is twice the area of the triangle
+		float mag = sqrtf(normX*normX + normY*normY + normZ*normZ);
+		if (mag > 0.0f) //Degenerate triangles keep a zero normal
+		{
+			normX /= mag;
+			normY /= mag;
+			normZ /= mag;
+		}
+
+		faceNormals[i] = normX;
+		faceNormals[i + 1] = normY;
+		faceNormals[i + 2] = normZ;
+
+		cornerWeights[i] = mag;
+		cornerWeights[i + 1] = mag;
+		cornerWeights[i + 2] = mag;
+	}
+}
+
+#ifdef STARDUST_X86
+
+//Writes lanes of SoA results back out as 3 floats per face
+static void _post_StoreFaceNormals(const float* x, const float* y, const float* z, const float* mag, uint32_t count, float* faceNormals, float* cornerWeights)
+{
+	for (uint32_t i = 0; i < count; i++)
+	{
+		faceNormals[i * 3] = x[i];
+		faceNormals[i * 3 + 1] = y[i];
+		faceNormals[i * 3 + 2] = z[i];
+
+		cornerWeights[i * 3] = mag[i];
+		cornerWeights[i * 3 + 1] = mag[i];
+		cornerWeights[i * 3 + 2] = mag[i];
+	}
+}
+
+CPU_TARGET("sse2")
+void _post_FaceNormalsSSE2(const Vertex* vertices, const uint32_t* indices, uint32_t triangleCount, int deterministic, float* faceNormals, float* cornerWeights)
+{
+	uint32_t vectorCount = triangleCount & ~3u;
+
+	for (uint32_t t = 0; t < vectorCount; t += 4)
+	{
+		const uint32_t* tri = indices + t * 3;
+
+		//Gather 4 triangles. The vertices are scattered so there is nothing better than scalar loads
+		const Vertex* a[4] = { &vertices[tri[0]], &vertices[tri[3]], &vertices[tri[6]], &vertices[tri[9]] };
+		const Vertex* b[4] = { &vertices[tri[1]], &vertices[tri[4]], &vertices[tri[7]], &vertices[tri[10]] };
+		const Vertex* c[4] = { &vertices[tri[2]], &vertices[tri[5]], &vertices[tri[8]], &vertices[tri[11]] };
+
+		__m128 ax = _mm_setr_ps(a[0]->x, a[1]->x, a[2]->x, a[3]->x);
+		__m128 ay = _mm_setr_ps(a[0]->y, a[1]->y, a[2]->y, a[3]->y);
+		__m128 az = _mm_setr_ps(a[0]->z, a[1]->z, a[2]->z, a[3]->z);
+
+		//Edge AB
+		__m128 edgeAx = _mm_sub_ps(_mm_setr_ps(b[0]->x, b[1]->x, b[2]->x, b[3]->x), ax);
+		__m128 edgeAy = _mm_sub_ps(_mm_setr_ps(b[0]->y, b[1]->y, b[2]->y, b[3]->y), ay);
+		__m128 edgeAz = _mm_sub_ps(_mm_setr_ps(b[0]->z, b[1]->z, b[2]->z, b[3]->z), az);
+
+		//Edge AC
+		__m128 edgeBx = _mm_sub_ps(_mm_setr_ps(c[0]->x, c[1]->x, c[2]->x, c[3]->x), ax);
+		__m128 edgeBy = _mm_sub_ps(_mm_setr_ps(c[0]->y, c[1]->y, c[2]->y, c[3]->y), ay);
+		__m128 edgeBz = _mm_sub_ps(_mm_setr_ps(c[0]->z, c[1]->z, c[2]->z, c[3]->z), az);
+
+		//Cross product
+		__m128 normX = _mm_sub_ps(_mm_mul_ps(edgeAy, edgeBz), _mm_mul_ps(edgeAz, edgeBy));
+		__m128 normY = _mm_sub_ps(_mm_mul_ps(edgeAz, edgeBx), _mm_mul_ps(edgeAx, edgeBz));
+		__m128 normZ = _mm_sub_ps(_mm_mul_ps(edgeAx, edgeBy), _mm_mul_ps(edgeAy, edgeBx));
+
+		__m128 length2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normX, normX), _mm_mul_ps(normY, normY)), _mm_mul_ps(normZ, normZ));
+
+		__m128 mag, unitX, unitY, unitZ, valid;
+		if (deterministic)
+		{
+			mag = _mm_sqrt_ps(length2);
+			valid = _mm_cmpgt_ps(mag, _mm_setzero_ps());
+
+			unitX = _mm_div_ps(normX, mag);
+			unitY = _mm_div_ps(normY, mag);
+			unitZ = _mm_div_ps(normZ, mag);
+		}
+		else
+		{
+			//The estimate isn't defined for denormals, so triangles that small are treated as degenerate
+			valid = _mm_cmpge_ps(length2, _mm_set1_ps(FLT_MIN));
+
+			__m128 inverse = _mm_rsqrt_ps(length2);
+			inverse = _mm_mul_ps(inverse, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), length2), _mm_mul_ps(inverse, inverse))));
+			inverse = _mm_and_ps(inverse, valid);
+
+			mag = _mm_mul_ps(length2, inverse);
+			unitX = _mm_mul_ps(normX, inverse);
+			unitY = _mm_mul_ps(normY, inverse);
+			unitZ = _mm_mul_ps(normZ, inverse);
+		}
+
+		//Degenerate triangles keep their unnormalised normal, like the scalar code
+		normX = _mm_or_ps(_mm_and_ps(valid, unitX), _mm_andnot_ps(valid, normX));
+		normY = _mm_or_ps(_mm_and_ps(valid, unitY), _mm_andnot_ps(valid, normY));
+		normZ = _mm_or_ps(_mm_and_ps(valid, unitZ), _mm_andnot_ps(valid, normZ));
+
+		float x[4], y[4], z[4], m[4];
+		_mm_storeu_ps(x, normX);
+		_mm_storeu_ps(y, normY);
+		_mm_storeu_ps(z, normZ);
+		_mm_storeu_ps(m, mag);
+
+		_post_StoreFaceNormals(x, y, z, m, 4, faceNormals + t * 3, cornerWeights + t * 3);
+	}
+
+	_post_FaceNormalsScalar(vertices, indices + vectorCount * 3, triangleCount - vectorCount, deterministic, faceNormals + vectorCount * 3, cornerWeights + vectorCount * 3);
+}
+
+CPU_TARGET("avx2")
+void _post_FaceNormalsAVX2(const Vertex* vertices, const uint32_t* indices, uint32_t triangleCount, int deterministic, float* faceNormals, float* cornerWeights)
+{
+	uint32_t vectorCount = triangleCount & ~7u;
+	const float* base = &vertices->x;
+
+	//Float offset of each corner's index within 8 triangles
+	const __m256i stride = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+	const __m256i floatsPerVertex = _mm256_set1_epi32(sizeof(Vertex) / sizeof(float));
+
+	for (uint32_t t = 0; t < vectorCount; t += 8)
+	{
+		const int* tri = (const int*)(indices + t * 3);
+
+		//Gather indices then positions
+		__m256i ia = _mm256_mullo_epi32(_mm256_i32gather_epi32(tri, stride, 4), floatsPerVertex);
+		__m256i ib = _mm256_mullo_epi32(_mm256_i32gather_epi32(tri + 1, stride, 4), floatsPerVertex);
+		__m256i ic = _mm256_mullo_epi32(_mm256_i32gather_epi32(tri + 2, stride, 4), floatsPerVertex);
+
+		__m256 ax = _mm256_i32gather_ps(base, ia, 4);
+		__m256 ay = _mm256_i32gather_ps(base + 1, ia, 4);
+		__m256 az = _mm256_i32gather_ps(base + 2, ia, 4);
+
+		//Edge AB
+		__m256 edgeAx = _mm256_sub_ps(_mm256_i32gather_ps(base, ib, 4), ax);
+		__m256 edgeAy = _mm256_sub_ps(_mm256_i32gather_ps(base + 1, ib, 4), ay);
+		__m256 edgeAz = _mm256_sub_ps(_mm256_i32gather_ps(base + 2, ib, 4), az);
+
+		//Edge AC
+		__m256 edgeBx = _mm256_sub_ps(_mm256_i32gather_ps(base, ic, 4), ax);
+		__m256 edgeBy = _mm256_sub_ps(_mm256_i32gather_ps(base + 1, ic, 4), ay);
+		__m256 edgeBz = _mm256_sub_ps(_mm256_i32gather_ps(base + 2, ic, 4), az);
+
+		//Cross product. No FMA so that the rounding matches the scalar code
+		__m256 normX = _mm256_sub_ps(_mm256_mul_ps(edgeAy, edgeBz), _mm256_mul_ps(edgeAz, edgeBy));
+		__m256 normY = _mm256_sub_ps(_mm256_mul_ps(edgeAz, edgeBx), _mm256_mul_ps(edgeAx, edgeBz));
+		__m256 normZ = _mm256_sub_ps(_mm256_mul_ps(edgeAx, edgeBy), _mm256_mul_ps(edgeAy, edgeBx));
+
+		__m256 length2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(normX, normX), _mm256_mul_ps(normY, normY)), _mm256_mul_ps(normZ, normZ));
+
+		__m256 mag, unitX, unitY, unitZ, valid;
+		if (deterministic)
+		{
+			mag = _mm256_sqrt_ps(length2);
+			valid = _mm256_cmp_ps(mag, _mm256_setzero_ps(), _CMP_GT_OQ);
+
+			unitX = _mm256_div_ps(normX, mag);
+			unitY = _mm256_div_ps(normY, mag);
+			unitZ = _mm256_div_ps(normZ, mag);
+		}
+		else
+		{
+			valid = _mm256_cmp_ps(length2, _mm256_set1_ps(FLT_MIN), _CMP_GE_OQ);
+
+			__m256 inverse = _mm256_rsqrt_ps(length2);
+			inverse = _mm256_mul_ps(inverse, _mm256_sub_ps(_mm256_set1_ps(1.5f), _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), length2), _mm256_mul_ps(inverse, inverse))));
+			inverse = _mm256_and_ps(inverse, valid);
+
+			mag = _mm256_mul_ps(length2, inverse);
+			unitX = _mm256_mul_ps(normX, inverse);
+			unitY = _mm256_mul_ps(normY, inverse);
+			unitZ = _mm256_mul_ps(normZ, inverse);
+		}
+
+		normX = _mm256_blendv_ps(normX, unitX, valid);
+		normY = _mm256_blendv_ps(normY, unitY, valid);
+		normZ = _mm256_blendv_ps(normZ, unitZ, valid);
+
+		float x[8], y[8], z[8], m[8];
+		_mm256_storeu_ps(x, normX);
+		_mm256_storeu_ps(y, normY);
+		_mm256_storeu_ps(z, normZ);
+		_mm256_storeu_ps(m, mag);
+
+		_post_StoreFaceNormals(x, y, z, m, 8, faceNormals + t * 3, cornerWeights + t * 3);
+	}
+
+	_post_FaceNormalsScalar(vertices, indices + vectorCount * 3, triangleCount - vectorCount, deterministic, faceNormals + vectorCount * 3, cornerWeights + vectorCount * 3);
+}
+
+CPU_TARGET("avx512f")
+void _post_FaceNormalsAVX512(const Vertex* vertices, const uint32_t* indices, uint32_t triangleCount, int deterministic, float* faceNormals, float* cornerWeights)
+{
+	uint32_t vectorCount = triangleCount & ~15u;
+	const float* base = &vertices->x;
+
+	const __m512i stride = _mm512_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21, 24, 27, 30, 33, 36, 39, 42, 45);
+	const __m512i floatsPerVertex = _mm512_set1_epi32(sizeof(Vertex) / sizeof(float));
+
+	for (uint32_t t = 0; t < vectorCount; t += 16)
+	{
+		const int* tri = (const int*)(indices + t * 3);
+
+		//Gather indices then positions
+		__m512i ia = _mm512_mullo_epi32(_mm512_i32gather_epi32(stride, tri, 4), floatsPerVertex);
+		__m512i ib = _mm512_mullo_epi32(_mm512_i32gather_epi32(stride, tri + 1, 4), floatsPerVertex);
+		__m512i ic = _mm512_mullo_epi32(_mm512_i32gather_epi32(stride, tri + 2, 4), floatsPerVertex);
+
+		__m512 ax = _mm512_i32gather_ps(ia, base, 4);
+		__m512 ay = _mm512_i32gather_ps(ia, base + 1, 4);
+		__m512 az = _mm512_i32gather_ps(ia, base + 2, 4);
+
+		//Edge AB
+		__m512 edgeAx = _mm512_sub_ps(_mm512_i32gather_ps(ib, base, 4), ax);
+		__m512 edgeAy = _mm512_sub_ps(_mm512_i32gather_ps(ib, base + 1, 4), ay);
+		__m512 edgeAz = _mm512_sub_ps(_mm512_i32gather_ps(ib, base + 2, 4), az);
+
+		//Edge AC
+		__m512 edgeBx = _mm512_sub_ps(_mm512_i32gather_ps(ic, base, 4), ax);
+		__m512 edgeBy = _mm512_sub_ps(_mm512_i32gather_ps(ic, base + 1, 4), ay);
+		__m512 edgeBz = _mm512_sub_ps(_mm512_i32gather_ps(ic, base + 2, 4), az);
+
+		//Cross product. No FMA so that the rounding matches the scalar code
+		__m512 normX = _mm512_sub_ps(_mm512_mul_ps(edgeAy, edgeBz), _mm512_mul_ps(edgeAz, edgeBy));
+		__m512 normY = _mm512_sub_ps(_mm512_mul_ps(edgeAz, edgeBx), _mm512_mul_ps(edgeAx, edgeBz));
+		__m512 normZ = _mm512_sub_ps(_mm512_mul_ps(edgeAx, edgeBy), _mm512_mul_ps(edgeAy, edgeBx));
+
+		__m512 length2 = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(normX, normX), _mm512_mul_ps(normY, normY)), _mm512_mul_ps(normZ, normZ));
+
+		__m512 mag;
+		if (deterministic)
+		{
+			mag = _mm512_sqrt_ps(length2);
+			__mmask16 valid = _mm512_cmp_ps_mask(mag, _mm512_setzero_ps(), _CMP_GT_OQ);
+
+			normX = _mm512_mask_div_ps(normX, valid, normX, mag);
+			normY = _mm512_mask_div_ps(normY, valid, normY, mag);
+			normZ = _mm512_mask_div_ps(normZ, valid, normZ, mag);
+		}
+		else
+		{
+			__mmask16 valid = _mm512_cmp_ps_mask(length2, _mm512_set1_ps(FLT_MIN), _CMP_GE_OQ);
+
+			__m512 inverse = _mm512_maskz_rsqrt14_ps(valid, length2);
+			inverse = _mm512_mul_ps(inverse, _mm512_sub_ps(_mm512_set1_ps(1.5f), _mm512_mul_ps(_mm512_mul_ps(_mm512_set1_ps(0.5f), length2), _mm512_mul_ps(inverse, inverse))));
+
+			mag = _mm512_mul_ps(length2, inverse);
+			normX = _mm512_mask_mul_ps(normX, valid, normX, inverse);
+			normY = _mm512_mask_mul_ps(normY, valid, normY, inverse);
+			normZ = _mm512_mask_mul_ps(normZ, valid, normZ, inverse);
+		}
+
+		float x[16], y[16], z[16], m[16];
+		_mm512_storeu_ps(x, normX);
+		_mm512_storeu_ps(y, normY);
+		_mm512_storeu_ps(z, normZ);
+		_mm512_storeu_ps(m, mag);
+
+		_post_StoreFaceNormals(x, y, z, m, 16, faceNormals + t * 3, cornerWeights + t * 3);
+	}
+
+	_post_FaceNormalsScalar(vertices, indices + vectorCount * 3, triangleCount - vectorCount, deterministic, faceNormals + vectorCount * 3, cornerWeights + vectorCount * 3);
+}
+
+#endif //STARDUST_X86
@@ -1,5 +1,7 @@
 #include "stardust.h"
 #include "postprocessing.h"
+#include "codec.h"
+#include "bvh.h"
 
 //Loaders
 #include "formats/obj/OBJLoader.h"
@@ -12,8 +14,198 @@
 
 #include "utils/file.h"
 #include "utils/string_tools.h"
+#include "utils/thread.h"
+#include "utils/bounds.h"
 #include "timing.h"
 
+typedef struct
+{
+	StardustMesh* meshes;
+	StardustMeshFlags flags;
+} PostProcessTask;
+
+static StardustErrorCode _sd_PostProcessTask(void* context, uint32_t index)
+{
+	PostProcessTask* task = context;
+	StardustMesh* mesh = &task->meshes[index];
+
+	StardustErrorCode ret = _post_PerformPostProcessing(mesh, task->flags);
+	if (ret != STARDUST_ERROR_SUCCESS)
+		return ret;
+
+	//Bounds come last so that they match the vertices post processing leaves behind
+	bd_CalculateBounds(mesh->vertices, mesh->vertexCount, _post_GetSettings()->instructionSet, &mesh->bounds);
+	mesh->dataType |= STARDUST_BOUNDS_DATA;
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+//Frees every array owned by a mesh but not the mesh itself
+static void _sd_FreeMeshData(StardustMesh* mesh)
+{
+	free(mesh->vertices);
+	free(mesh->indices);
+	free(mesh->tangents);
+	_post_FreeMeshlets(mesh);
+	_post_FreeLODs(mesh);
+}
+
+typedef struct
+{
+	StardustMesh* meshes;
+	StardustMesh* merged;
+	uint32_t* vertexOffsets;	//First vertex of each mesh in the merged mesh
+	uint32_t* indexOffsets;		//First index of each mesh in the merged mesh
+} MergeTask;
+
+static StardustErrorCode _sd_TriangulateTask(void* context, uint32_t index)
+{
+	MergeTask* task = context;
+	return _post_TriangulateMeshEC(&task->meshes[index]);
+}
+
+//Copies one mesh into its part of the merged mesh
+static StardustErrorCode _sd_MergeTask(void* context, uint32_t index)
+{
+	MergeTask* task = context;
+	const StardustMesh* mesh = &task->meshes[index];
+
+	Vertex* vertices = task->merged->vertices + task->vertexOffsets[index];
+	if (mesh->vertexCount > 0)
+		memcpy(vertices, mesh->vertices, mesh->vertexCount * sizeof(Vertex));
+
+	//Attributes the mesh doesn't have get the same defaults as a mesh loaded without them. Colours default to white so they
+	//can be multiplied in unconditionally
+	StardustMeshDataType missing = task->merged->dataType & ~mesh->dataType & (STARDUST_COLOR_DATA | STARDUST_NORMAL_DATA | STARDUST_TEXTURE_DATA);
+	for (uint32_t i = 0; i < mesh->vertexCount && missing != 0; i++)
+	{
+		if ((missing & STARDUST_COLOR_DATA) == STARDUST_COLOR_DATA)
+		{
+			vertices[i].r = 1.0f;
+			vertices[i].g = 1.0f;
+			vertices[i].b = 1.0f;
+		}
+
+		if ((missing & STARDUST_NORMAL_DATA) == STARDUST_NORMAL_DATA)
+		{
+			vertices[i].normX = 0.0f;
+			vertices[i].normY = 0.0f;
+			vertices[i].normZ = 0.0f;
+		}
+
+		if ((missing & STARDUST_TEXTURE_DATA) == STARDUST_TEXTURE_DATA)
+		{
+			vertices[i].texU = 0.0f;
+			vertices[i].texV = 0.0f;
+			vertices[i].texW = 0.0f;
+		}
+	}
+
+	uint32_t* indices = task->merged->indices + task->indexOffsets[index];
+	uint32_t base = task->vertexOffsets[index];
+	for (uint32_t i = 0; i < mesh->indexCount; i++)
+		indices[i] = mesh->indices[i] + base;
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+//Replaces the meshes of a load with a single mesh holding all of them. If it fails the meshes are still valid and owned by the
+//caller, but when triangulating one of them fails the others may already be triangulated
+static StardustErrorCode _sd_MergeMeshes(StardustMesh** meshes, size_t* meshCount)
+{
+	if (*meshCount < 2)
+		return STARDUST_ERROR_SUCCESS;
+
+	StardustMesh* source = *meshes;
+	uint32_t count = (uint32_t)*meshCount;
+	MergeTask task = { source, 0, 0, 0 };
+
+	//One index buffer can only have one face size, so mixed meshes are triangulated first
+	int triangulate = 0;
+	for (uint32_t i = 1; i < count; i++)
+	{
+		if (source[i].vertexStride != source[0].vertexStride)
+			triangulate = 1;
+	}
+
+	StardustMesh* merged = malloc(sizeof(StardustMesh));
+	task.vertexOffsets = malloc(count * sizeof(uint32_t));
+	task.indexOffsets = malloc(count * sizeof(uint32_t));
+	if (merged == 0 || task.vertexOffsets == 0 || task.indexOffsets == 0)
+	{
+		free(merged); free(task.vertexOffsets); free(task.indexOffsets);
+		return STARDUST_ERROR_MEMORY_ERROR;
+	}
+	memset(merged, 0, sizeof(StardustMesh));
+	task.merged = merged;
+
+	//Everything is allocated before triangulating, so the meshes are only changed once nothing else can fail.
+	//Every polygon becomes at most vertexStride - 2 triangles, which bounds the index count
+	size_t vertexCount = 0;
+	size_t indexCount = 0;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t stride = source[i].vertexStride;
+		vertexCount += source[i].vertexCount;
+		indexCount += triangulate && stride > 3 ? (size_t)(source[i].indexCount / stride) * (stride - 2) * 3 : source[i].indexCount;
+		merged->dataType |= source[i].dataType;
+	}
+
+	StardustErrorCode ret = STARDUST_ERROR_SUCCESS;
+	if (vertexCount > UINT32_MAX || indexCount > UINT32_MAX)
+		ret = STARDUST_ERROR_INVALID_ARGUMENT;
+	else
+	{
+		merged->vertices = malloc((vertexCount > 0 ? vertexCount : 1) * sizeof(Vertex));
+		merged->indices = malloc((indexCount > 0 ? indexCount : 1) * sizeof(uint32_t));
+		if (merged->vertices == 0 || merged->indices == 0)
+			ret = STARDUST_ERROR_MEMORY_ERROR;
+	}
+
+	if (ret == STARDUST_ERROR_SUCCESS && triangulate)
+		ret = t_ParallelFor(count, _sd_TriangulateTask, &task, 0);
+
+	if (ret == STARDUST_ERROR_SUCCESS)
+	{
+		//The offsets use the final counts, as concave polygons can come out with fewer triangles
+		vertexCount = 0;
+		indexCount = 0;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			task.vertexOffsets[i] = (uint32_t)vertexCount;
+			task.indexOffsets[i] = (uint32_t)indexCount;
+			vertexCount += source[i].vertexCount;
+			indexCount += source[i].indexCount;
+		}
+
+		merged->vertexCount = (uint32_t)vertexCount;
+		merged->indexCount = (uint32_t)indexCount;
+		merged->vertexStride = source[0].vertexStride;
+		if (triangulate)
+			merged->postProcessStages |= STARDUST_STAGE_TRIANGULATE;
+
+		ret = t_ParallelFor(count, _sd_MergeTask, &task, 0);
+	}
+
+	free(task.vertexOffsets);
+	free(task.indexOffsets);
+
+	if (ret != STARDUST_ERROR_SUCCESS)
+	{
+		_sd_FreeMeshData(merged);
+		free(merged);
+		return ret;
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+		_sd_FreeMeshData(&source[i]);
+	free(source);
+
+	*meshes = merged;
+	*meshCount = 1;
+	return STARDUST_ERROR_SUCCESS;
+}
+
 
 StardustErrorCode sd_LoadMesh(const char* filename, const StardustMeshFlags flags, StardustMesh** meshes, size_t* meshCount)
 {
@@ -59,30 +251,100 @@ StardustErrorCode sd_LoadMesh(const char* filename, const StardustMeshFlags flag
 	s_FreeStringArray(splitString, stringElem);
 	free(filenameBuffer);
 
-	
-	//Perform post processing
-	for (size_t i = 0; i < *meshCount; i++)
+	//Merge before post processing, so every stage runs once over the whole mesh
+	ret = STARDUST_ERROR_SUCCESS;
+	if ((flags & STARDUST_MESH_MERGE_MESHES) == STARDUST_MESH_MERGE_MESHES)
+		ret = _sd_MergeMeshes(meshes, meshCount);
+
+	//Perform post processing. Meshes are independent so each one is its own task
+	PostProcessTask task = { *meshes, flags };
+	if (ret == STARDUST_ERROR_SUCCESS)
+		ret = t_ParallelFor((uint32_t)*meshCount, _sd_PostProcessTask, &task, 0);
+	if (ret != STARDUST_ERROR_SUCCESS)
 	{
-		ret = _post_PerformPostProcessing(meshes[i], flags);
-		if (ret != STARDUST_ERROR_SUCCESS)
-		{
-			for (size_t j = 0; j < *meshCount; j++)
-				sd_FreeMesh(meshes[j]);
-			return ret;
-		}
+		for (size_t i = 0; i < *meshCount; i++)
+			_sd_FreeMeshData(&(*meshes)[i]);
+		free(*meshes);
+
+		*meshes = 0;
+		*meshCount = 0;
+		return ret;
 	}
 
 
 	return STARDUST_ERROR_SUCCESS;
 }
 
+STARDUST_FUNC StardustErrorCode sd_CreateMesh(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, uint32_t vertexStride, StardustMeshDataType dataType, StardustMesh** mesh)
+{
+	*mesh = 0;
+
+	if (vertexStride < 3 || indexCount % vertexStride != 0)
+		return STARDUST_ERROR_INVALID_ARGUMENT;
+
+	for (uint32_t i = 0; i < indexCount; i++)
+	{
+		if (indices[i] >= vertexCount)
+			return STARDUST_ERROR_INVALID_ARGUMENT;
+	}
+
+	StardustMesh* result = malloc(sizeof(StardustMesh));
+	if (result == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
+	memset(result, 0, sizeof(StardustMesh));
+
+	result->vertices = malloc(((size_t)vertexCount + 1) * sizeof(Vertex));
+	result->indices = malloc(((size_t)indexCount + 1) * sizeof(uint32_t));
+	if (result->vertices == 0 || result->indices == 0)
+	{
+		sd_FreeMesh(result);
+		return STARDUST_ERROR_MEMORY_ERROR;
+	}
+
+	if (vertexCount > 0)
+		memcpy(result->vertices, vertices, (size_t)vertexCount * sizeof(Vertex));
+	if (indexCount > 0)
+		memcpy(result->indices, indices, (size_t)indexCount * sizeof(uint32_t));
+
+	result->vertexCount = vertexCount;
+	result->indexCount = indexCount;
+	result->vertexStride = vertexStride;
+
+	//Only vertex attributes are taken from the caller. Tangents, meshlets and the rest come from post processing
+	result->dataType = STARDUST_VERTEX_DATA | STARDUST_INDEX_DATA |
+		(dataType & (STARDUST_TEXTURE_DATA | STARDUST_NORMAL_DATA | STARDUST_COLOR_DATA | STARDUST_SMOOTHSHADING));
+
+	bd_CalculateBounds(result->vertices, result->vertexCount, _post_GetSettings()->instructionSet, &result->bounds);
+	result->dataType |= STARDUST_BOUNDS_DATA;
+
+	*mesh = result;
+	return STARDUST_ERROR_SUCCESS;
+}
+
+STARDUST_FUNC StardustErrorCode sd_PostProcessMesh(StardustMesh* mesh, StardustMeshFlags flags)
+{
+	if (mesh->vertexStride < 3 || mesh->indexCount % mesh->vertexStride != 0)
+		return STARDUST_ERROR_INVALID_ARGUMENT;
+
+	PostProcessTask task = { mesh, flags };
+	return _sd_PostProcessTask(&task, 0);
+}
+
 STARDUST_FUNC void sd_FreeMesh(StardustMesh* mesh)
 {
-	free(mesh->vertices);
-	free(mesh->indices);
+	_sd_FreeMeshData(mesh);
 	free(mesh);
 }
 
+STARDUST_FUNC void sd_FreeMeshes(StardustMesh* meshes, size_t meshCount)
+{
+	if (meshes == 0)
+		return;
+
+	for (size_t i = 0; i < meshCount; i++)
+		_sd_FreeMeshData(&meshes[i]);
+	free(meshes);
+}
+
 STARDUST_FUNC int sd_isFormatSupported(const char* format)
 {
 	if (format == "obj")
@@ -91,6 +353,16 @@ STARDUST_FUNC int sd_isFormatSupported(const char* format)
 	return 0; //F
 }
 
+STARDUST_FUNC void sd_GetPostProcessSettings(StardustPostProcessSettings* settings)
+{
+	*settings = *_post_GetSettings();
+}
+
+STARDUST_FUNC void sd_SetPostProcessSettings(const StardustPostProcessSettings* settings)
+{
+	*_post_GetSettings() = *settings;
+}
+
 STARDUST_FUNC void sd_PrintVertex(Vertex* v)
 {
 	printf("Vertex Pos: (%f, %f, %f, %f), Vertex UVW: (%f, %f, %f), Vertex Norm (%f, %f, %f)\n", v->x, v->y, v->z, v->w, v->texU, v->texV, v->texW, v->normX, v->normY, v->normZ);
@@ -121,6 +393,138 @@ STARDUST_FUNC int sd_CompareVertex(Vertex* a, Vertex* b)
 
 }
 
+STARDUST_FUNC float sd_CalculateACMR(const StardustMesh* mesh, uint32_t cacheSize)
+{
+	if (mesh->vertexStride != 3)
+		return 0.0f;
+
+	return _post_CalculateACMR(mesh->indices, mesh->indexCount, mesh->vertexCount, cacheSize);
+}
+
+STARDUST_FUNC StardustErrorCode sd_SimplifyMesh(const StardustMesh* mesh, uint32_t targetIndexCount, float targetError, uint32_t** indices, uint32_t* indexCount, float* resultError)
+{
+	*indices = 0;
+	*indexCount = 0;
+
+	if (mesh->vertexStride != 3)
+		return STARDUST_ERROR_INVALID_ARGUMENT;
+
+	uint32_t* result = malloc(((size_t)mesh->indexCount + 1) * sizeof(uint32_t));
+	if (result == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
+
+	uint32_t count = 0;
+	float error = 0.0f;
+	StardustErrorCode ret = _post_SimplifyIndices(mesh, mesh->indices, mesh->indexCount, targetIndexCount, targetError, result, &count, &error);
+	if (ret != STARDUST_ERROR_SUCCESS)
+	{
+		free(result);
+		return ret;
+	}
+
+	*indices = result;
+	*indexCount = count;
+	if (resultError != 0)
+		*resultError = error;
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+STARDUST_FUNC StardustErrorCode sd_EncodeMesh(const StardustMesh* mesh, unsigned char** data, size_t* size)
+{
+	return _codec_EncodeMesh(mesh, data, size);
+}
+
+STARDUST_FUNC StardustErrorCode sd_DecodeMesh(const unsigned char* data, size_t size, StardustMesh** mesh)
+{
+	*mesh = malloc(sizeof(StardustMesh));
+	if (*mesh == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
+	memset(*mesh, 0, sizeof(StardustMesh));
+
+	StardustErrorCode ret = _codec_DecodeMesh(data, size, *mesh);
+	if (ret != STARDUST_ERROR_SUCCESS)
+	{
+		sd_FreeMesh(*mesh);
+		*mesh = 0;
+		return ret;
+	}
+
+	bd_CalculateBounds((*mesh)->vertices, (*mesh)->vertexCount, _post_GetSettings()->instructionSet, &(*mesh)->bounds);
+	(*mesh)->dataType |= STARDUST_BOUNDS_DATA;
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+STARDUST_FUNC StardustErrorCode sd_BuildAdjacency(const StardustMesh* mesh, StardustAdjacency** adjacency)
+{
+	*adjacency = 0;
+
+	if (mesh->vertexStride < 3 || mesh->indexCount % mesh->vertexStride != 0)
+		return STARDUST_ERROR_INVALID_ARGUMENT;
+
+	StardustAdjacency* result = malloc(sizeof(StardustAdjacency));
+	if (result == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
+
+	StardustErrorCode ret = _post_BuildAdjacency(mesh, 1, result);
+	if (ret != STARDUST_ERROR_SUCCESS)
+	{
+		free(result);
+		return ret;
+	}
+
+	*adjacency = result;
+	return STARDUST_ERROR_SUCCESS;
+}
+
+STARDUST_FUNC void sd_FreeAdjacency(StardustAdjacency* adjacency)
+{
+	if (adjacency == 0)
+		return;
+
+	_post_FreeAdjacency(adjacency);
+	free(adjacency);
+}
+
+STARDUST_FUNC StardustErrorCode sd_BuildBVH(const StardustMesh* mesh, StardustBVH** bvh)
+{
+	*bvh = 0;
+
+	if (mesh->vertexStride != 3 || mesh->indexCount % 3 != 0)
+		return STARDUST_ERROR_INVALID_ARGUMENT;
+
+	StardustBVH* result = malloc(sizeof(StardustBVH));
+	if (result == 0) { return STARDUST_ERROR_MEMORY_ERROR; }
+	memset(result, 0, sizeof(StardustBVH));
+
+	StardustErrorCode ret = _bvh_Build(mesh, _post_GetSettings()->instructionSet, result);
+	if (ret != STARDUST_ERROR_SUCCESS)
+	{
+		sd_FreeBVH(result);
+		return ret;
+	}
+
+	*bvh = result;
+	return STARDUST_ERROR_SUCCESS;
+}
+
+STARDUST_FUNC void sd_FreeBVH(StardustBVH* bvh)
+{
+	if (bvh == 0)
+		return;
+
+	_bvh_Free(bvh);
+	free(bvh);
+}
+
+STARDUST_FUNC int sd_RaycastBVH(const StardustBVH* bvh, const float* origin, const float* direction, float maxDistance, StardustRayHit* hit)
+{
+	return _bvh_Raycast(bvh, origin, direction, maxDistance, hit);
+}
+
+STARDUST_FUNC uint32_t sd_OverlapBVH(const StardustBVH* bvh, const float* minimum, const float* maximum, uint32_t* triangles, uint32_t capacity)
+{
+	return _bvh_Overlap(bvh, minimum, maximum, triangles, capacity);
+}
+
 STARDUST_FUNC const char* sd_TranslateError(StardustErrorCode error)
 {
 	switch (error)
@@ -139,6 +543,8 @@ STARDUST_FUNC const char* sd_TranslateError(StardustErrorCode error)
 		return "IO error";
 	case STARDUST_ERROR_MEMORY_ERROR:
 		return "Memory Error. Failed to allocate memory through malloc";
+	case STARDUST_ERROR_INVALID_ARGUMENT:
+		return "Invalid argument. The mesh or a parameter is not supported by the function";
 	}
 
 	return "Unknown Error";
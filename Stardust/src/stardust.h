@@ -49,6 +49,9 @@ DOCUMENTATION:
 		StardustMeshFlags -> unsigned integer to hold mesh flags
 		StardustErrorCode -> unsigned integer to hold error enums
 		StardustMeshDataType -> unsigned integer to hold the type of data in a mesh
+		StardustNormalWeighting -> unsigned integer to hold how faces are weighted when generating normals
+		StardustInstructionSet -> unsigned integer to hold the highest instruction set SIMD code may use
+		StardustPostProcessStages -> unsigned integer to hold the post processing stages that ran on a mesh
 
 
 	StardustMesh Object:
@@ -57,9 +60,23 @@ DOCUMENTATION:
 		StardustMeshDataType dataType -> The forms of data stored in the vertices. This includes normal data, vertex data, uv data, smoothing, etc...
 		Vertex* vertices -> The vertex array. This contains the mesh vertex data
 		uint32_t* indices -> The index array. This contains the mesh index data
+		Tangent* tangents -> The tangent array. Holds one tangent per vertex when the mesh has STARDUST_TANGENT_DATA, otherwise 0
 		uint32_t vertexCount -> The amount of vertices in the vertex array
 		uint32_t indexCount -> the amount of indices in the index array
 		uint32_t vertexStride -> The amount of indices per face.
+		StardustPostProcessStages postProcessStages -> STARDUST_STAGE_* bits of the post processing stages that ran on the mesh.
+			Stages that had nothing to do, like triangulating a triangulated mesh, are not reported. Stages that ran in a single pass
+			are also marked with a STARDUST_STAGE_FUSED_* bit
+		float acmr -> The average cache miss ratio of the index buffer, or vertex shader runs per triangle, after STARDUST_MESH_OPTIMIZE_VERTEX_CACHE or STARDUST_MESH_OPTIMIZE_OVERDRAW.
+			Ranges from about 0.5 for large regular grids to 3 for no reuse at all. Measured with a FIFO cache of vertexCacheSize
+		StardustMeshlet* meshlets -> The meshlet array when the mesh has STARDUST_MESHLET_DATA, otherwise 0
+		uint32_t meshletCount -> The amount of meshlets in the meshlet array
+		uint32_t* meshletVertices -> The vertices of every meshlet. Meshlet m uses meshletVertices[m.vertexOffset] to meshletVertices[m.vertexOffset + m.vertexCount - 1]
+		uint8_t* meshletTriangles -> The micro indices of every meshlet. Triangle t of meshlet m is meshletTriangles[m.triangleOffset + t * 3] to [m.triangleOffset + t * 3 + 2]
+		StardustLOD* lods -> The levels of detail when the mesh has STARDUST_LOD_DATA, otherwise 0. Each one is an index buffer into the mesh's vertex array
+		uint32_t lodCount -> The amount of levels in the lods array
+		StardustBounds bounds -> The axis aligned bounding box and a bounding sphere of every vertex in the vertex array, including unused ones.
+			Filled for every loaded or decoded mesh after post processing, which sets STARDUST_BOUNDS_DATA
 
 
 	Loading Meshes:
@@ -70,8 +87,91 @@ DOCUMENTATION:
 		The function returns a StardustErrorCode, if this is equal to STARDUST_ERROR_SUCCESS the operation completed succesfully
 		and the data inside can be trusted.
 
+	Creating and Processing Meshes:
+		sd_CreateMesh() builds a mesh from vertex and index arrays, for meshes generated in code rather than loaded from a file.
+		sd_PostProcessMesh() runs the post processing stages of a set of flags on any mesh, so a loaded mesh can be processed again
+		with other flags without reloading the file. Stages run in the same order as while loading and postProcessStages gains their bits.
+		Stages that replace the vertices or triangles, like welding or normal generation, drop the tangents, meshlets and levels of detail
+		of earlier runs along with the stage bits of every order optimisation, as those no longer match the mesh.
+
+	Merging Meshes:
+		STARDUST_MESH_MERGE_MESHES returns a single mesh holding the vertices and indices of every mesh in the file, in file order.
+		The indices of each mesh are moved past the vertices of the meshes before it. Meshes are merged before any post processing,
+		so stages like welding and vertex cache optimisation work across the whole result. The merged mesh has the data types of
+		every mesh combined. Vertices of meshes without an attribute get zero normals and texture coordinates and white colours.
+		If the meshes have different face sizes they are triangulated first, which sets STARDUST_STAGE_TRIANGULATE.
+
+	Post Processing Settings:
+		Some post processing stages take parameters, like the tolerances used by STARDUST_MESH_WELD_VERTICES.
+		These are stored in a StardustPostProcessSettings struct. Call sd_GetPostProcessSettings() to get the current settings,
+		change the values and pass it back to sd_SetPostProcessSettings().
+
+		Some stages, like face normal calculation, have SIMD kernels for SSE2, AVX2 and AVX-512. The best one the CPU supports
+		is picked at runtime, capped by instructionSet. With deterministic set, every kernel gives the same bits as the scalar code.
+
+	Tangents:
+		STARDUST_MESH_GENERATE_TANGENTS fills a separate tangent stream that runs parallel to the vertex array.
+		Tangents follow MikkTSpace: the per triangle tangent is projected onto each vertex normal and weighted by the corner angle.
+		Vertices shared by triangles with mirrored texture coordinates are split so that each copy has one handedness.
+		Meshes without texture coordinates, or without normals when normals aren't generated, don't get tangents.
+
+	Degenerate Triangles:
+		STARDUST_MESH_REMOVE_DEGENERATES drops triangles that repeat an index or whose corners are collinear, as they have no normal.
+		Vertices that no remaining triangle uses are then removed, keeping the order of the rest. It runs right after triangulation so
+		that normal generation never sees a degenerate triangle, and again after welding, which can collapse small triangles.
+
+	Spatial Sorting:
+		STARDUST_MESH_SORT_TRIANGLES and STARDUST_MESH_SORT_VERTICES put triangles or vertices that are close together next to each other in memory,
+		which helps code that walks the mesh by position, like collision, ray casts or meshlet building. Each one is sorted by the 30 bit Morton code
+		of its centroid, or its position for vertices, inside the box around the vertices. The sort is a parallel radix sort and is stable, so the
+		result doesn't depend on the thread count. Sorting vertices updates every index buffer. Both run after levels of detail are generated and
+		before the vertex cache and vertex fetch optimisations, which decide the final order when they are also requested.
+
+	Vertex Cache Optimization:
+		STARDUST_MESH_OPTIMIZE_VERTEX_CACHE reorders the triangles of a mesh with Tom Forsyth's linear speed vertex cache optimisation.
+		Only the order of the indices changes. sd_CalculateACMR() measures the ACMR of any mesh, so the order before and after can be compared.
+
+		STARDUST_MESH_OPTIMIZE_OVERDRAW then cuts that order into clusters, following Tipsify by Sander et al., and draws the clusters that face
+		out from the centre of the mesh first. overdrawThreshold trades vertex cache efficiency for smaller clusters that can be sorted more finely.
+
+		STARDUST_MESH_OPTIMIZE_VERTEX_FETCH runs after both and renumbers the vertices in the order the final index buffer first uses them,
+		so vertex fetches walk through memory. The vertex and tangent arrays are permuted together. Unused vertices are moved to the end.
+
+	Meshlets:
+		STARDUST_MESH_BUILD_MESHLETS splits a triangulated mesh into meshlets of at most meshletMaxVertices vertices and meshletMaxTriangles triangles.
+		Meshlets grow from their seed through neighbouring triangles, preferring ones that add few vertices and are close to the meshlet's centre.
+		Each meshlet has a bounding sphere and a normal cone for culling. Meshlets are built last, after every stage that changes the indices.
+
+	Simplification:
+		sd_SimplifyMesh() builds a smaller index buffer for a triangulated mesh by collapsing edges in order of their quadric error.
+		The result indexes the mesh's own vertex array, so no vertices are created. Borders stay where they are, and texture or normal seams
+		only collapse along themselves so that the attributes on either side stay intact. Errors are relative to the largest extent of the mesh.
+
+		STARDUST_MESH_GENERATE_LODS runs the same simplification while loading and fills StardustMesh::lods with up to lodCount levels.
+		Each level aims for lodReduction times the triangles of the level before. The chain stops early once lodTargetError keeps a level
+		from getting any simpler. The vertex cache and overdraw passes are also applied to every level.
+
+	Compression:
+		sd_EncodeMesh() packs the vertex and index buffers of a mesh, and its tangents, into one payload for caches or network transfer.
+		Triangles are coded against the edges and vertices of recent triangles, so a typical triangle after vertex fetch optimisation costs a byte.
+		Vertex attributes are stored as the bitwise difference to the previous vertex, split into byte planes and bit packed, which is lossless.
+		sd_DecodeMesh() returns a new mesh and fails cleanly on corrupted payloads. Meshlets and levels of detail are not stored.
+
+	Adjacency:
+		sd_BuildAdjacency() builds the connectivity of a mesh once so that algorithms can walk it instead of searching for neighbours.
+		Every index is a half-edge to the next corner of its face, and StardustAdjacency::twins pairs it with the half-edge running the other way.
+		Unpaired half-edges are borders, or edges shared by more than two faces. The corners around each position are stored in compressed rows.
+		Both are built with hash tables in time linear in the size of the mesh. Normal smoothing and generation use the same position groups.
+
+	Bounding Volume Hierarchies:
+		sd_BuildBVH() builds a BVH over a triangulated mesh for ray casts and box queries, such as picking, baking or collision.
+		Nodes have 4 children and leaves hold up to 4 triangles, so queries test 4 boxes or triangles at a time with SSE2.
+		sd_RaycastBVH() finds the closest hit of a ray and sd_OverlapBVH() lists the triangles whose bounds overlap a box.
+		The BVH owns copies of the positions it needs. Delete it with sd_FreeBVH().
+
 	Deleting Meshes:
-		To delete a mesh call the sd_FreeMesh() function on the mesh. This works on individual meshes so ensure that every mesh in the returned array is deleted
+		To delete the meshes returned by sd_LoadMesh() call sd_FreeMeshes() with the array and the mesh count. The meshes share one allocation,
+		so they can't be deleted one at a time. A mesh made by sd_CreateMesh() is deleted with sd_FreeMesh()
 
 */
 
@@ -84,7 +184,7 @@ DOCUMENTATION:
 enum MeshFlags
 {
 	STARDUST_MESH_IGNORE_NORMALS = 1 << 0,			//Doesn't load normals from file.
-	STARDUST_MESH_GENERATE_NORMALS = 1 << 1,		//Genrates mesh normals after loading the mesh
+	STARDUST_MESH_GENERATE_NORMALS = 1 << 1,		//Genrates mesh normals after loading the mesh. Combine with STARDUST_MESH_SMOOTH_NORMALS to only harden edges above the crease angle
 	STARDUST_MESH_HARDEN_NORMALS = 1 << 1,			//Hardens any normals
 	STARDUST_MESH_SMOOTH_NORMALS = 1 << 2,			//Smooths any normals
 
@@ -92,8 +192,25 @@ enum MeshFlags
 
 	STARDUST_MESH_TRIANGULATE = 1 << 5,			//Triangulate mesh. Safe to call on pretriangulated meshes.
 	
-	STARDUST_MESH_MERGE_MESHES = 1 << 6,			//Merges all meshes into a single mesh
-	STARDUST_MESH_USE_FIRST_MESH = 1 << 7			//Only uses first mesh found in file
+	STARDUST_MESH_MERGE_MESHES = 1 << 6,			//Merges all meshes into a single mesh before post processing. Meshes with different face sizes are triangulated
+	STARDUST_MESH_USE_FIRST_MESH = 1 << 7,			//Only uses first mesh found in file
+
+	STARDUST_MESH_WELD_VERTICES = 1 << 8,			//Merges vertices that are within the weld tolerances of StardustPostProcessSettings
+
+	STARDUST_MESH_GENERATE_TANGENTS = 1 << 9,		//Generates MikkTSpace tangents into StardustMesh::tangents. Needs texture coordinates and normals, which can be generated
+
+	STARDUST_MESH_OPTIMIZE_VERTEX_CACHE = 1 << 10,	//Reorders triangles for the post transform vertex cache. The resulting ACMR is stored in StardustMesh::acmr
+	STARDUST_MESH_OPTIMIZE_OVERDRAW = 1 << 11,		//Reorders clusters of triangles to reduce overdraw. Also optimises the vertex cache, as the clusters are cut from that order
+	STARDUST_MESH_OPTIMIZE_VERTEX_FETCH = 1 << 12,	//Renumbers vertices in the order the indices first use them
+
+	STARDUST_MESH_BUILD_MESHLETS = 1 << 13,			//Splits the mesh into meshlets with the limits in StardustPostProcessSettings. Stored in StardustMesh::meshlets
+
+	STARDUST_MESH_GENERATE_LODS = 1 << 14,			//Simplifies the mesh into the levels of detail described by StardustPostProcessSettings. Stored in StardustMesh::lods
+
+	STARDUST_MESH_REMOVE_DEGENERATES = 1 << 15,		//Removes triangles with repeated indices or no area, then every vertex no triangle uses. Triangulates the mesh
+
+	STARDUST_MESH_SORT_TRIANGLES = 1 << 16,			//Reorders triangles by the Morton code of their centroids. Triangulates the mesh
+	STARDUST_MESH_SORT_VERTICES = 1 << 17			//Renumbers vertices by the Morton code of their positions
 };
 
 enum MeshDataFlags
@@ -103,7 +220,47 @@ enum MeshDataFlags
 	STARDUST_TEXTURE_DATA = 1 << 2,
 	STARDUST_NORMAL_DATA = 1 << 3,
 	STARDUST_COLOR_DATA = 1 << 4,
-	STARDUST_SMOOTHSHADING = 1 << 5
+	STARDUST_SMOOTHSHADING = 1 << 5,
+	STARDUST_TANGENT_DATA = 1 << 6,
+	STARDUST_MESHLET_DATA = 1 << 7,
+	STARDUST_LOD_DATA = 1 << 8,
+	STARDUST_BOUNDS_DATA = 1 << 9
+};
+
+enum NormalWeightings
+{
+	STARDUST_NORMAL_WEIGHT_AREA = 0,		//Faces contribute to vertex normals by their area
+	STARDUST_NORMAL_WEIGHT_ANGLE = 1		//Faces contribute to vertex normals by the angle of the corner at the vertex
+};
+
+enum PostProcessStages
+{
+	STARDUST_STAGE_TRIANGULATE = 1 << 0,		//Polygons were triangulated
+	STARDUST_STAGE_GENERATE_NORMALS = 1 << 1,	//Normals were generated
+	STARDUST_STAGE_SMOOTH_NORMALS = 1 << 2,		//Normals were smoothed. Either generated with a crease angle or the existing normals were averaged
+	STARDUST_STAGE_WELD_VERTICES = 1 << 3,		//Vertices were welded
+
+	STARDUST_STAGE_FUSED_TRIANGULATE = 1 << 4,	//Triangulation ran in the same pass as normal generation
+	STARDUST_STAGE_FUSED_WELD = 1 << 5,			//Welding ran in the same pass as normal generation
+
+	STARDUST_STAGE_GENERATE_TANGENTS = 1 << 6,	//Tangents were generated
+	STARDUST_STAGE_OPTIMIZE_VERTEX_CACHE = 1 << 7, //Triangles were reordered for the vertex cache
+	STARDUST_STAGE_OPTIMIZE_OVERDRAW = 1 << 8,	//Triangle clusters were reordered to reduce overdraw
+	STARDUST_STAGE_OPTIMIZE_VERTEX_FETCH = 1 << 9, //Vertices were renumbered by first use
+	STARDUST_STAGE_BUILD_MESHLETS = 1 << 10,		//Meshlets were built
+	STARDUST_STAGE_GENERATE_LODS = 1 << 11,		//Levels of detail were generated
+	STARDUST_STAGE_REMOVE_DEGENERATES = 1 << 12,	//Degenerate triangles and unused vertices were removed
+	STARDUST_STAGE_SORT_TRIANGLES = 1 << 13,		//Triangles were sorted in Morton order
+	STARDUST_STAGE_SORT_VERTICES = 1 << 14		//Vertices were sorted in Morton order
+};
+
+enum InstructionSets
+{
+	STARDUST_INSTRUCTIONS_BEST = 0,			//Use the best instruction set the CPU supports
+	STARDUST_INSTRUCTIONS_SCALAR = 1,		//Plain C, no SIMD
+	STARDUST_INSTRUCTIONS_SSE2 = 2,			//4 wide
+	STARDUST_INSTRUCTIONS_AVX2 = 3,			//8 wide
+	STARDUST_INSTRUCTIONS_AVX512 = 4		//16 wide
 };
 
 enum ErrorCodes
@@ -115,12 +272,16 @@ enum ErrorCodes
 	STARDUST_ERROR_FILE_INVALID = 4,
 	STARDUST_ERROR_IO_ERROR = 5,
 	STARDUST_ERROR_MEMORY_ERROR = 6,
-	STARDUST_ERROR_EOF = 7
+	STARDUST_ERROR_EOF = 7,
+	STARDUST_ERROR_INVALID_ARGUMENT = 8
 };
 
 typedef unsigned int StardustMeshFlags;
 typedef unsigned int StardustErrorCode;
 typedef unsigned int StardustMeshDataType;
+typedef unsigned int StardustNormalWeighting;
+typedef unsigned int StardustInstructionSet;
+typedef unsigned int StardustPostProcessStages;
 
 // ================== Structs ================== //
 typedef struct
@@ -143,26 +304,223 @@ typedef struct
 	float		texW;			//W coord of UVW
 } Vertex;
 
+typedef struct
+{
+	float		x;				//Tangent X component
+	float		y;				//Tangent Y component
+	float		z;				//Tangent Z component
+	float		w;				//Handedness. 1 or -1. The bitangent is w * cross(normal, tangent)
+} Tangent;
+
+typedef struct
+{
+	uint32_t	vertexOffset;	//Offset of the meshlet's vertices into StardustMesh::meshletVertices
+	uint32_t	triangleOffset;	//Offset of the meshlet's micro indices into StardustMesh::meshletTriangles
+	uint32_t	vertexCount;	//Number of vertices used by the meshlet
+	uint32_t	triangleCount;	//Number of triangles in the meshlet
+
+	float		centerX;		//Bounding sphere centre X
+	float		centerY;		//Bounding sphere centre Y
+	float		centerZ;		//Bounding sphere centre Z
+	float		radius;			//Bounding sphere radius
+
+	float		coneApexX;		//Normal cone apex X
+	float		coneApexY;		//Normal cone apex Y
+	float		coneApexZ;		//Normal cone apex Z
+	float		coneAxisX;		//Normal cone axis X
+	float		coneAxisY;		//Normal cone axis Y
+	float		coneAxisZ;		//Normal cone axis Z
+	float		coneCutoff;		//Every triangle faces away from a camera at C when dot(normalize(apex - C), axis) >= coneCutoff. 1 when the cone is too wide to cull
+} StardustMeshlet; //A small cluster of triangles for mesh shaders and cluster culling
+
+typedef struct
+{
+	uint32_t*	indices;		//Triangle list into the vertex array of the mesh the level belongs to
+	uint32_t	indexCount;		//Number of indices in the indices array
+	float		error;			//Deviation from the full mesh relative to its largest extent. Adds up along the chain
+} StardustLOD; //A simplified level of detail of a mesh
+
+typedef struct
+{
+	float		minX;			//Bounding box minimum X
+	float		minY;			//Bounding box minimum Y
+	float		minZ;			//Bounding box minimum Z
+	float		maxX;			//Bounding box maximum X
+	float		maxY;			//Bounding box maximum Y
+	float		maxZ;			//Bounding box maximum Z
+
+	float		centerX;		//Bounding sphere centre X
+	float		centerY;		//Bounding sphere centre Y
+	float		centerZ;		//Bounding sphere centre Z
+	float		radius;			//Bounding sphere radius
+} StardustBounds; //Bounding volumes of the vertex positions of a mesh
+
+#define STARDUST_ADJACENCY_NONE 0xFFFFFFFFu	//StardustAdjacency::twins of a half-edge on a border or a non-manifold edge
+
+typedef struct
+{
+	uint32_t	vertexStride;	//Corners per face. Face f owns the half-edges f * vertexStride to f * vertexStride + vertexStride - 1
+	uint32_t	faceCount;		//Number of faces
+	uint32_t	halfEdgeCount;	//One per index. Half-edge h runs from the vertex of corner h to the vertex of the next corner of its face
+	uint32_t*	twins;			//Half-edge running the other way between the same positions, or STARDUST_ADJACENCY_NONE
+
+	uint32_t	positionCount;	//Number of unique positions. Vertices split by normal or uv seams share a position
+	uint32_t*	vertexPositions; //Position of every vertex
+	uint32_t*	cornerStart;	//Corners around position p are corners[cornerStart[p]] to corners[cornerStart[p + 1] - 1]. positionCount + 1 offsets
+	uint32_t*	corners;		//Corners, or index buffer positions, grouped by position. The face of corner c is c / vertexStride
+} StardustAdjacency; //Half-edge connectivity of a mesh and the faces around every position, in compressed rows
+
+#define STARDUST_BVH_LEAF 0x80000000u	//Set on StardustBVHNode::children that are leaves. The rest is the index of the leaf
+#define STARDUST_BVH_EMPTY 0xFFFFFFFFu	//Unused child slot, or unused triangle slot of a leaf
+
+typedef struct
+{
+	float		minX[4];		//Bounding box minimum X of each child
+	float		minY[4];		//Bounding box minimum Y of each child
+	float		minZ[4];		//Bounding box minimum Z of each child
+	float		maxX[4];		//Bounding box maximum X of each child
+	float		maxY[4];		//Bounding box maximum Y of each child
+	float		maxZ[4];		//Bounding box maximum Z of each child
+	uint32_t	children[4];	//Index of a child node, STARDUST_BVH_LEAF | index of a leaf, or STARDUST_BVH_EMPTY
+} StardustBVHNode; //Node of a 4 wide BVH. Child boxes are stored as structures of arrays so all 4 can be tested at once
+
+typedef struct
+{
+	float		ax[4], ay[4], az[4];	//First vertex of each triangle
+	float		bx[4], by[4], bz[4];	//Second vertex of each triangle
+	float		cx[4], cy[4], cz[4];	//Third vertex of each triangle
+	uint32_t	triangles[4];			//Triangle index into the mesh's indices, or STARDUST_BVH_EMPTY
+} StardustBVHLeaf; //Up to 4 triangles with copies of their positions, so leaves are tested without touching the mesh
+
+typedef struct
+{
+	StardustBVHNode* nodes;			//Node array. The root is nodes[0]
+	uint32_t		nodeCount;		//Number of nodes in the nodes array
+	StardustBVHLeaf* leaves;		//Leaf array
+	uint32_t		leafCount;		//Number of leaves in the leaves array
+	uint32_t		triangleCount;	//Number of triangles in the BVH
+	uint32_t		depth;			//Number of nodes on the longest path from the root
+
+	StardustInstructionSet instructionSet; //Instruction set the queries use. Picked when the BVH is built
+} StardustBVH; //Bounding volume hierarchy over the triangles of a mesh
+
+typedef struct
+{
+	float		distance;		//Distance along the ray in lengths of its direction
+	float		u;				//Barycentric weight of the triangle's second vertex
+	float		v;				//Barycentric weight of the triangle's third vertex
+	uint32_t	triangle;		//Triangle index. Its indices start at indices[triangle * 3]
+} StardustRayHit; //Closest hit of a ray
+
 typedef struct 
 {
 	StardustMeshDataType dataType;		//Types of data contained in the mesh
 
 	Vertex*			vertices;		//Vertex array
 	uint32_t*		indices;		//Index Array	
+	Tangent*		tangents;		//Tangent of every vertex. 0 unless the mesh has STARDUST_TANGENT_DATA
 
 	uint32_t		vertexCount;	//Number of vertices in the vertices array
 	uint32_t		indexCount;		//Number of indices in the indices array
 
 	uint32_t		vertexStride;//Number of verticies per face
 
+	StardustPostProcessStages postProcessStages; //Post processing stages that ran on the mesh
+	float			acmr;			//Average cache miss ratio after STARDUST_MESH_OPTIMIZE_VERTEX_CACHE or STARDUST_MESH_OPTIMIZE_OVERDRAW. 0 if neither ran
+
+	StardustMeshlet* meshlets;		//Meshlet array. 0 unless the mesh has STARDUST_MESHLET_DATA
+	uint32_t		meshletCount;	//Number of meshlets in the meshlets array
+	uint32_t*		meshletVertices; //Vertex indices of every meshlet
+	uint8_t*		meshletTriangles; //3 micro indices per meshlet triangle. Each indexes into the meshlet's vertices
+
+	StardustLOD*	lods;			//Levels of detail, most detailed first. 0 unless the mesh has STARDUST_LOD_DATA
+	uint32_t		lodCount;		//Number of levels in the lods array
+
+	StardustBounds	bounds;			//Bounding box and sphere of every vertex. Set when the mesh has STARDUST_BOUNDS_DATA
+
 } StardustMesh; //Mesh structure. Retured in arrays of each individual componenets
 
+typedef struct
+{
+	float		weldPositionTolerance;	//Maximum distance between the positions of two welded vertices. Defaults to 1e-5
+	float		weldNormalAngle;		//Maximum angle, in radians, between the normals of two welded vertices. Defaults to 1 degree
+	float		weldUVTolerance;		//Maximum difference of each texture coordinate component of two welded vertices. Defaults to 1e-5
+
+	float		normalCreaseAngle;		//Angle, in radians, between two faces above which smooth normal generation keeps the edge hard. Defaults to PI (smooth every edge)
+	StardustNormalWeighting normalWeighting; //How faces are weighted when generating smooth normals. Defaults to STARDUST_NORMAL_WEIGHT_AREA
+
+	StardustInstructionSet instructionSet;	//Highest instruction set the SIMD kernels may use. Lower it to compare against slower paths. Defaults to STARDUST_INSTRUCTIONS_BEST
+	int			deterministic;			//When non zero every instruction set gives bit identical results. Otherwise faster approximations may be used. Defaults to 1
+
+	uint32_t	vertexCacheSize;		//Number of vertices in the cache modelled by STARDUST_MESH_OPTIMIZE_VERTEX_CACHE and sd_CalculateACMR. Values below 4 are treated as 4. Defaults to 32
+	float		overdrawThreshold;		//How much STARDUST_MESH_OPTIMIZE_OVERDRAW may raise the ACMR of each cluster over the cache optimised order. 1 keeps the ACMR. Defaults to 1.05
+
+	uint32_t	meshletMaxVertices;		//Maximum vertices per meshlet. Clamped to 3 to 256 as micro indices are 8 bit. Defaults to 64
+	uint32_t	meshletMaxTriangles;	//Maximum triangles per meshlet. Clamped to 1 to 512. Defaults to 124
+
+	uint32_t	lodCount;				//Maximum levels of detail made by STARDUST_MESH_GENERATE_LODS. Defaults to 3
+	float		lodReduction;			//Fraction of the triangles of the previous level each level aims for. Defaults to 0.5
+	float		lodTargetError;			//Largest error each level may add, relative to the largest extent of the mesh. Defaults to 0.01
+
+} StardustPostProcessSettings; //Parameters used by the post processing stages. Shared by every load
+
 //Function prototypes
 STARDUST_FUNC StardustErrorCode sd_LoadMesh(const char* filename, const StardustMeshFlags flags, StardustMesh** meshes, size_t* meshCount);
+
+/// <summary>
+/// Deletes a single mesh, such as one made by sd_CreateMesh(). Use sd_FreeMeshes() for the array returned by sd_LoadMesh()
+/// </summary>
+/// <param name="mesh">Mesh to delete</param>
 STARDUST_FUNC void sd_FreeMesh(StardustMesh* mesh);
 
+/// <summary>
+/// Deletes every mesh in an array returned by sd_LoadMesh(), along with the array
+/// </summary>
+/// <param name="meshes">Mesh array</param>
+/// <param name="meshCount">Number of meshes in the array</param>
+STARDUST_FUNC void sd_FreeMeshes(StardustMesh* meshes, size_t meshCount);
+
+/// <summary>
+/// Creates a mesh from vertex and index arrays, such as a procedurally generated one, so that it can be post processed like a loaded mesh.
+/// The arrays are copied. The bounds are calculated, but no other post processing runs until sd_PostProcessMesh() is called.
+/// </summary>
+/// <param name="vertices">Vertex array</param>
+/// <param name="vertexCount">Number of vertices</param>
+/// <param name="indices">Index array. Every face has vertexStride indices</param>
+/// <param name="indexCount">Number of indices</param>
+/// <param name="vertexStride">Corners per face. 3 for triangles</param>
+/// <param name="dataType">Attributes filled in the vertices. STARDUST_TEXTURE_DATA, STARDUST_NORMAL_DATA, STARDUST_COLOR_DATA and STARDUST_SMOOTHSHADING are used, the rest are ignored</param>
+/// <param name="mesh">Filled with the new mesh. Delete it with sd_FreeMesh()</param>
+/// <returns>Error code. STARDUST_ERROR_INVALID_ARGUMENT if vertexStride is below 3, the indices don't fill whole faces or an index is out of range</returns>
+STARDUST_FUNC StardustErrorCode sd_CreateMesh(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, uint32_t vertexStride, StardustMeshDataType dataType, StardustMesh** mesh);
+
+/// <summary>
+/// Runs the post processing stages of flags on a loaded or created mesh, the same way sd_LoadMesh() does, then recalculates the bounds.
+/// Flags that only apply while loading, like STARDUST_MESH_IGNORE_NORMALS or STARDUST_MESH_MERGE_MESHES, are ignored.
+/// Stages that replace the vertices or triangles first drop the tangents, meshlets and levels of detail of earlier runs.
+/// </summary>
+/// <param name="mesh">Mesh to process</param>
+/// <param name="flags">The post processing flags</param>
+/// <returns>Error code. On failure the mesh is still valid, but stages before the failing one may have run</returns>
+STARDUST_FUNC StardustErrorCode sd_PostProcessMesh(StardustMesh* mesh, StardustMeshFlags flags);
+
 STARDUST_FUNC int sd_isFormatSupported(const char* format);
 
+// Settings Functions
+
+/// <summary>
+/// Copies the current post processing settings into settings
+/// </summary>
+/// <param name="settings">Settings struct to fill</param>
+STARDUST_FUNC void sd_GetPostProcessSettings(StardustPostProcessSettings* settings);
+
+/// <summary>
+/// Sets the post processing settings used by every subsequent load.
+/// Should not be called while a mesh is being loaded
+/// </summary>
+/// <param name="settings">New settings</param>
+STARDUST_FUNC void sd_SetPostProcessSettings(const StardustPostProcessSettings* settings);
+
 // Vertex Functions
 
 /// <summary>
@@ -181,6 +539,95 @@ STARDUST_FUNC void sd_PrintVertex(Vertex* v);
 STARDUST_FUNC int sd_CompareVertexPosition(Vertex* a, Vertex* b);
 STARDUST_FUNC int sd_CompareVertex(Vertex* a, Vertex* b);
 
+// Mesh Functions
+
+/// <summary>
+/// Calculates the average cache miss ratio of a triangulated mesh. This is the number of vertices transformed per triangle
+/// by a GPU with a FIFO post transform cache of cacheSize vertices.
+/// </summary>
+/// <param name="mesh">Triangulated mesh</param>
+/// <param name="cacheSize">Number of vertices in the cache</param>
+/// <returns>ACMR. 0 for meshes without triangles</returns>
+STARDUST_FUNC float sd_CalculateACMR(const StardustMesh* mesh, uint32_t cacheSize);
+
+/// <summary>
+/// Simplifies a triangulated mesh by collapsing edges until at most targetIndexCount indices are left or the next collapse would
+/// move the surface further than targetError. The mesh is not changed.
+/// </summary>
+/// <param name="mesh">Triangulated mesh</param>
+/// <param name="targetIndexCount">Number of indices to aim for</param>
+/// <param name="targetError">Largest error allowed, relative to the largest extent of the mesh. 0.01 is 1%</param>
+/// <param name="indices">Filled with a new index buffer into mesh->vertices. Free it with free()</param>
+/// <param name="indexCount">Filled with the number of indices in the new buffer</param>
+/// <param name="resultError">Filled with the error of the result. Can be 0</param>
+/// <returns>Error code. STARDUST_ERROR_INVALID_ARGUMENT if the mesh is not triangulated</returns>
+STARDUST_FUNC StardustErrorCode sd_SimplifyMesh(const StardustMesh* mesh, uint32_t targetIndexCount, float targetError, uint32_t** indices, uint32_t* indexCount, float* resultError);
+
+/// <summary>
+/// Compresses the vertices, indices and tangents of a mesh. Decoding gives back the same bits, though triangles may start from a different corner.
+/// </summary>
+/// <param name="mesh">Mesh to encode</param>
+/// <param name="data">Filled with the payload. Free it with free()</param>
+/// <param name="size">Filled with the size of the payload in bytes</param>
+/// <returns>Error code</returns>
+STARDUST_FUNC StardustErrorCode sd_EncodeMesh(const StardustMesh* mesh, unsigned char** data, size_t* size);
+
+/// <summary>
+/// Decompresses a payload made by sd_EncodeMesh()
+/// </summary>
+/// <param name="data">Payload</param>
+/// <param name="size">Size of the payload in bytes</param>
+/// <param name="mesh">Filled with a new mesh. Delete it with sd_FreeMesh()</param>
+/// <returns>Error code. STARDUST_ERROR_FILE_INVALID if the payload is corrupted</returns>
+STARDUST_FUNC StardustErrorCode sd_DecodeMesh(const unsigned char* data, size_t size, StardustMesh** mesh);
+
+// Adjacency Functions
+
+/// <summary>
+/// Builds the half-edge connectivity of a mesh and the corners around every position in linear time.
+/// Vertices are grouped by exact position with a hash table, so the connectivity crosses uv and normal seams.
+/// Half-edges are paired through a hash table of directed edges. Edges used more than once in the same direction are non-manifold and left unpaired.
+/// </summary>
+/// <param name="mesh">Mesh with faces of vertexStride corners. Doesn't have to be triangulated</param>
+/// <param name="adjacency">Filled with the new adjacency. Delete it with sd_FreeAdjacency()</param>
+/// <returns>Error code. STARDUST_ERROR_INVALID_ARGUMENT if the faces have fewer than 3 corners or the indices don't fill whole faces</returns>
+STARDUST_FUNC StardustErrorCode sd_BuildAdjacency(const StardustMesh* mesh, StardustAdjacency** adjacency);
+STARDUST_FUNC void sd_FreeAdjacency(StardustAdjacency* adjacency);
+
+// BVH Functions
+
+/// <summary>
+/// Builds a 4 wide BVH over the triangles of a triangulated mesh. Splits are picked with a binned surface area heuristic
+/// and large subtrees are built in parallel. The BVH copies the triangle positions, so it stays valid if the mesh is freed.
+/// </summary>
+/// <param name="mesh">Triangulated mesh</param>
+/// <param name="bvh">Filled with a new BVH. Delete it with sd_FreeBVH()</param>
+/// <returns>Error code. STARDUST_ERROR_INVALID_ARGUMENT if the mesh is not triangulated</returns>
+STARDUST_FUNC StardustErrorCode sd_BuildBVH(const StardustMesh* mesh, StardustBVH** bvh);
+STARDUST_FUNC void sd_FreeBVH(StardustBVH* bvh);
+
+/// <summary>
+/// Finds the closest triangle hit by a ray. Both sides of a triangle are hit
+/// </summary>
+/// <param name="bvh">BVH to trace</param>
+/// <param name="origin">Ray origin. 3 floats</param>
+/// <param name="direction">Ray direction. 3 floats. Doesn't need to be normalised</param>
+/// <param name="maxDistance">Hits further than this, in lengths of direction, are ignored</param>
+/// <param name="hit">Filled with the closest hit. Unchanged if nothing is hit</param>
+/// <returns>1 if a triangle was hit, otherwise 0</returns>
+STARDUST_FUNC int sd_RaycastBVH(const StardustBVH* bvh, const float* origin, const float* direction, float maxDistance, StardustRayHit* hit);
+
+/// <summary>
+/// Finds the triangles whose bounding boxes overlap a box. These are candidates for an exact test
+/// </summary>
+/// <param name="bvh">BVH to query</param>
+/// <param name="minimum">Box minimum. 3 floats</param>
+/// <param name="maximum">Box maximum. 3 floats</param>
+/// <param name="triangles">Filled with up to capacity triangle indices. Can be 0 when capacity is 0</param>
+/// <param name="capacity">Size of the triangles array</param>
+/// <returns>Number of overlapping triangles. Can be larger than capacity, in which case only the first capacity are written</returns>
+STARDUST_FUNC uint32_t sd_OverlapBVH(const StardustBVH* bvh, const float* minimum, const float* maximum, uint32_t* triangles, uint32_t capacity);
+
 //Error Functions
 STARDUST_FUNC const char* sd_TranslateError(StardustErrorCode error);
 
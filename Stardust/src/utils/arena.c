@@ -0,0 +1,98 @@
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//Space for the header, rounded up so that the first allocation is aligned
+#define AR_HEADER_SIZE ((sizeof(ArenaBlock) + AR_ALIGNMENT - 1) & ~(size_t)(AR_ALIGNMENT - 1))
+
+static unsigned char* _ar_BlockData(ArenaBlock* block)
+{
+	return (unsigned char*)block + AR_HEADER_SIZE;
+}
+
+void ar_InitArena(Arena* arena, size_t blockSize)
+{
+	arena->head = 0;
+	arena->blockSize = blockSize > 0 ? blockSize : AR_DEFAULT_BLOCK_SIZE;
+}
+
+void* ar_Allocate(Arena* arena, size_t size)
+{
+	size = (size + AR_ALIGNMENT - 1) & ~(size_t)(AR_ALIGNMENT - 1);
+
+	ArenaBlock* head = arena->head;
+	if (head != 0 && head->size - head->used >= size)
+	{
+		void* memory = _ar_BlockData(head) + head->used;
+		head->used += size;
+		return memory;
+	}
+
+	//Big allocations fill a block of their own. It goes behind the head, which keeps its free space
+	int dedicated = size > arena->blockSize / 2;
+	size_t blockSize = dedicated ? size : arena->blockSize;
+
+	ArenaBlock* block = malloc(AR_HEADER_SIZE + blockSize);
+	if (block == 0)
+		return 0;
+
+	block->size = blockSize;
+	block->used = size;
+
+	if (dedicated && head != 0)
+	{
+		block->next = head->next;
+		head->next = block;
+	}
+	else
+	{
+		block->next = head;
+		arena->head = block;
+	}
+
+	return _ar_BlockData(block);
+}
+
+void* ar_Grow(Arena* arena, void* memory, size_t oldSize, size_t newSize)
+{
+	if (memory != 0 && newSize <= oldSize)
+		return memory;
+
+	//The last allocation of the head block can take the free space after it
+	ArenaBlock* head = arena->head;
+	if (memory != 0 && head != 0)
+	{
+		size_t alignedOld = (oldSize + AR_ALIGNMENT - 1) & ~(size_t)(AR_ALIGNMENT - 1);
+		size_t alignedNew = (newSize + AR_ALIGNMENT - 1) & ~(size_t)(AR_ALIGNMENT - 1);
+		unsigned char* end = _ar_BlockData(head) + head->used;
+
+		if ((unsigned char*)memory + alignedOld == end && head->size - head->used >= alignedNew - alignedOld)
+		{
+			head->used += alignedNew - alignedOld;
+			return memory;
+		}
+	}
+
+	void* grown = ar_Allocate(arena, newSize);
+	if (grown == 0)
+		return 0;
+
+	if (memory != 0 && oldSize > 0)
+		memcpy(grown, memory, oldSize);
+
+	return grown;
+}
+
+void ar_FreeArena(Arena* arena)
+{
+	ArenaBlock* block = arena->head;
+	while (block != 0)
+	{
+		ArenaBlock* next = block->next;
+		free(block);
+		block = next;
+	}
+
+	arena->head = 0;
+}
@@ -0,0 +1,59 @@
+#ifndef _STARDUST_ARENA
+#define _STARDUST_ARENA
+
+#include "stardust.h"
+
+#include <stddef.h>
+
+#define AR_ALIGNMENT 16					//Alignment of every allocation
+#define AR_DEFAULT_BLOCK_SIZE 65536		//Bytes per block unless an allocation needs more
+
+//A block of arena memory. The allocations follow the header
+typedef struct ArenaBlock
+{
+	struct ArenaBlock* next;
+	size_t size;						//Usable bytes after the header
+	size_t used;
+} ArenaBlock;
+
+//Bump allocator. Allocations are never freed on their own, only the whole arena at once
+typedef struct
+{
+	ArenaBlock* head;					//Block being allocated from. Blocks are only appended behind it when an allocation is too big for a block
+	size_t blockSize;
+} Arena;
+
+/// <summary>
+/// Sets up an empty arena. No memory is allocated until the first allocation
+/// </summary>
+/// <param name="arena">Arena to set up</param>
+/// <param name="blockSize">Bytes per block. 0 uses AR_DEFAULT_BLOCK_SIZE</param>
+void ar_InitArena(Arena* arena, size_t blockSize);
+
+/// <summary>
+/// Allocates memory from an arena. Allocations bigger than half a block get a block of their own,
+/// so that the space left in the current block isn't thrown away
+/// </summary>
+/// <param name="arena">Arena to allocate from</param>
+/// <param name="size">Bytes to allocate</param>
+/// <returns>Memory aligned to AR_ALIGNMENT, or 0 if a block couldn't be allocated</returns>
+void* ar_Allocate(Arena* arena, size_t size);
+
+/// <summary>
+/// Grows an allocation. The last allocation of the current block grows in place if there is room,
+/// otherwise the data is copied into a new allocation and the old space stays unused until the arena is freed
+/// </summary>
+/// <param name="arena">Arena the allocation came from</param>
+/// <param name="memory">Allocation to grow. Can be 0</param>
+/// <param name="oldSize">Current size of the allocation</param>
+/// <param name="newSize">Size needed</param>
+/// <returns>The grown allocation, or 0 if memory couldn't be allocated. The old allocation is still valid then</returns>
+void* ar_Grow(Arena* arena, void* memory, size_t oldSize, size_t newSize);
+
+/// <summary>
+/// Frees every block of an arena and leaves it empty
+/// </summary>
+/// <param name="arena">Arena to free</param>
+void ar_FreeArena(Arena* arena);
+
+#endif //_STARDUST_ARENA
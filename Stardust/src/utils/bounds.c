@@ -0,0 +1,168 @@
+#include "bounds.h"
+#include "cpu.h"
+
+#include <math.h>
+#include <float.h>
+#include <string.h>
+
+#ifdef STARDUST_X86
+#include <immintrin.h>
+#endif
+
+void bd_CalculateBounds(const Vertex* vertices, uint32_t vertexCount, StardustInstructionSet requested, StardustBounds* bounds)
+{
+	memset(bounds, 0, sizeof(StardustBounds));
+	if (vertexCount == 0)
+		return;
+
+	float minimum[3], maximum[3];
+	uint32_t minimumVertex[3], maximumVertex[3];
+
+#ifdef STARDUST_X86
+	if (cpu_SelectInstructionSet(requested) >= STARDUST_INSTRUCTIONS_SSE2)
+		bd_FindExtremesSSE2(vertices, vertexCount, minimum, maximum, minimumVertex, maximumVertex);
+	else
+#endif
+		bd_FindExtremesScalar(vertices, vertexCount, minimum, maximum, minimumVertex, maximumVertex);
+
+	bounds->minX = minimum[0]; bounds->minY = minimum[1]; bounds->minZ = minimum[2];
+	bounds->maxX = maximum[0]; bounds->maxY = maximum[1]; bounds->maxZ = maximum[2];
+
+	//Start on the pair of extreme vertices that are furthest apart
+	const Vertex* a = &vertices[minimumVertex[0]];
+	const Vertex* b = &vertices[maximumVertex[0]];
+	float span2 = -1.0f;
+	for (int i = 0; i < 3; i++)
+	{
+		const Vertex* low = &vertices[minimumVertex[i]];
+		const Vertex* high = &vertices[maximumVertex[i]];
+
+		float dx = high->x - low->x;
+		float dy = high->y - low->y;
+		float dz = high->z - low->z;
+
+		float distance2 = dx * dx + dy * dy + dz * dz;
+		if (distance2 > span2)
+		{
+			span2 = distance2;
+			a = low;
+			b = high;
+		}
+	}
+
+	float centre[3] = { (a->x + b->x) * 0.5f, (a->y + b->y) * 0.5f, (a->z + b->z) * 0.5f };
+	float radius = sqrtf(span2) * 0.5f;
+	float radius2 = radius * radius;
+
+	//Ritter does badly on boxy meshes, so the sphere around the centre of the box is measured in the same pass and the smaller one kept
+	float boxCentre[3] = { (minimum[0] + maximum[0]) * 0.5f, (minimum[1] + maximum[1]) * 0.5f, (minimum[2] + maximum[2]) * 0.5f };
+	float boxRadius2 = 0.0f;
+
+	//Grow just enough to touch each vertex outside, moving the centre towards it
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		float bx = vertices[i].x - boxCentre[0];
+		float by = vertices[i].y - boxCentre[1];
+		float bz = vertices[i].z - boxCentre[2];
+
+		float boxDistance2 = bx * bx + by * by + bz * bz;
+		if (boxDistance2 > boxRadius2)
+			boxRadius2 = boxDistance2;
+
+		float dx = vertices[i].x - centre[0];
+		float dy = vertices[i].y - centre[1];
+		float dz = vertices[i].z - centre[2];
+
+		float distance2 = dx * dx + dy * dy + dz * dz;
+		if (distance2 <= radius2)
+			continue;
+
+		float distance = sqrtf(distance2);
+		float grown = (radius + distance) * 0.5f;
+		float shift = (grown - radius) / distance;
+
+		centre[0] += dx * shift;
+		centre[1] += dy * shift;
+		centre[2] += dz * shift;
+		radius = grown;
+		radius2 = radius * radius;
+	}
+
+	float boxRadius = sqrtf(boxRadius2);
+	if (boxRadius < radius)
+	{
+		memcpy(centre, boxCentre, sizeof(centre));
+		radius = boxRadius;
+	}
+
+	//The growth is rounded, which can leave the vertex that caused it a few ulps outside
+	bounds->centerX = centre[0];
+	bounds->centerY = centre[1];
+	bounds->centerZ = centre[2];
+	bounds->radius = radius * (1.0f + 4.0f * FLT_EPSILON);
+}
+
+void bd_FindExtremesScalar(const Vertex* vertices, uint32_t vertexCount, float* minimum, float* maximum, uint32_t* minimumVertex, uint32_t* maximumVertex)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		minimum[i] = (&vertices[0].x)[i];
+		maximum[i] = minimum[i];
+		minimumVertex[i] = 0;
+		maximumVertex[i] = 0;
+	}
+
+	for (uint32_t i = 1; i < vertexCount; i++)
+	{
+		const float* position = &vertices[i].x;
+		for (int j = 0; j < 3; j++)
+		{
+			if (position[j] < minimum[j]) { minimum[j] = position[j]; minimumVertex[j] = i; }
+			if (position[j] > maximum[j]) { maximum[j] = position[j]; maximumVertex[j] = i; }
+		}
+	}
+}
+
+#ifdef STARDUST_X86
+
+CPU_TARGET("sse2")
+void bd_FindExtremesSSE2(const Vertex* vertices, uint32_t vertexCount, float* minimum, float* maximum, uint32_t* minimumVertex, uint32_t* maximumVertex)
+{
+	//x, y, z and w are next to each other, so each vertex is one load. Lane 3 holds w and is ignored
+	__m128 low = _mm_loadu_ps(&vertices[0].x);
+	__m128 high = low;
+	__m128i lowVertex = _mm_setzero_si128();
+	__m128i highVertex = _mm_setzero_si128();
+
+	for (uint32_t i = 1; i < vertexCount; i++)
+	{
+		__m128 position = _mm_loadu_ps(&vertices[i].x);
+		__m128i index = _mm_set1_epi32((int)i);
+
+		//Strict compares keep the first vertex on ties, like the scalar code
+		__m128i below = _mm_castps_si128(_mm_cmplt_ps(position, low));
+		__m128i above = _mm_castps_si128(_mm_cmpgt_ps(position, high));
+
+		low = _mm_min_ps(position, low);
+		high = _mm_max_ps(position, high);
+		lowVertex = _mm_or_si128(_mm_and_si128(below, index), _mm_andnot_si128(below, lowVertex));
+		highVertex = _mm_or_si128(_mm_and_si128(above, index), _mm_andnot_si128(above, highVertex));
+	}
+
+	float lowValues[4], highValues[4];
+	uint32_t lowIndices[4], highIndices[4];
+	_mm_storeu_ps(lowValues, low);
+	_mm_storeu_ps(highValues, high);
+	_mm_storeu_si128((__m128i*)lowIndices, lowVertex);
+	_mm_storeu_si128((__m128i*)highIndices, highVertex);
+
+	for (int i = 0; i < 3; i++)
+	{
+		minimum[i] = lowValues[i];
+		maximum[i] = highValues[i];
+		minimumVertex[i] = lowIndices[i];
+		maximumVertex[i] = highIndices[i];
+	}
+}
+
+#endif //STARDUST_X86
@@ -0,0 +1,30 @@
+#ifndef _STARDUST_BOUNDS
+#define _STARDUST_BOUNDS
+
+#include "stardust.h"
+
+/// <summary>
+/// Calculates the axis aligned bounding box and a bounding sphere of the positions of vertices.
+/// The box and the vertices at its faces come from one SIMD min/max pass. The sphere is Ritter's: it starts on the pair of those
+/// vertices that are furthest apart and grows to take in every vertex outside it in a second pass. The same pass measures the sphere
+/// around the centre of the box, and the smaller of the two is kept.
+/// </summary>
+/// <param name="vertices">Vertex array</param>
+/// <param name="vertexCount">Number of vertices. Empty arrays give zeroed bounds</param>
+/// <param name="requested">Highest instruction set allowed</param>
+/// <param name="bounds">Filled with the bounds</param>
+void bd_CalculateBounds(const Vertex* vertices, uint32_t vertexCount, StardustInstructionSet requested, StardustBounds* bounds);
+
+/// <summary>
+/// Finds the box and the first vertex with the smallest and the largest value on each axis
+/// </summary>
+/// <param name="vertices">Vertex array</param>
+/// <param name="vertexCount">Number of vertices. At least 1</param>
+/// <param name="minimum">Filled with the smallest x, y and z</param>
+/// <param name="maximum">Filled with the largest x, y and z</param>
+/// <param name="minimumVertex">Filled with the vertex at the smallest value of each axis</param>
+/// <param name="maximumVertex">Filled with the vertex at the largest value of each axis</param>
+void bd_FindExtremesScalar(const Vertex* vertices, uint32_t vertexCount, float* minimum, float* maximum, uint32_t* minimumVertex, uint32_t* maximumVertex);
+void bd_FindExtremesSSE2(const Vertex* vertices, uint32_t vertexCount, float* minimum, float* maximum, uint32_t* minimumVertex, uint32_t* maximumVertex);
+
+#endif //_STARDUST_BOUNDS
@@ -0,0 +1,76 @@
+#include "cpu.h"
+
+#ifdef STARDUST_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#ifdef STARDUST_X86
+static void _cpu_CpuId(uint32_t leaf, uint32_t subleaf, uint32_t registers[4])
+{
+#if defined(_MSC_VER)
+	int values[4];
+	__cpuidex(values, (int)leaf, (int)subleaf);
+	for (int i = 0; i < 4; i++)
+		registers[i] = (uint32_t)values[i];
+#else
+	__cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+static uint64_t _cpu_GetEnabledStates()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	uint32_t low, high;
+	__asm__ volatile ("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+	return ((uint64_t)high << 32) | low;
+#endif
+}
+#endif
+
+StardustInstructionSet cpu_GetInstructionSet()
+{
+#ifdef STARDUST_X86
+	uint32_t registers[4]; //EAX, EBX, ECX, EDX
+
+	_cpu_CpuId(0, 0, registers);
+	uint32_t maxLeaf = registers[0];
+
+	_cpu_CpuId(1, 0, registers);
+	if ((registers[3] & (1u << 26)) == 0) //SSE2
+		return STARDUST_INSTRUCTIONS_SCALAR;
+
+	//AVX registers need OS support. OSXSAVE and AVX bits
+	if ((registers[2] & (1u << 27)) == 0 || (registers[2] & (1u << 28)) == 0 || maxLeaf < 7)
+		return STARDUST_INSTRUCTIONS_SSE2;
+
+	uint64_t states = _cpu_GetEnabledStates();
+	if ((states & 0x6) != 0x6) //XMM and YMM state
+		return STARDUST_INSTRUCTIONS_SSE2;
+
+	_cpu_CpuId(7, 0, registers);
+	if ((registers[1] & (1u << 5)) == 0) //AVX2
+		return STARDUST_INSTRUCTIONS_SSE2;
+
+	if ((registers[1] & (1u << 16)) == 0 || (states & 0xE6) != 0xE6) //AVX-512F. Opmask and ZMM state
+		return STARDUST_INSTRUCTIONS_AVX2;
+
+	return STARDUST_INSTRUCTIONS_AVX512;
+#else
+	return STARDUST_INSTRUCTIONS_SCALAR;
+#endif
+}
+
+StardustInstructionSet cpu_SelectInstructionSet(StardustInstructionSet requested)
+{
+	StardustInstructionSet supported = cpu_GetInstructionSet();
+
+	if (requested == STARDUST_INSTRUCTIONS_BEST || requested > supported)
+		return supported;
+	return requested;
+}
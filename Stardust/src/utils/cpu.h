@@ -0,0 +1,32 @@
+#ifndef _STARDUST_CPU
+#define _STARDUST_CPU
+
+#include "stardust.h"
+
+//x86 builds can use the SIMD kernels. Everything else only has the scalar code
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define STARDUST_X86
+#endif
+
+//GCC and Clang only allow intrinsics of instruction sets enabled for the function they are used in. MSVC allows them anywhere
+#if defined(__GNUC__) || defined(__clang__)
+#define CPU_TARGET(instructions) __attribute__((target(instructions)))
+#else
+#define CPU_TARGET(instructions)
+#endif
+
+/// <summary>
+/// Gets the best instruction set supported by both the CPU and the OS.
+/// AVX2 and AVX-512 also need the OS to save their registers, which is checked through XGETBV.
+/// </summary>
+/// <returns>STARDUST_INSTRUCTIONS_SCALAR to STARDUST_INSTRUCTIONS_AVX512</returns>
+StardustInstructionSet cpu_GetInstructionSet();
+
+/// <summary>
+/// Picks the instruction set a kernel should use
+/// </summary>
+/// <param name="requested">Highest instruction set allowed. STARDUST_INSTRUCTIONS_BEST allows any</param>
+/// <returns>The lower of requested and the best supported instruction set</returns>
+StardustInstructionSet cpu_SelectInstructionSet(StardustInstructionSet requested);
+
+#endif //_STARDUST_CPU
@@ -40,9 +40,9 @@ void f_Seek(struct File* f, long offset, FileOrigin origin)
 	int method = 0;
 	switch (origin)
 	{
-	case FileOrigin_Start: method = SEEK_SET;
-	case FileOrigin_Current: method = SEEK_CUR;
-	case FileOrigin_End: method = SEEK_END;
+	case FileOrigin_Start: method = SEEK_SET; break;
+	case FileOrigin_Current: method = SEEK_CUR; break;
+	case FileOrigin_End: method = SEEK_END; break;
 	}
 
 	fseek(f->file, offset, method);
@@ -25,6 +25,12 @@ StardustErrorCode fs_CloseStream(FileStream* stream)
 	return ret;
 }
 
+void fs_Seek(FileStream* stream, long position)
+{
+	f_Seek(stream->file, position, FileOrigin_Start);
+	stream->characterIndex = position;
+}
+
 StardustErrorCode fs_ReadBytes(FileStream* stream, char* buf, long count)
 {
 	int eof = f_ReadBytes(stream->file, buf, count);
@@ -16,6 +16,9 @@ typedef struct
 StardustErrorCode fs_OpenStream(const char* file, FileStream* stream);
 StardustErrorCode fs_CloseStream(FileStream* stream);
 
+//Move
+void fs_Seek(FileStream* stream, long position);
+
 //Read
 StardustErrorCode fs_ReadBytes(FileStream* stream, char* buf, long count);
 
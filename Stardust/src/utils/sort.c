@@ -0,0 +1,105 @@
+#include "sort.h"
+#include "thread.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+StardustErrorCode rs_RadixSort(uint32_t* keys, uint32_t* values, uint32_t count, uint32_t keyBits)
+{
+	if (count < 2 || keyBits == 0)
+		return STARDUST_ERROR_SUCCESS;
+
+	uint32_t taskCount = (count + RS_TASK_SIZE - 1) / RS_TASK_SIZE;
+
+	uint32_t* scratchKeys = malloc((size_t)count * sizeof(uint32_t));
+	uint32_t* scratchValues = malloc((size_t)count * sizeof(uint32_t));
+	uint32_t* histograms = malloc((size_t)taskCount * RS_BUCKET_COUNT * sizeof(uint32_t));
+	if (scratchKeys == 0 || scratchValues == 0 || histograms == 0)
+	{
+		free(scratchKeys); free(scratchValues); free(histograms);
+		return STARDUST_ERROR_MEMORY_ERROR;
+	}
+
+	RadixPass pass = { keys, values, scratchKeys, scratchValues, count, 0, histograms };
+
+	StardustErrorCode ret = STARDUST_ERROR_SUCCESS;
+	for (pass.shift = 0; pass.shift < keyBits && ret == STARDUST_ERROR_SUCCESS; pass.shift += RS_DIGIT_BITS)
+	{
+		ret = t_ParallelFor(taskCount, rs_HistogramTask, &pass, 0);
+		if (ret != STARDUST_ERROR_SUCCESS)
+			break;
+
+		//Bucket major, block minor, so each block writes after the same bucket of every block before it
+		uint32_t position = 0;
+		for (uint32_t b = 0; b < RS_BUCKET_COUNT; b++)
+		{
+			for (uint32_t t = 0; t < taskCount; t++)
+			{
+				uint32_t bucketCount = histograms[t * RS_BUCKET_COUNT + b];
+				histograms[t * RS_BUCKET_COUNT + b] = position;
+				position += bucketCount;
+			}
+		}
+
+		ret = t_ParallelFor(taskCount, rs_ScatterTask, &pass, 0);
+
+		//The sorted arrays are the input of the next pass
+		const uint32_t* previousKeys = pass.keys;
+		const uint32_t* previousValues = pass.values;
+		pass.keys = pass.sortedKeys;
+		pass.values = pass.sortedValues;
+		pass.sortedKeys = (uint32_t*)previousKeys;
+		pass.sortedValues = (uint32_t*)previousValues;
+	}
+
+	//After an odd number of passes the result is in the scratch arrays
+	if (ret == STARDUST_ERROR_SUCCESS && pass.keys != keys)
+	{
+		memcpy(keys, pass.keys, (size_t)count * sizeof(uint32_t));
+		memcpy(values, pass.values, (size_t)count * sizeof(uint32_t));
+	}
+
+	free(scratchKeys);
+	free(scratchValues);
+	free(histograms);
+
+	return ret;
+}
+
+StardustErrorCode rs_HistogramTask(void* context, uint32_t index)
+{
+	RadixPass* pass = context;
+
+	uint32_t start = index * RS_TASK_SIZE;
+	uint32_t end = pass->count;
+	if (end - start > RS_TASK_SIZE)
+		end = start + RS_TASK_SIZE;
+
+	uint32_t* histogram = &pass->histograms[(size_t)index * RS_BUCKET_COUNT];
+	memset(histogram, 0, RS_BUCKET_COUNT * sizeof(uint32_t));
+
+	for (uint32_t i = start; i < end; i++)
+		histogram[(pass->keys[i] >> pass->shift) & (RS_BUCKET_COUNT - 1)]++;
+
+	return STARDUST_ERROR_SUCCESS;
+}
+
+StardustErrorCode rs_ScatterTask(void* context, uint32_t index)
+{
+	RadixPass* pass = context;
+
+	uint32_t start = index * RS_TASK_SIZE;
+	uint32_t end = pass->count;
+	if (end - start > RS_TASK_SIZE)
+		end = start + RS_TASK_SIZE;
+
+	uint32_t* positions = &pass->histograms[(size_t)index * RS_BUCKET_COUNT];
+	for (uint32_t i = start; i < end; i++)
+	{
+		uint32_t position = positions[(pass->keys[i] >> pass->shift) & (RS_BUCKET_COUNT - 1)]++;
+		pass->sortedKeys[position] = pass->keys[i];
+		pass->sortedValues[position] = pass->values[i];
+	}
+
+	return STARDUST_ERROR_SUCCESS;
+}
@@ -0,0 +1,43 @@
+#ifndef _STARDUST_SORT
+#define _STARDUST_SORT
+
+#include "stardust.h"
+
+#define RS_DIGIT_BITS 8							//Bits sorted per pass
+#define RS_BUCKET_COUNT (1u << RS_DIGIT_BITS)
+#define RS_TASK_SIZE 16384						//Keys per histogram and scatter task
+
+typedef struct
+{
+	const uint32_t* keys;
+	const uint32_t* values;
+	uint32_t* sortedKeys;
+	uint32_t* sortedValues;
+	uint32_t count;
+	uint32_t shift;				//First bit of the digit sorted by this pass
+	uint32_t* histograms;		//RS_BUCKET_COUNT counts per task. Turned into the first output position of each bucket
+} RadixPass;
+
+/// <summary>
+/// Sorts values by their keys with a stable least significant digit radix sort.
+/// Each pass counts the digits of blocks of RS_TASK_SIZE keys in parallel, then scatters every block in parallel to positions
+/// worked out from the counts of the blocks before it. Blocks keep their order, so the result doesn't depend on the thread count.
+/// </summary>
+/// <param name="keys">Keys. Sorted in place</param>
+/// <param name="values">Value of every key. Moved with the keys</param>
+/// <param name="count">Number of keys</param>
+/// <param name="keyBits">Number of low bits of the keys that are used. Higher bits must be zero</param>
+/// <returns>Error code</returns>
+StardustErrorCode rs_RadixSort(uint32_t* keys, uint32_t* values, uint32_t count, uint32_t keyBits);
+
+/// <summary>
+/// Counts the digits of one block. Task for t_ParallelFor
+/// </summary>
+StardustErrorCode rs_HistogramTask(void* context, uint32_t index);
+
+/// <summary>
+/// Moves one block to its sorted positions. Task for t_ParallelFor
+/// </summary>
+StardustErrorCode rs_ScatterTask(void* context, uint32_t index);
+
+#endif //_STARDUST_SORT
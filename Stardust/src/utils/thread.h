@@ -0,0 +1,36 @@
+#ifndef _THREAD
+#define _THREAD
+
+#include "stardust.h"
+
+/// <summary>
+/// A task run by t_ParallelFor.
+/// </summary>
+/// <param name="context">Context pointer passed to t_ParallelFor</param>
+/// <param name="index">Index of the task</param>
+/// <returns>Error code. Anything but STARDUST_ERROR_SUCCESS cancels the tasks after this one</returns>
+typedef StardustErrorCode (*t_Task)(void* context, uint32_t index);
+
+/// <summary>
+/// Gets the number of threads that t_ParallelFor will use at most. This includes the calling thread
+/// </summary>
+/// <returns>Thread count</returns>
+uint32_t t_GetThreadCount();
+
+/// <summary>
+/// Runs task for every index in [0, count) across a pool of worker threads. The calling thread works as well.
+/// Indices are handed out in increasing order through an atomic counter, so every index below a failed one has always been started.
+/// Once a task fails, tasks with a higher index that have not started yet are skipped. Tasks with a lower index still run
+/// so that the returned error is the same one a serial loop would return.
+/// Runs on the calling thread alone when count is 1 or threads can't be created.
+/// Calls made from a task of a t_ParallelFor that runs on several threads run inline, in order, on the thread of that task,
+/// so nested loops never create more threads than there are cores.
+/// </summary>
+/// <param name="count">Number of tasks</param>
+/// <param name="task">Task function</param>
+/// <param name="context">Context pointer passed to every task</param>
+/// <param name="failedIndex">Optional. Filled with the index of the first failed task, or count if none failed</param>
+/// <returns>Error code of the lowest index task that failed. Otherwise STARDUST_ERROR_SUCCESS</returns>
+StardustErrorCode t_ParallelFor(uint32_t count, t_Task task, void* context, uint32_t* failedIndex);
+
+#endif
@@ -0,0 +1,172 @@
+#ifdef _STARDUST_STD
+#ifndef _THREAD_STD
+#define _THREAD_STD
+
+#include "thread.h"
+
+#include <stdlib.h>
+#include <threads.h>
+#include <stdatomic.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+typedef struct
+{
+	t_Task task;
+	void* context;
+	uint32_t count;
+
+	atomic_uint nextIndex;
+	atomic_uint failedIndex; //Lowest failed index so far. Tasks above it are skipped
+} ParallelForState;
+
+typedef struct
+{
+	ParallelForState* state;
+	thrd_t thread;
+
+	//Lowest failure seen by this worker
+	uint32_t failedIndex;
+	StardustErrorCode error;
+} ParallelForWorker;
+
+//Set while this thread runs tasks of a t_ParallelFor that other threads are working on as well
+static thread_local int _t_InsideWorker = 0;
+
+static void _t_RunTasks(ParallelForWorker* worker)
+{
+	ParallelForState* state = worker->state;
+
+	worker->failedIndex = state->count;
+	worker->error = STARDUST_ERROR_SUCCESS;
+
+	while (1)
+	{
+		uint32_t index = atomic_fetch_add(&state->nextIndex, 1);
+		if (index >= state->count || index > atomic_load(&state->failedIndex))
+			return;
+
+		StardustErrorCode ret = state->task(state->context, index);
+		if (ret != STARDUST_ERROR_SUCCESS)
+		{
+			worker->failedIndex = index;
+			worker->error = ret;
+
+			//Atomic minimum so that other workers stop picking up tasks above this one
+			unsigned int current = atomic_load(&state->failedIndex);
+			while (index < current && !atomic_compare_exchange_weak(&state->failedIndex, &current, index));
+
+			//Every index this worker could claim from here is higher, so it has nothing left to do
+			return;
+		}
+	}
+}
+
+static int _t_WorkerProc(void* param)
+{
+	_t_InsideWorker = 1;
+	_t_RunTasks(param);
+	return 0;
+}
+
+uint32_t t_GetThreadCount()
+{
+#ifdef _SC_NPROCESSORS_ONLN
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	if (count > 0)
+		return (uint32_t)count;
+#endif
+
+	return 1; //Nothing in the standard library reports the core count
+}
+
+//Runs every task in order on the calling thread, stopping at the first failure
+static StardustErrorCode _t_RunInline(uint32_t count, t_Task task, void* context, uint32_t* failedIndex)
+{
+	for (uint32_t i = 0; i < count; i++)
+	{
+		StardustErrorCode ret = task(context, i);
+		if (ret != STARDUST_ERROR_SUCCESS)
+		{
+			if (failedIndex != 0)
+				*failedIndex = i;
+			return ret;
+		}
+	}
+
+	if (failedIndex != 0)
+		*failedIndex = count;
+	return STARDUST_ERROR_SUCCESS;
+}
+
+StardustErrorCode t_ParallelFor(uint32_t count, t_Task task, void* context, uint32_t* failedIndex)
+{
+	//Every core is already busy with the outer loop. More threads would only multiply the thread count
+	if (_t_InsideWorker)
+		return _t_RunInline(count, task, context, failedIndex);
+
+	ParallelForState state;
+	state.task = task;
+	state.context = context;
+	state.count = count;
+	atomic_init(&state.nextIndex, 0);
+	atomic_init(&state.failedIndex, count);
+
+	//No more threads than tasks
+	uint32_t threadCount = t_GetThreadCount();
+	if (threadCount > count)
+		threadCount = count;
+	if (threadCount == 0)
+		threadCount = 1;
+
+	ParallelForWorker* workers = malloc(sizeof(ParallelForWorker) * threadCount);
+	ParallelForWorker single;
+	if (workers == 0) //Fall back to running everything on this thread
+	{
+		workers = &single;
+		threadCount = 1;
+	}
+
+	//Worker 0 is the calling thread
+	uint32_t started = 1;
+	for (uint32_t i = 1; i < threadCount; i++)
+	{
+		workers[started].state = &state;
+		if (thrd_create(&workers[started].thread, _t_WorkerProc, &workers[started]) == thrd_success)
+			started++;
+	}
+
+	//Nested loops only run inline when other threads are working. With one thread they can still use every core
+	workers[0].state = &state;
+	_t_InsideWorker = started > 1;
+	_t_RunTasks(&workers[0]);
+	_t_InsideWorker = 0;
+
+	for (uint32_t i = 1; i < started; i++)
+		thrd_join(workers[i].thread, NULL);
+
+	//The lowest failed index across workers is the one a serial loop would have stopped at
+	StardustErrorCode ret = STARDUST_ERROR_SUCCESS;
+	uint32_t lowest = count;
+	for (uint32_t i = 0; i < started; i++)
+	{
+		if (workers[i].failedIndex < lowest)
+		{
+			lowest = workers[i].failedIndex;
+			ret = workers[i].error;
+		}
+	}
+
+	if (workers != &single)
+		free(workers);
+
+	if (failedIndex != 0)
+		*failedIndex = lowest;
+
+	return ret;
+}
+
+#endif //_THREAD_STD
+#endif //_STARDUST_STD
@@ -0,0 +1,176 @@
+#ifdef _STARDUST_WIN32
+#ifndef _THREAD_WIN32
+#define _THREAD_WIN32
+
+#include "thread.h"
+
+#include <stdlib.h>
+#include <Windows.h>
+
+typedef struct
+{
+	t_Task task;
+	void* context;
+	uint32_t count;
+
+	volatile LONG nextIndex;
+	volatile LONG failedIndex; //Lowest failed index so far. Tasks above it are skipped
+} ParallelForState;
+
+typedef struct
+{
+	ParallelForState* state;
+	HANDLE thread;
+
+	//Lowest failure seen by this worker
+	uint32_t failedIndex;
+	StardustErrorCode error;
+} ParallelForWorker;
+
+//Set while this thread runs tasks of a t_ParallelFor that other threads are working on as well
+static __declspec(thread) int _t_InsideWorker = 0;
+
+static void _t_RunTasks(ParallelForWorker* worker)
+{
+	ParallelForState* state = worker->state;
+
+	worker->failedIndex = state->count;
+	worker->error = STARDUST_ERROR_SUCCESS;
+
+	while (1)
+	{
+		uint32_t index = (uint32_t)InterlockedIncrement(&state->nextIndex) - 1;
+		if (index >= state->count || index > (uint32_t)state->failedIndex)
+			return;
+
+		StardustErrorCode ret = state->task(state->context, index);
+		if (ret != STARDUST_ERROR_SUCCESS)
+		{
+			worker->failedIndex = index;
+			worker->error = ret;
+
+			//Atomic minimum so that other workers stop picking up tasks above this one
+			LONG current = state->failedIndex;
+			while ((LONG)index < current)
+			{
+				LONG previous = InterlockedCompareExchange(&state->failedIndex, (LONG)index, current);
+				if (previous == current)
+					break;
+				current = previous;
+			}
+
+			//Every index this worker could claim from here is higher, so it has nothing left to do
+			return;
+		}
+	}
+}
+
+static DWORD WINAPI _t_WorkerProc(LPVOID param)
+{
+	_t_InsideWorker = 1;
+	_t_RunTasks(param);
+	return 0;
+}
+
+uint32_t t_GetThreadCount()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+
+	if (info.dwNumberOfProcessors == 0)
+		return 1;
+	return info.dwNumberOfProcessors;
+}
+
+//Runs every task in order on the calling thread, stopping at the first failure
+static StardustErrorCode _t_RunInline(uint32_t count, t_Task task, void* context, uint32_t* failedIndex)
+{
+	for (uint32_t i = 0; i < count; i++)
+	{
+		StardustErrorCode ret = task(context, i);
+		if (ret != STARDUST_ERROR_SUCCESS)
+		{
+			if (failedIndex != 0)
+				*failedIndex = i;
+			return ret;
+		}
+	}
+
+	if (failedIndex != 0)
+		*failedIndex = count;
+	return STARDUST_ERROR_SUCCESS;
+}
+
+StardustErrorCode t_ParallelFor(uint32_t count, t_Task task, void* context, uint32_t* failedIndex)
+{
+	//Every core is already busy with the outer loop. More threads would only multiply the thread count
+	if (_t_InsideWorker)
+		return _t_RunInline(count, task, context, failedIndex);
+
+	ParallelForState state;
+	state.task = task;
+	state.context = context;
+	state.count = count;
+	state.nextIndex = 0;
+	state.failedIndex = (LONG)count;
+
+	//No more threads than tasks
+	uint32_t threadCount = t_GetThreadCount();
+	if (threadCount > count)
+		threadCount = count;
+	if (threadCount == 0)
+		threadCount = 1;
+
+	ParallelForWorker* workers = malloc(sizeof(ParallelForWorker) * threadCount);
+	ParallelForWorker single;
+	if (workers == 0) //Fall back to running everything on this thread
+	{
+		workers = &single;
+		threadCount = 1;
+	}
+
+	//Worker 0 is the calling thread
+	uint32_t started = 1;
+	for (uint32_t i = 1; i < threadCount; i++)
+	{
+		workers[started].state = &state;
+		workers[started].thread = CreateThread(NULL, 0, _t_WorkerProc, &workers[started], 0, NULL);
+		if (workers[started].thread != NULL)
+			started++;
+	}
+
+	//Nested loops only run inline when other threads are working. With one thread they can still use every core
+	workers[0].state = &state;
+	_t_InsideWorker = started > 1;
+	_t_RunTasks(&workers[0]);
+	_t_InsideWorker = 0;
+
+	for (uint32_t i = 1; i < started; i++)
+	{
+		WaitForSingleObject(workers[i].thread, INFINITE);
+		CloseHandle(workers[i].thread);
+	}
+
+	//The lowest failed index across workers is the one a serial loop would have stopped at
+	StardustErrorCode ret = STARDUST_ERROR_SUCCESS;
+	uint32_t lowest = count;
+	for (uint32_t i = 0; i < started; i++)
+	{
+		if (workers[i].failedIndex < lowest)
+		{
+			lowest = workers[i].failedIndex;
+			ret = workers[i].error;
+		}
+	}
+
+	if (workers != &single)
+		free(workers);
+
+	if (failedIndex != 0)
+		*failedIndex = lowest;
+
+	return ret;
+}
+
+#endif //_THREAD_WIN32
+#endif //_STARDUST_WIN32
@@ -68,8 +68,7 @@ int main(int argc, char* argv[])
 		printf("%s\n", "");
 	}
 
-	for (size_t i = 0; i < meshCount; i++)
-		sd_FreeMesh(&meshes[i]);
+	sd_FreeMeshes(meshes, meshCount);
 
 	return 0;*/
 }
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "stardust.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+const char* objectPath = ".\\tests\\resources\\cube.obj";
+const char* quadPath = "build_adjacency.obj";
+
+//A single quad. Every edge is a border
+const char* quadData =
+    "o Quad\n"
+    "v 0.0 0.0 0.0\n"
+    "v 1.0 0.0 0.0\n"
+    "v 1.0 1.0 0.0\n"
+    "v 0.0 1.0 0.0\n"
+    "f 1 2 3 4\n";
+
+//Position at the end of a half-edge
+uint32_t endPosition(const StardustMesh* mesh, const StardustAdjacency* adjacency, uint32_t halfEdge)
+{
+    uint32_t stride = adjacency->vertexStride;
+    uint32_t next = halfEdge - halfEdge % stride + (halfEdge % stride + 1) % stride;
+    return adjacency->vertexPositions[mesh->indices[next]];
+}
+
+//Checks that twins pair up and every corner is listed once under its position. Returns the number of border half-edges or -1
+int checkAdjacency(const StardustMesh* mesh, const StardustAdjacency* adjacency)
+{
+    if (adjacency->halfEdgeCount != mesh->indexCount || adjacency->faceCount * adjacency->vertexStride != mesh->indexCount)
+        return -1;
+
+    int borders = 0;
+    for (uint32_t h = 0; h < adjacency->halfEdgeCount; h++)
+    {
+        uint32_t twin = adjacency->twins[h];
+        if (twin == STARDUST_ADJACENCY_NONE)
+        {
+            borders++;
+            continue;
+        }
+
+        if (twin >= adjacency->halfEdgeCount || adjacency->twins[twin] != h)
+            return -1;
+
+        //The twin runs the other way
+        if (adjacency->vertexPositions[mesh->indices[twin]] != endPosition(mesh, adjacency, h) ||
+            endPosition(mesh, adjacency, twin) != adjacency->vertexPositions[mesh->indices[h]])
+            return -1;
+    }
+
+    if (adjacency->cornerStart[0] != 0 || adjacency->cornerStart[adjacency->positionCount] != mesh->indexCount)
+        return -1;
+
+    unsigned char* seen = calloc(mesh->indexCount, 1);
+    for (uint32_t p = 0; p < adjacency->positionCount; p++)
+    {
+        for (uint32_t i = adjacency->cornerStart[p]; i < adjacency->cornerStart[p + 1]; i++)
+        {
+            uint32_t corner = adjacency->corners[i];
+            if (corner >= mesh->indexCount || seen[corner] || adjacency->vertexPositions[mesh->indices[corner]] != p)
+            {
+                free(seen);
+                return -1;
+            }
+            seen[corner] = 1;
+        }
+    }
+    free(seen);
+
+    return borders;
+}
+
+int main(int argc, char* argv[])
+{
+    //Load mesh
+    StardustMesh* meshes = 0;
+    size_t meshCount = 0;
+
+    StardustErrorCode res = sd_LoadMesh(objectPath, STARDUST_MESH_TRIANGULATE, &meshes, &meshCount);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 1;
+
+    StardustAdjacency* adjacency = 0;
+    res = sd_BuildAdjacency(&meshes[0], &adjacency);
+    if (res != STARDUST_ERROR_SUCCESS || adjacency == 0)
+        return 2;
+
+    if (checkAdjacency(&meshes[0], adjacency) < 0)
+        return 3;
+
+    sd_FreeAdjacency(adjacency);
+    sd_FreeMeshes(meshes, meshCount);
+
+    //A quad has 4 border half-edges. Triangulated, the diagonal is shared
+    FILE* file = fopen(quadPath, "w");
+    if (file == 0)
+        return 4;
+    fputs(quadData, file);
+    fclose(file);
+
+    StardustMesh* quad = 0;
+    StardustMesh* triangles = 0;
+    res = sd_LoadMesh(quadPath, 0, &quad, &meshCount);
+    if (res == STARDUST_ERROR_SUCCESS)
+        res = sd_LoadMesh(quadPath, STARDUST_MESH_TRIANGULATE, &triangles, &meshCount);
+    remove(quadPath);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 5;
+
+    res = sd_BuildAdjacency(quad, &adjacency);
+    if (res != STARDUST_ERROR_SUCCESS || adjacency->faceCount != 1 || adjacency->positionCount != 4 || checkAdjacency(quad, adjacency) != 4)
+        return 6;
+    sd_FreeAdjacency(adjacency);
+
+    res = sd_BuildAdjacency(triangles, &adjacency);
+    if (res != STARDUST_ERROR_SUCCESS || adjacency->faceCount != 2 || checkAdjacency(triangles, adjacency) != 4)
+        return 7;
+    sd_FreeAdjacency(adjacency);
+
+    //Delete mesh
+    sd_FreeMesh(quad);
+    sd_FreeMesh(triangles);
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include "stardust.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+const char* objectPath = ".\\tests\\resources\\cube.obj";
+const char* quadPath = ".\\tests\\resources\\quadCube.obj";
+
+int main(int argc, char* argv[])
+{
+    //Load mesh
+    StardustMesh* meshes = 0;
+    size_t meshCount = 0;
+
+    StardustErrorCode res = sd_LoadMesh(objectPath, STARDUST_MESH_TRIANGULATE, &meshes, &meshCount);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 1;
+
+    StardustMesh* mesh = &meshes[0];
+    uint32_t triangleCount = mesh->indexCount / 3;
+
+    StardustBVH* bvh = 0;
+    if (sd_BuildBVH(mesh, &bvh) != STARDUST_ERROR_SUCCESS || bvh->triangleCount != triangleCount)
+        return 2;
+
+    //Every triangle is in exactly one leaf
+    unsigned char* seen = calloc(triangleCount, 1);
+    if (seen == 0)
+        return 3;
+
+    for (uint32_t i = 0; i < bvh->leafCount; i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            uint32_t triangle = bvh->leaves[i].triangles[j];
+            if (triangle == STARDUST_BVH_EMPTY)
+                continue;
+
+            if (triangle >= triangleCount || seen[triangle])
+                return 4;
+            seen[triangle] = 1;
+        }
+    }
+
+    for (uint32_t i = 0; i < triangleCount; i++)
+    {
+        if (!seen[i])
+            return 5;
+    }
+    free(seen);
+
+    //A ray along -x through the centre enters the cube at its +x face. The scalar and SIMD kernels agree exactly
+    StardustBounds* b = &mesh->bounds;
+    float origin[3] = { b->maxX + 2.0f, (b->minY + b->maxY) * 0.5f, (b->minZ + b->maxZ) * 0.5f };
+    float direction[3] = { -1.0f, 0.0f, 0.0f };
+
+    StardustRayHit hits[2];
+    StardustInstructionSet best = bvh->instructionSet;
+    StardustInstructionSet sets[2] = { STARDUST_INSTRUCTIONS_SCALAR, best };
+    for (int s = 0; s < 2; s++)
+    {
+        bvh->instructionSet = sets[s];
+        if (!sd_RaycastBVH(bvh, origin, direction, 1e30f, &hits[s]))
+            return 6;
+
+        if (fabsf(hits[s].distance - 2.0f) > 1e-4f || hits[s].triangle >= triangleCount)
+            return 7;
+    }
+
+    if (memcmp(&hits[0], &hits[1], sizeof(StardustRayHit)) != 0)
+        return 8;
+
+    //The same ray misses when it stops short of the cube or points away from it
+    StardustRayHit miss = hits[0];
+    if (sd_RaycastBVH(bvh, origin, direction, 1.5f, &miss) || memcmp(&miss, &hits[0], sizeof(StardustRayHit)) != 0)
+        return 9;
+
+    direction[0] = 1.0f;
+    if (sd_RaycastBVH(bvh, origin, direction, 1e30f, &miss))
+        return 10;
+
+    //A box around the whole cube overlaps every triangle, and one off to the side overlaps none
+    float minimum[3] = { b->minX - 1.0f, b->minY - 1.0f, b->minZ - 1.0f };
+    float maximum[3] = { b->maxX + 1.0f, b->maxY + 1.0f, b->maxZ + 1.0f };
+    if (sd_OverlapBVH(bvh, minimum, maximum, 0, 0) != triangleCount)
+        return 11;
+
+    uint32_t* triangles = malloc(triangleCount * sizeof(uint32_t));
+    if (triangles == 0)
+        return 12;
+
+    for (int s = 0; s < 2; s++)
+    {
+        bvh->instructionSet = sets[s];
+        memset(triangles, 0xFF, triangleCount * sizeof(uint32_t));
+        if (sd_OverlapBVH(bvh, minimum, maximum, triangles, triangleCount) != triangleCount)
+            return 13;
+
+        for (uint32_t i = 0; i < triangleCount; i++)
+        {
+            if (triangles[i] >= triangleCount)
+                return 14;
+        }
+    }
+    free(triangles);
+
+    minimum[0] = b->maxX + 1.0f;
+    maximum[0] = b->maxX + 2.0f;
+    if (sd_OverlapBVH(bvh, minimum, maximum, 0, 0) != 0)
+        return 15;
+
+    sd_FreeBVH(bvh);
+
+    //Delete mesh
+    sd_FreeMeshes(meshes, meshCount);
+
+    //Quads are rejected
+    res = sd_LoadMesh(quadPath, 0, &meshes, &meshCount);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 16;
+
+    bvh = 0;
+    if (sd_BuildBVH(&meshes[0], &bvh) != STARDUST_ERROR_INVALID_ARGUMENT || bvh != 0)
+        return 17;
+
+    sd_FreeMeshes(meshes, meshCount);
+
+    return 0;
+}
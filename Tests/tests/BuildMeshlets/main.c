@@ -0,0 +1,57 @@
+#include "stardust.h"
+
+const char* objectPath = ".\\tests\\resources\\cube.obj";
+
+int main(int argc, char* argv[])
+{
+    //Small limits so that the cube needs several meshlets
+    StardustPostProcessSettings settings;
+    sd_GetPostProcessSettings(&settings);
+    settings.meshletMaxVertices = 8;
+    settings.meshletMaxTriangles = 4;
+    sd_SetPostProcessSettings(&settings);
+
+    //Load mesh
+    StardustMesh* meshes = 0;
+    size_t meshCount = 0;
+
+    StardustErrorCode res = sd_LoadMesh(objectPath, STARDUST_MESH_BUILD_MESHLETS, &meshes, &meshCount);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 1;
+
+    StardustMesh* mesh = &meshes[0];
+    if (mesh->meshlets == 0 || (mesh->dataType & STARDUST_MESHLET_DATA) != STARDUST_MESHLET_DATA)
+        return 2;
+
+    //Every triangle is in exactly one meshlet and every micro index is within its meshlet
+    uint32_t triangleCount = 0;
+    for (uint32_t i = 0; i < mesh->meshletCount; i++)
+    {
+        StardustMeshlet* meshlet = &mesh->meshlets[i];
+        if (meshlet->vertexCount > settings.meshletMaxVertices || meshlet->triangleCount > settings.meshletMaxTriangles)
+            return 3;
+
+        for (uint32_t j = 0; j < meshlet->triangleCount * 3; j++)
+        {
+            if (mesh->meshletTriangles[meshlet->triangleOffset + j] >= meshlet->vertexCount)
+                return 4;
+        }
+
+        for (uint32_t j = 0; j < meshlet->vertexCount; j++)
+        {
+            if (mesh->meshletVertices[meshlet->vertexOffset + j] >= mesh->vertexCount)
+                return 5;
+        }
+
+        triangleCount += meshlet->triangleCount;
+    }
+
+    if (triangleCount != mesh->indexCount / 3)
+        return 6;
+
+
+    //Delete mesh
+    sd_FreeMeshes(meshes, meshCount);
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "stardust.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+const char* objectPath = ".\\tests\\resources\\cube.obj";
+
+//Index of the smallest corner, as decoded triangles may start from a different corner
+static uint32_t FirstCorner(const uint32_t* triangle)
+{
+    uint32_t first = 0;
+    for (uint32_t i = 1; i < 3; i++)
+    {
+        if (triangle[i] < triangle[first])
+            first = i;
+    }
+    return first;
+}
+
+static int CompareMeshes(const StardustMesh* a, const StardustMesh* b)
+{
+    if (a->vertexCount != b->vertexCount || a->indexCount != b->indexCount || a->vertexStride != b->vertexStride)
+        return 1;
+
+    //Vertices are lossless
+    if (memcmp(a->vertices, b->vertices, a->vertexCount * sizeof(Vertex)) != 0)
+        return 2;
+
+    for (uint32_t i = 0; i < a->indexCount; i += 3)
+    {
+        uint32_t firstA = FirstCorner(&a->indices[i]);
+        uint32_t firstB = FirstCorner(&b->indices[i]);
+
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            if (a->indices[i + (firstA + j) % 3] != b->indices[i + (firstB + j) % 3])
+                return 3;
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    //Load mesh
+    StardustMesh* meshes = 0;
+    size_t meshCount = 0;
+
+    StardustErrorCode res = sd_LoadMesh(objectPath, STARDUST_MESH_TRIANGULATE | STARDUST_MESH_OPTIMIZE_VERTEX_FETCH, &meshes, &meshCount);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 1;
+
+    StardustMesh* mesh = &meshes[0];
+
+    //Encode
+    unsigned char* data = 0;
+    size_t size = 0;
+
+    res = sd_EncodeMesh(mesh, &data, &size);
+    if (res != STARDUST_ERROR_SUCCESS || data == 0)
+        return 2;
+
+    //Decode with the scalar decoder and the fastest one. Both must give the mesh back
+    StardustPostProcessSettings settings;
+    sd_GetPostProcessSettings(&settings);
+
+    StardustInstructionSet sets[2] = { STARDUST_INSTRUCTIONS_SCALAR, STARDUST_INSTRUCTIONS_BEST };
+    for (int i = 0; i < 2; i++)
+    {
+        settings.instructionSet = sets[i];
+        sd_SetPostProcessSettings(&settings);
+
+        StardustMesh* decoded = 0;
+        res = sd_DecodeMesh(data, size, &decoded);
+        if (res != STARDUST_ERROR_SUCCESS)
+            return 3;
+
+        if (CompareMeshes(mesh, decoded) != 0)
+            return 4;
+
+        sd_FreeMesh(decoded);
+    }
+
+    //Corrupted payloads fail instead of returning a mesh
+    StardustMesh* decoded = 0;
+    if (sd_DecodeMesh(data, size / 2, &decoded) != STARDUST_ERROR_FILE_INVALID || decoded != 0)
+        return 5;
+
+    data[0] ^= 0xFF;
+    if (sd_DecodeMesh(data, size, &decoded) != STARDUST_ERROR_FILE_INVALID || decoded != 0)
+        return 6;
+
+    free(data);
+
+
+    //Delete mesh
+    sd_FreeMeshes(meshes, meshCount);
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include "stardust.h"
+
+#include <math.h>
+
+const char* objectPath = ".\\tests\\resources\\cube.obj";
+
+int main(int argc, char* argv[])
+{
+    //Load mesh
+    StardustMesh* meshes = 0;
+    size_t meshCount = 0;
+
+    StardustErrorCode res = sd_LoadMesh(objectPath, STARDUST_MESH_GENERATE_NORMALS | STARDUST_MESH_GENERATE_TANGENTS, &meshes, &meshCount);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 1;
+
+    StardustMesh* mesh = &meshes[0];
+
+    //Tangents are only generated for meshes with texture coordinates
+    if ((mesh->dataType & STARDUST_TEXTURE_DATA) != STARDUST_TEXTURE_DATA)
+        return mesh->tangents == 0 ? 0 : 2;
+
+    if (mesh->tangents == 0 || (mesh->dataType & STARDUST_TANGENT_DATA) != STARDUST_TANGENT_DATA)
+        return 2;
+
+    //Every tangent must be a unit vector perpendicular to its normal
+    for (uint32_t i = 0; i < mesh->vertexCount; i++)
+    {
+        Vertex* v = &mesh->vertices[i];
+        Tangent* t = &mesh->tangents[i];
+
+        float length = sqrtf(t->x * t->x + t->y * t->y + t->z * t->z);
+        float dot = t->x * v->normX + t->y * v->normY + t->z * v->normZ;
+
+        if (fabsf(length - 1.0f) > 1e-4f)
+            return 3;
+        if (fabsf(dot) > 1e-4f)
+            return 4;
+        if (t->w != 1.0f && t->w != -1.0f)
+            return 5;
+    }
+
+
+    //Delete mesh
+    sd_FreeMeshes(meshes, meshCount);
+
+    return 0;
+}
@@ -0,0 +1,30 @@
+#include "stardust.h"
+
+const char* objectPath = ".\\tests\\resources\\cube.obj";
+
+int main(int argc, char* argv[])
+{
+    //Harden every edge sharper than 60 degrees
+    StardustPostProcessSettings settings;
+    sd_GetPostProcessSettings(&settings);
+    settings.normalCreaseAngle = 1.0471975f;
+    sd_SetPostProcessSettings(&settings);
+
+    //Load mesh
+    StardustMesh* meshes = 0;
+    size_t meshCount = 0;
+
+    StardustErrorCode res = sd_LoadMesh(objectPath, STARDUST_MESH_GENERATE_NORMALS | STARDUST_MESH_SMOOTH_NORMALS, &meshes, &meshCount);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 1;
+
+    //A cube only has 90 degree edges so every face keeps its own normals
+    if (meshes[0].vertexCount != 24)
+        return 2;
+
+
+    //Delete mesh
+    sd_FreeMeshes(meshes, meshCount);
+
+    return 0;
+}
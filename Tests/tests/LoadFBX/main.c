@@ -0,0 +1,119 @@
+#include "stardust.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//Binary FBX 7400 with two Geometry nodes of one triangle each and an AnimationCurve between them.
+//Every array is stored uncompressed
+const char* objectPath = ".\\tests\\resources\\two_geometries.fbx";
+const char* brokenPath = "load_fbx_broken.fbx";
+
+//Positions of the triangles in file order
+const float positions[2][9] =
+{
+    { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f },
+    { 2.0f, 0.0f, 1.0f, 3.0f, 0.0f, 1.0f, 2.0f, 1.0f, 1.0f }
+};
+
+int CheckMesh(const StardustMesh* mesh, uint32_t geometry)
+{
+    if (mesh->vertexCount != 3 || mesh->indexCount != 3 || mesh->vertexStride != 3)
+        return 1;
+
+    if ((mesh->dataType & (STARDUST_VERTEX_DATA | STARDUST_INDEX_DATA)) != (STARDUST_VERTEX_DATA | STARDUST_INDEX_DATA))
+        return 2;
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        const Vertex* v = &mesh->vertices[i];
+        if (mesh->indices[i] != i || v->x != positions[geometry][i * 3] || v->y != positions[geometry][i * 3 + 1] || v->z != positions[geometry][i * 3 + 2])
+            return 3;
+    }
+
+    return 0;
+}
+
+//Writes the first size bytes of the file, with an optional 32 bit value replaced
+StardustErrorCode LoadBroken(const char* data, long size, long patchOffset, uint32_t patch)
+{
+    char* copy = malloc(size);
+    if (copy == 0)
+        return STARDUST_ERROR_MEMORY_ERROR;
+    memcpy(copy, data, size);
+    if (patchOffset >= 0)
+        memcpy(copy + patchOffset, &patch, sizeof(uint32_t));
+
+    FILE* file = fopen(brokenPath, "wb");
+    if (file == 0) { free(copy); return STARDUST_ERROR_IO_ERROR; }
+    fwrite(copy, 1, size, file);
+    fclose(file);
+    free(copy);
+
+    StardustMesh* meshes = 0;
+    size_t meshCount = 0;
+    StardustErrorCode res = sd_LoadMesh(brokenPath, 0, &meshes, &meshCount);
+    remove(brokenPath);
+
+    if (res == STARDUST_ERROR_SUCCESS)
+        sd_FreeMeshes(meshes, meshCount);
+
+    return res;
+}
+
+int main(int argc, char* argv[])
+{
+    //Load every mesh
+    StardustMesh* meshes = 0;
+    size_t meshCount = 0;
+
+    StardustErrorCode res = sd_LoadMesh(objectPath, 0, &meshes, &meshCount);
+    if (res != STARDUST_ERROR_SUCCESS || meshCount != 2)
+        return 1;
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        if (CheckMesh(&meshes[i], i) != 0)
+            return 2;
+    }
+    sd_FreeMeshes(meshes, meshCount);
+
+    //Only the first mesh
+    res = sd_LoadMesh(objectPath, STARDUST_MESH_USE_FIRST_MESH, &meshes, &meshCount);
+    if (res != STARDUST_ERROR_SUCCESS || meshCount != 1)
+        return 3;
+
+    if (CheckMesh(&meshes[0], 0) != 0)
+        return 4;
+    sd_FreeMeshes(meshes, meshCount);
+
+    //Read the file to make broken copies
+    FILE* file = fopen(objectPath, "rb");
+    if (file == 0)
+        return 5;
+
+    char data[4096];
+    long size = (long)fread(data, 1, sizeof(data), file);
+    fclose(file);
+
+    //Find the array of the first Vertices node. The length of the array follows the name and the type code
+    long vertices = -1;
+    for (long i = 0; i + 8 <= size && vertices == -1; i++)
+    {
+        if (memcmp(data + i, "Vertices", 8) == 0)
+            vertices = i;
+    }
+
+    if (vertices == -1 || data[vertices + 8] != 'd')
+        return 6;
+
+    //A file cut off in the second Geometry
+    if (LoadBroken(data, size - 500, -1, 0) != STARDUST_ERROR_FILE_INVALID)
+        return 7;
+
+    //An array longer than the property list it is in
+    if (LoadBroken(data, size, vertices + 9, 0x10000000) != STARDUST_ERROR_FILE_INVALID)
+        return 8;
+
+    return 0;
+}
@@ -14,8 +14,7 @@ int main(int argc, char* argv[])
         return 1;
 
     //Delete mesh
-    for (size_t i = 0; i < meshCount; i++)
-        sd_FreeMesh(&meshes[i]);
+    sd_FreeMeshes(meshes, meshCount);
 
     return 0;
 }
@@ -0,0 +1,84 @@
+#include "stardust.h"
+
+#include <stdio.h>
+
+const char* objectPath = "merge_meshes.obj";
+
+//A quad with normals and a triangle with texture coordinates but no normals
+const char* objectData =
+    "o Quad\n"
+    "v 0.0 0.0 0.0\n"
+    "v 1.0 0.0 0.0\n"
+    "v 1.0 1.0 0.0\n"
+    "v 0.0 1.0 0.0\n"
+    "vt 0.5 0.5\n"
+    "vn 0.0 0.0 1.0\n"
+    "f 1/1/1 2/1/1 3/1/1 4/1/1\n"
+    "o Triangle\n"
+    "v 2.0 0.0 0.0\n"
+    "v 3.0 0.0 0.0\n"
+    "v 2.0 1.0 0.0\n"
+    "vt 0.0 0.0\n"
+    "vt 1.0 0.0\n"
+    "vt 0.0 1.0\n"
+    "f 1/1 2/2 3/3\n";
+
+//X and Y of every vertex in file order
+const float positions[] = { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 2.0f, 0.0f, 3.0f, 0.0f, 2.0f, 1.0f };
+
+int main(int argc, char* argv[])
+{
+    FILE* file = fopen(objectPath, "w");
+    if (file == 0)
+        return 1;
+    fputs(objectData, file);
+    fclose(file);
+
+    //Load merged
+    StardustMesh* merged = 0;
+    size_t mergedCount = 0;
+
+    StardustErrorCode res = sd_LoadMesh(objectPath, STARDUST_MESH_MERGE_MESHES, &merged, &mergedCount);
+    remove(objectPath);
+    if (res != STARDUST_ERROR_SUCCESS || mergedCount != 1)
+        return 2;
+
+    //Face sizes differ, so the quad was triangulated
+    if (merged->vertexStride != 3 || merged->vertexCount != 7 || merged->indexCount != 9)
+        return 3;
+
+    if ((merged->postProcessStages & STARDUST_STAGE_TRIANGULATE) != STARDUST_STAGE_TRIANGULATE)
+        return 4;
+
+    StardustMeshDataType both = STARDUST_VERTEX_DATA | STARDUST_INDEX_DATA | STARDUST_TEXTURE_DATA | STARDUST_NORMAL_DATA;
+    if ((merged->dataType & both) != both)
+        return 5;
+
+    //Vertices are copied in file order and the triangle's missing normals are zero
+    for (uint32_t i = 0; i < merged->vertexCount; i++)
+    {
+        Vertex* v = &merged->vertices[i];
+        if (v->x != positions[i * 2] || v->y != positions[i * 2 + 1] || v->z != 0.0f)
+            return 6;
+
+        float normal = i < 4 ? 1.0f : 0.0f;
+        if (v->normX != 0.0f || v->normY != 0.0f || v->normZ != normal)
+            return 7;
+    }
+
+    //The triangle's indices follow the quad's vertices
+    for (uint32_t i = 6; i < merged->indexCount; i++)
+    {
+        if (merged->indices[i] != i - 2)
+            return 8;
+    }
+
+    //Bounds cover both meshes
+    if (merged->bounds.minX != 0.0f || merged->bounds.maxX != 3.0f)
+        return 9;
+
+    //Delete mesh
+    sd_FreeMesh(merged);
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "stardust.h"
+
+#include <string.h>
+
+const char* objectPath = ".\\tests\\resources\\cube.obj";
+
+int main(int argc, char* argv[])
+{
+    //Load mesh with the scalar and the fastest kernels
+    StardustPostProcessSettings settings;
+    sd_GetPostProcessSettings(&settings);
+
+    StardustBounds bounds[2];
+    StardustInstructionSet sets[2] = { STARDUST_INSTRUCTIONS_SCALAR, STARDUST_INSTRUCTIONS_BEST };
+    for (int s = 0; s < 2; s++)
+    {
+        settings.instructionSet = sets[s];
+        sd_SetPostProcessSettings(&settings);
+
+        StardustMesh* meshes = 0;
+        size_t meshCount = 0;
+
+        StardustErrorCode res = sd_LoadMesh(objectPath, 0, &meshes, &meshCount);
+        if (res != STARDUST_ERROR_SUCCESS)
+            return 1;
+
+        StardustMesh* mesh = &meshes[0];
+        if ((mesh->dataType & STARDUST_BOUNDS_DATA) != STARDUST_BOUNDS_DATA)
+            return 2;
+
+        //Every vertex is inside both volumes and the box touches the vertices
+        StardustBounds* b = &mesh->bounds;
+        float minimum[3] = { mesh->vertices[0].x, mesh->vertices[0].y, mesh->vertices[0].z };
+        float maximum[3] = { minimum[0], minimum[1], minimum[2] };
+        for (uint32_t i = 0; i < mesh->vertexCount; i++)
+        {
+            Vertex* v = &mesh->vertices[i];
+            if (v->x < b->minX || v->y < b->minY || v->z < b->minZ || v->x > b->maxX || v->y > b->maxY || v->z > b->maxZ)
+                return 3;
+
+            float dx = v->x - b->centerX;
+            float dy = v->y - b->centerY;
+            float dz = v->z - b->centerZ;
+            if (dx * dx + dy * dy + dz * dz > b->radius * b->radius)
+                return 4;
+
+            if (v->x < minimum[0]) minimum[0] = v->x;
+            if (v->y < minimum[1]) minimum[1] = v->y;
+            if (v->z < minimum[2]) minimum[2] = v->z;
+            if (v->x > maximum[0]) maximum[0] = v->x;
+            if (v->y > maximum[1]) maximum[1] = v->y;
+            if (v->z > maximum[2]) maximum[2] = v->z;
+        }
+
+        if (minimum[0] != b->minX || minimum[1] != b->minY || minimum[2] != b->minZ || maximum[0] != b->maxX || maximum[1] != b->maxY || maximum[2] != b->maxZ)
+            return 5;
+
+        //The sphere is no bigger than the one around the box
+        float ex = b->maxX - b->minX;
+        float ey = b->maxY - b->minY;
+        float ez = b->maxZ - b->minZ;
+        if (b->radius * b->radius > (ex * ex + ey * ey + ez * ez) * 0.25f * 1.001f)
+            return 6;
+
+        bounds[s] = *b;
+
+        //Delete mesh
+        sd_FreeMeshes(meshes, meshCount);
+    }
+
+    //Every instruction set gives the same bounds
+    if (memcmp(&bounds[0], &bounds[1], sizeof(StardustBounds)) != 0)
+        return 7;
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "stardust.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//37 triangles run the 16, 8 and 4 wide loops at least twice and leave a tail for the scalar kernel on every instruction set
+#define TRIANGLE_COUNT 37
+#define VERTEX_COUNT (TRIANGLE_COUNT * 3)
+
+//Generates normals for separate random triangles. No two vertices share a position, so each vertex gets its face normal
+StardustErrorCode GenerateNormals(StardustInstructionSet set, StardustMesh** mesh)
+{
+    StardustPostProcessSettings settings;
+    sd_GetPostProcessSettings(&settings);
+    settings.deterministic = 1;
+    settings.instructionSet = set;
+    sd_SetPostProcessSettings(&settings);
+
+    Vertex vertices[VERTEX_COUNT] = { 0 };
+    uint32_t indices[VERTEX_COUNT];
+
+    srand(1);
+    for (uint32_t i = 0; i < VERTEX_COUNT; i++)
+    {
+        vertices[i].x = (float)rand() / (float)RAND_MAX * 10.0f - 5.0f;
+        vertices[i].y = (float)rand() / (float)RAND_MAX * 10.0f - 5.0f;
+        vertices[i].z = (float)rand() / (float)RAND_MAX * 10.0f - 5.0f;
+        vertices[i].w = 1.0f;
+        indices[i] = i;
+    }
+
+    //Degenerate triangles in a full vector and in the tail
+    uint32_t degenerates[] = { 5, TRIANGLE_COUNT - 1 };
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        Vertex* v = &vertices[degenerates[i] * 3];
+        v[2].x = v[1].x * 2.0f - v[0].x;
+        v[2].y = v[1].y * 2.0f - v[0].y;
+        v[2].z = v[1].z * 2.0f - v[0].z;
+    }
+
+    StardustErrorCode res = sd_CreateMesh(vertices, VERTEX_COUNT, indices, VERTEX_COUNT, 3, 0, mesh);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return res;
+
+    return sd_PostProcessMesh(*mesh, STARDUST_MESH_GENERATE_NORMALS);
+}
+
+int main(int argc, char* argv[])
+{
+    //The scalar kernel is the reference
+    StardustMesh* reference = 0;
+    if (GenerateNormals(STARDUST_INSTRUCTIONS_SCALAR, &reference) != STARDUST_ERROR_SUCCESS)
+        return 1;
+
+    //Every other instruction set must give the same bits. Unsupported ones fall back to the best supported
+    StardustInstructionSet sets[] = { STARDUST_INSTRUCTIONS_SSE2, STARDUST_INSTRUCTIONS_AVX2, STARDUST_INSTRUCTIONS_AVX512 };
+    for (int i = 0; i < 3; i++)
+    {
+        StardustMesh* mesh = 0;
+        if (GenerateNormals(sets[i], &mesh) != STARDUST_ERROR_SUCCESS)
+            return 2;
+
+        if (mesh->vertexCount != reference->vertexCount || mesh->indexCount != reference->indexCount)
+            return 3;
+        if (memcmp(mesh->vertices, reference->vertices, sizeof(Vertex) * mesh->vertexCount) != 0)
+            return 4;
+        if (memcmp(mesh->indices, reference->indices, sizeof(uint32_t) * mesh->indexCount) != 0)
+            return 5;
+
+        sd_FreeMesh(mesh);
+    }
+
+    //Delete mesh
+    sd_FreeMesh(reference);
+
+    return 0;
+}
@@ -0,0 +1,35 @@
+#include "stardust.h"
+
+const char* objectPath = ".\\tests\\resources\\cube.obj";
+
+int main(int argc, char* argv[])
+{
+    StardustPostProcessSettings settings;
+    sd_GetPostProcessSettings(&settings);
+
+    //Load mesh
+    StardustMesh* meshes = 0;
+    size_t meshCount = 0;
+
+    StardustErrorCode res = sd_LoadMesh(objectPath, STARDUST_MESH_OPTIMIZE_OVERDRAW, &meshes, &meshCount);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 1;
+
+    //The clusters are cut from the vertex cache order, so both stages run
+    StardustPostProcessStages expected = STARDUST_STAGE_OPTIMIZE_VERTEX_CACHE | STARDUST_STAGE_OPTIMIZE_OVERDRAW;
+    if ((meshes[0].postProcessStages & expected) != expected)
+        return 2;
+
+    if (meshes[0].vertexStride != 3)
+        return 3;
+
+    //The reported ACMR is for the final order
+    if (meshes[0].acmr != sd_CalculateACMR(&meshes[0], settings.vertexCacheSize))
+        return 4;
+
+
+    //Delete mesh
+    sd_FreeMeshes(meshes, meshCount);
+
+    return 0;
+}
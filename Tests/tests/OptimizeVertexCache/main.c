@@ -0,0 +1,48 @@
+#include "stardust.h"
+
+const char* objectPath = ".\\tests\\resources\\cube.obj";
+
+int main(int argc, char* argv[])
+{
+    StardustPostProcessSettings settings;
+    sd_GetPostProcessSettings(&settings);
+
+    //Load the mesh in its original order
+    StardustMesh* reference = 0;
+    size_t referenceCount = 0;
+
+    StardustErrorCode res = sd_LoadMesh(objectPath, STARDUST_MESH_TRIANGULATE, &reference, &referenceCount);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 1;
+
+    //Load optimised
+    StardustMesh* meshes = 0;
+    size_t meshCount = 0;
+
+    res = sd_LoadMesh(objectPath, STARDUST_MESH_TRIANGULATE | STARDUST_MESH_OPTIMIZE_VERTEX_CACHE, &meshes, &meshCount);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 1;
+
+    //Only the triangle order may change
+    if (meshes[0].indexCount != reference[0].indexCount || meshes[0].vertexCount != reference[0].vertexCount)
+        return 2;
+
+    if ((meshes[0].postProcessStages & STARDUST_STAGE_OPTIMIZE_VERTEX_CACHE) != STARDUST_STAGE_OPTIMIZE_VERTEX_CACHE)
+        return 3;
+
+    //The reported ACMR must match the index buffer and be no worse than the original order
+    float acmr = sd_CalculateACMR(&meshes[0], settings.vertexCacheSize);
+    if (meshes[0].acmr != acmr)
+        return 4;
+
+    if (acmr > sd_CalculateACMR(&reference[0], settings.vertexCacheSize))
+        return 5;
+
+
+    //Delete mesh
+    sd_FreeMeshes(meshes, meshCount);
+    for (size_t i = 0; i < referenceCount; i++)
+        sd_FreeMesh(&reference[i]);
+
+    return 0;
+}
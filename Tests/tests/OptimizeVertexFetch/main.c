@@ -0,0 +1,34 @@
+#include "stardust.h"
+
+const char* objectPath = ".\\tests\\resources\\cube.obj";
+
+int main(int argc, char* argv[])
+{
+    //Load mesh
+    StardustMesh* meshes = 0;
+    size_t meshCount = 0;
+
+    StardustErrorCode res = sd_LoadMesh(objectPath, STARDUST_MESH_OPTIMIZE_VERTEX_CACHE | STARDUST_MESH_OPTIMIZE_VERTEX_FETCH, &meshes, &meshCount);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 1;
+
+    if ((meshes[0].postProcessStages & STARDUST_STAGE_OPTIMIZE_VERTEX_FETCH) != STARDUST_STAGE_OPTIMIZE_VERTEX_FETCH)
+        return 2;
+
+    //Every index is either a vertex used before or the next new one
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < meshes[0].indexCount; i++)
+    {
+        uint32_t index = meshes[0].indices[i];
+        if (index > next)
+            return 3;
+        if (index == next)
+            next++;
+    }
+
+
+    //Delete mesh
+    sd_FreeMeshes(meshes, meshCount);
+
+    return 0;
+}
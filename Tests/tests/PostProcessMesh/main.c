@@ -0,0 +1,69 @@
+#include "stardust.h"
+
+//A 2 by 2 grid of quads in the XY plane, wound counter clockwise
+const uint32_t quads[] =
+{
+    0, 1, 4, 3,
+    1, 2, 5, 4,
+    3, 4, 7, 6,
+    4, 5, 8, 7
+};
+
+int main(int argc, char* argv[])
+{
+    Vertex vertices[9] = { 0 };
+    for (uint32_t i = 0; i < 9; i++)
+    {
+        vertices[i].x = (float)(i % 3);
+        vertices[i].y = (float)(i / 3);
+        vertices[i].w = 1.0f;
+    }
+
+    //Indices past the vertices are rejected
+    StardustMesh* mesh = 0;
+    const uint32_t outOfRange[] = { 0, 1, 9, 3 };
+    if (sd_CreateMesh(vertices, 9, outOfRange, 4, 4, 0, &mesh) != STARDUST_ERROR_INVALID_ARGUMENT || mesh != 0)
+        return 1;
+
+    StardustErrorCode res = sd_CreateMesh(vertices, 9, quads, 16, 4, STARDUST_NORMAL_DATA | STARDUST_LOD_DATA, &mesh);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 2;
+
+    //Only vertex attributes are kept from the data type
+    if (mesh->vertexStride != 4 || mesh->postProcessStages != 0 || (mesh->dataType & STARDUST_LOD_DATA) == STARDUST_LOD_DATA ||
+        (mesh->dataType & STARDUST_NORMAL_DATA) != STARDUST_NORMAL_DATA || mesh->bounds.maxX != 2.0f || mesh->bounds.maxY != 2.0f)
+        return 3;
+
+    //Generate normals and meshlets
+    res = sd_PostProcessMesh(mesh, STARDUST_MESH_GENERATE_NORMALS | STARDUST_MESH_BUILD_MESHLETS);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 4;
+
+    StardustPostProcessStages stages = STARDUST_STAGE_TRIANGULATE | STARDUST_STAGE_GENERATE_NORMALS | STARDUST_STAGE_BUILD_MESHLETS;
+    if ((mesh->postProcessStages & stages) != stages || mesh->vertexStride != 3 || mesh->indexCount != 24 || mesh->meshletCount == 0)
+        return 5;
+
+    for (uint32_t i = 0; i < mesh->vertexCount; i++)
+    {
+        if (!(mesh->vertices[i].normZ > 0.99f))
+            return 6;
+    }
+
+    //Welding replaces the vertices, so the meshlets built from the old ones are dropped. Earlier stages stay reported
+    res = sd_PostProcessMesh(mesh, STARDUST_MESH_WELD_VERTICES);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 7;
+
+    if (mesh->meshlets != 0 || mesh->meshletCount != 0 || (mesh->dataType & STARDUST_MESHLET_DATA) == STARDUST_MESHLET_DATA ||
+        (mesh->postProcessStages & STARDUST_STAGE_BUILD_MESHLETS) == STARDUST_STAGE_BUILD_MESHLETS)
+        return 8;
+
+    stages = STARDUST_STAGE_TRIANGULATE | STARDUST_STAGE_GENERATE_NORMALS | STARDUST_STAGE_WELD_VERTICES;
+    if ((mesh->postProcessStages & stages) != stages || mesh->vertexCount != 9)
+        return 9;
+
+    //Delete mesh
+    sd_FreeMesh(mesh);
+
+    return 0;
+}
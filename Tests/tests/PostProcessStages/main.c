@@ -0,0 +1,40 @@
+#include "stardust.h"
+
+const char* objectPath = ".\\tests\\resources\\cube.obj";
+
+int main(int argc, char* argv[])
+{
+    //Load mesh
+    StardustMesh* meshes = 0;
+    size_t meshCount = 0;
+
+    StardustErrorCode res = sd_LoadMesh(objectPath, STARDUST_MESH_TRIANGULATE | STARDUST_MESH_GENERATE_NORMALS | STARDUST_MESH_WELD_VERTICES, &meshes, &meshCount);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 1;
+
+    //Welding is done while the generated normals are added
+    StardustPostProcessStages expected = STARDUST_STAGE_GENERATE_NORMALS | STARDUST_STAGE_WELD_VERTICES | STARDUST_STAGE_FUSED_WELD;
+    if ((meshes[0].postProcessStages & expected) != expected)
+        return 2;
+
+    //Hard normals never smooth
+    if ((meshes[0].postProcessStages & STARDUST_STAGE_SMOOTH_NORMALS) != 0)
+        return 3;
+
+    sd_FreeMeshes(meshes, meshCount);
+
+
+    //Nothing runs without flags
+    res = sd_LoadMesh(objectPath, 0, &meshes, &meshCount);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 1;
+
+    if (meshes[0].postProcessStages != 0)
+        return 4;
+
+
+    //Delete mesh
+    sd_FreeMeshes(meshes, meshCount);
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include "stardust.h"
+
+#include <stdio.h>
+
+const char* objectPath = "remove_degenerates.obj";
+
+//A square made of two triangles, a triangle that repeats a corner and a triangle along a line. The last vertex is only used
+//by the line
+const char* objectData =
+    "o Degenerates\n"
+    "v 0.0 0.0 0.0\n"
+    "v 1.0 0.0 0.0\n"
+    "v 1.0 1.0 0.0\n"
+    "v 0.0 1.0 0.0\n"
+    "v 2.0 0.0 0.0\n"
+    "vt 0.0 0.0\n"
+    "vn 0.0 0.0 1.0\n"
+    "f 1/1/1 2/1/1 3/1/1\n"
+    "f 1/1/1 3/1/1 3/1/1\n"
+    "f 1/1/1 3/1/1 4/1/1\n"
+    "f 1/1/1 2/1/1 5/1/1\n";
+
+int main(int argc, char* argv[])
+{
+    FILE* file = fopen(objectPath, "w");
+    if (file == 0)
+        return 1;
+    fputs(objectData, file);
+    fclose(file);
+
+    //Load mesh
+    StardustMesh* meshes = 0;
+    size_t meshCount = 0;
+
+    StardustErrorCode res = sd_LoadMesh(objectPath, STARDUST_MESH_REMOVE_DEGENERATES | STARDUST_MESH_GENERATE_NORMALS, &meshes, &meshCount);
+    remove(objectPath);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 2;
+
+    StardustMesh* mesh = &meshes[0];
+    if ((mesh->postProcessStages & STARDUST_STAGE_REMOVE_DEGENERATES) != STARDUST_STAGE_REMOVE_DEGENERATES)
+        return 3;
+
+    //Only the square is left, and the vertex of the line is gone
+    if (mesh->indexCount != 6 || mesh->vertexCount != 4)
+        return 4;
+
+    for (uint32_t i = 0; i < mesh->indexCount; i++)
+    {
+        if (mesh->indices[i] >= mesh->vertexCount)
+            return 5;
+    }
+
+    //Every generated normal faces +Z. NaN fails the comparison
+    for (uint32_t i = 0; i < mesh->vertexCount; i++)
+    {
+        Vertex* v = &mesh->vertices[i];
+        if (!(v->normZ > 0.99f) || v->x > 1.0f)
+            return 6;
+    }
+
+    //Delete mesh
+    sd_FreeMeshes(meshes, meshCount);
+
+    return 0;
+}
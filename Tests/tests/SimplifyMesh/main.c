@@ -0,0 +1,79 @@
+#include "stardust.h"
+
+#include <stdlib.h>
+
+const char* objectPath = ".\\tests\\resources\\cube.obj";
+
+int main(int argc, char* argv[])
+{
+    //Load mesh with levels of detail
+    StardustMesh* meshes = 0;
+    size_t meshCount = 0;
+
+    StardustErrorCode res = sd_LoadMesh(objectPath, STARDUST_MESH_TRIANGULATE | STARDUST_MESH_GENERATE_LODS, &meshes, &meshCount);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 1;
+
+    StardustMesh* mesh = &meshes[0];
+
+    //Every level has fewer triangles than the one before and only uses the mesh's vertices
+    uint32_t previousCount = mesh->indexCount;
+    float previousError = 0.0f;
+    for (uint32_t i = 0; i < mesh->lodCount; i++)
+    {
+        StardustLOD* lod = &mesh->lods[i];
+        if (lod->indexCount >= previousCount || lod->indexCount % 3 != 0 || lod->error < previousError)
+            return 2;
+
+        for (uint32_t j = 0; j < lod->indexCount; j++)
+        {
+            if (lod->indices[j] >= mesh->vertexCount)
+                return 3;
+        }
+
+        previousCount = lod->indexCount;
+        previousError = lod->error;
+    }
+
+    //Nothing to do when the mesh is already at the target
+    uint32_t* indices = 0;
+    uint32_t indexCount = 0;
+    float error = 1.0f;
+
+    res = sd_SimplifyMesh(mesh, mesh->indexCount, 0.01f, &indices, &indexCount, &error);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 4;
+    if (indexCount != mesh->indexCount || error != 0.0f)
+        return 5;
+    free(indices);
+
+    //Simplify as far as possible
+    res = sd_SimplifyMesh(mesh, 0, 1.0f, &indices, &indexCount, &error);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 6;
+    if (indexCount > mesh->indexCount || indexCount % 3 != 0)
+        return 7;
+
+    for (uint32_t i = 0; i < indexCount; i++)
+    {
+        if (indices[i] >= mesh->vertexCount)
+            return 8;
+    }
+    free(indices);
+
+
+    //Delete mesh
+    sd_FreeMeshes(meshes, meshCount);
+
+    //Polygons can't be simplified
+    res = sd_LoadMesh(objectPath, 0, &meshes, &meshCount);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 9;
+
+    if (meshes[0].vertexStride != 3 && sd_SimplifyMesh(&meshes[0], 0, 1.0f, &indices, &indexCount, &error) != STARDUST_ERROR_INVALID_ARGUMENT)
+        return 10;
+
+    sd_FreeMeshes(meshes, meshCount);
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include "stardust.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+const char* objectPath = ".\\tests\\resources\\cube.obj";
+
+//Morton code of a point with the same grid as the library
+uint32_t mortonCode(const StardustBounds* bounds, float x, float y, float z)
+{
+    const float minimum[3] = { bounds->minX, bounds->minY, bounds->minZ };
+    const float maximum[3] = { bounds->maxX, bounds->maxY, bounds->maxZ };
+    const float position[3] = { x, y, z };
+
+    uint32_t code = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        float extent = maximum[i] - minimum[i];
+        float cell = extent > 0.0f ? (position[i] - minimum[i]) * (1023.0f / extent) : 0.0f;
+        if (!(cell > 0.0f))
+            cell = 0.0f;
+        else if (cell > 1023.0f)
+            cell = 1023.0f;
+
+        uint32_t value = (uint32_t)cell;
+        for (int bit = 0; bit < 10; bit++)
+            code |= ((value >> bit) & 1) << (bit * 3 + i);
+    }
+
+    return code;
+}
+
+uint32_t triangleCode(const StardustMesh* mesh, uint32_t triangle)
+{
+    const Vertex* a = &mesh->vertices[mesh->indices[triangle * 3]];
+    const Vertex* b = &mesh->vertices[mesh->indices[triangle * 3 + 1]];
+    const Vertex* c = &mesh->vertices[mesh->indices[triangle * 3 + 2]];
+
+    const float third = 1.0f / 3.0f;
+    return mortonCode(&mesh->bounds, (a->x + b->x + c->x) * third, (a->y + b->y + c->y) * third, (a->z + b->z + c->z) * third);
+}
+
+int main(int argc, char* argv[])
+{
+    //Load mesh
+    StardustMesh* original = 0;
+    StardustMesh* sorted = 0;
+    size_t meshCount = 0;
+
+    StardustErrorCode res = sd_LoadMesh(objectPath, STARDUST_MESH_TRIANGULATE, &original, &meshCount);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 1;
+
+    res = sd_LoadMesh(objectPath, STARDUST_MESH_TRIANGULATE | STARDUST_MESH_SORT_TRIANGLES | STARDUST_MESH_SORT_VERTICES, &sorted, &meshCount);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 2;
+
+    StardustPostProcessStages both = STARDUST_STAGE_SORT_TRIANGLES | STARDUST_STAGE_SORT_VERTICES;
+    if ((sorted->postProcessStages & both) != both)
+        return 3;
+
+    if (sorted->vertexCount != original->vertexCount || sorted->indexCount != original->indexCount)
+        return 4;
+
+    //Triangles and vertices are in Morton order
+    for (uint32_t i = 1; i < sorted->indexCount / 3; i++)
+    {
+        if (triangleCode(sorted, i - 1) > triangleCode(sorted, i))
+            return 5;
+    }
+
+    for (uint32_t i = 1; i < sorted->vertexCount; i++)
+    {
+        const Vertex* a = &sorted->vertices[i - 1];
+        const Vertex* b = &sorted->vertices[i];
+        if (mortonCode(&sorted->bounds, a->x, a->y, a->z) > mortonCode(&sorted->bounds, b->x, b->y, b->z))
+            return 6;
+    }
+
+    //Every triangle of the original mesh is still there once, with the same vertices
+    unsigned char* used = calloc(original->indexCount / 3, 1);
+    for (uint32_t i = 0; i < sorted->indexCount / 3; i++)
+    {
+        uint32_t match = 0;
+        for (; match < original->indexCount / 3; match++)
+        {
+            if (used[match])
+                continue;
+
+            int same = 1;
+            for (uint32_t j = 0; j < 3; j++)
+                same &= memcmp(&sorted->vertices[sorted->indices[i * 3 + j]], &original->vertices[original->indices[match * 3 + j]], sizeof(Vertex)) == 0;
+
+            if (same)
+                break;
+        }
+
+        if (match == original->indexCount / 3)
+            return 7;
+        used[match] = 1;
+    }
+    free(used);
+
+    //Delete mesh
+    sd_FreeMesh(original);
+    sd_FreeMesh(sorted);
+
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include "stardust.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define MAX_POLYGON_SIZE 512
+
+//Signed area of a polygon or triangle in the XY plane. Positive when counter clockwise
+float GetArea(const Vertex* vertices, const uint32_t* indices, uint32_t count)
+{
+    double area = 0.0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const Vertex* a = &vertices[indices[i]];
+        const Vertex* b = &vertices[indices[(i + 1) % count]];
+        area += (double)a->x * b->y - (double)b->x * a->y;
+    }
+
+    return (float)(area * 0.5);
+}
+
+//Triangulates one counter clockwise polygon and checks that the triangles cover it exactly
+int TestPolygon(const float* points, uint32_t pointCount)
+{
+    Vertex vertices[MAX_POLYGON_SIZE] = { 0 };
+    uint32_t polygon[MAX_POLYGON_SIZE];
+    for (uint32_t i = 0; i < pointCount; i++)
+    {
+        vertices[i].x = points[i * 2];
+        vertices[i].y = points[i * 2 + 1];
+        vertices[i].w = 1.0f;
+        polygon[i] = i;
+    }
+
+    StardustMesh* mesh = 0;
+    if (sd_CreateMesh(vertices, pointCount, polygon, pointCount, pointCount, 0, &mesh) != STARDUST_ERROR_SUCCESS)
+        return 1;
+
+    if (sd_PostProcessMesh(mesh, STARDUST_MESH_TRIANGULATE) != STARDUST_ERROR_SUCCESS)
+        return 2;
+
+    //n - 2 triangles made of the polygon's own vertices
+    if (mesh->vertexStride != 3 || mesh->indexCount != (pointCount - 2) * 3 || mesh->vertexCount != pointCount)
+        return 3;
+
+    for (uint32_t i = 0; i < mesh->indexCount; i++)
+    {
+        if (mesh->indices[i] >= pointCount)
+            return 4;
+    }
+
+    //Triangles that overlap or face the wrong way would make the unsigned total larger than the polygon
+    float polygonArea = GetArea(vertices, polygon, pointCount);
+    double signedTotal = 0.0;
+    double unsignedTotal = 0.0;
+    for (uint32_t i = 0; i < mesh->indexCount; i += 3)
+    {
+        float area = GetArea(mesh->vertices, &mesh->indices[i], 3);
+        signedTotal += area;
+        unsignedTotal += fabs(area);
+    }
+
+    float tolerance = polygonArea * 1e-3f;
+    if (fabs(signedTotal - polygonArea) > tolerance || fabs(unsignedTotal - polygonArea) > tolerance)
+        return 5;
+
+    sd_FreeMesh(mesh);
+
+    return 0;
+}
+
+//A bar along the X axis with a flat bottom and a saw tooth top
+uint32_t MakeComb(float* points, uint32_t teeth, float width, float height)
+{
+    uint32_t count = 0;
+    points[count++] = 0.0f; points[count++] = 0.0f;
+    points[count++] = width; points[count++] = 0.0f;
+
+    uint32_t topCount = teeth * 2 + 1;
+    for (uint32_t i = 0; i < topCount; i++)
+    {
+        points[count++] = width * (float)(topCount - 1 - i) / (float)(topCount - 1);
+        points[count++] = i % 2 == 0 ? height : height * 0.5f;
+    }
+
+    return count / 2;
+}
+
+//A star with alternating outer and inner points
+uint32_t MakeStar(float* points, uint32_t tips, float outer, float inner)
+{
+    for (uint32_t i = 0; i < tips * 2; i++)
+    {
+        float angle = 3.14159265f * (float)i / (float)tips;
+        float radius = i % 2 == 0 ? outer : inner;
+        points[i * 2] = cosf(angle) * radius;
+        points[i * 2 + 1] = sinf(angle) * radius;
+    }
+
+    return tips * 2;
+}
+
+int main(int argc, char* argv[])
+{
+    float points[MAX_POLYGON_SIZE * 2];
+    int res;
+
+    //A thin pentagon with a notch in its top. Its one reflex vertex used to get a grid far taller than one cell
+    const float pentagon[] = { 0.0f, 0.0f, 0.002f, 0.0f, 0.002f, 100.0f, 0.001f, 60.0f, 0.0f, 100.0f };
+    res = TestPolygon(pentagon, 5);
+    if (res != 0)
+        return 10 + res;
+
+    //The same notch lying along the X axis
+    const float flatPentagon[] = { 0.0f, 0.0f, 100.0f, 0.0f, 100.0f, 0.002f, 60.0f, 0.001f, 0.0f, 0.002f };
+    res = TestPolygon(flatPentagon, 5);
+    if (res != 0)
+        return 20 + res;
+
+    //Thin combs with a 100:1 and a 10000:1 aspect ratio
+    res = TestPolygon(points, MakeComb(points, 4, 100.0f, 1.0f));
+    if (res != 0)
+        return 30 + res;
+
+    res = TestPolygon(points, MakeComb(points, 200, 1000.0f, 0.1f));
+    if (res != 0)
+        return 40 + res;
+
+    //Large polygons with many reflex vertices
+    res = TestPolygon(points, MakeStar(points, 200, 10.0f, 4.0f));
+    if (res != 0)
+        return 50 + res;
+
+    res = TestPolygon(points, MakeComb(points, 250, 10.0f, 10.0f));
+    if (res != 0)
+        return 60 + res;
+
+    //A convex polygon takes the fan path
+    res = TestPolygon(points, MakeStar(points, 32, 5.0f, 5.0f));
+    if (res != 0)
+        return 70 + res;
+
+    //Random concave polygons. A star with random radii is always simple
+    srand(1);
+    for (uint32_t i = 0; i < 200; i++)
+    {
+        uint32_t count = 5 + rand() % 60;
+        float stretch = 1.0f + (float)(rand() % 1000);
+        for (uint32_t j = 0; j < count; j++)
+        {
+            float angle = 6.2831853f * (float)j / (float)count;
+            float radius = 0.2f + (float)rand() / (float)RAND_MAX;
+            points[j * 2] = cosf(angle) * radius * stretch;
+            points[j * 2 + 1] = sinf(angle) * radius;
+        }
+
+        res = TestPolygon(points, count);
+        if (res != 0)
+            return 80 + res;
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "stardust.h"
+
+#include <math.h>
+
+//Position, normal angle from +Z in degrees and texture U of every vertex. Every other value matches vertex 0
+const float vertexData[][5] =
+{
+    { 1.0f,    1.0f, 1.0f, 0.0f,  0.5f },   //0
+    { 1.004f,  1.0f, 1.0f, 0.0f,  0.5f },   //1 Within the position tolerance of 0, in the same grid cell
+    { 2.0095f, 0.0f, 0.0f, 0.0f,  0.5f },   //2
+    { 2.0105f, 0.0f, 0.0f, 0.0f,  0.5f },   //3 Within the position tolerance of 2, but in the next grid cell
+    { 1.02f,   1.0f, 1.0f, 0.0f,  0.5f },   //4 Too far from 0
+    { 1.0f,    1.0f, 1.0f, 5.0f,  0.5f },   //5 Normal within the angle of 0
+    { 1.0f,    1.0f, 1.0f, 20.0f, 0.5f },   //6 Normal too far from 0
+    { 1.0f,    1.0f, 1.0f, 0.0f,  0.505f }, //7 Texture coordinate within the tolerance of 0
+    { 1.0f,    1.0f, 1.0f, 0.0f,  0.52f },  //8 Texture coordinate too far from 0
+    { 2.0095f, 0.0f, 0.0f, 0.0f,  0.5f }    //9 Exact duplicate of 2
+};
+
+const uint32_t indices[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 4 };
+
+//Welded vertices are numbered in the order their clusters are first seen
+const uint32_t weldedIndices[] = { 0, 0, 1, 1, 2, 0, 3, 0, 4, 1, 0, 2 };
+
+int main(int argc, char* argv[])
+{
+    Vertex vertices[10] = { 0 };
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        float angle = vertexData[i][3] * 3.14159265f / 180.0f;
+        vertices[i].x = vertexData[i][0];
+        vertices[i].y = vertexData[i][1];
+        vertices[i].z = vertexData[i][2];
+        vertices[i].w = 1.0f;
+        vertices[i].normX = sinf(angle);
+        vertices[i].normZ = cosf(angle);
+        vertices[i].texU = vertexData[i][4];
+        vertices[i].texV = 0.5f;
+    }
+
+    StardustPostProcessSettings settings;
+    sd_GetPostProcessSettings(&settings);
+    settings.weldPositionTolerance = 0.01f;
+    settings.weldNormalAngle = 10.0f * 3.14159265f / 180.0f;
+    settings.weldUVTolerance = 0.01f;
+    sd_SetPostProcessSettings(&settings);
+
+    StardustMesh* mesh = 0;
+    StardustErrorCode res = sd_CreateMesh(vertices, 10, indices, 12, 3, STARDUST_NORMAL_DATA | STARDUST_TEXTURE_DATA, &mesh);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 1;
+
+    res = sd_PostProcessMesh(mesh, STARDUST_MESH_WELD_VERTICES);
+    if (res != STARDUST_ERROR_SUCCESS)
+        return 2;
+
+    if ((mesh->postProcessStages & STARDUST_STAGE_WELD_VERTICES) != STARDUST_STAGE_WELD_VERTICES)
+        return 3;
+
+    if (mesh->vertexCount != 5 || mesh->indexCount != 12)
+        return 4;
+
+    for (uint32_t i = 0; i < 12; i++)
+    {
+        if (mesh->indices[i] != weldedIndices[i])
+            return 5;
+    }
+
+    //The first vertex of each cluster is kept
+    if (mesh->vertices[1].x != 2.0095f || mesh->vertices[2].x != 1.02f || mesh->vertices[4].texU != 0.52f)
+        return 6;
+
+    //Delete mesh
+    sd_FreeMesh(mesh);
+
+    return 0;
+}